@@ -0,0 +1,311 @@
+// Kullanıcı alanı ağ bozma vekili (tc/netem olmayan CI için). Her --link bir localhost UDP
+// portunu dinler ve paketleri bozarak diğerine iletir; karşıdan gelen yanıtlar (PONG gibi)
+// aynı bağlantıdan son göndericiye bozulmadan geri döner.
+//
+//   kayıp  : loss=%  ya da Gilbert-Elliott ge=p,r[,iyi_kayıp,kötü_kayıp] (hepsi %)
+//   gecikme: delay=ms jitter=ms (düzgün ±jitter; paketler sıra değiştirebilir, fifo=1 engeller)
+//   sıra   : reorder=%[,ms] seçilen paketlere ek gecikme
+//   bant   : rate=kbps queue=ms (token bucket; kuyruk süresi aşılırsa kuyruk sonundan düşer)
+// Profil değişiklikleri bir betikten zamanla uygulanır ("<saniye> anahtar=değer ...", # yorum):
+//   0  rate=8000 delay=20 jitter=5
+//   10 rate=2000            # bant basamağı
+//   20 delay=300 fifo=1     # gecikme sıçraması
+//   22 delay=20
+// Tekrarlanabilirlik: bağlantı başına tohumlu RNG, paket başına sabit sayıda çekiliş. Aynı tohum
+// ve profille bir bağlantının k. paketinin kaderi aynıdır (gönderici aynı paketleri ürettikçe).
+//
+// İki uçlu yerel çağrı (video 6000->5000, 6001->5001; kontrol 7000->7003, 7002->7001):
+//   impair_proxy --seed=7 --log=run.csv --link=6000:5000 --script=steps.txt --link=6001:5001
+//                --link=7000:7003 --link=7002:7001
+//   nova_engine 127.0.0.1 6000 5001 7000 7001 ...     nova_engine 127.0.0.1 6001 5000 7002 7003 ...
+// Seçenekler (--profile, --script) kendilerinden önceki --link'e uygulanır.
+//
+//   impair_proxy --link=listen:forward [--profile="loss=1 delay=30"] [--script=file] ...
+//                [--seed=1] [--log=file.csv] [--seconds=0]
+#include <arpa/inet.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <poll.h>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+static std::atomic<bool> g_stop{false};
+
+static int64_t now_us() {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct Profile {
+  double loss = 0;                                  // bağımsız kayıp olasılığı
+  bool   ge = false;                                // Gilbert-Elliott açık
+  double ge_p = 0, ge_r = 1, ge_lg = 0, ge_lb = 1;  // iyi->kötü, kötü->iyi, durum kayıpları
+  double delay_ms = 0, jitter_ms = 0;
+  double reorder = 0, reorder_ms = 20;
+  bool   fifo = false;
+  double rate_kbps = 0;                             // 0 = sınırsız
+  double queue_ms = 200;
+};
+
+struct Step { double t_s; std::string spec; };
+
+struct Link {
+  int listen_port = 0, fwd_port = 0;
+  int in_fd = -1, out_fd = -1;
+  sockaddr_in client{};        // son gönderici: yanıtlar buna döner
+  bool have_client = false;
+  Profile prof;
+  std::vector<Step> steps;
+  size_t next_step = 0;
+  std::mt19937_64 rng;
+  bool ge_bad = false;
+  int64_t free_us = 0;         // bant sınırı: son paketin hattan çıkış anı
+  int64_t last_due_us = 0;     // fifo
+  uint64_t in = 0, fwd = 0, lost = 0, qdrop = 0, back = 0;
+};
+
+struct Pending {
+  int64_t due_us;
+  uint64_t order;              // eşit zamanlarda geliş sırası
+  size_t link;
+  std::vector<uint8_t> data;
+  bool operator>(const Pending& o) const { return due_us != o.due_us ? due_us > o.due_us : order > o.order; }
+};
+
+static double pct(const std::string& s) { return std::clamp(atof(s.c_str()) / 100.0, 0.0, 1.0); }
+
+// "anahtar=değer" listesi; verilmeyen anahtarlar değişmez
+static bool apply_spec(Profile& p, const std::string& spec) {
+  std::istringstream in(spec);
+  std::string tok;
+  while (in >> tok) {
+    const auto eq = tok.find('=');
+    if (eq == std::string::npos) return false;
+    const std::string k = tok.substr(0, eq), v = tok.substr(eq + 1);
+    std::vector<std::string> f;
+    std::stringstream vs(v);
+    for (std::string x; std::getline(vs, x, ',');) f.push_back(x);
+    if (f.empty()) return false;
+    if      (k == "loss")   { p.loss = pct(f[0]); p.ge = false; }
+    else if (k == "ge") {
+      if (f.size() < 2) return false;
+      p.ge = true; p.ge_p = pct(f[0]); p.ge_r = pct(f[1]);
+      p.ge_lg = f.size() > 2 ? pct(f[2]) : 0.0;
+      p.ge_lb = f.size() > 3 ? pct(f[3]) : 1.0;
+    }
+    else if (k == "delay")   p.delay_ms = std::max(0.0, atof(f[0].c_str()));
+    else if (k == "jitter")  p.jitter_ms = std::max(0.0, atof(f[0].c_str()));
+    else if (k == "reorder") { p.reorder = pct(f[0]); if (f.size() > 1) p.reorder_ms = std::max(0.0, atof(f[1].c_str())); }
+    else if (k == "fifo")    p.fifo = f[0] != "0";
+    else if (k == "rate")    p.rate_kbps = std::max(0.0, atof(f[0].c_str()));
+    else if (k == "queue")   p.queue_ms = std::max(1.0, atof(f[0].c_str()));
+    else return false;
+  }
+  return true;
+}
+
+static bool load_script(const std::string& path, std::vector<Step>& out) {
+  std::ifstream f(path);
+  if (!f) { fprintf(stderr, "cannot open script %s\n", path.c_str()); return false; }
+  for (std::string line; std::getline(f, line);) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream in(line);
+    Step s;
+    if (!(in >> s.t_s)) continue;
+    std::getline(in, s.spec);
+    s.spec.erase(0, s.spec.find_first_not_of(" \t"));
+    s.spec.erase(s.spec.find_last_not_of(" \t\r") + 1);
+    Profile check;
+    if (!apply_spec(check, s.spec)) { fprintf(stderr, "bad script line: %s\n", line.c_str()); return false; }
+    out.push_back(s);
+  }
+  std::stable_sort(out.begin(), out.end(), [](const Step& a, const Step& b) { return a.t_s < b.t_s; });
+  return true;
+}
+
+static int udp_socket(int port) {
+  int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) { perror("socket"); return -1; }
+  const int buf = 4 * 1024 * 1024;
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buf, sizeof(buf));
+  setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buf, sizeof(buf));
+  sockaddr_in a{}; a.sin_family = AF_INET; a.sin_port = htons(port); a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(fd, (sockaddr*)&a, sizeof(a)) < 0) { perror("bind"); close(fd); return -1; }
+  return fd;
+}
+
+// RTP ise sıra numarası (günlükte kayıpları akışla eşlemek için), değilse -1
+static int rtp_seq(const uint8_t* d, size_t n) {
+  return n >= 12 && (d[0] >> 6) == 2 ? (d[2] << 8 | d[3]) : -1;
+}
+
+int main(int argc, char** argv) {
+  std::vector<Link> links;
+  uint64_t seed = 1;
+  std::string log_path;
+  int seconds = 0;
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    auto v = [&](const char* k) -> const char* { size_t l = strlen(k); return a.compare(0, l, k) == 0 ? a.c_str() + l : nullptr; };
+    if (auto s = v("--link=")) {
+      Link l;
+      if (sscanf(s, "%d:%d", &l.listen_port, &l.fwd_port) != 2) { fprintf(stderr, "bad link %s\n", s); return 1; }
+      links.push_back(std::move(l));
+    }
+    else if (auto s = v("--profile=")) {
+      if (links.empty() || !apply_spec(links.back().prof, s)) { fprintf(stderr, "bad profile %s\n", s); return 1; }
+    }
+    else if (auto s = v("--script=")) {
+      if (links.empty() || !load_script(s, links.back().steps)) return 1;
+    }
+    else if (auto s = v("--seed=")) seed = strtoull(s, nullptr, 10);
+    else if (auto s = v("--log=")) log_path = s;
+    else if (auto s = v("--seconds=")) seconds = atoi(s);
+    else { fprintf(stderr, "unknown option %s\n", argv[i]); return 1; }
+  }
+  if (links.empty()) { fprintf(stderr, "usage: impair_proxy --link=listen:forward [--profile=...] [--script=file] ... [--seed=n] [--log=file.csv] [--seconds=n]\n"); return 1; }
+
+  FILE* log = nullptr;
+  if (!log_path.empty()) {
+    if (!(log = fopen(log_path.c_str(), "w"))) { perror(log_path.c_str()); return 1; }
+    setvbuf(log, nullptr, _IOFBF, 1 << 20);
+    fprintf(log, "t_ms,link,seq,bytes,outcome,delay_ms\n");
+  }
+
+  std::vector<pollfd> pfds;
+  for (size_t i = 0; i < links.size(); ++i) {
+    Link& l = links[i];
+    std::seed_seq ss{(uint32_t)seed, (uint32_t)(seed >> 32), (uint32_t)i};
+    l.rng.seed(ss);
+    if ((l.in_fd = udp_socket(l.listen_port)) < 0 || (l.out_fd = udp_socket(0)) < 0) return 1;
+    pfds.push_back({l.in_fd, POLLIN, 0});
+    pfds.push_back({l.out_fd, POLLIN, 0});
+    fprintf(stderr, "[link %zu] %d -> %d\n", i, l.listen_port, l.fwd_port);
+  }
+  std::signal(SIGINT, [](int) { g_stop = true; });
+  std::signal(SIGTERM, [](int) { g_stop = true; });
+
+  std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> sched;
+  uint64_t order = 0;
+  const int64_t t0 = now_us();
+  int64_t next_stats = t0 + 5000000;
+  std::uniform_real_distribution<double> U(0.0, 1.0);
+  alignas(8) uint8_t buf[65536];
+
+  while (!g_stop && (seconds <= 0 || now_us() - t0 < (int64_t)seconds * 1000000)) {
+    int64_t wait_us = 100000;
+    if (!sched.empty()) wait_us = std::clamp<int64_t>(sched.top().due_us - now_us(), 0, wait_us);
+    const timespec ts{(time_t)(wait_us / 1000000), (long)(wait_us % 1000000) * 1000};
+    if (ppoll(pfds.data(), pfds.size(), &ts, nullptr) < 0 && errno != EINTR) { perror("ppoll"); break; }
+
+    const int64_t now = now_us();
+    for (size_t i = 0; i < links.size(); ++i) {   // betik adımları
+      Link& l = links[i];
+      while (l.next_step < l.steps.size() && now - t0 >= (int64_t)(l.steps[l.next_step].t_s * 1e6)) {
+        apply_spec(l.prof, l.steps[l.next_step].spec);
+        fprintf(stderr, "[link %zu] t=%.1fs %s\n", i, l.steps[l.next_step].t_s, l.steps[l.next_step].spec.c_str());
+        if (log) fprintf(log, "%.3f,%zu,-1,0,step,0\n", (now - t0) / 1000.0, i);
+        ++l.next_step;
+      }
+    }
+
+    for (size_t i = 0; i < links.size(); ++i) {
+      Link& l = links[i];
+      // yanıt yönü: bozulmadan son göndericiye
+      for (ssize_t n; (n = recv(l.out_fd, buf, sizeof(buf), 0)) > 0;) {
+        if (!l.have_client) continue;
+        sendto(l.in_fd, buf, (size_t)n, 0, (sockaddr*)&l.client, sizeof(l.client));
+        ++l.back;
+      }
+      for (;;) {
+        sockaddr_in from{};
+        socklen_t fl = sizeof(from);
+        const ssize_t n = recvfrom(l.in_fd, buf, sizeof(buf), 0, (sockaddr*)&from, &fl);
+        if (n <= 0) break;
+        l.client = from; l.have_client = true;
+        ++l.in;
+        const Profile& p = l.prof;
+        // paket başına hep dört çekiliş: kader yalnızca tohuma ve paket sırasına bağlı
+        const double u_loss = U(l.rng), u_state = U(l.rng), u_jit = U(l.rng), u_reord = U(l.rng);
+        const double t_ms = (now - t0) / 1000.0;
+        const int seq = rtp_seq(buf, (size_t)n);
+
+        bool lose;
+        if (p.ge) {
+          lose = u_loss < (l.ge_bad ? p.ge_lb : p.ge_lg);
+          l.ge_bad = l.ge_bad ? !(u_state < p.ge_r) : u_state < p.ge_p;
+        } else {
+          lose = u_loss < p.loss;
+        }
+        if (lose) {
+          ++l.lost;
+          if (log) fprintf(log, "%.3f,%zu,%d,%zd,loss,0\n", t_ms, i, seq, n);
+          continue;
+        }
+
+        int64_t depart = now;
+        if (p.rate_kbps > 0) {
+          const int64_t start = std::max(now, l.free_us);
+          if (start - now > (int64_t)(p.queue_ms * 1000)) {
+            ++l.qdrop;
+            if (log) fprintf(log, "%.3f,%zu,%d,%zd,qdrop,%.3f\n", t_ms, i, seq, n, (start - now) / 1000.0);
+            continue;
+          }
+          l.free_us = start + (int64_t)(n * 8 * 1000.0 / p.rate_kbps);
+          depart = l.free_us;
+        }
+        double extra_ms = p.delay_ms + p.jitter_ms * (2.0 * u_jit - 1.0);
+        if (u_reord < p.reorder) extra_ms += p.reorder_ms;
+        int64_t due = depart + (int64_t)(std::max(0.0, extra_ms) * 1000);
+        if (p.fifo) due = std::max(due, l.last_due_us);
+        l.last_due_us = std::max(l.last_due_us, due);
+
+        if (log) fprintf(log, "%.3f,%zu,%d,%zd,fwd,%.3f\n", t_ms, i, seq, n, (due - now) / 1000.0);
+        sched.push({due, order++, i, std::vector<uint8_t>(buf, buf + n)});
+      }
+    }
+
+    for (int64_t t = now_us(); !sched.empty() && sched.top().due_us <= t;) {
+      const Pending& pk = sched.top();
+      Link& l = links[pk.link];
+      sockaddr_in dst{}; dst.sin_family = AF_INET; dst.sin_port = htons(l.fwd_port); dst.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      sendto(l.out_fd, pk.data.data(), pk.data.size(), 0, (sockaddr*)&dst, sizeof(dst));
+      ++l.fwd;
+      sched.pop();
+    }
+
+    if (now >= next_stats) {
+      next_stats = now + 5000000;
+      for (size_t i = 0; i < links.size(); ++i) {
+        const Link& l = links[i];
+        fprintf(stderr, "[link %zu] in=%llu fwd=%llu loss=%llu qdrop=%llu back=%llu\n", i,
+                (unsigned long long)l.in, (unsigned long long)l.fwd, (unsigned long long)l.lost,
+                (unsigned long long)l.qdrop, (unsigned long long)l.back);
+      }
+    }
+  }
+
+  printf("%-6s %7s %7s %10s %10s %10s %8s\n", "link", "listen", "fwd", "in", "loss", "qdrop", "loss%");
+  for (size_t i = 0; i < links.size(); ++i) {
+    const Link& l = links[i];
+    printf("%-6zu %7d %7d %10llu %10llu %10llu %8.2f\n", i, l.listen_port, l.fwd_port,
+           (unsigned long long)l.in, (unsigned long long)l.lost, (unsigned long long)l.qdrop,
+           l.in ? 100.0 * (l.lost + l.qdrop) / l.in : 0.0);
+    close(l.in_fd); close(l.out_fd);
+  }
+  if (log) fclose(log);
+  return 0;
+}
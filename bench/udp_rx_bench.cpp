@@ -0,0 +1,164 @@
+// UDP alım yolu karşılaştırması (loopback):
+//   udpsrc : udpsrc ! rtpjitterbuffer ! fakesink   (paket başına bir recvmsg + GstBuffer)
+//   ring   : UdpRxRing (recvmmsg + slab + seq ringi) -> appsrc ! fakesink
+// Gönderici thread'i sentetik RTP kareleri (PT 96, marker AU sonunda) yollar; CPU
+// ölçümünden göndericinin kendi thread süresi çıkarılır.
+//
+//   udp_rx_bench [--seconds=5] [--mbps=200] [--fps=60] [--mtu=1200] [--port=50992] [--latency=50]
+#include "udp_batch.hpp"
+#include "udp_rx_ring.hpp"
+#include <gst/gst.h>
+#include <gst/app/gstappsrc.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <optional>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+struct Opts { int seconds = 5; double mbps = 200; int fps = 60; int mtu = 1200; int port = 50992; int latency = 50; };
+
+static const char* RTP_CAPS = "application/x-rtp,media=video,clock-rate=90000,encoding-name=H264,payload=96";
+
+static double process_cpu_s() {
+  rusage ru{}; getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static double thread_cpu_s() {
+  timespec ts; clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static GstPadProbeReturn count_probe(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+  auto* n = static_cast<std::atomic<uint64_t>*>(user_data);
+  if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER_LIST)
+    *n += gst_buffer_list_length(GST_PAD_PROBE_INFO_BUFFER_LIST(info));
+  else
+    *n += 1;
+  return GST_PAD_PROBE_OK;
+}
+
+// sentetik H264 RTP akışı; dönüş: gönderilen paket sayısı, cpu_s: gönderici thread CPU'su
+static uint64_t send_stream(const Opts& o, double& cpu_s) {
+  UdpBatchSender tx("127.0.0.1", o.port);
+  tx.set_pacing(false);
+  const double frame_bytes = o.mbps * 1e6 / 8 / o.fps;
+  const int pkts = std::max(1, std::min(static_cast<int>(UdpBatchSender::MAX_BATCH), static_cast<int>(frame_bytes / o.mtu)));
+
+  std::vector<uint8_t> buf(static_cast<size_t>(pkts) * o.mtu, 0x5a);
+  uint16_t seq = 0;
+  uint32_t ts = 0;
+  uint64_t sent = 0;
+  const double cpu0 = thread_cpu_s();
+  const auto t0 = std::chrono::steady_clock::now();
+  const auto tend = t0 + std::chrono::seconds(o.seconds);
+  for (long f = 0; std::chrono::steady_clock::now() < tend; ++f) {
+    for (int i = 0; i < pkts; ++i) {
+      uint8_t* p = &buf[static_cast<size_t>(i) * o.mtu];
+      p[0] = 0x80; p[1] = 96 | (i == pkts - 1 ? 0x80 : 0);
+      p[2] = uint8_t(seq >> 8); p[3] = uint8_t(seq); ++seq;
+      p[4] = uint8_t(ts >> 24); p[5] = uint8_t(ts >> 16); p[6] = uint8_t(ts >> 8); p[7] = uint8_t(ts);
+      p[12] = 0x1c; p[13] = (i == 0 ? 0x80 : 0) | (i == pkts - 1 ? 0x40 : 0) | 1;   // FU-A
+      tx.push(p, o.mtu);
+    }
+    tx.flush();
+    sent += static_cast<uint64_t>(pkts);
+    ts += 90000 / o.fps;
+    std::this_thread::sleep_until(t0 + std::chrono::microseconds((f + 1) * 1000000 / o.fps));
+  }
+  cpu_s = thread_cpu_s() - cpu0;
+  return sent;
+}
+
+struct Result { double pkts_per_s, loss, cpu_ms_per_mbit, pkts_per_call; };
+
+static Result run(bool ring_mode, const Opts& o) {
+  char desc[512];
+  if (ring_mode)
+    snprintf(desc, sizeof(desc), "appsrc name=rxsrc is-live=true format=time caps=\"%s\" ! fakesink name=sink sync=false", RTP_CAPS);
+  else
+    snprintf(desc, sizeof(desc), "udpsrc port=%d buffer-size=8388608 caps=\"%s\" ! rtpjitterbuffer latency=%d"
+             " ! fakesink name=sink sync=false", o.port, RTP_CAPS, o.latency);
+  GError* err = nullptr;
+  GstElement* pipe = gst_parse_launch(desc, &err);
+  if (!pipe) { fprintf(stderr, "pipeline: %s\n", err ? err->message : "?"); std::exit(1); }
+
+  std::atomic<uint64_t> got{0};
+  GstElement* sink = gst_bin_get_by_name(GST_BIN(pipe), "sink");
+  GstPad* pad = gst_element_get_static_pad(sink, "sink");
+  gst_pad_add_probe(pad, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST), count_probe, &got, nullptr);
+  gst_object_unref(pad);
+  gst_object_unref(sink);
+
+  std::optional<UdpRxRing> ring;
+  if (ring_mode) {
+    ring.emplace(o.port, o.latency, 96);
+    if (!ring->ok()) std::exit(1);
+    GstElement* appsrc = gst_bin_get_by_name(GST_BIN(pipe), "rxsrc");
+    gst_object_unref(appsrc);
+    UdpRxRing* r = &*ring;
+    ring->on_au([r, appsrc](const RxPacket* pkts, size_t n, bool) {
+      GstBufferList* list = gst_buffer_list_new_sized(static_cast<guint>(n));
+      for (size_t i = 0; i < n; ++i)
+        gst_buffer_list_add(list, gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY, pkts[i].data, UdpRxRing::SLOT_SIZE,
+                                                              0, pkts[i].len, r->cookie(pkts[i].slot), UdpRxRing::release_cookie));
+      gst_app_src_push_buffer_list(GST_APP_SRC(appsrc), list);
+    });
+  }
+
+  gst_element_set_state(pipe, GST_STATE_PLAYING);
+  gst_element_get_state(pipe, nullptr, nullptr, GST_SECOND);
+  if (ring) ring->start();
+
+  const double cpu0 = process_cpu_s();
+  double tx_cpu = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  const uint64_t sent = send_stream(o, tx_cpu);
+  std::this_thread::sleep_for(std::chrono::milliseconds(o.latency + 200));
+  const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  const double rx_cpu = process_cpu_s() - cpu0 - tx_cpu;
+
+  Result res;
+  const uint64_t n = got.load();
+  res.pkts_per_s = n / secs;
+  res.loss = sent ? 1.0 - static_cast<double>(n) / sent : 0;
+  res.cpu_ms_per_mbit = rx_cpu * 1000 / (n * o.mtu * 8 / 1e6);
+  res.pkts_per_call = ring && ring->syscalls() ? static_cast<double>(ring->packets()) / ring->syscalls() : 1.0;
+
+  if (ring) ring->stop();
+  gst_element_set_state(pipe, GST_STATE_NULL);
+  gst_object_unref(pipe);
+  return res;
+}
+
+int main(int argc, char** argv) {
+  gst_init(&argc, &argv);
+  Opts o;
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    auto v = [&](const char* k) -> const char* { size_t l = strlen(k); return a.compare(0, l, k) == 0 ? a.c_str() + l : nullptr; };
+    if (auto s = v("--seconds=")) o.seconds = atoi(s);
+    else if (auto s = v("--mbps=")) o.mbps = atof(s);
+    else if (auto s = v("--fps=")) o.fps = atoi(s);
+    else if (auto s = v("--mtu=")) o.mtu = atoi(s);
+    else if (auto s = v("--port=")) o.port = atoi(s);
+    else if (auto s = v("--latency=")) o.latency = atoi(s);
+    else { fprintf(stderr, "unknown option %s\n", argv[i]); return 1; }
+  }
+
+  printf("# %.0f Mbps @%d fps, mtu %d, latency %d ms\n", o.mbps, o.fps, o.mtu, o.latency);
+  printf("%-7s %12s %8s %12s %10s\n", "mode", "pkts/s", "loss%", "cpu ms/Mbit", "pkts/call");
+  for (bool ring : {false, true}) {
+    Result r = run(ring, o);
+    printf("%-7s %12.0f %8.2f %12.4f %10.1f\n", ring ? "ring" : "udpsrc", r.pkts_per_s, r.loss * 100,
+           r.cpu_ms_per_mbit, r.pkts_per_call);
+  }
+  return 0;
+}
@@ -0,0 +1,141 @@
+// UDP gönderim yolu karşılaştırması (loopback):
+//   sendto   : paket başına bir syscall (udpsink'in tekil buffer yolu)
+//   sendmmsg : AU başına tek UdpBatchSender::flush(), pacer kapalı
+//   paced    : UdpBatchSender + token bucket pacer
+// Her mod için: sentetik kare akışında CPU/Mbps ve alıcı kaybı, ardından
+// kare zamanlaması olmadan azami paket/s.
+//
+//   udp_tx_bench [--seconds=5] [--mbps=18] [--fps=60] [--mtu=1200] [--port=50990] [--rcvbuf=262144]
+#include "udp_batch.hpp"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+struct Opts { int seconds = 5; double mbps = 18; int fps = 60; int mtu = 1200; int port = 50990; int rcvbuf = 256*1024; };
+
+static double thread_cpu_s() {
+  rusage ru{}; getrusage(RUSAGE_THREAD, &ru);
+  return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+class Drain {
+ public:
+  Drain(int port, int rcvbuf) {
+    fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    timeval tv{0, 100000};
+    setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    sockaddr_in a{}; a.sin_family = AF_INET; a.sin_port = htons(port); a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd_, (sockaddr*)&a, sizeof(a)) < 0) { perror("bind"); std::exit(1); }
+    thr_ = std::thread([this]{ run(); });
+  }
+  ~Drain() { stop_ = true; thr_.join(); close(fd_); }
+  uint64_t take() { return got_.exchange(0); }
+ private:
+  void run() {
+    static constexpr int N = 64;
+    std::vector<uint8_t> buf(N * 2048);
+    mmsghdr m[N]; iovec io[N];
+    for (int i = 0; i < N; ++i) {
+      io[i] = { &buf[i * 2048], 2048 };
+      memset(&m[i], 0, sizeof(m[i])); m[i].msg_hdr.msg_iov = &io[i]; m[i].msg_hdr.msg_iovlen = 1;
+    }
+    while (!stop_) {
+      int r = recvmmsg(fd_, m, N, 0, nullptr);
+      if (r > 0) got_ += static_cast<uint64_t>(r);
+    }
+  }
+  int fd_;
+  std::atomic<bool> stop_{false};
+  std::atomic<uint64_t> got_{0};
+  std::thread thr_;
+};
+
+enum class Mode { SENDTO, SENDMMSG, PACED };
+static const char* mode_name(Mode m) { return m == Mode::SENDTO ? "sendto" : m == Mode::SENDMMSG ? "sendmmsg" : "paced"; }
+
+struct Result { double pkts_per_s, mbps, cpu_s, loss; };
+
+// frames=true: gerçek kare zamanlaması (keyframe her 60 karede 8x); false: azami hız
+static Result run(Mode mode, const Opts& o, bool frames, Drain& drain) {
+  std::vector<uint8_t> payload(static_cast<size_t>(o.mtu), 0x5a);
+  payload[0] = 0x80;
+
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in dst{}; dst.sin_family = AF_INET; dst.sin_port = htons(o.port); dst.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  UdpBatchSender batch("127.0.0.1", o.port);
+  batch.set_frame_interval_us(1000000 / o.fps);
+  batch.set_pacing(mode == Mode::PACED);
+
+  const double frame_bytes = o.mbps * 1e6 / 8 / o.fps;
+  const int p_pkts = std::max(1, static_cast<int>(frame_bytes * 0.9 / o.mtu));
+  const int k_pkts = std::min(static_cast<int>(UdpBatchSender::MAX_BATCH), p_pkts * 8);
+
+  drain.take();
+  uint64_t sent = 0;
+  const double cpu0 = thread_cpu_s();
+  const auto t0 = std::chrono::steady_clock::now();
+  const auto tend = t0 + std::chrono::seconds(o.seconds);
+  for (long f = 0; std::chrono::steady_clock::now() < tend; ++f) {
+    const int n = frames ? (f % 60 == 0 ? k_pkts : p_pkts) : 256;
+    if (mode == Mode::SENDTO) {
+      for (int i = 0; i < n; ++i) sendto(fd, payload.data(), payload.size(), 0, (sockaddr*)&dst, sizeof(dst));
+    } else {
+      for (int i = 0; i < n; ++i) batch.push(payload.data(), payload.size());
+      batch.flush();
+    }
+    sent += static_cast<uint64_t>(n);
+    if (frames) std::this_thread::sleep_until(t0 + std::chrono::microseconds((f + 1) * 1000000 / o.fps));
+  }
+  const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  const double cpu = thread_cpu_s() - cpu0;
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  const uint64_t got = drain.take();
+  close(fd);
+
+  Result r;
+  r.pkts_per_s = sent / secs;
+  r.mbps = sent * o.mtu * 8 / secs / 1e6;
+  r.cpu_s = cpu / secs;
+  r.loss = sent ? 1.0 - static_cast<double>(got) / sent : 0;
+  return r;
+}
+
+int main(int argc, char** argv) {
+  Opts o;
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    auto v = [&](const char* k) -> const char* { size_t l = strlen(k); return a.compare(0, l, k) == 0 ? a.c_str() + l : nullptr; };
+    if (auto s = v("--seconds=")) o.seconds = atoi(s);
+    else if (auto s = v("--mbps=")) o.mbps = atof(s);
+    else if (auto s = v("--fps=")) o.fps = atoi(s);
+    else if (auto s = v("--mtu=")) o.mtu = atoi(s);
+    else if (auto s = v("--port=")) o.port = atoi(s);
+    else if (auto s = v("--rcvbuf=")) o.rcvbuf = atoi(s);
+    else { fprintf(stderr, "unknown option %s\n", argv[i]); return 1; }
+  }
+
+  Drain drain(o.port, o.rcvbuf);
+  printf("# %.0f Mbps @%d fps, mtu %d, receiver rcvbuf %d\n", o.mbps, o.fps, o.mtu, o.rcvbuf);
+  printf("%-9s %-7s %12s %9s %12s %8s\n", "mode", "load", "pkts/s", "Mbps", "cpu ms/Mbit", "loss%");
+  for (Mode m : {Mode::SENDTO, Mode::SENDMMSG, Mode::PACED}) {
+    Result r = run(m, o, true, drain);
+    printf("%-9s %-7s %12.0f %9.1f %12.4f %8.2f\n", mode_name(m), "frames", r.pkts_per_s, r.mbps,
+           r.cpu_s * 1000 / r.mbps, r.loss * 100);
+  }
+  for (Mode m : {Mode::SENDTO, Mode::SENDMMSG}) {
+    Result r = run(m, o, false, drain);
+    printf("%-9s %-7s %12.0f %9.1f %12.4f %8.2f\n", mode_name(m), "max", r.pkts_per_s, r.mbps,
+           r.cpu_s * 1000 / r.mbps, r.loss * 100);
+  }
+  return 0;
+}
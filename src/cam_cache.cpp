@@ -0,0 +1,116 @@
+#include "cam_cache.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+static constexpr const char* CACHE_MAGIC = "nova-cam-cache 2";   // 2: ayrık fps listeleri
+
+static bool same_identity(const V4l2Identity& a, const V4l2Identity& b) {
+  return a.driver == b.driver && a.card == b.card && a.bus_info == b.bus_info && a.version == b.version;
+}
+
+static std::vector<std::string> split_tabs(const std::string& line) {
+  std::vector<std::string> out;
+  std::string cur;
+  std::istringstream is(line);
+  while (std::getline(is, cur, '\t')) out.push_back(cur);
+  return out;
+}
+
+static void mkdir_parents(const std::string& path) {
+  for (size_t i = 1; i < path.size(); ++i) {
+    if (path[i] != '/') continue;
+    ::mkdir(path.substr(0, i).c_str(), 0755);
+  }
+}
+
+std::string CamCache::default_path() {
+  if (const char* p = std::getenv("NOVA_CAM_CACHE")) {
+    if (!*p || (p[0]=='0' && !p[1])) return "";
+    return p;
+  }
+  std::string base;
+  if (const char* x = std::getenv("XDG_CACHE_HOME"); x && *x) base = x;
+  else if (const char* h = std::getenv("HOME"); h && *h) base = std::string(h) + "/.cache";
+  else return "";
+  return base + "/nova_engine/cameras.txt";
+}
+
+bool CamCache::load(const std::string& path) {
+  entries_.clear();
+  std::ifstream in(path);
+  if (!in) return false;
+
+  std::string line;
+  if (!std::getline(in, line) || line != CACHE_MAGIC) return false;
+
+  while (std::getline(in, line)) {
+    auto f = split_tabs(line);
+    if (f.empty()) continue;
+    if (f[0] == "dev" && f.size() >= 9) {
+      CamCacheEntry e;
+      e.id.driver = f[1]; e.id.card = f[2]; e.id.bus_info = f[3];
+      e.id.version = static_cast<uint32_t>(std::strtoul(f[4].c_str(), nullptr, 10));
+      e.id.capture = true;
+      e.device = f[5];
+      e.validated = f[6] == "1";
+      CamProfile p; int mj = 0;
+      if (std::sscanf(f[8].c_str(), "%d %d %d %d", &p.width, &p.height, &p.fps, &mj) == 4 && f[7] == "1") {
+        p.device = e.device; p.mjpg = mj != 0;
+        e.best = p;
+      }
+      entries_.push_back(std::move(e));
+    } else if (f[0] == "win" && f.size() >= 2 && !entries_.empty()) {
+      CapsWindow w{}; int mj = 0;
+      if (std::sscanf(f[1].c_str(), "%d %d %d %d %d %d %d",
+                      &w.wmin, &w.wmax, &w.hmin, &w.hmax, &w.fmin, &w.fmax, &mj) == 7) {
+        w.mjpg = mj != 0;
+        if (f.size() >= 3) {
+          std::istringstream rs(f[2]);
+          for (std::string r; std::getline(rs, r, ',');) if (!r.empty()) w.rates.push_back(std::atoi(r.c_str()));
+        }
+        entries_.back().windows.push_back(std::move(w));
+      }
+    }
+  }
+  return true;
+}
+
+bool CamCache::save(const std::string& path) const {
+  mkdir_parents(path);
+  const std::string tmp = path + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::trunc);
+    if (!out) return false;
+    out << CACHE_MAGIC << "\n";
+    for (const auto& e : entries_) {
+      out << "dev\t" << e.id.driver << "\t" << e.id.card << "\t" << e.id.bus_info << "\t" << e.id.version
+          << "\t" << e.device << "\t" << (e.validated ? 1 : 0) << "\t" << (e.best ? 1 : 0) << "\t";
+      if (e.best) out << e.best->width << " " << e.best->height << " " << e.best->fps << " " << (e.best->mjpg ? 1 : 0);
+      else        out << "0 0 0 0";
+      out << "\n";
+      for (const auto& w : e.windows) {
+        out << "win\t" << w.wmin << " " << w.wmax << " " << w.hmin << " " << w.hmax << " "
+            << w.fmin << " " << w.fmax << " " << (w.mjpg ? 1 : 0);
+        for (size_t i = 0; i < w.rates.size(); ++i) out << (i ? "," : "\t") << w.rates[i];
+        out << "\n";
+      }
+    }
+    if (!out.flush()) return false;
+  }
+  return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+const CamCacheEntry* CamCache::find(const V4l2Identity& id) const {
+  for (const auto& e : entries_) if (same_identity(e.id, id)) return &e;
+  return nullptr;
+}
+
+void CamCache::put(const CamCacheEntry& e) {
+  for (auto& x : entries_) {
+    if (same_identity(x.id, e.id)) { x = e; return; }
+  }
+  entries_.push_back(e);
+}
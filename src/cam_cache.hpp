@@ -0,0 +1,32 @@
+#pragma once
+#include "camera.hpp"
+#include "v4l2_probe.hpp"
+#include <optional>
+#include <string>
+#include <vector>
+
+// Kalıcı kamera yetenek veritabanı. Anahtar: driver/card/bus_info/version;
+// kimlik değişmedikçe yeniden probe yapılmaz.
+struct CamCacheEntry {
+  V4l2Identity id;
+  std::string device;                // son görüldüğü düğüm
+  std::vector<CapsWindow> windows;
+  std::optional<CamProfile> best;
+  bool validated = false;            // best, validate_mode'dan geçti
+};
+
+class CamCache {
+ public:
+  // $NOVA_CAM_CACHE (dosya yolu, "0" = kapalı), yoksa $XDG_CACHE_HOME veya
+  // ~/.cache altında nova_engine/cameras.txt. Boş dönerse önbellek kapalıdır.
+  static std::string default_path();
+
+  bool load(const std::string& path);
+  bool save(const std::string& path) const;
+
+  const CamCacheEntry* find(const V4l2Identity& id) const;
+  void put(const CamCacheEntry& e);
+
+ private:
+  std::vector<CamCacheEntry> entries_;
+};
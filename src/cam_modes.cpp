@@ -0,0 +1,58 @@
+#include "cam_modes.hpp"
+#include "v4l2_probe.hpp"
+#include <algorithm>
+#include <optional>
+
+std::vector<CapsWindow> enumerate_caps(const std::string& devpath) {
+  std::vector<std::pair<int,int>> sizes;
+  for (int k=0; k<PREFERRED_COUNT; ++k) sizes.emplace_back(PREFERRED_MODES[k][0], PREFERRED_MODES[k][1]);
+
+  std::vector<CapsWindow> out;
+  for (const auto& m : v4l2_enumerate_modes(devpath, sizes)) {
+    if (m.width > MAX_W || m.height > MAX_H) continue;
+    CapsWindow w{m.width, m.width, m.height, m.height, m.fps_min, std::min(m.fps_max, MAX_FPS), m.mjpg, {}};
+    for (int f : m.rates) if (f <= MAX_FPS) w.rates.push_back(f);
+    if (!m.rates.empty() && w.rates.empty()) continue;
+    if (!w.rates.empty()) { w.fmin = w.rates.back(); w.fmax = w.rates.front(); }
+    out.push_back(std::move(w));
+  }
+  return out;
+}
+
+std::vector<CamProfile> rank_modes(const std::string& devpath, const std::vector<CapsWindow>& windows) {
+  std::vector<CamProfile> out;
+  if (windows.empty()) return out;
+
+  auto add = [&](const CamProfile& p) {
+    for (const auto& q : out)
+      if (q.width == p.width && q.height == p.height && q.fps == p.fps && q.mjpg == p.mjpg) return;
+    out.push_back(p);
+  };
+
+  for (bool mjpg : {true, false}) {
+    for (int k=0; k<PREFERRED_COUNT; ++k) {
+      int W = PREFERRED_MODES[k][0];
+      int H = PREFERRED_MODES[k][1];
+      int F = PREFERRED_MODES[k][2];
+      for (const auto& cw : windows) {
+        if (cw.mjpg != mjpg) continue;
+        if (W>=cw.wmin && W<=cw.wmax && H>=cw.hmin && H<=cw.hmax && cw.has_fps(F)) {
+          add(CamProfile{devpath, W,H,F, mjpg});
+          break;
+        }
+      }
+    }
+  }
+
+  // listede olmayan modlar: sürücünün bildirdiği en büyük gerçek mod
+  std::optional<CamProfile> largest;
+  for (const auto& cw : windows) {
+    CamProfile p{devpath, cw.wmax, cw.hmax, cw.fmax, cw.mjpg};
+    if (!largest || p.score() > largest->score() || (p.score()==largest->score() && p.mjpg && !largest->mjpg)) largest = p;
+  }
+  if (largest) add(*largest);
+
+  add(CamProfile{devpath, 1280,720,30, true});
+  add(CamProfile{devpath, 1280,720,30, false});
+  return out;
+}
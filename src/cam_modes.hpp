@@ -0,0 +1,29 @@
+#pragma once
+#include "camera.hpp"
+#include <string>
+#include <vector>
+
+// Kamera mod tablosu ve aday sıralaması (V4L2 ioctl; GStreamer boru hattı kurulmaz).
+inline constexpr int MAX_W = 7680;
+inline constexpr int MAX_H = 4320;
+inline constexpr int MAX_FPS = 240;
+
+inline constexpr int PREFERRED_MODES[][3] = {
+  {3840,2160,60}, {3840,2160,30},
+  {2560,1440,60}, {2560,1440,30},
+  {1920,1080,60}, {1920,1080,30},
+  {1600, 900,60}, {1600, 900,30},
+  {1280, 720,60}, {1280, 720,30},
+  {960, 540,30},
+  {848, 480,30},
+  {640, 480,30},
+};
+inline constexpr int PREFERRED_COUNT = sizeof(PREFERRED_MODES)/sizeof(PREFERRED_MODES[0]);
+
+// Sürücünün bildirdiği (format, boyut, hızlar); stepwise boyutlar tablo boyutlarında açılır
+std::vector<CapsWindow> enumerate_caps(const std::string& devpath);
+
+// Doğrulanacak modlar tercih sırasıyla: tablodaki MJPG modları, tablodaki ham modlar, sürücünün
+// bildirdiği en büyük gerçek mod, son çare 1280x720@30 (MJPG, ham). Biri doğrulanamazsa
+// sıradaki denenir; pencere yoksa boş.
+std::vector<CamProfile> rank_modes(const std::string& devpath, const std::vector<CapsWindow>& windows);
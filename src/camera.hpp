@@ -0,0 +1,29 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <vector>
+
+struct CamProfile {
+  std::string device;
+  int width = 0, height = 0, fps = 0;
+  bool mjpg = false;
+  long long score() const { return 1LL * width * height * fps; }
+};
+
+// rates boş değilse sürücü ayrık aralıklar bildirdi: yalnızca listedeki hızlar geçerli
+// (fmin/fmax listenin uçları); boşsa fmin..fmax sürekli aralık.
+struct CapsWindow {
+  int wmin,wmax,hmin,hmax,fmin,fmax; bool mjpg;
+  std::vector<int> rates;   // büyükten küçüğe
+
+  bool has_fps(int F) const {
+    if (rates.empty()) return F >= fmin && F <= fmax;
+    return std::find(rates.begin(), rates.end(), F) != rates.end();
+  }
+  // F'i aşmayan en yüksek geçerli hız; yoksa 0
+  int fps_upto(int F) const {
+    if (rates.empty()) return F < fmin ? 0 : std::min(F, fmax);
+    for (int r : rates) if (r <= F) return r;
+    return 0;
+  }
+};
@@ -0,0 +1,113 @@
+#include "clock_sync.hpp"
+#include <algorithm>
+
+void ClockSync::on_sample(const ClockSample& s) {
+  const int64_t t1 = (int64_t)s.t1_us, t2 = (int64_t)s.t2_us, t3 = (int64_t)s.t3_us, t4 = (int64_t)s.t4_us;
+  if (t4 < t1 || t3 < t2) return;   // eski PONG (t3 yok) t3 = t2 ile gelir
+  const double offset = ((t2 - t1) + (t3 - t4)) / 2.0;
+  const double delay  = std::max<int64_t>(0, (t4 - t1) - (t3 - t2));
+
+  std::lock_guard<std::mutex> lk(mu_);
+  raw_.push_back({t4, offset, delay});
+  if (raw_.size() > FILTER) raw_.pop_front();
+  const Raw& best = *std::min_element(raw_.begin(), raw_.end(),
+                                      [](const Raw& a, const Raw& b) { return a.delay_us < b.delay_us; });
+  delay_us_ = best.delay_us;
+  // aynı en iyi örnek birkaç tur seçilebilir: noktalar tekrarlanmaz
+  if (points_.empty() || points_.back().t_us < best.t_us) points_.push_back({best.t_us, best.offset_us});
+  while (points_.size() > 2 && t4 - points_.front().t_us > FIT_WINDOW_US) points_.pop_front();
+
+  const Point& last = points_.back();
+  drift_ = 0;
+  if (points_.size() >= 4 && last.t_us - points_.front().t_us >= FIT_MIN_SPAN_US) {
+    double mt = 0, mo = 0;
+    for (const auto& p : points_) { mt += p.t_us - last.t_us; mo += p.offset_us; }
+    mt /= points_.size(); mo /= points_.size();
+    double sxy = 0, sxx = 0;
+    for (const auto& p : points_) {
+      const double dt = (p.t_us - last.t_us) - mt;
+      sxy += dt * (p.offset_us - mo);
+      sxx += dt * dt;
+    }
+    if (sxx > 0) drift_ = std::clamp(sxy / sxx, -MAX_DRIFT_PPM * 1e-6, MAX_DRIFT_PPM * 1e-6);
+    ref_t_us_ = last.t_us;
+    ref_offset_us_ = mo - drift_ * mt;   // doğrunun son noktadaki değeri
+  } else {
+    ref_t_us_ = last.t_us;
+    ref_offset_us_ = last.offset_us;
+  }
+  valid_ = true;
+}
+
+void ClockSync::reset() {
+  std::lock_guard<std::mutex> lk(mu_);
+  raw_.clear(); points_.clear();
+  valid_ = false;
+  ref_t_us_ = 0; ref_offset_us_ = drift_ = delay_us_ = 0;
+}
+
+double ClockSync::offset_at(int64_t local_us) const {
+  return ref_offset_us_ + drift_ * (local_us - ref_t_us_);
+}
+
+bool ClockSync::valid() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return valid_;
+}
+
+int64_t ClockSync::peer_to_local_us(uint64_t peer_us) const {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (!valid_) return 0;
+  // yerel = eş - ofset(yerel); ofset yavaş değiştiğinden tek yineleme yeterli
+  const double guess = (double)peer_us - ref_offset_us_;
+  return (int64_t)((double)peer_us - offset_at((int64_t)guess));
+}
+
+double ClockSync::offset_us() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (!valid_) return 0;
+  return offset_at(raw_.empty() ? ref_t_us_ : raw_.back().t_us);
+}
+
+double ClockSync::drift_ppm() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return drift_ * 1e6;
+}
+
+double ClockSync::delay_us() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return delay_us_;
+}
+
+void OwdTracker::on_sender_report(uint32_t rtp_ts, uint64_t capture_us) {
+  std::lock_guard<std::mutex> lk(mu_);
+  have_sr_ = true;
+  sr_rtp_ts_ = rtp_ts;
+  sr_capture_us_ = capture_us;
+}
+
+void OwdTracker::on_frame(uint32_t rtp_ts, uint64_t arrival_us) {
+  uint32_t sr_ts;
+  uint64_t sr_cap;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (!have_sr_) return;
+    sr_ts = sr_rtp_ts_; sr_cap = sr_capture_us_;
+  }
+  if (!clock_.valid()) return;
+  // SR'den bu yana geçen medya zamanı (±2^31 tick, 90 kHz'de ~6 saat)
+  const int64_t dts = (int32_t)(rtp_ts - sr_ts);
+  const int64_t capture_peer = (int64_t)sr_cap + dts * 1000000 / (int64_t)clock_rate_;
+  if (capture_peer <= 0) return;
+  const int64_t capture_local = clock_.peer_to_local_us((uint64_t)capture_peer);
+  hist_.record((int64_t)arrival_us - capture_local, arrival_us * 1000);
+}
+
+void OwdTracker::reset() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    have_sr_ = false;
+  }
+  clock_.reset();
+  hist_.reset();
+}
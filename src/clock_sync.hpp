@@ -0,0 +1,70 @@
+#pragma once
+#include "stage_metrics.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+// PING/PONG'un dört zaman damgası (µs): t1 PING gönderimi (yerel), t2 eşte alım, t3 eşte PONG
+// gönderimi (eş saati), t4 PONG alımı (yerel). Saatler steady (CLOCK_MONOTONIC): ortak epoch yok,
+// ofset açılıştan açılışa değişir.
+struct ClockSample { uint64_t t1_us, t2_us, t3_us, t4_us; };
+
+// NTP tarzı eş saat tahmini: offset = ((t2 - t1) + (t3 - t4)) / 2 (eş - yerel),
+// delay = (t4 - t1) - (t3 - t2). Asimetrik kuyruklanma ofseti bozar; son 8 örnekten en küçük
+// gecikmeli olanı alınır (saat filtresi). Kayma: filtrelenmiş ofsetlere son 60 sn üzerinde
+// en küçük kareler; en az 10 sn veri olmadan kayma 0 sayılır.
+// on_sample() kontrol thread'inden, dönüşümler herhangi bir thread'den.
+class ClockSync {
+ public:
+  void on_sample(const ClockSample& s);
+  void reset();
+
+  bool valid() const;
+  // eş saatindeki an -> yerel steady µs (geçerli değilse 0)
+  int64_t peer_to_local_us(uint64_t peer_us) const;
+  double offset_us() const;     // şimdiki an için eş - yerel
+  double drift_ppm() const;     // eş saati yerel saate göre ne kadar hızlı
+  double delay_us() const;      // filtrelenmiş örneğin gidiş-dönüşü (eşteki bekleme hariç)
+
+ private:
+  struct Raw { int64_t t_us; double offset_us, delay_us; };
+  struct Point { int64_t t_us; double offset_us; };
+  static constexpr size_t FILTER = 8;
+  static constexpr int64_t FIT_WINDOW_US = 60000000, FIT_MIN_SPAN_US = 10000000;
+  static constexpr double MAX_DRIFT_PPM = 500.0;
+
+  double offset_at(int64_t local_us) const;   // mu_ tutulurken
+
+  mutable std::mutex mu_;
+  std::deque<Raw> raw_;
+  std::deque<Point> points_;
+  bool valid_ = false;
+  int64_t ref_t_us_ = 0;
+  double ref_offset_us_ = 0, drift_ = 0, delay_us_ = 0;
+};
+
+// Tek yön gecikme: gönderenin SENDER_REPORT'u (RTP zaman damgası <-> yakalama anı, gönderen saati)
+// + ClockSync ile her karenin yakalamadan alımına (marker paketi) kadar geçen süre.
+// Ağ + gönderen boru hattı (kodlama, paketleme, pacing) birlikte; alıcı tarafı dahil değil.
+class OwdTracker {
+ public:
+  explicit OwdTracker(uint32_t clock_rate = 90000) : clock_rate_(clock_rate) {}
+
+  void on_sender_report(uint32_t rtp_ts, uint64_t capture_us);   // kontrol thread'i
+  void on_frame(uint32_t rtp_ts, uint64_t arrival_us);            // streaming thread'i, marker paketi
+  void reset();
+
+  ClockSync& clock() { return clock_; }
+  const ClockSync& clock() const { return clock_; }
+  const RollingHistogram& histogram() const { return hist_; }
+
+ private:
+  const uint32_t clock_rate_;
+  ClockSync clock_;
+  RollingHistogram hist_;
+  std::mutex mu_;
+  bool have_sr_ = false;
+  uint32_t sr_rtp_ts_ = 0;
+  uint64_t sr_capture_us_ = 0;
+};
@@ -0,0 +1,188 @@
+#include "codec.hpp"
+#include "common.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+
+static bool has_factory(const char* name) {
+  GstElementFactory* f = gst_element_factory_find(name);
+  if (f) { gst_object_unref(f); return true; }
+  return false;
+}
+
+static bool starts_with(const std::string& s, const char* p) { return s.rfind(p, 0) == 0; }
+
+// eklenti sürümüne göre olmayabilecek özellikler
+static void try_int(GstElement* e, const char* prop, int v)  { if (has_prop(e, prop)) set_int(e, prop, v); }
+static void try_bool(GstElement* e, const char* prop, gboolean v) { if (has_prop(e, prop)) set_bool(e, prop, v); }
+static void try_arg(GstElement* e, const char* prop, const char* v) { if (has_prop(e, prop)) set_arg(e, prop, v); }
+
+std::vector<std::string> installed_encoders() {
+  std::vector<std::string> out;
+  for (int i = 0; i < CODEC_COUNT; ++i) {
+    const CodecInfo& c = codec_info(static_cast<Codec>(i));
+    for (const char* e : c.encoders) if (has_factory(e) && has_factory(c.pay)) out.push_back(e);
+  }
+  return out;
+}
+
+// Fabrika var ama cihaz yok (CUDA/VA sürücüsü açılamıyor) olabilir: READY'ye geçebiliyor mu.
+static bool decoder_opens(const char* name) {
+  GstElement* d = gst_element_factory_make(name, nullptr);
+  if (!d) return false;
+  gst_object_ref_sink(d);
+  const bool ok = gst_element_set_state(d, GST_STATE_READY) != GST_STATE_CHANGE_FAILURE;
+  gst_element_set_state(d, GST_STATE_NULL);
+  gst_object_unref(d);
+  return ok;
+}
+
+std::string choose_decoder(Codec c, const std::string& pref) {
+  if (pref != "auto" && pref != "sw") return has_factory(pref.c_str()) ? pref : "";
+  const char* force = std::getenv("NOVA_FORCE_SWDEC");
+  const bool sw_only = pref == "sw" || (force && *force=='1');
+
+  // donanım denemesi cihaz açar: kodek başına bir kez
+  static std::mutex mu;
+  static std::string cache[CODEC_COUNT][2];
+  static bool cached[CODEC_COUNT][2] = {};
+  std::lock_guard<std::mutex> lk(mu);
+  const int ci = static_cast<int>(c), si = sw_only ? 1 : 0;
+  if (cached[ci][si]) return cache[ci][si];
+  std::string out;
+  for (const char* d : codec_info(c).decoders) {
+    if (!has_factory(d)) continue;
+    if (is_hw_decoder(d) && (sw_only || !decoder_opens(d))) continue;
+    out = d;
+    break;
+  }
+  cached[ci][si] = true;
+  return cache[ci][si] = out;
+}
+
+std::string configure_decoder(GstElement* dec, const std::string& name, int threads, const std::string& threading) {
+  std::string label = name;
+  if (starts_with(name, "avdec_")) {
+    // frame: daha yüksek verim, (iş parçacığı - 1) kare ek gecikme; slice: gecikme yok, kodlayıcı
+    // birden çok dilim üretiyorsa ölçeklenir
+    if (threading != "auto" && has_prop(dec, "thread-type")) { set_arg(dec, "thread-type", threading.c_str()); label += " " + threading; }
+    if (threads > 0 && has_prop(dec, "max-threads")) { set_int(dec, "max-threads", threads); label += " x" + std::to_string(threads); }
+  } else if (name == "dav1ddec") {
+    if (threads > 0) { try_int(dec, "n-threads", threads); label += " x" + std::to_string(threads); }
+    if (threading == "slice") { try_int(dec, "max-frame-delay", 1); label += " delay=1"; }
+  } else if (name == "vp9dec") {
+    if (threads > 0) { try_int(dec, "threads", threads); label += " x" + std::to_string(threads); }
+  }
+  if (is_hw_decoder(name)) label += " (hw)";
+  return label;
+}
+
+uint8_t decodable_codecs() {
+  uint8_t mask = 0;
+  for (int i = 0; i < CODEC_COUNT; ++i) {
+    const CodecInfo& c = codec_info(static_cast<Codec>(i));
+    if (!has_factory(c.depay) || (c.parse && !has_factory(c.parse))) continue;
+    if (!choose_decoder(c.codec, "auto").empty()) mask |= uint8_t(1u << static_cast<int>(c.codec));
+  }
+  return mask;
+}
+
+void configure_encoder(GstElement* enc, const std::string& enc_name, int kbps, int keyint, int threads) {
+  const std::string fam = encoder_family(enc_name);
+  if (enc_name == "nvh264enc" || enc_name == "nvh265enc") {
+    set_str(enc, "preset", "low-latency-hq"); set_str(enc, "rc", "cbr");
+    set_int(enc, "key-int-max", keyint); set_bool(enc, "zerolatency", TRUE);
+  } else if (fam == "nv") {               // nvav1enc: yeni nvcodec ön ayarları
+    try_arg(enc, "preset", "p1"); try_arg(enc, "tune", "ultra-low-latency");
+    try_arg(enc, "rate-control", "cbr"); try_int(enc, "gop-size", keyint);
+  } else if (fam == "vaapi") {
+    set_arg(enc, "rate-control", "cbr");
+    set_int(enc, "keyframe-period", keyint);
+  } else if (fam == "qsv") {
+    try_arg(enc, "rate-control", "cbr"); try_int(enc, "gop-size", keyint);
+  } else if (fam == "va") {
+    // sürücü varsayılanları; yalnızca bitrate (aşağıda)
+  } else if (enc_name == "x265enc") {
+    set_arg(enc, "tune", "zerolatency"); set_arg(enc, "speed-preset", "ultrafast");
+    set_int(enc, "key-int-max", keyint);
+  } else if (enc_name == "vp9enc") {
+    set_int(enc, "deadline", 1);          // realtime
+    set_int(enc, "cpu-used", 8);
+    set_arg(enc, "end-usage", "cbr");
+    set_int(enc, "lag-in-frames", 0);
+    set_int(enc, "keyframe-max-dist", keyint);
+    try_bool(enc, "row-mt", TRUE);
+    if (threads > 0) set_int(enc, "threads", threads);
+  } else if (enc_name == "svtav1enc") {
+    try_int(enc, "preset", 12);
+    try_int(enc, "intra-period-length", keyint);
+  } else if (enc_name == "rav1enc") {
+    try_int(enc, "speed-preset", 10); try_bool(enc, "low-latency", TRUE);
+    try_int(enc, "max-key-frame-interval", keyint);
+    if (threads > 0) try_int(enc, "threads", threads);
+  } else if (enc_name == "av1enc") {      // libaom: yalnızca karşılaştırma için, canlıda yavaş
+    try_arg(enc, "usage-profile", "realtime"); try_int(enc, "cpu-used", 10);
+    try_arg(enc, "end-usage", "cbr"); try_int(enc, "lag-in-frames", 0);
+    try_int(enc, "keyframe-max-dist", keyint);
+    if (threads > 0) try_int(enc, "threads", threads);
+  } else { // x264enc
+    set_arg(enc, "tune", "zerolatency"); set_arg(enc, "speed-preset", "ultrafast");
+    set_int(enc, "key-int-max", keyint); set_bool(enc, "byte-stream", TRUE);
+    if (threads > 0) set_int(enc, "threads", threads);
+  }
+  set_encoder_bitrate(enc, enc_name, kbps);
+}
+
+void set_encoder_bitrate(GstElement* enc, const std::string& enc_name, int kbps) {
+  const std::string fam = encoder_family(enc_name);
+  if (enc_name == "vp9enc")                            set_int(enc, "target-bitrate", kbps*1000);
+  else if (enc_name == "rav1enc")                           set_int(enc, "bitrate", kbps*1000);
+  else if (enc_name == "svtav1enc" || enc_name == "av1enc") set_int(enc, "target-bitrate", kbps);
+  else set_int(enc, "bitrate", kbps);   // x264/x265, nv, vaapi, qsv, va: kbit/s
+}
+
+// configure_encoder'daki aralık özelliği; va ailesi orada sürücü varsayılanında bırakılır
+static const char* keyint_prop(const std::string& enc_name) {
+  const std::string fam = encoder_family(enc_name);
+  if (enc_name == "nvh264enc" || enc_name == "nvh265enc") return "key-int-max";
+  if (fam == "nv" || fam == "qsv")                        return "gop-size";
+  if (fam == "vaapi")                                     return "keyframe-period";
+  if (enc_name == "vp9enc" || enc_name == "av1enc")       return "keyframe-max-dist";
+  if (enc_name == "svtav1enc")                            return "intra-period-length";
+  if (enc_name == "rav1enc")                              return "max-key-frame-interval";
+  return "key-int-max";                                   // x264enc, x265enc, va
+}
+
+bool set_encoder_keyint(GstElement* enc, const std::string& enc_name, int keyint) {
+  GParamSpec* ps = g_object_class_find_property(G_OBJECT_GET_CLASS(enc), keyint_prop(enc_name));
+  if (!ps) return false;
+  if (GST_STATE(enc) > GST_STATE_READY && !(ps->flags & GST_PARAM_MUTABLE_PLAYING)) return false;
+  set_int(enc, ps->name, keyint);
+  return true;
+}
+
+std::vector<std::string> encoder_raw_formats(GstElement* enc) {
+  std::vector<std::string> out;
+  GstPad* pad = gst_element_get_static_pad(enc, "sink");
+  if (!pad) return out;
+  GstCaps* caps = gst_pad_query_caps(pad, nullptr);
+  gst_object_unref(pad);
+  if (!caps) return out;
+  auto add = [&out](const GValue* v) {
+    if (!G_VALUE_HOLDS_STRING(v)) return;
+    const std::string f = g_value_get_string(v);
+    if (std::find(out.begin(), out.end(), f) == out.end()) out.push_back(f);
+  };
+  for (guint i=0; i<gst_caps_get_size(caps); ++i) {
+    GstCapsFeatures* feat = gst_caps_get_features(caps, i);
+    if (feat && !gst_caps_features_is_equal(feat, GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY)) continue;
+    const GstStructure* st = gst_caps_get_structure(caps, i);
+    if (!gst_structure_has_name(st, "video/x-raw")) continue;
+    const GValue* v = gst_structure_get_value(st, "format");
+    if (!v) continue;
+    if (GST_VALUE_HOLDS_LIST(v)) for (guint j=0; j<gst_value_list_get_size(v); ++j) add(gst_value_list_get_value(v, j));
+    else add(v);
+  }
+  gst_caps_unref(caps);
+  return out;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// GStreamer başlığı gerekmez: tablo ve bit akışı yardımcıları (codec_info.cpp) testlerde GStreamer'sız
+// derlenir; eleman seçimi/ayarı codec.cpp'de.
+typedef struct _GstElement GstElement;
+
+// Video kodekleri ve kodlayıcı aileleri. Kimlikler kontrol kanalında (CODEC_CAPS) taşınır:
+// değerler değişmemeli.
+enum class Codec : uint8_t { H264 = 0, H265 = 1, VP9 = 2, AV1 = 3 };
+constexpr int CODEC_COUNT = 4;
+
+struct CodecInfo {
+  Codec codec;
+  const char* name;          // "h264" (komut satırı / günlük)
+  const char* rtp_name;      // RTP caps encoding-name
+  const char* parse;         // bitstream ayrıştırıcı; nullptr = gerekmez
+  const char* pay;
+  const char* depay;
+  std::vector<const char*> encoders;   // varsayılan sıra: donanım önce, CPU en son
+  std::vector<const char*> decoders;   // tercih sırası
+};
+
+const CodecInfo& codec_info(Codec c);
+bool codec_from_name(const std::string& name, Codec& out);
+// bilinmeyen kodlayıcı H264 sayılır (eski davranış)
+Codec codec_of_encoder(const std::string& encoder);
+
+// "nv", "vaapi", "va", "qsv" ya da "sw": aynı cihazdaki çözücü / dmabuf kararları için
+std::string encoder_family(const std::string& encoder);
+
+// kurulu kodlayıcılar (tüm kodekler, tablo sırası)
+std::vector<std::string> installed_encoders();
+// depay + (gerekiyorsa) parse + en az bir çözücü kuruluysa bit set: 1 << Codec
+uint8_t decodable_codecs();
+// Çözücü seçimi, choose_h264_encoder gibi: auto = açılabilen ilk donanım çözücü, yoksa yazılım;
+// sw = yalnızca yazılım ($NOVA_FORCE_SWDEC=1 auto'yu da böyle yapar); diğer değerler eleman adı.
+// Bulunamazsa boş.
+std::string choose_decoder(Codec c, const std::string& pref = "auto");
+bool is_hw_decoder(const std::string& decoder);
+// threading: auto | slice | frame (yalnızca yazılım çözücüler); threads 0 = otomatik.
+// Günlük için etiket döner ("avdec_h264 slice x4").
+std::string configure_decoder(GstElement* dec, const std::string& name, int threads, const std::string& threading);
+
+// Erişim birimi hiçbir karenin referansı değilse true (atlanırsa sonraki kareler bozulmaz).
+// H264: tüm dilimlerde nal_ref_idc == 0; H265: tüm VCL NAL'lar alt katman referans olmayan tiplerde.
+// length_prefixed: avc/hvc1 (4 bayt uzunluk), değilse byte-stream. VP9/AV1 için false.
+bool au_is_nonref(Codec c, const uint8_t* data, size_t size, bool length_prefixed);
+
+// Düşük gecikme ayarları (B-kare yok, CBR, keyint) + bitrate. threads: yalnızca CPU kodlayıcılar, 0 = otomatik
+void configure_encoder(GstElement* enc, const std::string& enc_name, int kbps, int keyint, int threads);
+// bitrate birimi kodlayıcıya göre değişir; canlıyken de çağrılabilir
+void set_encoder_bitrate(GstElement* enc, const std::string& enc_name, int kbps);
+// Anahtar kare aralığı (kare). Çoğu kodlayıcı bunu yalnızca READY'de kabul eder: canlıyken
+// özellik PLAYING'de değiştirilemiyorsa false döner ve hiçbir şey yapılmaz.
+bool set_encoder_keyint(GstElement* enc, const std::string& enc_name, int keyint);
+
+// Kodlayıcının sistem belleğinde kabul ettiği ham formatlar, kendi tercih sırasıyla.
+std::vector<std::string> encoder_raw_formats(GstElement* enc);
+
+// Gönderen sıralı kodekleri, alıcı çözebildiklerini (maske) bildirir: sıradaki ilk ortak kodek,
+// yoksa H264. Anlaşmadaki iki uç aynı kuralı çalıştırır.
+Codec pick_codec(const uint8_t* ranked, size_t n, uint8_t decode_mask);
@@ -0,0 +1,97 @@
+#include "codec.hpp"
+#include <cstdint>
+
+// Kodek tablosu ve bit akışı yardımcıları: GStreamer'a dokunmaz (birim testleri bağlar).
+
+static const CodecInfo CODECS[CODEC_COUNT] = {
+  {Codec::H264, "h264", "H264", "h264parse", "rtph264pay", "rtph264depay",
+   {"nvh264enc", "vaapih264enc", "qsvh264enc", "vah264enc", "x264enc"},
+   {"nvh264dec", "vah264dec", "vaapih264dec", "qsvh264dec", "v4l2slh264dec", "avdec_h264"}},
+  {Codec::H265, "h265", "H265", "h265parse", "rtph265pay", "rtph265depay",
+   {"nvh265enc", "vaapih265enc", "qsvh265enc", "vah265enc", "x265enc"},
+   {"nvh265dec", "vah265dec", "vaapih265dec", "qsvh265dec", "v4l2slh265dec", "avdec_h265"}},
+  {Codec::VP9, "vp9", "VP9", nullptr, "rtpvp9pay", "rtpvp9depay",
+   {"vaapivp9enc", "qsvvp9enc", "vavp9enc", "vp9enc"},
+   {"nvvp9dec", "vavp9dec", "vaapivp9dec", "qsvvp9dec", "v4l2slvp9dec", "vp9dec", "avdec_vp9"}},
+  {Codec::AV1, "av1", "AV1", nullptr, "rtpav1pay", "rtpav1depay",
+   {"nvav1enc", "qsvav1enc", "vaav1enc", "svtav1enc", "rav1enc", "av1enc"},
+   {"nvav1dec", "vaav1dec", "qsvav1dec", "dav1ddec", "av1dec", "avdec_av1"}},
+};
+
+const CodecInfo& codec_info(Codec c) { return CODECS[static_cast<int>(c)]; }
+
+static bool starts_with(const std::string& s, const char* p) { return s.rfind(p, 0) == 0; }
+
+bool codec_from_name(const std::string& name, Codec& out) {
+  for (const auto& c : CODECS) {
+    if (name == c.name) { out = c.codec; return true; }
+  }
+  if (name == "hevc") { out = Codec::H265; return true; }
+  return false;
+}
+
+Codec codec_of_encoder(const std::string& encoder) {
+  for (const auto& c : CODECS)
+    for (const char* e : c.encoders) if (encoder == e) return c.codec;
+  return Codec::H264;
+}
+
+std::string encoder_family(const std::string& encoder) {
+  if (starts_with(encoder, "nv"))    return "nv";
+  if (starts_with(encoder, "vaapi")) return "vaapi";
+  if (starts_with(encoder, "qsv"))   return "qsv";
+  if (starts_with(encoder, "va"))    return "va";
+  return "sw";
+}
+
+bool is_hw_decoder(const std::string& decoder) {
+  return encoder_family(decoder) != "sw" || starts_with(decoder, "v4l2");
+}
+
+// NAL başlıklarını sırayla fn'e verir: byte-stream (başlangıç kodları) ya da 4 bayt uzunluk önekli
+template <typename Fn>
+static void for_each_nal(const uint8_t* p, size_t n, bool length_prefixed, Fn fn) {
+  if (length_prefixed) {
+    for (size_t i = 0; i + 4 < n; ) {
+      const size_t len = size_t(p[i]) << 24 | size_t(p[i+1]) << 16 | size_t(p[i+2]) << 8 | p[i+3];
+      if (len == 0 || len > n - i - 4) return;
+      fn(p + i + 4, len);
+      i += 4 + len;
+    }
+    return;
+  }
+  size_t start = SIZE_MAX;
+  for (size_t i = 0; i + 3 <= n; ++i) {
+    if (p[i] != 0 || p[i+1] != 0 || p[i+2] != 1) continue;
+    if (start != SIZE_MAX) fn(p + start, i - start);
+    start = i + 3;
+    i += 2;
+  }
+  if (start != SIZE_MAX && start < n) fn(p + start, n - start);
+}
+
+bool au_is_nonref(Codec c, const uint8_t* data, size_t size, bool length_prefixed) {
+  if (c != Codec::H264 && c != Codec::H265) return false;
+  int vcl = 0, ref = 0;
+  for_each_nal(data, size, length_prefixed, [&](const uint8_t* nal, size_t len) {
+    if (len < 2) return;
+    if (c == Codec::H264) {
+      const int type = nal[0] & 0x1f;
+      if (type < 1 || type > 5) return;
+      ++vcl;
+      if (type == 5 || (nal[0] & 0x60)) ++ref;
+    } else {
+      const int type = nal[0] >> 1 & 0x3f;
+      if (type >= 32) return;
+      ++vcl;
+      if (type > 14 || (type & 1)) ++ref;   // TRAIL_N, TSA_N, STSA_N, RADL_N, RASL_N, RSV_VCL_N1x: çift
+    }
+  });
+  return vcl > 0 && ref == 0;
+}
+
+Codec pick_codec(const uint8_t* ranked, size_t n, uint8_t decode_mask) {
+  for (size_t i = 0; i < n; ++i)
+    if (ranked[i] < CODEC_COUNT && (decode_mask >> ranked[i] & 1)) return static_cast<Codec>(ranked[i]);
+  return Codec::H264;
+}
@@ -1,7 +1,9 @@
 #pragma once
 #include <gst/gst.h>
+#include <algorithm>
 #include <string>
 #include <iostream>
+#include <vector>
 
 #define CHECK_ELEM(x, name) \
 if (!(x)) { std::cerr << "Element create failed: " << (name) << std::endl; return nullptr; }
@@ -18,3 +20,21 @@ inline void set_bool(GstElement* e, const char* prop, gboolean v) {
 inline void set_arg(GstElement* e, const char* prop, const char* val) {
   gst_util_set_object_arg(G_OBJECT(e), prop, val);
 }
+// eklenti sürümüne göre olmayabilecek özellikler için
+inline bool has_prop(GstElement* e, const char* prop) {
+  return g_object_class_find_property(G_OBJECT_GET_CLASS(e), prop) != nullptr;
+}
+
+// Zinciri bin'e ekler (zaten ekli olanlar hariç) ve sırayla bağlar.
+// nullptr elemanlar (kapalı isteğe bağlı aşamalar) atlanır.
+inline bool add_chain(GstElement* bin, std::vector<GstElement*> chain) {
+  chain.erase(std::remove(chain.begin(), chain.end(), nullptr), chain.end());
+  for (auto* e : chain) if (!GST_OBJECT_PARENT(e)) gst_bin_add(GST_BIN(bin), e);
+  for (size_t i=1; i<chain.size(); ++i) {
+    if (!gst_element_link(chain[i-1], chain[i])) {
+      std::cerr << "Link failed: " << GST_ELEMENT_NAME(chain[i-1]) << "->" << GST_ELEMENT_NAME(chain[i]) << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
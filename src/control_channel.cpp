@@ -0,0 +1,266 @@
+#include "control_channel.hpp"
+#include "thread_policy.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+static constexpr int PING_INTERVAL_MS = 500;
+
+uint64_t ctrl_now_us() {
+  using namespace std::chrono;
+  return static_cast<uint64_t>(duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+ControlChannel::ControlChannel(const std::string& peer_ip, int send_port, int listen_port)
+: peer_ip_(peer_ip), send_port_(send_port), listen_port_(listen_port) {}
+
+ControlChannel::~ControlChannel() { stop(); }
+
+bool ControlChannel::start() {
+  fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd_ < 0) { perror("socket ctrl"); return false; }
+
+  sockaddr_in addr{}; addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = INADDR_ANY;
+  addr.sin_port = htons(listen_port_);
+  if (bind(fd_, (sockaddr*)&addr, sizeof(addr)) < 0) { perror("bind ctrl"); return false; }
+
+  memset(&peer_addr_, 0, sizeof(peer_addr_));
+  peer_addr_.sin_family = AF_INET;
+  peer_addr_.sin_port = htons(send_port_);
+  inet_pton(AF_INET, peer_ip_.c_str(), &peer_addr_.sin_addr);
+
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  stop_fd_  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  ep_fd_    = epoll_create1(EPOLL_CLOEXEC);
+  if (timer_fd_ < 0 || stop_fd_ < 0 || ep_fd_ < 0) { perror("ctrl fds"); return false; }
+
+  itimerspec its{};
+  its.it_interval.tv_nsec = PING_INTERVAL_MS * 1000000L;
+  its.it_value.tv_nsec = 1;   // ilk PING hemen
+  timerfd_settime(timer_fd_, 0, &its, nullptr);
+
+  for (int fd : {fd_, timer_fd_, stop_fd_}) {
+    epoll_event ev{}; ev.events = EPOLLIN; ev.data.fd = fd;
+    if (epoll_ctl(ep_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) { perror("epoll_ctl"); return false; }
+  }
+
+  thr_ = std::thread([this]{ this->loop(); });
+  return true;
+}
+
+void ControlChannel::stop() {
+  if (thr_.joinable()) {
+    uint64_t one = 1;
+    if (write(stop_fd_, &one, sizeof(one)) < 0) perror("ctrl stop");
+    thr_.join();
+  }
+  for (int* fd : {&ep_fd_, &timer_fd_, &stop_fd_, &fd_}) {
+    if (*fd >= 0) { close(*fd); *fd = -1; }
+  }
+}
+
+bool same_addr(const sockaddr_in& a, const sockaddr_in& b) {
+  return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+}
+
+void ControlChannel::add_peer(const sockaddr_in& ctrl_addr) {
+  std::lock_guard<std::mutex> lk(peers_mu_);
+  for (const auto& p : peers_) if (same_addr(p, ctrl_addr)) return;
+  peers_.push_back(ctrl_addr);
+}
+
+void ControlChannel::remove_peer(const sockaddr_in& ctrl_addr) {
+  std::lock_guard<std::mutex> lk(peers_mu_);
+  for (auto it = peers_.begin(); it != peers_.end(); ++it)
+    if (same_addr(*it, ctrl_addr)) { peers_.erase(it); return; }
+}
+
+void ControlChannel::send_to(const uint8_t* buf, size_t n, const sockaddr_in* to) {
+  const sockaddr_in* dst = to ? to : &peer_addr_;
+  if (dst->sin_addr.s_addr == 0) return;   // çok eşli modda ana eş olmayabilir
+  sendto(fd_, buf, n, 0, (const sockaddr*)dst, sizeof(*dst));
+}
+
+void ControlChannel::send_ping() {
+  uint8_t buf[ctrl::PING_SIZE];
+  ctrl::Ping m; m.t_send_us = ctrl_now_us();
+  size_t n = ctrl::encode(buf, tx_seq_++, m);
+  std::lock_guard<std::mutex> lk(peers_mu_);
+  if (!std::any_of(peers_.begin(), peers_.end(), [this](const sockaddr_in& p){ return same_addr(p, peer_addr_); }))
+    send_to(buf, n, nullptr);
+  for (const auto& p : peers_) send_to(buf, n, &p);
+}
+
+void ControlChannel::send_report(const ctrl::ReceiverReport& r, const sockaddr_in* to) {
+  if (fd_ < 0) return;
+  uint8_t buf[ctrl::RR_SIZE];
+  size_t n = ctrl::encode(buf, tx_seq_++, r);
+  send_to(buf, n, to);
+}
+
+void ControlChannel::send_nack(const ctrl::Nack& nk, const sockaddr_in* to) {
+  if (fd_ < 0) return;
+  uint8_t buf[ctrl::HEADER_SIZE + 4 + 2*ctrl::MAX_NACK];
+  size_t n = ctrl::encode(buf, tx_seq_++, nk);
+  send_to(buf, n, to);
+}
+
+void ControlChannel::send_keyframe_request(const ctrl::KeyframeRequest& k, const sockaddr_in* to) {
+  if (fd_ < 0) return;
+  uint8_t buf[ctrl::KEYFRAME_REQ_SIZE];
+  size_t n = ctrl::encode(buf, tx_seq_++, k);
+  send_to(buf, n, to);
+}
+
+void ControlChannel::send_peer_update(bool add, const ctrl::PeerUpdate& u, const sockaddr_in* to) {
+  if (fd_ < 0) return;
+  uint8_t buf[ctrl::PEER_UPDATE_SIZE];
+  size_t n = ctrl::encode(buf, tx_seq_++, add ? ctrl::PEER_ADD : ctrl::PEER_REMOVE, u);
+  send_to(buf, n, to);
+}
+
+void ControlChannel::send_layer_select(const ctrl::LayerSelect& l, const sockaddr_in* to) {
+  if (fd_ < 0) return;
+  uint8_t buf[ctrl::LAYER_SELECT_SIZE];
+  size_t n = ctrl::encode(buf, tx_seq_++, l);
+  send_to(buf, n, to);
+}
+
+void ControlChannel::send_sender_report(const ctrl::SenderReport& r, const sockaddr_in* to) {
+  if (fd_ < 0) return;
+  uint8_t buf[ctrl::SENDER_REPORT_SIZE];
+  size_t n = ctrl::encode(buf, tx_seq_++, r);
+  send_to(buf, n, to);
+}
+
+void ControlChannel::send_reconfig(const ctrl::Reconfig& r, const sockaddr_in* to) {
+  if (fd_ < 0) return;
+  uint8_t buf[ctrl::RECONFIG_SIZE];
+  size_t n = ctrl::encode(buf, tx_seq_++, r);
+  send_to(buf, n, to);
+}
+
+void ControlChannel::send_codec_caps(const ctrl::CodecCaps& c, const sockaddr_in* to) {
+  if (fd_ < 0) return;
+  uint8_t buf[ctrl::CODEC_CAPS_SIZE];
+  size_t n = ctrl::encode(buf, tx_seq_++, c);
+  send_to(buf, n, to);
+}
+
+void ControlChannel::handle_datagram(const uint8_t* buf, size_t n) {
+  const uint8_t* p = buf;
+  ctrl::Header h;
+  if (!ctrl::get_header(p, n, h)) return;
+
+  switch (h.type) {
+    case ctrl::PING: {
+      ctrl::Ping ping;
+      if (!ctrl::decode(p, n, ping)) return;
+      ctrl::Pong pong; pong.t_send_us = ping.t_send_us; pong.t_recv_us = now_us_;
+      pong.t_reply_us = ctrl_now_us();
+      uint8_t out[ctrl::PONG_SIZE];
+      size_t m = ctrl::encode(out, h.seq, pong);
+      send_to(out, m, &from_);   // çok eşli modda PING her eşten gelir
+      break;
+    }
+    case ctrl::PONG: {
+      ctrl::Pong pong;
+      if (!ctrl::decode(p, n, pong)) return;
+      // NTP: eşteki bekleme (t3 - t2) gidiş-dönüşten çıkarılır
+      const ClockSample cs{pong.t_send_us, pong.t_recv_us, pong.t_reply_us, now_us_};
+      if (clock_cb_) clock_cb_(cs);
+      double rtt = (double)std::max<int64_t>(0, (int64_t)(cs.t4_us - cs.t1_us) - (int64_t)(cs.t3_us - cs.t2_us)) / 1000.0;
+      rtt_ms_ = rtt;
+      std::cout << "[ctrl] RTT ~ " << static_cast<long long>(rtt) << " ms\n";
+      if (rtt_cb_) rtt_cb_(rtt);
+      break;
+    }
+    case ctrl::RR: {
+      ctrl::ReceiverReport rr;
+      if (!ctrl::decode(p, n, rr)) return;
+      if (report_cb_) report_cb_(rr);
+      break;
+    }
+    case ctrl::NACK: {
+      ctrl::Nack nk;
+      if (!ctrl::decode(p, n, nk)) return;
+      if (nack_cb_) nack_cb_(nk);
+      break;
+    }
+    case ctrl::KEYFRAME_REQ: {
+      ctrl::KeyframeRequest kr;
+      if (!ctrl::decode(p, n, kr)) return;
+      if (keyframe_cb_) keyframe_cb_(kr);
+      break;
+    }
+    case ctrl::PEER_ADD:
+    case ctrl::PEER_REMOVE: {
+      ctrl::PeerUpdate u;
+      if (!ctrl::decode(p, n, u)) return;
+      if (!u.ipv4) u.ipv4 = ntohl(from_.sin_addr.s_addr);
+      if (peer_cb_) peer_cb_(h.type == ctrl::PEER_ADD, u);
+      break;
+    }
+    case ctrl::LAYER_SELECT: {
+      ctrl::LayerSelect ls;
+      if (!ctrl::decode(p, n, ls)) return;
+      if (layer_cb_) layer_cb_(ls);
+      break;
+    }
+    case ctrl::SENDER_REPORT: {
+      ctrl::SenderReport sr;
+      if (!ctrl::decode(p, n, sr)) return;
+      if (sr_cb_) sr_cb_(sr);
+      break;
+    }
+    case ctrl::RECONFIG: {
+      ctrl::Reconfig rc;
+      if (!ctrl::decode(p, n, rc)) return;
+      if (reconfig_cb_) reconfig_cb_(rc);
+      break;
+    }
+    case ctrl::CODEC_CAPS: {
+      ctrl::CodecCaps cc;
+      if (!ctrl::decode(p, n, cc)) return;
+      if (codec_cb_) codec_cb_(cc);
+      break;
+    }
+    default: break;
+  }
+}
+
+void ControlChannel::loop() {
+  ThreadScope scope(ThreadClass::Control, "nova-ctrl");
+  alignas(8) uint8_t buf[ctrl::MAX_MSG];
+  epoll_event evs[4];
+  for (;;) {
+    int ne = epoll_wait(ep_fd_, evs, 4, -1);
+    if (ne < 0) { if (errno == EINTR) continue; perror("epoll_wait"); return; }
+    for (int i = 0; i < ne; ++i) {
+      const int fd = evs[i].data.fd;
+      if (fd == stop_fd_) return;
+      if (fd == timer_fd_) {
+        uint64_t expirations;
+        if (read(timer_fd_, &expirations, sizeof(expirations)) > 0) send_ping();
+      } else if (fd == fd_) {
+        for (;;) {   // soketi boşalt
+          socklen_t alen = sizeof(from_);
+          ssize_t n = recvfrom(fd_, buf, sizeof(buf), 0, (sockaddr*)&from_, &alen);
+          if (n <= 0) break;
+          now_us_ = ctrl_now_us();   // t2/t4: işleme gecikmesi saat örneğine girmesin
+          handle_datagram(buf, static_cast<size_t>(n));
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "ctrl_proto.hpp"
+#include "clock_sync.hpp"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <thread>
+#include <netinet/in.h>
+
+// ---- kontrol kanalı ----
+// Tek thread, tek epoll döngüsü: UDP soketi + PING timerfd + durdurma eventfd.
+// stop() eventfd'ye yazar; döngü beklemeden çıkar.
+class ControlChannel {
+ public:
+  using RttHandler    = std::function<void(double rtt_ms)>;
+  using ReportHandler = std::function<void(const ctrl::ReceiverReport&)>;
+  using NackHandler   = std::function<void(const ctrl::Nack&)>;
+  using KeyframeHandler = std::function<void(const ctrl::KeyframeRequest&)>;
+  using PeerHandler   = std::function<void(bool add, const ctrl::PeerUpdate&)>;   // ipv4 doldurulmuş
+  using LayerHandler  = std::function<void(const ctrl::LayerSelect&)>;
+  using CodecHandler  = std::function<void(const ctrl::CodecCaps&)>;
+  using ClockHandler  = std::function<void(const ClockSample&)>;
+  using SenderReportHandler = std::function<void(const ctrl::SenderReport&)>;
+  using ReconfigHandler = std::function<void(const ctrl::Reconfig&)>;
+
+  ControlChannel(const std::string& peer_ip, int send_port, int listen_port);
+  ~ControlChannel();
+
+  // start()'tan önce çağrılmalı (kanal thread'inden çağrılırlar)
+  void on_rtt(RttHandler h)       { rtt_cb_ = std::move(h); }
+  void on_report(ReportHandler h) { report_cb_ = std::move(h); }
+  void on_nack(NackHandler h)     { nack_cb_ = std::move(h); }
+  void on_keyframe_request(KeyframeHandler h) { keyframe_cb_ = std::move(h); }
+  void on_peer_update(PeerHandler h) { peer_cb_ = std::move(h); }
+  void on_layer_select(LayerHandler h) { layer_cb_ = std::move(h); }
+  void on_codec_caps(CodecHandler h)   { codec_cb_ = std::move(h); }
+  // her PONG'da, rtt'den önce (from() eşi gösterir)
+  void on_clock_sample(ClockHandler h) { clock_cb_ = std::move(h); }
+  void on_sender_report(SenderReportHandler h) { sr_cb_ = std::move(h); }
+  void on_reconfig(ReconfigHandler h) { reconfig_cb_ = std::move(h); }
+
+  // mesajın kaynağı; yalnızca handler içinde geçerli (çok eşli modda eşi ayırt etmek için)
+  const sockaddr_in& from() const { return from_; }
+
+  // çok eşli: PING'ler bu adreslere de gider (RTT eş başına handler'da from() ile)
+  void add_peer(const sockaddr_in& ctrl_addr);
+  void remove_peer(const sockaddr_in& ctrl_addr);
+
+  bool start();
+  void stop();
+
+  // herhangi bir thread'den çağrılabilir (tek sendto); to == nullptr: ana eş
+  void send_report(const ctrl::ReceiverReport& r, const sockaddr_in* to = nullptr);
+  void send_nack(const ctrl::Nack& n, const sockaddr_in* to = nullptr);
+  void send_keyframe_request(const ctrl::KeyframeRequest& k, const sockaddr_in* to = nullptr);
+  void send_peer_update(bool add, const ctrl::PeerUpdate& u, const sockaddr_in* to = nullptr);
+  void send_layer_select(const ctrl::LayerSelect& l, const sockaddr_in* to = nullptr);
+  void send_codec_caps(const ctrl::CodecCaps& c, const sockaddr_in* to = nullptr);
+  void send_sender_report(const ctrl::SenderReport& r, const sockaddr_in* to = nullptr);
+  void send_reconfig(const ctrl::Reconfig& r, const sockaddr_in* to = nullptr);
+
+  double rtt_ms() const { return rtt_ms_.load(); }
+
+ private:
+  void loop();
+  void handle_datagram(const uint8_t* buf, size_t n);
+  void send_ping();
+  void send_to(const uint8_t* buf, size_t n, const sockaddr_in* to);
+
+  std::string peer_ip_;
+  int send_port_, listen_port_;
+  int fd_ = -1, timer_fd_ = -1, stop_fd_ = -1, ep_fd_ = -1;
+  sockaddr_in peer_addr_{};
+  sockaddr_in from_{};
+  uint64_t now_us_ = 0;   // son datagramın alım anı
+  std::mutex peers_mu_;
+  std::vector<sockaddr_in> peers_;
+  std::thread thr_;
+  std::atomic<uint32_t> tx_seq_{0};
+  std::atomic<double> rtt_ms_{0.0};
+  RttHandler rtt_cb_;
+  ReportHandler report_cb_;
+  NackHandler nack_cb_;
+  KeyframeHandler keyframe_cb_;
+  PeerHandler peer_cb_;
+  LayerHandler layer_cb_;
+  CodecHandler codec_cb_;
+  ClockHandler clock_cb_;
+  SenderReportHandler sr_cb_;
+  ReconfigHandler reconfig_cb_;
+};
+
+bool same_addr(const sockaddr_in& a, const sockaddr_in& b);
+
+uint64_t ctrl_now_us();   // steady clock, µs
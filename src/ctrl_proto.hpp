@@ -0,0 +1,277 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Kontrol kanalı tel formatı: sabit uzunluklu alanlar, big-endian, metin yok.
+//   header: magic(1) version(1) type(1) reserved(1) seq(4)
+namespace ctrl {
+
+constexpr uint8_t MAGIC   = 0x4E;   // 'N'
+constexpr uint8_t VERSION = 1;
+constexpr size_t  HEADER_SIZE = 8;
+constexpr size_t  MAX_MSG = 1400;
+
+enum MsgType : uint8_t {
+  PING = 1,
+  PONG = 2,
+  RR   = 3,
+  NACK = 4,
+  KEYFRAME_REQ = 5,
+  PEER_ADD    = 6,
+  PEER_REMOVE = 7,
+  LAYER_SELECT = 8,
+  CODEC_CAPS   = 9,
+  SENDER_REPORT = 10,
+  RECONFIG      = 11,
+};
+
+struct Header { uint8_t type = 0; uint32_t seq = 0; };
+
+struct Ping { uint64_t t_send_us = 0; };
+
+struct Pong {
+  uint64_t t_send_us = 0;   // echoed from PING
+  uint64_t t_recv_us = 0;   // responder clock at PING arrival
+  uint64_t t_reply_us = 0;  // responder clock at PONG send (eski sürüm göndermez: t_recv_us)
+};
+
+// RTCP RR benzeri alıcı raporu (kümülatif sayaçlar).
+struct ReceiverReport {
+  uint64_t t_report_us = 0;
+  uint32_t ext_highest_seq = 0;   // cycles << 16 | highest RTP seq
+  uint32_t cumulative_lost = 0;
+  uint32_t jitter = 0;            // RFC 3550 interarrival jitter, RTP clock units
+  uint64_t packets = 0;
+  uint64_t bytes = 0;
+  uint32_t fec_recovered = 0;     // rtpulpfecdec sayaçları (FEC kapalıysa 0)
+  uint32_t fec_unrecovered = 0;
+};
+
+inline void put8 (uint8_t*& p, uint8_t v)  { *p++ = v; }
+inline void put16(uint8_t*& p, uint16_t v) { put8(p, uint8_t(v >> 8)); put8(p, uint8_t(v)); }
+inline void put32(uint8_t*& p, uint32_t v) { put16(p, uint16_t(v >> 16)); put16(p, uint16_t(v)); }
+inline void put64(uint8_t*& p, uint64_t v) { put32(p, uint32_t(v >> 32)); put32(p, uint32_t(v)); }
+
+// Eksik RTP sıra numaraları (generic NACK benzeri).
+constexpr size_t MAX_NACK = 64;
+struct Nack {
+  uint16_t budget_ms = 0;   // alıcıda oynatma anına kalan süre
+  uint16_t count = 0;
+  uint16_t seqs[MAX_NACK];
+};
+
+// PLI/FIR benzeri: alıcı çözülemeyen kareden sonra IDR ister.
+enum KeyframeReason : uint8_t { KF_PACKET_LOSS = 1, KF_DECODE_ERROR = 2 };
+struct KeyframeRequest { uint8_t reason = KF_PACKET_LOSS; };
+constexpr size_t KEYFRAME_REQ_SIZE = HEADER_SIZE + 1;
+
+// Çok eşli yayın: gönderim kümesine eş ekle/çıkar (oda sunucusu ya da eşin kendisi).
+// ipv4 == 0: datagramın kaynak adresi kullanılır (eş kendini duyurur).
+struct PeerUpdate {
+  uint32_t ipv4 = 0;        // host byte order
+  uint16_t video_port = 0;  // eşin video dinleme portu (fan-out hedefi)
+  uint16_t ctrl_port = 0;   // eşin kontrol portu (RR/NACK/PLI buradan gelir)
+  uint16_t rx_port = 0;     // eşin bize video gönderdiği yerel port; 0 = yalnızca alıcı eş
+};
+constexpr size_t PEER_UPDATE_SIZE = HEADER_SIZE + 10;
+
+// Simulcast: alıcının kabul ettiği en ince katman (0 = tam çözünürlük). Gönderici bant
+// genişliğine göre daha kaba bir katman seçebilir, daha incesini seçmez.
+enum LayerReason : uint8_t { LAYER_MANUAL = 1, LAYER_DECODE_LOAD = 2 };
+struct LayerSelect {
+  uint8_t layer = 0;
+  uint8_t reason = LAYER_MANUAL;
+};
+constexpr size_t LAYER_SELECT_SIZE = HEADER_SIZE + 2;
+
+// Kodek anlaşması (oturum başında, iki yönlü): decode_mask bu ucun çözebildiği kodekler
+// (1 << Codec), ranked gönderen olarak tercih sırası (benchmark sonucu). ack: ACK_HAVE_CAPS =
+// karşının CODEC_CAPS'i alındı; ACK_COMMITTED = karşının da bizimkini aldığı görüldü, seçim bu uçta
+// kesinleşti. Kesinleşen uç, karşıdan ACK_COMMITTED görene kadar yinelemeyi sürdürür.
+enum CodecAck : uint8_t { ACK_NONE = 0, ACK_HAVE_CAPS = 1, ACK_COMMITTED = 2 };
+constexpr size_t MAX_CODECS = 8;
+struct CodecCaps {
+  uint8_t decode_mask = 0;
+  uint8_t ack = 0;
+  uint8_t count = 0;
+  uint8_t ranked[MAX_CODECS] = {};
+};
+constexpr size_t CODEC_CAPS_SIZE = HEADER_SIZE + 3 + MAX_CODECS;
+
+// RTCP SR benzeri: gönderenin son paketlediği karenin RTP zaman damgası ve yakalama anı
+// (gönderen steady saati, µs). Alıcı saat eşlemesiyle tek yön gecikmeyi buradan hesaplar.
+struct SenderReport {
+  uint32_t rtp_ts = 0;
+  uint64_t capture_us = 0;
+};
+constexpr size_t SENDER_REPORT_SIZE = HEADER_SIZE + 12;
+
+// Canlı yeniden yapılandırma: karşının bize gönderdiği akış için istek; 0 = değişmez.
+// Boru hattı yıkılmaz: çözünürlük/fps kaynak capsfilter'ından yeniden anlaşılır, kbps ABR üst sınırı.
+struct Reconfig {
+  uint16_t width = 0, height = 0;
+  uint16_t fps = 0;
+  uint16_t keyint = 0;
+  uint16_t mtu = 0;
+  uint32_t kbps = 0;
+};
+constexpr size_t RECONFIG_SIZE = HEADER_SIZE + 14;
+
+inline uint8_t  get8 (const uint8_t*& p) { return *p++; }
+inline uint16_t get16(const uint8_t*& p) { uint16_t h = get8(p);  return uint16_t(h << 8 | get8(p)); }
+inline uint32_t get32(const uint8_t*& p) { uint32_t h = get16(p); return h << 16 | get16(p); }
+inline uint64_t get64(const uint8_t*& p) { uint64_t h = get32(p); return h << 32 | get32(p); }
+
+inline uint8_t* put_header(uint8_t* p, MsgType t, uint32_t seq) {
+  put8(p, MAGIC); put8(p, VERSION); put8(p, t); put8(p, 0); put32(p, seq);
+  return p;
+}
+
+inline bool get_header(const uint8_t*& p, size_t n, Header& h) {
+  if (n < HEADER_SIZE || p[0] != MAGIC || p[1] != VERSION) return false;
+  p += 2; h.type = get8(p); p += 1; h.seq = get32(p);
+  return true;
+}
+
+constexpr size_t PING_SIZE = HEADER_SIZE + 8;
+constexpr size_t PONG_SIZE = HEADER_SIZE + 24;
+constexpr size_t PONG_V1_SIZE = HEADER_SIZE + 16;   // t_reply_us öncesi
+constexpr size_t RR_SIZE   = HEADER_SIZE + 8 + 4*3 + 8*2 + 4*2;
+
+inline size_t encode(uint8_t* buf, uint32_t seq, const Ping& m) {
+  uint8_t* p = put_header(buf, PING, seq);
+  put64(p, m.t_send_us);
+  return size_t(p - buf);
+}
+inline size_t encode(uint8_t* buf, uint32_t seq, const Pong& m) {
+  uint8_t* p = put_header(buf, PONG, seq);
+  put64(p, m.t_send_us); put64(p, m.t_recv_us); put64(p, m.t_reply_us);
+  return size_t(p - buf);
+}
+inline size_t encode(uint8_t* buf, uint32_t seq, const ReceiverReport& m) {
+  uint8_t* p = put_header(buf, RR, seq);
+  put64(p, m.t_report_us);
+  put32(p, m.ext_highest_seq); put32(p, m.cumulative_lost); put32(p, m.jitter);
+  put64(p, m.packets); put64(p, m.bytes);
+  put32(p, m.fec_recovered); put32(p, m.fec_unrecovered);
+  return size_t(p - buf);
+}
+
+inline size_t encode(uint8_t* buf, uint32_t seq, const Nack& m) {
+  uint8_t* p = put_header(buf, NACK, seq);
+  const uint16_t c = m.count < MAX_NACK ? m.count : uint16_t(MAX_NACK);
+  put16(p, m.budget_ms); put16(p, c);
+  for (uint16_t i = 0; i < c; ++i) put16(p, m.seqs[i]);
+  return size_t(p - buf);
+}
+
+inline size_t encode(uint8_t* buf, uint32_t seq, const KeyframeRequest& m) {
+  uint8_t* p = put_header(buf, KEYFRAME_REQ, seq);
+  put8(p, m.reason);
+  return size_t(p - buf);
+}
+
+// type: PEER_ADD ya da PEER_REMOVE
+inline size_t encode(uint8_t* buf, uint32_t seq, MsgType type, const PeerUpdate& m) {
+  uint8_t* p = put_header(buf, type, seq);
+  put32(p, m.ipv4); put16(p, m.video_port); put16(p, m.ctrl_port); put16(p, m.rx_port);
+  return size_t(p - buf);
+}
+
+inline size_t encode(uint8_t* buf, uint32_t seq, const LayerSelect& m) {
+  uint8_t* p = put_header(buf, LAYER_SELECT, seq);
+  put8(p, m.layer); put8(p, m.reason);
+  return size_t(p - buf);
+}
+
+inline size_t encode(uint8_t* buf, uint32_t seq, const SenderReport& m) {
+  uint8_t* p = put_header(buf, SENDER_REPORT, seq);
+  put32(p, m.rtp_ts); put64(p, m.capture_us);
+  return size_t(p - buf);
+}
+
+inline size_t encode(uint8_t* buf, uint32_t seq, const Reconfig& m) {
+  uint8_t* p = put_header(buf, RECONFIG, seq);
+  put16(p, m.width); put16(p, m.height); put16(p, m.fps); put16(p, m.keyint); put16(p, m.mtu);
+  put32(p, m.kbps);
+  return size_t(p - buf);
+}
+
+inline size_t encode(uint8_t* buf, uint32_t seq, const CodecCaps& m) {
+  uint8_t* p = put_header(buf, CODEC_CAPS, seq);
+  put8(p, m.decode_mask); put8(p, m.ack);
+  const uint8_t c = m.count < MAX_CODECS ? m.count : uint8_t(MAX_CODECS);
+  put8(p, c);
+  for (size_t i = 0; i < MAX_CODECS; ++i) put8(p, i < c ? m.ranked[i] : 0);
+  return size_t(p - buf);
+}
+
+// body: header'dan sonraki baytlar; n: toplam mesaj uzunluğu
+inline bool decode(const uint8_t* p, size_t n, Ping& m) {
+  if (n < PING_SIZE) return false;
+  m.t_send_us = get64(p);
+  return true;
+}
+inline bool decode(const uint8_t* p, size_t n, Pong& m) {
+  if (n < PONG_V1_SIZE) return false;
+  m.t_send_us = get64(p); m.t_recv_us = get64(p);
+  m.t_reply_us = n >= PONG_SIZE ? get64(p) : m.t_recv_us;
+  return true;
+}
+inline bool decode(const uint8_t* p, size_t n, ReceiverReport& m) {
+  if (n < RR_SIZE) return false;
+  m.t_report_us = get64(p);
+  m.ext_highest_seq = get32(p); m.cumulative_lost = get32(p); m.jitter = get32(p);
+  m.packets = get64(p); m.bytes = get64(p);
+  m.fec_recovered = get32(p); m.fec_unrecovered = get32(p);
+  return true;
+}
+
+inline bool decode(const uint8_t* p, size_t n, Nack& m) {
+  if (n < HEADER_SIZE + 4) return false;
+  m.budget_ms = get16(p); m.count = get16(p);
+  if (m.count > MAX_NACK || n < HEADER_SIZE + 4 + 2u*m.count) return false;
+  for (uint16_t i = 0; i < m.count; ++i) m.seqs[i] = get16(p);
+  return true;
+}
+
+inline bool decode(const uint8_t* p, size_t n, KeyframeRequest& m) {
+  if (n < KEYFRAME_REQ_SIZE) return false;
+  m.reason = get8(p);
+  return true;
+}
+
+inline bool decode(const uint8_t* p, size_t n, PeerUpdate& m) {
+  if (n < PEER_UPDATE_SIZE) return false;
+  m.ipv4 = get32(p); m.video_port = get16(p); m.ctrl_port = get16(p); m.rx_port = get16(p);
+  return true;
+}
+
+inline bool decode(const uint8_t* p, size_t n, LayerSelect& m) {
+  if (n < LAYER_SELECT_SIZE) return false;
+  m.layer = get8(p); m.reason = get8(p);
+  return true;
+}
+
+inline bool decode(const uint8_t* p, size_t n, SenderReport& m) {
+  if (n < SENDER_REPORT_SIZE) return false;
+  m.rtp_ts = get32(p); m.capture_us = get64(p);
+  return true;
+}
+
+inline bool decode(const uint8_t* p, size_t n, Reconfig& m) {
+  if (n < RECONFIG_SIZE) return false;
+  m.width = get16(p); m.height = get16(p); m.fps = get16(p); m.keyint = get16(p); m.mtu = get16(p);
+  m.kbps = get32(p);
+  return true;
+}
+
+inline bool decode(const uint8_t* p, size_t n, CodecCaps& m) {
+  if (n < CODEC_CAPS_SIZE) return false;
+  m.decode_mask = get8(p); m.ack = get8(p); m.count = get8(p);
+  if (m.count > MAX_CODECS) return false;
+  for (size_t i = 0; i < MAX_CODECS; ++i) m.ranked[i] = get8(p);
+  return true;
+}
+
+} // namespace ctrl
@@ -0,0 +1,162 @@
+#include "disk_writer.hpp"
+#include "thread_policy.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+
+DiskWriter::DiskWriter(size_t max_bytes)
+: max_blocks_(std::max<size_t>(2, max_bytes / BLOCK_SIZE)) {
+  thr_ = std::thread(&DiskWriter::run, this);
+}
+
+DiskWriter::~DiskWriter() {
+  close();
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  if (thr_.joinable()) thr_.join();
+  for (uint8_t* b : free_) std::free(b);
+}
+
+uint8_t* DiskWriter::alloc_block() {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (!free_.empty()) { uint8_t* b = free_.back(); free_.pop_back(); return b; }
+  if (allocated_ >= max_blocks_) return nullptr;
+  void* p = nullptr;
+  if (posix_memalign(&p, ALIGN, BLOCK_SIZE) != 0) return nullptr;
+  ++allocated_;
+  return static_cast<uint8_t*>(p);
+}
+
+void DiskWriter::release_block(uint8_t* b) {
+  std::lock_guard<std::mutex> lk(mu_);
+  free_.push_back(b);
+}
+
+void DiskWriter::push(Op op) {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    q_.push_back(std::move(op));
+  }
+  cv_.notify_one();
+}
+
+void DiskWriter::flush_block() {
+  if (!cur_) return;
+  if (cur_len_) push({Op::DATA, {}, cur_, cur_len_});
+  else release_block(cur_);
+  cur_ = nullptr;
+  cur_len_ = 0;
+}
+
+void DiskWriter::open(const std::string& path) {
+  std::lock_guard<std::mutex> lk(pmu_);
+  if (open_) { flush_block(); push({Op::CLOSE, {}, nullptr, 0}); }
+  open_ = true;
+  skip_ = false;
+  push({Op::OPEN, path, nullptr, 0});
+}
+
+void DiskWriter::write(const void* data, size_t n) {
+  std::lock_guard<std::mutex> lk(pmu_);
+  if (!open_ || skip_) { dropped_.fetch_add(n, std::memory_order_relaxed); return; }
+  auto* p = static_cast<const uint8_t*>(data);
+  while (n) {
+    if (!cur_ && !(cur_ = alloc_block())) {
+      // disk yetişemiyor: beklemek yerine bu dosyanın kalanı atılır
+      skip_ = true;
+      dropped_.fetch_add(n, std::memory_order_relaxed);
+      std::cerr << "[rec] yazma kuyruğu dolu (" << max_blocks_ << " MiB), dosyanın kalanı atlanıyor\n";
+      return;
+    }
+    const size_t k = std::min(n, BLOCK_SIZE - cur_len_);
+    std::memcpy(cur_ + cur_len_, p, k);
+    cur_len_ += k; p += k; n -= k;
+    if (cur_len_ == BLOCK_SIZE) flush_block();
+  }
+}
+
+void DiskWriter::close() {
+  std::lock_guard<std::mutex> lk(pmu_);
+  if (!open_) return;
+  flush_block();
+  push({Op::CLOSE, {}, nullptr, 0});
+  open_ = false;
+}
+
+void DiskWriter::run() {
+  ThreadScope scope(ThreadClass::Io, "nova-rec");
+  for (;;) {
+    Op op;
+    {
+      std::unique_lock<std::mutex> lk(mu_);
+      cv_.wait(lk, [&]{ return stop_ || !q_.empty(); });
+      if (q_.empty()) break;   // stop_ ve kuyruk boş
+      op = std::move(q_.front());
+      q_.pop_front();
+    }
+    switch (op.kind) {
+      case Op::OPEN:  do_open(op.path); break;
+      case Op::DATA:  do_write(op.block, op.len); release_block(op.block); break;
+      case Op::CLOSE: do_close(); break;
+    }
+  }
+  do_close();
+}
+
+void DiskWriter::do_open(const std::string& path) {
+  do_close();
+  // O_DIRECT: sayfa önbelleğini kayıt verisiyle doldurma; tmpfs gibi desteklemeyenlerde normal
+  fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_DIRECT, 0644);
+  direct_ = fd_ >= 0;
+  if (fd_ < 0 && errno == EINVAL) fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd_ < 0) { std::cerr << "[rec] " << path << ": " << std::strerror(errno) << "\n"; return; }
+  path_ = path;
+  file_bytes_ = 0;
+  failed_ = false;
+  files_.fetch_add(1, std::memory_order_relaxed);
+  std::cout << "[rec] -> " << path << "\n";
+}
+
+void DiskWriter::do_write(uint8_t* block, size_t len) {
+  if (fd_ < 0 || failed_) { dropped_.fetch_add(len, std::memory_order_relaxed); return; }
+  // kısmi blok yalnızca dosya sonunda: hizasız uzunluk O_DIRECT'siz yazılır
+  if (direct_ && len % ALIGN) {
+    fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) & ~O_DIRECT);
+    direct_ = false;
+  }
+  size_t off = 0;
+  while (off < len) {
+    const ssize_t w = ::write(fd_, block + off, len - off);
+    if (w < 0 && errno == EINTR) continue;
+    if (w < 0 && errno == EINVAL && direct_) {   // dosya sistemi O_DIRECT'i yazarken reddetti
+      fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) & ~O_DIRECT);
+      direct_ = false;
+      continue;
+    }
+    if (w <= 0) {
+      std::cerr << "[rec] " << path_ << ": " << std::strerror(errno) << "\n";
+      failed_ = true;
+      dropped_.fetch_add(len - off, std::memory_order_relaxed);
+      return;
+    }
+    off += (size_t)w;
+  }
+  file_bytes_ += len;
+  written_.fetch_add(len, std::memory_order_relaxed);
+}
+
+void DiskWriter::do_close() {
+  if (fd_ < 0) return;
+  ::close(fd_);
+  fd_ = -1;
+  std::cout << "[rec] " << path_ << " " << file_bytes_ / 1024 << " KiB"
+            << (failed_ ? " (yazma hatası)" : "") << "\n";
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Kayıt dosyaları için asenkron yazıcı. Üretici (GStreamer streaming thread'i) veriyi hizalı
+// 1 MiB bloklara kopyalar; ayrı bir I/O thread'i blokları sırayla diske yazar (O_DIRECT
+// destekleniyorsa tam bloklar doğrudan, dosya sonundaki kısmi blok O_DIRECT kapatılarak).
+// Bellek sınırlıdır: blok kalmazsa üretici beklemez, o dosyanın kalanı atılır ve bir sonraki
+// open()'a kadar veri kabul edilmez (yarım dosya; canlı yol etkilenmez).
+class DiskWriter {
+ public:
+  static constexpr size_t BLOCK_SIZE = 1 << 20;
+  static constexpr size_t ALIGN = 4096;   // O_DIRECT: adres, uzunluk ve ofset hizası
+
+  explicit DiskWriter(size_t max_bytes = 64u << 20);
+  ~DiskWriter();   // kuyruktakiler yazılır, sonra thread durur
+  DiskWriter(const DiskWriter&) = delete;
+  DiskWriter& operator=(const DiskWriter&) = delete;
+
+  // Üretici tarafı; çağrılar sıralı olmalı (farklı thread'lerden olabilir)
+  void open(const std::string& path);   // açık dosya varsa önce kapanır
+  void write(const void* data, size_t n);
+  void close();
+
+  uint64_t bytes_written() const { return written_.load(std::memory_order_relaxed); }
+  uint64_t bytes_dropped() const { return dropped_.load(std::memory_order_relaxed); }
+  uint64_t files() const         { return files_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Op {
+    enum Kind { OPEN, DATA, CLOSE } kind;
+    std::string path;
+    uint8_t* block = nullptr;
+    size_t len = 0;
+  };
+
+  void run();
+  void push(Op op);
+  uint8_t* alloc_block();              // havuzdan ya da sınır içindeyse yeni; nullptr = sınır dolu
+  void release_block(uint8_t* b);
+  void flush_block();                  // pmu_ tutulurken
+
+  // I/O thread'i
+  void do_open(const std::string& path);
+  void do_write(uint8_t* block, size_t len);
+  void do_close();
+
+  const size_t max_blocks_;
+
+  std::mutex mu_;                      // kuyruk + blok havuzu
+  std::condition_variable cv_;
+  std::deque<Op> q_;
+  std::vector<uint8_t*> free_;
+  size_t allocated_ = 0;
+  bool stop_ = false;
+
+  std::mutex pmu_;                     // üretici tarafı
+  uint8_t* cur_ = nullptr;
+  size_t cur_len_ = 0;
+  bool open_ = false, skip_ = false;
+
+  // I/O thread'inin durumu
+  int fd_ = -1;
+  bool direct_ = false;
+  std::string path_;
+  uint64_t file_bytes_ = 0;
+  bool failed_ = false;
+
+  std::atomic<uint64_t> written_{0}, dropped_{0}, files_{0};
+  std::thread thr_;
+};
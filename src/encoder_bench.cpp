@@ -0,0 +1,270 @@
+#include "encoder_bench.hpp"
+#include "common.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+static constexpr const char* CACHE_MAGIC = "nova-enc-cache 1";
+static constexpr int CLIP_FRAMES = 90;
+
+bool EncoderScore::meets_budget(int fps_target) const {
+  // %10 pay: canlıda kaynak, ağ ve önizleme de aynı çekirdekleri kullanır
+  return ok && fps >= fps_target * 1.1 && p95_ms <= 1000.0 / std::max(1, fps_target);
+}
+
+static int64_t mono_ns() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static double process_cpu_ms() {
+  rusage ru{};
+  getrusage(RUSAGE_SELF, &ru);
+  return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e3 + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e3;
+}
+
+// kodlayıcı girişi/çıkışı PTS ile eşlenir (kodlayıcılar giriş PTS'ini korur)
+struct ClipTiming {
+  std::mutex mu;
+  std::map<GstClockTime, int64_t> in_ns;
+  std::vector<double> lat_ms;
+  int64_t first_in = 0, last_out = 0;
+  int out = 0;
+};
+
+static GstPadProbeReturn enc_in_probe(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+  auto* t = static_cast<ClipTiming*>(user_data);
+  const int64_t now = mono_ns();
+  std::lock_guard<std::mutex> lk(t->mu);
+  if (!t->first_in) t->first_in = now;
+  t->in_ns[GST_BUFFER_PTS(GST_PAD_PROBE_INFO_BUFFER(info))] = now;
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn enc_out_probe(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+  auto* t = static_cast<ClipTiming*>(user_data);
+  const int64_t now = mono_ns();
+  std::lock_guard<std::mutex> lk(t->mu);
+  auto it = t->in_ns.find(GST_BUFFER_PTS(GST_PAD_PROBE_INFO_BUFFER(info)));
+  if (it != t->in_ns.end()) {
+    t->lat_ms.push_back((now - it->second) / 1e6);
+    t->in_ns.erase(it);
+  }
+  t->last_out = now;
+  ++t->out;
+  return GST_PAD_PROBE_OK;
+}
+
+// encoder boş: kaynağın kendi CPU maliyeti (taban çizgisi). format boş: videoconvert ile I420.
+static EncoderScore run_clip(const std::string& encoder, const std::string& format, int width, int height,
+                             int fps, int kbps, int frames, int timeout_ms, double& cpu_total_ms) {
+  EncoderScore s;
+  s.encoder = encoder;
+  s.codec = codec_of_encoder(encoder);
+  cpu_total_ms = 0;
+
+  GstElement* pipe = gst_pipeline_new("encbench");
+  GstElement* src  = gst_element_factory_make("videotestsrc", nullptr);
+  GstElement* capf = gst_element_factory_make("capsfilter", nullptr);
+  GstElement* conv = format.empty() ? gst_element_factory_make("videoconvert", nullptr) : nullptr;
+  GstElement* enc  = encoder.empty() ? nullptr : gst_element_factory_make(encoder.c_str(), "enc");
+  GstElement* sink = gst_element_factory_make("fakesink", nullptr);
+  if (!src || !capf || !sink || (format.empty() && !conv) || (!encoder.empty() && !enc)) {
+    for (GstElement* e : {src, capf, conv, enc, sink}) if (e) gst_object_unref(e);
+    gst_object_unref(pipe);
+    return s;
+  }
+  set_int(src, "num-buffers", frames);
+  set_bool(src, "is-live", FALSE);
+  if (has_prop(src, "horizontal-speed")) set_int(src, "horizontal-speed", 4);   // hareket: boş sahne kodlaması yanıltır
+  GstCaps* caps = gst_caps_new_simple("video/x-raw", "width", G_TYPE_INT, width, "height", G_TYPE_INT, height,
+                                      "framerate", GST_TYPE_FRACTION, fps, 1, NULL);
+  if (!format.empty()) gst_caps_set_simple(caps, "format", G_TYPE_STRING, format.c_str(), NULL);
+  g_object_set(G_OBJECT(capf), "caps", caps, NULL);
+  gst_caps_unref(caps);
+  set_bool(sink, "sync", FALSE);
+  if (enc) configure_encoder(enc, encoder, kbps, fps * 2, 0);
+
+  ClipTiming t;
+  if (!add_chain(pipe, {src, capf, conv, enc, sink})) { gst_object_unref(pipe); return s; }
+  if (enc) {
+    GstPad* in  = gst_element_get_static_pad(enc, "sink");
+    GstPad* out = gst_element_get_static_pad(enc, "src");
+    gst_pad_add_probe(in,  GST_PAD_PROBE_TYPE_BUFFER, enc_in_probe,  &t, nullptr);
+    gst_pad_add_probe(out, GST_PAD_PROBE_TYPE_BUFFER, enc_out_probe, &t, nullptr);
+    gst_object_unref(in);
+    gst_object_unref(out);
+  }
+
+  const double cpu0 = process_cpu_ms();
+  const int64_t t0 = mono_ns();
+  bool eos = false;
+  if (gst_element_set_state(pipe, GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE) {
+    GstBus* bus = gst_element_get_bus(pipe);
+    GstMessage* msg = gst_bus_timed_pop_filtered(bus, (GstClockTime)timeout_ms * GST_MSECOND,
+                                                 (GstMessageType)(GST_MESSAGE_ERROR | GST_MESSAGE_EOS));
+    if (msg) {
+      eos = GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS;
+      gst_message_unref(msg);
+    }
+    gst_object_unref(bus);
+  }
+  const int64_t t1 = mono_ns();
+  cpu_total_ms = process_cpu_ms() - cpu0;
+  gst_element_set_state(pipe, GST_STATE_NULL);
+  gst_object_unref(pipe);
+
+  if (!enc) {
+    s.ok = eos;
+    s.fps = eos ? frames * 1e9 / std::max<int64_t>(1, t1 - t0) : 0;
+    return s;
+  }
+  std::lock_guard<std::mutex> lk(t.mu);
+  s.ok = eos && t.out >= frames * 9 / 10 && !t.lat_ms.empty();
+  if (!s.ok) return s;
+  s.fps = t.out * 1e9 / std::max<int64_t>(1, t.last_out - t.first_in);
+  std::sort(t.lat_ms.begin(), t.lat_ms.end());
+  s.p50_ms = t.lat_ms[t.lat_ms.size() / 2];
+  s.p95_ms = t.lat_ms[std::min(t.lat_ms.size() - 1, t.lat_ms.size() * 95 / 100)];
+  return s;
+}
+
+// kodlayıcının doğrudan aldığı ilk sistem belleği formatı; kaynak bunu üretir (dönüşüm ölçülmesin)
+static std::string clip_format(const std::string& encoder) {
+  GstElement* enc = gst_element_factory_make(encoder.c_str(), nullptr);
+  if (!enc) return "";
+  gst_object_ref_sink(enc);
+  const auto fmts = encoder_raw_formats(enc);
+  gst_object_unref(enc);
+  return fmts.empty() ? "" : fmts[0];
+}
+
+EncoderScore bench_encoder(const std::string& encoder, int width, int height, int fps, int kbps,
+                           int frames, int timeout_ms) {
+  const std::string fmt = clip_format(encoder);
+  double base_cpu = 0, enc_cpu = 0;
+  run_clip("", fmt, width, height, fps, kbps, frames, timeout_ms, base_cpu);
+  EncoderScore s = run_clip(encoder, fmt, width, height, fps, kbps, frames, timeout_ms, enc_cpu);
+  if (s.ok) s.cpu_ms = std::max(0.0, enc_cpu - base_cpu) / frames;
+  return s;
+}
+
+void rank_encoders(std::vector<EncoderScore>& scores, int fps_target) {
+  auto tier = [fps_target](const EncoderScore& s) { return s.meets_budget(fps_target) ? 0 : s.ok ? 1 : 2; };
+  std::stable_sort(scores.begin(), scores.end(), [&](const EncoderScore& x, const EncoderScore& y) {
+    const int tx = tier(x), ty = tier(y);
+    if (tx != ty) return tx < ty;
+    if (tx == 0) return x.cpu_ms < y.cpu_ms;
+    if (tx == 1) return x.fps > y.fps;
+    return false;
+  });
+}
+
+std::string encoder_cache_path() {
+  if (const char* p = std::getenv("NOVA_ENC_CACHE")) {
+    if (!*p || (p[0]=='0' && !p[1])) return "";
+    return p;
+  }
+  std::string base;
+  if (const char* x = std::getenv("XDG_CACHE_HOME"); x && *x) base = x;
+  else if (const char* h = std::getenv("HOME"); h && *h) base = std::string(h) + "/.cache";
+  else return "";
+  return base + "/nova_engine/encoders.txt";
+}
+
+static void mkdir_parents(const std::string& path) {
+  for (size_t i = 1; i < path.size(); ++i) {
+    if (path[i] != '/') continue;
+    ::mkdir(path.substr(0, i).c_str(), 0755);
+  }
+}
+
+// dosya: "run<TAB>anahtar" satırını o anahtarın "enc" satırları izler
+using CacheBlocks = std::vector<std::pair<std::string, std::vector<EncoderScore>>>;
+
+static CacheBlocks load_cache(const std::string& path) {
+  CacheBlocks out;
+  std::ifstream in(path);
+  std::string line;
+  if (!in || !std::getline(in, line) || line != CACHE_MAGIC) return out;
+  while (std::getline(in, line)) {
+    std::istringstream is(line);
+    std::string tag;
+    std::getline(is, tag, '\t');
+    if (tag == "run") {
+      std::string key;
+      std::getline(is, key);
+      out.push_back({key, {}});
+    } else if (tag == "enc" && !out.empty()) {
+      EncoderScore s;
+      int ok = 0;
+      std::getline(is, s.encoder, '\t');
+      if (!(is >> ok >> s.fps >> s.p50_ms >> s.p95_ms >> s.cpu_ms)) continue;
+      s.ok = ok != 0;
+      s.codec = codec_of_encoder(s.encoder);
+      out.back().second.push_back(s);
+    }
+  }
+  return out;
+}
+
+static bool save_cache(const std::string& path, const CacheBlocks& blocks) {
+  mkdir_parents(path);
+  const std::string tmp = path + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::trunc);
+    if (!out) return false;
+    out << CACHE_MAGIC << "\n";
+    for (const auto& b : blocks) {
+      out << "run\t" << b.first << "\n";
+      for (const auto& s : b.second)
+        out << "enc\t" << s.encoder << "\t" << (s.ok ? 1 : 0) << " " << s.fps << " " << s.p50_ms
+            << " " << s.p95_ms << " " << s.cpu_ms << "\n";
+    }
+    if (!out.flush()) return false;
+  }
+  return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+std::vector<EncoderScore> encoder_ranking(int width, int height, int fps, int kbps, bool refresh) {
+  const std::vector<std::string> encoders = installed_encoders();
+  std::ostringstream key;
+  gchar* ver = gst_version_string();
+  key << width << "x" << height << "@" << fps << "\t" << ver << "\t";
+  g_free(ver);
+  for (size_t i = 0; i < encoders.size(); ++i) key << (i ? "," : "") << encoders[i];
+
+  const std::string path = encoder_cache_path();
+  CacheBlocks blocks = path.empty() ? CacheBlocks{} : load_cache(path);
+  auto hit = std::find_if(blocks.begin(), blocks.end(), [&](const auto& b) { return b.first == key.str(); });
+  if (hit != blocks.end() && !refresh) {
+    std::vector<EncoderScore> scores = hit->second;
+    rank_encoders(scores, fps);
+    return scores;
+  }
+
+  // bozuk eklenti takılabilir: kare başına bütçenin 4 katı, en az 3 sn
+  const int timeout_ms = std::max(3000, CLIP_FRAMES * 4000 / std::max(1, fps));
+  std::vector<EncoderScore> scores;
+  for (const auto& e : encoders) {
+    std::cerr << "[encbench] " << e << " " << width << "x" << height << "@" << fps << " ..." << std::flush;
+    scores.push_back(bench_encoder(e, width, height, fps, kbps, CLIP_FRAMES, timeout_ms));
+    const auto& s = scores.back();
+    if (s.ok) std::cerr << " " << s.fps << " fps p95=" << s.p95_ms << " ms cpu=" << s.cpu_ms << " ms/kare\n";
+    else      std::cerr << " başarısız\n";
+  }
+  rank_encoders(scores, fps);
+
+  if (!path.empty()) {
+    if (hit != blocks.end()) hit->second = scores;
+    else blocks.push_back({key.str(), scores});
+    if (!save_cache(path, blocks)) std::cerr << "[encbench] önbellek yazılamadı: " << path << "\n";
+  }
+  return scores;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "codec.hpp"
+#include <string>
+#include <vector>
+
+// Başlangıç mikro-benchmark'ı: her kurulu kodlayıcı kısa bir sentetik klibi (videotestsrc,
+// canlı olmayan, hareketli) oturumla aynı ayarlarla kodlar. Kodlanamayan/takılan eklenti
+// elenir; kalanlar kare bütçesini (fps) tutanlar önce, kare başına CPU'ya göre sıralanır.
+struct EncoderScore {
+  std::string encoder;
+  Codec codec = Codec::H264;
+  bool ok = false;
+  double fps = 0;          // kodlama verimi (canlı olmayan kaynakla, kare/sn)
+  double p50_ms = 0, p95_ms = 0;   // kare gecikmesi: kodlayıcı girişi -> çıkışı
+  double cpu_ms = 0;       // kare başına süreç CPU'su, kaynağın kendi maliyeti çıkarılmış
+
+  bool meets_budget(int fps_target) const;
+};
+
+// Tek kodlayıcı; frames kare, en fazla timeout_ms.
+EncoderScore bench_encoder(const std::string& encoder, int width, int height, int fps, int kbps,
+                           int frames, int timeout_ms);
+
+// Kararlı sıralama: bütçeyi tutanlar (CPU artan), tutmayanlar (fps azalan), başarısızlar.
+void rank_encoders(std::vector<EncoderScore>& scores, int fps_target);
+
+// Önbellekten ya da ölçerek sıralı liste. Anahtar: WxH@fps + GStreamer sürümü + kurulu kodlayıcılar;
+// yeni eklenti kurulunca ya da refresh'te yeniden ölçülür.
+std::vector<EncoderScore> encoder_ranking(int width, int height, int fps, int kbps, bool refresh);
+
+// $NOVA_ENC_CACHE (dosya yolu, "0" = kapalı), yoksa $XDG_CACHE_HOME veya ~/.cache altında
+// nova_engine/encoders.txt. Boş dönerse önbellek kapalıdır.
+std::string encoder_cache_path();
@@ -0,0 +1,207 @@
+#pragma once
+#include "common.hpp"
+#include "camera.hpp"
+#include "codec.hpp"
+#include "control_channel.hpp"
+#include "clock_sync.hpp"
+#include "playout_delay.hpp"
+#include "rtp_stats.hpp"
+#include "stage_metrics.hpp"
+#include "udp_rx_ring.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+
+// nova_engine oturumunun dosyalar arası ortak parçaları (kayıt, çok eşli yayın, canlı
+// yeniden yapılandırma): komut satırı ayarları ve sınırları, alıcı bağlamları ve yardımcılar.
+enum class Preview { Full, Lite, Off };
+
+struct Args {
+  std::string peer_ip;
+  int video_send_port;
+  int video_listen_port;
+  int ctrl_send_port;
+  int ctrl_listen_port;
+
+  bool use_ts = false;
+  int  mtu = 1200;
+  int  bitrate_kbps = 18000;      // ABR açıkken üst sınır
+  int  min_bitrate_kbps = 1000;
+  bool abr = true;
+  int  keyint = 60;
+  int  latency_ms = 200;           // sabit tampon; uyarlamalıda başlangıç değeri
+  bool adaptive_jb = false;        // --latency=auto
+  int  jb_min_ms = 20, jb_max_ms = 1000;
+  double jb_percentile = 0.99;     // göreli gecikmenin hedef yüzdeliği
+  int  fec_percent = 0;           // ULPFEC ek yükü (%), 0 = kapalı; iki uçta aynı olmalı
+  bool nack = true;               // jitterbuffer NACK -> kontrol kanalı -> geçmişten tekrar gönderim
+  bool pli = true;                // alıcı kayıpta/çözme hatasında IDR ister; keyint büyütülebilir
+  bool batch_tx = false;          // udpsink yerine appsink -> sendmmsg
+  bool pacing = true;             // batch_tx: AU'yu kare aralığına yay
+  bool ring_rx = false;           // udpsrc+jitterbuffer yerine recvmmsg ringi -> appsrc
+  int  dec_threads = 0;           // çözücü max-threads; 0 = otomatik
+  std::string decoder = "auto";    // auto = donanım (açılabiliyorsa) yoksa yazılım, sw, ya da eleman adı
+  std::string dec_threading = "auto";  // yazılım çözücü: slice | frame | auto (lowlat'ta slice)
+  bool dec_lowlat = false;         // --dec-mode=lowlat: geç kalınca referans olmayan kareleri,
+                                   // çok geride kalınca IDR'ye kadar her şeyi atla
+
+  // çok eşli yayın: tek kodlama, eşler kontrol kanalından eklenir/çıkarılır
+  bool multi = false;
+  std::string peers;              // başlangıç eşleri "ip:vport:cport[:rxport],..."
+  bool join = false;              // konumsal eşe (hub) kendini PEER_ADD ile duyur
+
+  // simulcast: tee -> katman başına ölçek + kodlayıcı (tam, 1/2, 1/4); her eş kendi katmanını alır
+  int simulcast = 1;              // katman sayısı; 1 = kapalı, >1 çok eşli modu açar
+  std::string simulcast_kbps;     // "18000,6000,2000"; boş: bitrate, /3, /9
+  int layer = -1;                 // alıcı: istenen katman; -1 = otomatik (gösterim düşmelerine göre)
+
+  std::string encoder;             // boş: benchmark sıralaması + kodek anlaşması
+  // kodek: auto = benchmark sırası; h264/h265/vp9/av1 = yalnızca o kodek (eş çözemiyorsa H264)
+  std::string codec = "auto";
+  Codec rx_codec = Codec::H264;    // eşin gönderdiği kodek (anlaşmadan)
+  int  enc_bench = 1;              // 0 = sabit sıra (choose_h264_encoder), 1 = önbellekli, 2 = yeniden ölç
+  int  codec_timeout_ms = 5000;    // eş CODEC_CAPS'e yanıt vermezse H264
+
+  // yerel önizleme: full = tam kare, lite = küçültülmüş + seyreltilmiş, off = dal yok (headless)
+  Preview preview = Preview::Full;
+  int preview_width = 0, preview_height = 0;   // lite; 0 = yarı boyut (alanın dörtte biri)
+  int preview_fps = 15;
+
+  // yakalama yolu: native = kamera formatı kodlayıcıya kadar (yalnızca farklıysa dönüşüm),
+  // legacy = her zaman videoconvert + yazılım jpegdec (karşılaştırma için)
+  bool native_capture = true;
+  std::string io_mode = "auto";    // v4l2src io-mode; auto: VA/QSV kodlayıcıyla dmabuf
+  std::string mjpg_decoder;        // boş: choose_jpeg_decoder()
+
+  // kayıt: kodlanmış akış yeniden kodlanmadan parçalı dosyalara (gönderilen ve/veya alınan)
+  bool record_tx = false, record_rx = false;
+  std::string record_dir = ".";
+  std::string record_format = "mkv";  // mkv | mp4 (parçalı) | ts
+  int record_segment_s = 300;         // anahtar karede bölünür
+  int record_buffer_mb = 64;          // diske yazılmayı bekleyebilecek en fazla veri
+
+  // hareket kapısı: durağan sahnede kare hızı ve bitrate düşer, sahne kesmesinde IDR
+  std::string motion = "auto";        // auto = yazılım kodlayıcıda (benchmark hariç) | on | off
+  double motion_thresh = 4.0;         // gürültü tabanının üstünde karo ortalaması (0-255)
+  int motion_idle_fps = 5;
+  int motion_idle_kbps = 25;          // durağanken bitrate, hedefin yüzdesi
+  int motion_budget_us = 500;         // kare başına analiz bütçesi
+
+  // streaming thread'leri: ad + thread başına CPU; kurallar (--affinity/--sched) ThreadPolicy'de
+  bool threads = false;
+  int thread_stats_s = 5;             // CPU raporu aralığı; 0 = yok
+
+  // aşama metrikleri: "" = kapalı (prob yok), "prom" = 127.0.0.1:metrics_port, "json" = metrics_out
+  std::string metrics;
+  int metrics_port = 9464;
+  std::string metrics_out = "nova_metrics.json";
+
+  // headless benchmark (--bench): sentetik/dosya kaynağı, fakesink, 127.0.0.1 döngüsü
+  bool bench = false;
+  std::string bench_src;           // boş: videotestsrc
+  int bench_seconds = 10, bench_warmup = 2;
+  std::string bench_encoders;      // virgülle ayrılmış; boş: --encoder / otomatik
+  std::string bench_sizes;         // "1280x720,1920x1080"; boş: width x height
+  std::string bench_out;           // JSON dosyası; boş: stdout
+  std::string bench_format = "I420";  // kaynağın "kamera" formatları (virgüllü) ya da MJPG
+  std::string bench_capture;       // "native,legacy": yakalama yolu karşılaştırması; boş: --capture
+
+  std::string device = "/dev/video0";
+  int width = 1280, height = 720, fps = 30;
+  int prefer_mjpg = 1;
+
+  // çoklu kamera: off = yalnızca en iyi kamera; composite = tüm kameralar karolara birleştirilip
+  // tek kodlama (width x height@fps çıktı); streams = her kamera kendi kodlayıcısıyla ayrı akış
+  // (k. kamera video_send_port + k'ye; karşı uç --rx-streams ile alır)
+  std::string multicam = "off";
+  int multicam_max = 4;
+  int multicam_kbps = 0;             // streams: ek akış başına sabit bitrate; 0 = bitrate / kamera sayısı
+  std::vector<CamProfile> cams;      // seçilenler; cams[0] ana akış (device/width/height/fps ile aynı)
+  int rx_streams = 1;                // alıcı: eşin streams modundaki akış sayısı (video_listen_port + k)
+};
+
+constexpr int FEC_PT = 122;   // ULPFEC payload type (video: 96)
+constexpr int MAX_LAYERS = 3; // simulcast: tam, 1/2, 1/4
+
+constexpr int MIN_MTU = 576;
+constexpr int MAX_MTU = 1400;   // FEC başlığı + RtxHistory::MAX_PKT payı
+constexpr int MAX_CAMS = 4;
+// composite çıktısı en fazla 1080p30: karolar küçüldükçe kaynaklar da küçük modda yakalanır
+constexpr int COMPOSITE_MAX_W = 1920, COMPOSITE_MAX_H = 1080, COMPOSITE_MAX_FPS = 30;
+
+// ---- alıcı bağlamları (tanımlar nova_engine.cpp'de) ----
+// Bir alıcı boru hattının istatistikleri ve geri bildirim hedefi; çok eşli modda eş başına bir tane.
+struct RxLink {
+  RtpRxStats stats;
+  DelayTracker delay;   // aynı streaming thread'inden beslenir
+  OwdTracker owd;       // saat örnekleri ve SENDER_REPORT kontrol thread'inden
+  ControlChannel* ctrl = nullptr;
+  bool has_to = false;
+  sockaddr_in to{};     // has_to: eşin kontrol adresi; değilse ana eş
+  std::atomic<int64_t> last_kf_ms{0};
+  const sockaddr_in* dest() const { return has_to ? &to : nullptr; }
+};
+
+// RR gönderimi (report_cb, 250 ms); ring modunda jbuf nullptr, FEC kapalıysa fecdec nullptr
+struct ReportCtx { GstElement* jbuf; GstElement* fecdec; UdpRxRing* ring; RxLink* link; };
+gboolean report_cb(gpointer user_data);
+
+// uyarlamalı alıcı tamponu (jb_cb, 250 ms)
+struct JbCtx {
+  GstElement* jbuf; UdpRxRing* ring; PlayoutDelay* pd; RxLink* link;
+  bool adaptive; double pct;
+  int64_t last_log_ms;
+};
+gboolean jb_cb(gpointer user_data);
+
+// simulcast katman isteği (layer_cb, 2 sn)
+struct LayerCtx {
+  GstElement* pipe; RxLink* link;
+  int pref;                      // --layer; -1 = otomatik
+  int cap = 0;                   // otomatik: istenen en ince katman
+  guint64 rendered = 0, dropped = 0;
+  int bad = 0;
+  int64_t good_since_ms = 0, sent_ms = 0;
+};
+gboolean layer_cb(gpointer user_data);
+
+// çözme süresi ve gecikme farkındalıklı atlama (dec_cb, 500 ms)
+struct DecodeCtx {
+  GstElement* dec = nullptr;       // boru hattı sahibi
+  Codec codec = Codec::H264;
+  bool lowlat = false;
+  std::string label;
+  StageStats timing{"receiver", "dec", "decoder"};   // giriş -> çıkış, anahtar PTS
+  std::atomic<bool> length_prefixed{false};          // avc/hvc1 caps
+  std::atomic<int64_t> max_late_ns{0};               // pencere içi en büyük QoS gecikmesi
+  std::atomic<int> level{0};
+  std::atomic<uint64_t> skipped_nonref{0}, skipped_delta{0};
+  int late_windows = 0, calm_windows = 0;
+  uint64_t last_count = 0, last_sum_ns = 0;
+  int64_t last_log_ms = 0;
+};
+// build_receiver'ın "dec" elemanına; ctx boru hattından uzun yaşamalı
+void attach_decode_ctx(GstElement* receiver, DecodeCtx* ctx, const Args& a);
+gboolean dec_cb(gpointer user_data);
+
+// name: boru hattı adı (bus/metrik etiketi); çok eşli modda eş başına "receiver-<ip>:<port>"
+GstElement* build_receiver(const Args& a, RxLink* link, const std::string& name = "receiver");
+
+// ---- ortak yardımcılar ----
+int64_t steady_ms();
+// G_SOURCE_REMOVE ile kendiliğinden bitmiş olanlar atlanır
+void remove_sources(std::vector<guint>& ids);
+void force_key_unit(GstElement* enc);
+// virgüllü liste; boş öğeler atlanır
+std::vector<std::string> split_list(const std::string& s);
+// katman 0 eski adları taşır; diğerleri sonek alır ("enc1", "udpsink2")
+std::string layer_name(const char* base, int layer);
+// simulcast katman hedefleri (kbps): --simulcast-kbps ya da tam / 3 / 9 (alan 1/4, 1/16)
+std::vector<int> layer_kbps(const Args& a);
+
+// hareket kapısı sahneyi durağan bulduysa kodlayıcıya hedefin yalnızca --motion-idle-kbps'i verilir
+// (CBR kodlayıcı sabit sahnede bitleri gürültüye harcamasın); hedefler ABR'de ölçeksiz tutulur
+extern std::atomic<bool> g_scene_idle;
+int scene_kbps(const Args& a, int kbps);
@@ -0,0 +1,37 @@
+#include "frame_pacing.hpp"
+#include <algorithm>
+#include <cmath>
+
+void FramePacing::on_frame(uint64_t now_us) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (!window_us_) window_us_ = now_us;
+  ++frames_;
+  if (last_us_ && now_us > last_us_) {
+    const double d = (double)(now_us - last_us_);
+    ++intervals_;
+    sum_ += d;
+    sumsq_ += d * d;
+    max_ = std::max(max_, d);
+    if (d > nominal_us_ * 1.5) ++late_;
+  }
+  last_us_ = now_us;
+}
+
+FramePacing::Snapshot FramePacing::take(uint64_t now_us) {
+  std::lock_guard<std::mutex> lk(mu_);
+  Snapshot s;
+  s.frames = frames_;
+  s.late = late_;
+  if (window_us_ && now_us > window_us_) s.fps = frames_ * 1e6 / (double)(now_us - window_us_);
+  if (intervals_) {
+    const double mean = sum_ / intervals_;
+    s.mean_ms = mean / 1000.0;
+    s.jitter_ms = std::sqrt(std::max(0.0, sumsq_ / intervals_ - mean * mean)) / 1000.0;
+    s.max_ms = max_ / 1000.0;
+  }
+  // aralık zinciri kopmaz: sonraki pencerenin ilk aralığı last_us_'tan ölçülür
+  window_us_ = now_us;
+  frames_ = intervals_ = late_ = 0;
+  sum_ = sumsq_ = max_ = 0;
+  return s;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+
+// Kaynak başına kare zamanlaması: yakalama çıkışında ardışık karelerin varış aralıkları (steady µs).
+// Geç kare: aralık nominalin 1.5 katından uzun (sürücü kare kaçırdı, USB bant genişliği yetmedi,
+// ya da kaynak thread'i bekletildi). on_frame() streaming thread'inden, take() ana thread'den.
+class FramePacing {
+ public:
+  explicit FramePacing(int nominal_fps) : nominal_us_(1000000.0 / (nominal_fps > 0 ? nominal_fps : 30)) {}
+
+  void on_frame(uint64_t now_us);
+
+  struct Snapshot {
+    uint64_t frames = 0;
+    double fps = 0;
+    double mean_ms = 0, jitter_ms = 0, max_ms = 0;   // aralık ortalaması, standart sapması, en uzunu
+    uint64_t late = 0;
+  };
+  // son take()'ten bu yana (ilk çağrıda ilk kareden bu yana)
+  Snapshot take(uint64_t now_us);
+
+ private:
+  const double nominal_us_;
+  std::mutex mu_;
+  uint64_t last_us_ = 0, window_us_ = 0;
+  uint64_t frames_ = 0, intervals_ = 0, late_ = 0;
+  double sum_ = 0, sumsq_ = 0, max_ = 0;
+};
@@ -17,3 +17,18 @@ std::string choose_h264_encoder() {
   if (has_factory("vah264enc"))    return "vah264enc";     // AMD (bazı distrolar)
   return "x264enc"; // CPU fallback
 }
+
+std::string choose_jpeg_decoder(const std::string& encoder) {
+  const char* force = std::getenv("NOVA_FORCE_JPEGDEC");
+  if (force && *force=='1') return "jpegdec";
+  const char* same = nullptr;
+  // kodlayıcıyla aynı cihaz/ailede çözücü (kodekten bağımsız: nvh265enc -> nvjpegdec)
+  if      (encoder.rfind("nv", 0) == 0)    same = "nvjpegdec";
+  else if (encoder.rfind("vaapi", 0) == 0) same = "vaapijpegdec";
+  else if (encoder.rfind("qsv", 0) == 0)   same = "qsvjpegdec";
+  else if (encoder.rfind("va", 0) == 0)    same = "vajpegdec";
+  if (same && has_factory(same)) return same;
+  for (const char* d : {"nvjpegdec", "vajpegdec", "qsvjpegdec", "vaapijpegdec", "v4l2jpegdec"})
+    if (has_factory(d)) return d;
+  return "jpegdec"; // CPU fallback
+}
@@ -1,3 +1,6 @@
 #pragma once
 #include <string>
 std::string choose_h264_encoder();
+// MJPG kamera için: kodlayıcıyla aynı aileden donanım çözücü (bellek aynı cihazda kalır),
+// yoksa başka bir donanım çözücü, en son jpegdec
+std::string choose_jpeg_decoder(const std::string& encoder);
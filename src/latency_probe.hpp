@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// ---- piksel kodlu kare damgası ----
+// Y düzleminin sol üst köşesinde tek sıra kare blok: 24 bit kare sayacı + 8 bit sağlama.
+// Blok kenarı min(16, genişlik/32); siyah/beyaz bloklar yüksek sıkıştırmada da okunur.
+// Kodlayıcının kaydırmadığı (flip/crop olmayan) bir yol gerektirir.
+void stamp_write(uint8_t* luma, int stride, int width, int height, uint32_t id);
+bool stamp_read(const uint8_t* luma, int stride, int width, int height, uint32_t& id);
+
+// Yakalama anı -> gösterim anı gecikmeleri. Gönderici ve alıcı aynı süreçte olmalı
+// (aynı steady clock). on_capture/on_display farklı streaming thread'lerinden çağrılır.
+class LatencyRecorder {
+ public:
+  struct Summary {
+    uint64_t captured = 0, displayed = 0, bad_stamps = 0;
+    double p50_ms = 0, p99_ms = 0, p999_ms = 0, mean_ms = 0, max_ms = 0;
+  };
+
+  uint32_t on_capture(uint64_t now_ns);            // damgalanacak kimliği döner
+  void on_display(uint32_t id, uint64_t now_ns);
+  void on_bad_stamp() { bad_.fetch_add(1, std::memory_order_relaxed); }
+
+  // ölçüm penceresini (yeniden) başlatır; öncesindeki örnekler atılır
+  void start_window();
+  Summary summary() const;
+
+ private:
+  static constexpr size_t SLOTS = 4096;   // 60 fps'te ~68 sn geçmiş
+
+  std::atomic<uint32_t> next_id_{1};
+  std::atomic<uint32_t> slot_id_[SLOTS] = {};
+  std::atomic<uint64_t> slot_ns_[SLOTS] = {};
+
+  std::atomic<bool> recording_{false};
+  std::atomic<uint64_t> captured_{0}, bad_{0};
+  mutable std::mutex mu_;
+  std::vector<double> samples_ms_;
+};
@@ -0,0 +1,202 @@
+#include "live_reconfig.hpp"
+#include "cam_modes.hpp"
+#include "v4l2_probe.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+GstPadProbeReturn live_keyint_probe(GstPad*, GstPadProbeInfo*, gpointer user_data) {
+  auto* lc = static_cast<LiveCtx*>(user_data);
+  const int n = lc->force_keyint.load(std::memory_order_relaxed);
+  if (n > 0 && lc->frames.fetch_add(1, std::memory_order_relaxed) % (uint32_t)n == 0)
+    for (GstElement* e : lc->encs) force_key_unit(e);
+  return GST_PAD_PROBE_OK;
+}
+
+// "1280x720", "1280x720@30", "@30", "fps=30", "kbps=4000", "keyint=60", "mtu=1200"; verilmeyen alan 0
+static bool parse_reconfig(std::istream& in, ctrl::Reconfig& r) {
+  std::string tok;
+  bool any = false;
+  while (in >> tok) {
+    int w = 0, h = 0, f = 0;
+    const auto eq = tok.find('=');
+    if (eq != std::string::npos) {
+      const std::string key = tok.substr(0, eq);
+      int v = 0;
+      try { v = std::stoi(tok.substr(eq + 1)); } catch (const std::exception&) { return false; }
+      if (v <= 0) return false;
+      if      (key == "fps")    r.fps = (uint16_t)std::min(v, MAX_FPS);
+      else if (key == "kbps")   r.kbps = (uint32_t)v;
+      else if (key == "keyint") r.keyint = (uint16_t)std::min(v, 65535);
+      else if (key == "mtu")    r.mtu = (uint16_t)std::clamp(v, MIN_MTU, MAX_MTU);
+      else return false;
+    } else if (sscanf(tok.c_str(), "@%d", &f) == 1 && f > 0) {
+      r.fps = (uint16_t)std::min(f, MAX_FPS);
+    } else {
+      const int m = sscanf(tok.c_str(), "%dx%d@%d", &w, &h, &f);
+      if (m < 2 || w < 16 || h < 16 || w > MAX_W || h > MAX_H || (m == 3 && f <= 0)) return false;
+      r.width = (uint16_t)w; r.height = (uint16_t)h;
+      if (m == 3) r.fps = (uint16_t)std::min(f, MAX_FPS);
+    }
+    any = true;
+  }
+  return any;
+}
+
+// Kamera bu modu sunuyor mu (ioctl; cihaz yakalamadayken de sorgulanabilir).
+// format: native yolda caps_src'deki ham format; boşsa herhangi biri.
+static bool camera_has_mode(const Args& a, int W, int H, int F, const std::string& format) {
+  const bool mjpg = a.prefer_mjpg != 0;
+  for (const auto& m : v4l2_enumerate_modes(a.device, {{W, H}})) {
+    if (m.mjpg != mjpg || m.width != W || m.height != H || !m.has_fps(F)) continue;
+    if (mjpg || format.empty()) return true;
+    const char* f = v4l2_fourcc_to_gst(m.fourcc);
+    if (f && format == f) return true;
+  }
+  return false;
+}
+
+// capsfilter'ın boyut/fps alanlarını değiştirir (format vb. korunur); F == 0: fps'e dokunulmaz
+static void retarget_caps(GstElement* capsf, int W, int H, int F) {
+  GstCaps* c = nullptr;
+  g_object_get(G_OBJECT(capsf), "caps", &c, NULL);
+  if (!c) return;
+  c = gst_caps_make_writable(c);
+  gst_caps_set_simple(c, "width", G_TYPE_INT, W, "height", G_TYPE_INT, H, NULL);
+  if (F > 0) gst_caps_set_simple(c, "framerate", GST_TYPE_FRACTION, F, 1, NULL);
+  g_object_set(G_OBJECT(capsf), "caps", c, NULL);
+  gst_caps_unref(c);
+}
+
+static std::string caps_format(GstElement* capsf) {
+  GstCaps* c = nullptr;
+  g_object_get(G_OBJECT(capsf), "caps", &c, NULL);
+  std::string out;
+  if (c && !gst_caps_is_empty(c))
+    if (const char* f = gst_structure_get_string(gst_caps_get_structure(c, 0), "format")) out = f;
+  if (c) gst_caps_unref(c);
+  return out;
+}
+
+void live_apply(LiveCtx* lc, const ctrl::Reconfig& r, const std::string& origin) {
+  Args& a = *lc->a;
+  const int nlayers = std::max(1, a.simulcast);
+  std::ostringstream done;
+
+  const int W = r.width ? r.width & ~1 : a.width, H = r.height ? r.height & ~1 : a.height;
+  const int F = r.fps ? r.fps : a.fps;
+  if ((W != a.width || H != a.height || F != a.fps) && a.multicam == "composite" && a.cams.size() > 1) {
+    // karo boyutları ve kamera modları açılışta seçildi; çıktı sabit
+    std::cerr << "[reconfig] composite: çözünürlük/fps değiştirilemez\n";
+  } else if ((W != a.width || H != a.height || F != a.fps) && lc->recording) {
+    // splitmuxsink içindeki matroskamux/mp4mux akış ortasında boyut/codec_data değişimini reddeder
+    std::cerr << "[reconfig] kayıt sürerken çözünürlük/fps değiştirilemez\n";
+  } else if (W != a.width || H != a.height || F != a.fps) {
+    GstElement* capsf = gst_bin_get_by_name(GST_BIN(lc->sender), a.bench ? "bench_caps" : "caps_src");
+    if (!capsf) {
+      std::cerr << "[reconfig] kaynak capsfilter yok\n";
+    } else if (!a.bench && !camera_has_mode(a, W, H, F, caps_format(capsf))) {
+      std::cerr << "[reconfig] " << a.device << " " << W << "x" << H << "@" << F << " sunmuyor\n";
+    } else {
+      // önce aşağı akıştaki sabit boyutlar: yeni kaynak caps'i geldiğinde hazır olsunlar
+      for (int i = 1; i < nlayers; ++i)
+        if (GstElement* sc = gst_bin_get_by_name(GST_BIN(lc->sender), layer_name("scaps", i).c_str())) {
+          retarget_caps(sc, std::max(16, (W >> i) & ~1), std::max(16, (H >> i) & ~1), 0);
+          gst_object_unref(sc);
+        }
+      if (a.preview == Preview::Lite && a.preview_width <= 0)
+        if (GstElement* pc = gst_bin_get_by_name(GST_BIN(lc->sender), "prev_caps")) {
+          retarget_caps(pc, std::max(2, W / 2 & ~1), std::max(2, H / 2 & ~1), 0);
+          gst_object_unref(pc);
+        }
+      retarget_caps(capsf, W, H, F);
+      a.width = W; a.height = H; a.fps = F;
+      for (UdpBatchSender* b : lc->batch) b->set_frame_interval_us(1000000 / F);
+      for (GstElement* e : lc->encs) force_key_unit(e);
+      done << " " << W << "x" << H << "@" << F;
+    }
+    if (capsf) gst_object_unref(capsf);
+  }
+
+  if (r.kbps && (int)r.kbps != a.bitrate_kbps) {
+    // Args'ın hız alanları; çok eşli modda hub->mu altında (IDR probu streaming thread'inde okur)
+    auto retarget = [&a, &r]() {
+      const int old = a.bitrate_kbps;
+      a.bitrate_kbps = std::max(a.min_bitrate_kbps, (int)r.kbps);
+      // açık katman listesi aynı oranla ölçeklenir
+      if (!a.simulcast_kbps.empty()) {
+        std::string list;
+        for (const auto& k : split_list(a.simulcast_kbps))
+          list += (list.empty() ? "" : ",") + std::to_string((int)((int64_t)std::atoi(k.c_str()) * a.bitrate_kbps / old));
+        a.simulcast_kbps = list;
+      }
+      return layer_kbps(a);
+    };
+    if (lc->hub) {
+      std::lock_guard<std::mutex> lk(lc->hub->mu);
+      const std::vector<int> kbps = retarget();
+      for (auto& kv : lc->hub->peers) kv.second.rc->set_max_kbps(a.bitrate_kbps);
+      for (auto& l : lc->hub->layers) {
+        l.max_kbps = kbps[l.index];
+        if (a.abr) continue;
+        l.enc_kbps = l.max_kbps;
+        set_encoder_bitrate(l.enc, lc->enc_name, scene_kbps(a, l.enc_kbps));
+      }
+      hub_apply_rate(lc->hub);
+    } else {
+      retarget();
+      set_encoder_bitrate(lc->encs[0], lc->enc_name,
+                          scene_kbps(a, a.abr ? lc->rc->set_max_kbps(a.bitrate_kbps) : a.bitrate_kbps));
+    }
+    done << " " << (a.abr ? "max-kbps=" : "kbps=") << a.bitrate_kbps;
+  }
+
+  if (r.keyint && r.keyint != a.keyint) {
+    a.keyint = r.keyint;
+    bool live = true;
+    for (GstElement* e : lc->encs) live = set_encoder_keyint(e, lc->enc_name, a.keyint) && live;
+    if (live) lc->base_keyint = a.keyint;
+    const bool forced = !live && a.keyint < lc->base_keyint;
+    lc->frames = 0;
+    lc->force_keyint = forced ? a.keyint : 0;
+    done << " keyint=" << a.keyint;
+    if (forced) done << " (zorlanmış IDR)";
+    else if (!live) done << " (kodlayıcı canlı değiştiremiyor, " << lc->base_keyint << " geçerli)";
+  }
+
+  if (r.mtu && r.mtu != a.mtu) {
+    a.mtu = std::clamp<int>(r.mtu, MIN_MTU, MAX_MTU);
+    for (int i = 0; i < nlayers; ++i)
+      if (GstElement* pay = gst_bin_get_by_name(GST_BIN(lc->sender), layer_name("pay", i).c_str())) {
+        set_int(pay, "mtu", a.mtu);
+        gst_object_unref(pay);
+      }
+    done << " mtu=" << a.mtu;
+  }
+
+  if (done.tellp() > 0) std::cout << "[reconfig] " << origin << ":" << done.str() << "\n";
+}
+
+void live_post(LiveCtx* lc, const ctrl::Reconfig& r, const std::string& origin) {
+  struct Req { LiveCtx* lc; ctrl::Reconfig r; std::string origin; };
+  std::lock_guard<std::mutex> lk(lc->mu);
+  lc->idle_ids.push_back(g_idle_add_full(G_PRIORITY_DEFAULT, +[](gpointer d) -> gboolean {
+    auto* q = static_cast<Req*>(d);
+    live_apply(q->lc, q->r, q->origin);
+    return G_SOURCE_REMOVE;
+  }, new Req{lc, r, origin}, +[](gpointer d){ delete static_cast<Req*>(d); }));
+}
+
+void live_command(LiveCtx* lc, const std::string& line) {
+  std::istringstream in(line);
+  std::string cmd;
+  in >> cmd;
+  ctrl::Reconfig r;
+  if ((cmd == "set" || cmd == "peer") && parse_reconfig(in, r)) {
+    if (cmd == "set") live_apply(lc, r, "stdin");
+    else { lc->ctrl->send_reconfig(r); std::cout << "[reconfig] karşıya gönderildi\n"; }
+    return;
+  }
+  std::cout << "[key] komutlar: set|peer WxH[@fps] [fps=N] [kbps=N] [keyint=N] [mtu=N]; q = çıkış\n";
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "common.hpp"
+#include "control_channel.hpp"
+#include "ctrl_proto.hpp"
+#include "engine.hpp"
+#include "peer_hub.hpp"
+#include "rate_control.hpp"
+#include "udp_batch.hpp"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Canlı yeniden yapılandırma.
+// Boru hattı yıkılmaz. Çözünürlük/fps kaynağın capsfilter'ında değişir, caps aşağı akışta yeniden
+// anlaşılır (simulcast ölçekleri ve küçük önizleme birlikte); kodlayıcı yeni boyutla yeniden
+// başlar ve ayrıca IDR istenir: alıcının depay/çözücüsü yeni SPS'e o IDR'da geçer. kbps ABR'nin
+// üst sınırıdır (kapalıysa doğrudan bitrate), mtu paketleyicilere anında. keyint'i PLAYING'de
+// kabul etmeyen kodlayıcıda (x264enc dahil çoğu) kısaltma zorlanmış IDR ile yapılır; uzatma
+// açılıştaki aralıkla sınırlı kalır.
+// Girişler: stdin satırı ("set 1280x720@30 kbps=4000 keyint=30 mtu=1200"; "peer ..." aynı isteği
+// karşıya gönderir) ve kontrol kanalından RECONFIG. Uygulama ana thread'de.
+struct LiveCtx {
+  Args* a = nullptr;
+  GstElement* sender = nullptr;
+  std::string enc_name;
+  std::vector<GstElement*> encs;           // katman kodlayıcıları (ref)
+  ControlChannel* ctrl = nullptr;
+  PeerHub* hub = nullptr;                  // çok eşli; değilse nullptr
+  RateController* rc = nullptr;            // tek eş
+  std::vector<UdpBatchSender*> batch;      // toplu gönderim: pacing kare aralığı
+  int base_keyint = 0;                     // kodlayıcının bildiği aralık
+  bool recording = false;                  // gönderici kaydı: kodlanmış akışın caps'i sabit kalmalı
+  std::atomic<int> force_keyint{0};        // >0: her N yakalanan karede bir IDR
+  std::atomic<uint32_t> frames{0};
+  std::mutex mu;                           // idle_ids
+  std::vector<guint> idle_ids;
+};
+
+// tee girişinde yakalanan kareler: kodlayıcı keyint'i canlı değiştiremiyorsa IDR burada zorlanır
+GstPadProbeReturn live_keyint_probe(GstPad*, GstPadProbeInfo*, gpointer user_data);
+
+// ana thread; origin günlük için ("stdin", eşin adresi)
+void live_apply(LiveCtx* lc, const ctrl::Reconfig& r, const std::string& origin);
+
+// kontrol thread'inden: ana döngüye aktarılır (boru hattı ve Args orada değişir)
+void live_post(LiveCtx* lc, const ctrl::Reconfig& r, const std::string& origin);
+
+// stdin satırı ("set ..." yerelde, "peer ..." karşıda); tanınmazsa kullanım yazılır
+void live_command(LiveCtx* lc, const std::string& line);
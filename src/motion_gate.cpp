@@ -0,0 +1,133 @@
+#include "motion_gate.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Sensör gürültüsü bundan yüksek sayılmaz: kamera kaydırmasında karoların hepsi birlikte değişir,
+// taban onu "gürültü" diye öğrenip hareketi yutmasın
+static constexpr double MAX_NOISE = 8.0;
+
+// iki satırın mutlak fark toplamı; hizasız yükleme (stride hizası garanti değil)
+static uint64_t sad_row(const uint8_t* a, const uint8_t* b, int n) {
+  uint64_t s = 0;
+  int i = 0;
+#if defined(__SSE2__)
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 16 <= n; i += 16)
+    acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                                          _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i))));
+  s = (uint64_t)_mm_cvtsi128_si64(acc) + (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(acc, acc));
+#elif defined(__ARM_NEON)
+  uint32x4_t acc = vdupq_n_u32(0);
+  for (; i + 16 <= n; i += 16)
+    acc = vpadalq_u16(acc, vpaddlq_u8(vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i))));
+  s = (uint64_t)vgetq_lane_u32(acc, 0) + vgetq_lane_u32(acc, 1) + vgetq_lane_u32(acc, 2) + vgetq_lane_u32(acc, 3);
+#endif
+  for (; i < n; ++i) s += (uint64_t)std::abs(a[i] - b[i]);
+  return s;
+}
+
+MotionGate::MotionGate(const Config& c) : cfg_(c) {}
+
+void MotionGate::reset_ref(int row_bytes, int height) {
+  ref_bytes_ = row_bytes;
+  ref_height_ = height;
+  ref_.resize((size_t)((height + step_ - 1) / step_) * row_bytes);
+  have_ref_ = false;
+}
+
+void MotionGate::adapt(double us) {
+  double cost = cost_us_.load(std::memory_order_relaxed);
+  cost = cost > 0 ? cost + (us - cost) * 0.1 : us;
+  if (cost > cfg_.budget_us) {
+    if (step_ < MAX_STEP) {
+      // yarı satır, yaklaşık yarı maliyet; referans yeni düzende yeniden alınır
+      step_ *= 2;
+      cost /= 2;
+      over_ = 0;
+      reset_ref(ref_bytes_, ref_height_);
+    } else if (++over_ >= OVER_BUDGET_FRAMES) {
+      disabled_ = true;
+      idle_.store(false, std::memory_order_relaxed);
+    }
+  } else {
+    over_ = 0;
+    if (cost < cfg_.budget_us / 4.0 && step_ > BASE_STEP) {
+      step_ /= 2;
+      cost *= 2;
+      reset_ref(ref_bytes_, ref_height_);
+    }
+  }
+  cost_us_.store(cost, std::memory_order_relaxed);
+}
+
+MotionGate::Verdict MotionGate::on_frame(const uint8_t* plane, int stride, int row_bytes, int height, int64_t t_us) {
+  frames_.fetch_add(1, std::memory_order_relaxed);
+  if (disabled_ || !plane || row_bytes < TILES * 16 || height < TILES) return Verdict::Pass;
+  if (row_bytes != ref_bytes_ || height != ref_height_) reset_ref(row_bytes, height);
+
+  const auto t0 = std::chrono::steady_clock::now();
+  uint64_t sad[TILES][TILES] = {}, cnt[TILES][TILES] = {};
+  const int seg = row_bytes / TILES & ~15;   // son karo kalanı da alır
+  uint8_t* ref = ref_.data();
+  for (int y = 0; y < height; y += step_, ref += row_bytes) {
+    const uint8_t* row = plane + (size_t)y * stride;
+    if (have_ref_) {
+      const int ty = y * TILES / height;
+      for (int tx = 0; tx < TILES; ++tx) {
+        const int off = tx * seg, len = tx == TILES - 1 ? row_bytes - off : seg;
+        sad[ty][tx] += sad_row(row + off, ref + off, len);
+        cnt[ty][tx] += (uint64_t)len;
+      }
+    }
+    std::memcpy(ref, row, (size_t)row_bytes);
+  }
+  const bool compared = have_ref_;
+  have_ref_ = true;
+  adapt(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+  if (!compared) return Verdict::Pass;
+
+  double mean[TILES * TILES];
+  uint64_t total = 0, n = 0;
+  for (int ty = 0; ty < TILES; ++ty)
+    for (int tx = 0; tx < TILES; ++tx) {
+      mean[ty * TILES + tx] = cnt[ty][tx] ? (double)sad[ty][tx] / cnt[ty][tx] : 0.0;
+      total += sad[ty][tx]; n += cnt[ty][tx];
+    }
+  const double global = n ? (double)total / n : 0.0;
+  // gürültü tabanı: karoların ortancası (sahnenin çoğu durağan arka plandır)
+  std::nth_element(mean, mean + TILES * TILES / 2, mean + TILES * TILES);
+  const double median = mean[TILES * TILES / 2];
+  const double peak = *std::max_element(mean, mean + TILES * TILES);
+  noise_ = noise_ < 0 ? median : noise_ + (median - noise_) * 0.05;
+  noise_ = std::min(noise_, MAX_NOISE);
+
+  if (global >= cfg_.cut && median >= cfg_.cut / 2 && t_us - last_cut_us_ >= CUT_COOLDOWN_US) {
+    last_cut_us_ = last_pass_us_ = t_us;
+    still_since_us_ = -1;
+    idle_.store(false, std::memory_order_relaxed);
+    cuts_.fetch_add(1, std::memory_order_relaxed);
+    return Verdict::Cut;
+  }
+
+  if (peak > noise_ + cfg_.thresh) {
+    still_since_us_ = -1;
+    idle_.store(false, std::memory_order_relaxed);
+  } else {
+    if (still_since_us_ < 0) still_since_us_ = t_us;
+    if (t_us - still_since_us_ >= (int64_t)cfg_.hold_ms * 1000) idle_.store(true, std::memory_order_relaxed);
+  }
+
+  if (idle() && t_us - last_pass_us_ < 1000000 / std::max(1, cfg_.idle_fps)) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return Verdict::Drop;
+  }
+  last_pass_us_ = t_us;
+  return Verdict::Pass;
+}
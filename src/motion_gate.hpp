@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Durağan sahne / sahne kesmesi tespiti: yakalanan karenin parlaklık düzlemi bir öncekiyle
+// karşılaştırılır (SIMD mutlak fark toplamı, SSE2 / NEON, yoksa skaler). Kare 8x8 karoya bölünür;
+// hareket = en çok değişen karonun piksel başına ortalama farkı (küçük bir nesne de yakalanır),
+// gürültü tabanı sakin karelerden yavaşça izlenir. Satırlar seyreltilerek örneklenir: ölçülen
+// maliyet bütçeyi aşarsa seyreltme ikiye katlanır, en seyrek adımda da aşılıyorsa kapı kapanır
+// (her kare geçer). Karar yalnızca on_frame()'in çağrıldığı streaming thread'inde verilir.
+class MotionGate {
+ public:
+  struct Config {
+    double thresh = 4.0;        // gürültü tabanının üstünde, karo ortalaması (0-255)
+    double cut = 40.0;          // sahne kesmesi: tüm karenin ortalama farkı
+    int idle_fps = 5;           // durağanken geçirilen kare hızı
+    int hold_ms = 1000;         // bu kadar hareketsizlikten sonra seyreltme başlar
+    int budget_us = 500;        // kare başına analiz bütçesi
+  };
+  enum class Verdict { Pass, Drop, Cut };   // Cut: kare geçer, kodlayıcıdan IDR istenir
+
+  explicit MotionGate(const Config& c);
+
+  // plane: parlaklık düzlemi (paketli YUV'da 0. bileşenin satırı, kroma dahil); t_us kare zamanı
+  Verdict on_frame(const uint8_t* plane, int stride, int row_bytes, int height, int64_t t_us);
+
+  bool idle() const     { return idle_.load(std::memory_order_relaxed); }
+  bool disabled() const { return disabled_; }
+  int  row_step() const { return step_; }
+
+  uint64_t frames() const  { return frames_.load(std::memory_order_relaxed); }
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+  uint64_t cuts() const    { return cuts_.load(std::memory_order_relaxed); }
+  double cost_us() const   { return cost_us_.load(std::memory_order_relaxed); }   // EWMA
+
+ private:
+  static constexpr int TILES = 8;                 // karo ızgarası TILES x TILES
+  static constexpr int BASE_STEP = 2, MAX_STEP = 16;
+  static constexpr int OVER_BUDGET_FRAMES = 30;   // en seyrek adımda kapanmadan önce
+  static constexpr int64_t CUT_COOLDOWN_US = 1000000;
+
+  void reset_ref(int row_bytes, int height);
+  void adapt(double us);
+
+  const Config cfg_;
+  std::vector<uint8_t> ref_;      // örneklenen satırların önceki karedeki kopyası
+  int ref_bytes_ = 0, ref_height_ = 0;
+  bool have_ref_ = false;
+  int step_ = BASE_STEP;
+  int over_ = 0;
+  bool disabled_ = false;
+
+  double noise_ = -1;             // sakin karelerde karo ortalaması tabanı
+  int64_t still_since_us_ = -1;   // -1: hareket var
+  int64_t last_pass_us_ = 0, last_cut_us_ = -CUT_COOLDOWN_US;
+
+  std::atomic<bool> idle_{false};
+  std::atomic<uint64_t> frames_{0}, dropped_{0}, cuts_{0};
+  std::atomic<double> cost_us_{0};
+};
@@ -1,5 +1,32 @@
 #include "common.hpp"
 #include "gpu_detect.hpp"
+#include "v4l2_probe.hpp"
+#include "camera.hpp"
+#include "cam_cache.hpp"
+#include "cam_modes.hpp"
+#include "rate_control.hpp"
+#include "control_channel.hpp"
+#include "rtp_stats.hpp"
+#include "rtx.hpp"
+#include "udp_batch.hpp"
+#include "udp_rx_ring.hpp"
+#include "playout_delay.hpp"
+#include "latency_probe.hpp"
+#include "pipeline_metrics.hpp"
+#include "codec.hpp"
+#include "encoder_bench.hpp"
+#include "clock_sync.hpp"
+#include "motion_gate.hpp"
+#include "thread_policy.hpp"
+#include "frame_pacing.hpp"
+#include "engine.hpp"
+#include "recording.hpp"
+#include "peer_hub.hpp"
+#include "live_reconfig.hpp"
+#include <gst/rtp/gstrtpbuffer.h>
+#include <gst/video/video.h>
+#include <gst/app/gstappsink.h>
+#include <gst/app/gstappsrc.h>
 #include <csignal>
 #include <atomic>
 #include <iostream>
@@ -8,12 +35,19 @@
 #include <vector>
 #include <cstring>
 #include <optional>
-#include <climits>
-
-// Linux UDP (kontrol kanalı)
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <fstream>
+#include <cmath>
+#include <ctime>
+#include <sstream>
+#include <iomanip>
+#include <sys/resource.h>
 #include <arpa/inet.h>
-#include <netinet/in.h>
-#include <sys/socket.h>
+
 #include <unistd.h>
 
 static std::atomic<bool> g_stop(false);
@@ -24,147 +58,7 @@ static void sig_handler(int){
   if (g_loop) g_main_loop_quit(g_loop);
 }
 
-struct Args {
-  std::string peer_ip;
-  int video_send_port;
-  int video_listen_port;
-  int ctrl_send_port;
-  int ctrl_listen_port;
-
-  bool use_ts = false;
-  int  mtu = 1200;
-  int  bitrate_kbps = 18000;
-  int  keyint = 60;
-  int  latency_ms = 200;
-
-  std::string device = "/dev/video0";
-  int width = 1280, height = 720, fps = 30;
-  int prefer_mjpg = 1;
-};
-
-struct CamProfile {
-  std::string device;
-  int width = 0, height = 0, fps = 0;
-  bool mjpg = false;
-  long long score() const { return 1LL * width * height * fps; }
-};
-
-static constexpr int MAX_W = 7680;
-static constexpr int MAX_H = 4320;
-static constexpr int MAX_FPS = 240;
-
-static const int PREFERRED_MODES[][3] = {
-  {3840,2160,60}, {3840,2160,30},
-  {2560,1440,60}, {2560,1440,30},
-  {1920,1080,60}, {1920,1080,30},
-  {1600, 900,60}, {1600, 900,30},
-  {1280, 720,60}, {1280, 720,30},
-  {960, 540,30},
-  {848, 480,30},
-  {640, 480,30},
-};
-static constexpr int PREFERRED_COUNT = sizeof(PREFERRED_MODES)/sizeof(PREFERRED_MODES[0]);
-
-// ---- helpers to read caps ranges ----
-static bool get_int_min_max(const GValue* v, int& out_min, int& out_max) {
-  if (!v) return false;
-  if (G_VALUE_HOLDS_INT(v)) { out_min = out_max = g_value_get_int(v); return true; }
-  if (GST_VALUE_HOLDS_INT_RANGE(v)) {
-    out_min = gst_value_get_int_range_min(v);
-    out_max = gst_value_get_int_range_max(v);
-    if (out_max > MAX_W * 4) out_max = MAX_W;
-    if (out_min < 1) out_min = 1;
-    return true;
-  }
-  if (GST_VALUE_HOLDS_LIST(v)) {
-    int mn = INT_MAX, mx = 0, ok = 0;
-    for (guint i=0;i<gst_value_list_get_size(v);++i) {
-      const GValue* it = gst_value_list_get_value(v, i);
-      int a=0,b=0;
-      if (get_int_min_max(it, a, b)) { mn = std::min(mn, a); mx = std::max(mx, b); ok++; }
-    }
-    if (ok) { out_min = mn; out_max = mx; return true; }
-  }
-  return false;
-}
-
-static bool get_fps_min_max(const GValue* v, int& out_min, int& out_max) {
-  auto frac_to_int = [](const GValue* fv)->int{
-    int n = gst_value_get_fraction_numerator(fv);
-    int d = gst_value_get_fraction_denominator(fv);
-    if (d<=0) return 0;
-    return n/d;
-  };
-  if (!v) { out_min = 1; out_max = 30; return true; }
-
-  if (GST_VALUE_HOLDS_FRACTION(v)) {
-    int f = frac_to_int(v);
-    if (f<=0) return false;
-    out_min = out_max = std::min(f, MAX_FPS);
-    return true;
-  }
-  if (GST_VALUE_HOLDS_FRACTION_RANGE(v)) {
-    const GValue* minv = gst_value_get_fraction_range_min(v);
-    const GValue* maxv = gst_value_get_fraction_range_max(v);
-    int fmin = frac_to_int(minv);
-    int fmax = frac_to_int(maxv);
-    if (fmax<=0) return false;
-    out_min = std::max(1, fmin);
-    out_max = std::min(MAX_FPS, fmax);
-    return true;
-  }
-  if (GST_VALUE_HOLDS_LIST(v)) {
-    int mn = INT_MAX, mx = 0, ok=0;
-    for (guint i=0;i<gst_value_list_get_size(v);++i) {
-      const GValue* it = gst_value_list_get_value(v, i);
-      int a=0,b=0;
-      if (get_fps_min_max(it, a, b)) { mn = std::min(mn, a); mx = std::max(mx, b); ok++; }
-    }
-    if (ok) { out_min = mn; out_max = mx; return true; }
-  }
-  out_min = 1; out_max = 30;
-  return true;
-}
-
-// --- caps enumeration & validation ---
-struct CapsWindow { int wmin,wmax,hmin,hmax,fmin,fmax; bool mjpg; };
-
-static std::vector<CapsWindow> enumerate_caps(const std::string& devpath) {
-  std::vector<CapsWindow> out;
-  GstElement* src = gst_element_factory_make("v4l2src", NULL);
-  if (!src) return out;
-  g_object_set(G_OBJECT(src), "device", devpath.c_str(), NULL);
-
-  GstPad* pad = gst_element_get_static_pad(src, "src");
-  if (!pad) { gst_object_unref(src); return out; }
-
-  GstCaps* caps = gst_pad_query_caps(pad, NULL);
-  if (!caps) { gst_object_unref(pad); gst_object_unref(src); return out; }
-
-  const guint n = gst_caps_get_size(caps);
-  for (guint i=0; i<n; ++i) {
-    const GstStructure* s = gst_caps_get_structure(caps, i);
-    const char* name = gst_structure_get_name(s);
-    bool is_mjpg = g_str_has_prefix(name, "image/jpeg");
-
-    int wmin=0,wmax=0,hmin=0,hmax=0, fmin=1,fmax=30;
-    if (!get_int_min_max(gst_structure_get_value(s, "width"),  wmin, wmax)) continue;
-    if (!get_int_min_max(gst_structure_get_value(s, "height"), hmin, hmax)) continue;
-    get_fps_min_max(gst_structure_get_value(s, "framerate"), fmin, fmax);
-
-    wmax = std::min(wmax, MAX_W);
-    hmax = std::min(hmax, MAX_H);
-    fmax = std::min(fmax, MAX_FPS);
-
-    out.push_back({wmin,wmax,hmin,hmax,fmin,fmax,is_mjpg});
-  }
-
-  gst_caps_unref(caps);
-  gst_object_unref(pad);
-  gst_object_unref(src);
-  return out;
-}
-
+// --- caps validation (pipeline) ---
 static bool validate_mode(const std::string& devpath, bool mjpg, int W, int H, int F) {
   GstElement* pipe = gst_pipeline_new("probe");
   if (!pipe) return false;
@@ -205,54 +99,148 @@ static bool validate_mode(const std::string& devpath, bool mjpg, int W, int H, i
   return ok;
 }
 
-static std::optional<CamProfile> probe_device_best(const std::string& devpath) {
-  auto windows = enumerate_caps(devpath);
-  if (windows.empty()) return std::nullopt;
-
-  auto try_space = [&](bool mjpg)->std::optional<CamProfile>{
-    for (int k=0; k<PREFERRED_COUNT; ++k) {
-      int W = PREFERRED_MODES[k][0];
-      int H = PREFERRED_MODES[k][1];
-      int F = PREFERRED_MODES[k][2];
-      for (const auto& cw : windows) {
-        if (cw.mjpg != mjpg) continue;
-        if (W>=cw.wmin && W<=cw.wmax && H>=cw.hmin && H<=cw.hmax && F>=cw.fmin && F<=cw.fmax) {
-          if (validate_mode(devpath, mjpg, W,H,F)) {
-            return CamProfile{devpath, W,H,F, mjpg};
-          }
-        }
+static constexpr int BENCH_VIDEO_PORT = 5600;
+static constexpr int BENCH_CTRL_PORT  = 5700;
+static constexpr int MAX_VIDEO_NODES = 10;
+
+struct DeviceProbe {
+  bool present = false;
+  bool from_cache = false;
+  CamCacheEntry entry;
+  std::vector<CamProfile> modes;   // doğrulama sırası (rank_modes)
+};
+
+// /dev/video0..9 paralel taranır; kimliği önbellekteki ile aynı olan düğümler
+// yeniden probe edilmez.
+static std::vector<DeviceProbe> probe_all_devices(const CamCache& cache) {
+  std::vector<DeviceProbe> probes(MAX_VIDEO_NODES);
+  std::atomic<int> next(0);
+
+  auto worker = [&]{
+    for (int n; (n = next++) < MAX_VIDEO_NODES; ) {
+      DeviceProbe& p = probes[n];
+      const std::string dev = "/dev/video" + std::to_string(n);
+      V4l2Identity id;
+      if (!v4l2_query_identity(dev, id) || !id.capture) continue;
+      p.present = true;
+
+      if (const CamCacheEntry* hit = cache.find(id)) {
+        p.entry = *hit;
+        p.from_cache = true;
+      } else {
+        p.entry.id = id;
+        p.entry.windows = enumerate_caps(dev);
       }
+      p.modes = rank_modes(dev, p.entry.windows);
+      if (!p.entry.best && !p.modes.empty()) p.entry.best = p.modes[0];
+      p.entry.device = dev;
+      if (p.entry.best) p.entry.best->device = dev;
     }
-    return std::nullopt;
   };
 
-  if (auto ok = try_space(true))  return ok;   // MJPG
-  if (auto ok = try_space(false)) return ok;   // RAW
+  unsigned hw = std::thread::hardware_concurrency();
+  unsigned nthr = std::min<unsigned>(MAX_VIDEO_NODES, hw ? hw : 2);
+  std::vector<std::thread> pool;
+  for (unsigned i=0; i<nthr; ++i) pool.emplace_back(worker);
+  for (auto& t : pool) t.join();
+  return probes;
+}
 
-  if (validate_mode(devpath, true, 1280,720,30))  return CamProfile{devpath,1280,720,30,true};
-  if (validate_mode(devpath, false,1280,720,30))  return CamProfile{devpath,1280,720,30,false};
-  return std::nullopt;
+// composite: karo ızgarası (sütun = tavan(kök n)) ve çıktı boyu; kaynaklar karoyu karşılayan en küçük
+// modda yakalanır (ölçek küçültme kamerada, USB bant genişliği ve çözme maliyeti düşer). Yeni mod
+// doğrulanamazsa kameranın en iyi modu kalır, compositor küçültür.
+static void composite_layout(Args& a, const std::vector<DeviceProbe*>& chosen) {
+  const int n = (int)chosen.size();
+  const int cols = (int)std::ceil(std::sqrt((double)n)), rows = (n + cols - 1) / cols;
+  const double scale = std::min({1.0, (double)COMPOSITE_MAX_W / a.width, (double)COMPOSITE_MAX_H / a.height});
+  a.width  = (int)(a.width * scale) & ~1;
+  a.height = (int)(a.height * scale) & ~1;
+  a.fps    = std::min(a.fps, COMPOSITE_MAX_FPS);
+  const int tw = a.width / cols & ~1, th = a.height / rows & ~1;
+
+  for (int i = 0; i < n; ++i) {
+    const auto& windows = chosen[i]->entry.windows;
+    std::optional<CamProfile> tile;
+    for (int k = PREFERRED_COUNT - 1; k >= 0 && !tile; --k) {
+      const int W = PREFERRED_MODES[k][0], H = PREFERRED_MODES[k][1];
+      if (W < tw || H < th) continue;
+      for (bool mjpg : {true, false})
+        for (const auto& cw : windows) {
+          const int F = cw.fps_upto(a.fps);
+          if (tile || cw.mjpg != mjpg || !F) continue;
+          if (W >= cw.wmin && W <= cw.wmax && H >= cw.hmin && H <= cw.hmax)
+            tile = CamProfile{a.cams[i].device, W, H, F, mjpg};
+        }
+    }
+    if (!tile || tile->score() >= a.cams[i].score()) continue;
+    if (validate_mode(tile->device, tile->mjpg, tile->width, tile->height, tile->fps)) a.cams[i] = *tile;
+  }
+  std::cout << "[multicam] composite " << cols << "x" << rows << " karo " << tw << "x" << th
+            << " -> " << a.width << "x" << a.height << "@" << a.fps << "\n";
 }
 
 static bool auto_select_best_camera(Args& a) {
-  CamProfile best;
-  bool found = false;
-  for (int n=0; n<=9; ++n) {
-    std::string dev = "/dev/video" + std::to_string(n);
-    auto prof = probe_device_best(dev);
-    if (!prof.has_value()) continue;
-    if (!found || prof->score() > best.score() || (prof->score()==best.score() && prof->mjpg && !best.mjpg)) {
-      best = *prof; found = true;
+  const std::string cache_path = CamCache::default_path();
+  const char* reprobe = std::getenv("NOVA_REPROBE");
+  CamCache cache;
+  if (!cache_path.empty() && !(reprobe && *reprobe=='1')) cache.load(cache_path);
+
+  auto probes = probe_all_devices(cache);
+
+  std::vector<DeviceProbe*> cands;
+  for (auto& p : probes) {
+    if (!p.present) continue;
+    if (p.from_cache) std::cout << "[auto] " << p.entry.device << " (" << p.entry.id.card << ") from cache\n";
+    if (p.entry.best) cands.push_back(&p);
+  }
+  std::stable_sort(cands.begin(), cands.end(), [](const DeviceProbe* px, const DeviceProbe* py){
+    const CamProfile& x = *px->entry.best;
+    const CamProfile& y = *py->entry.best;
+    return x.score() > y.score() || (x.score()==y.score() && x.mjpg && !y.mjpg);
+  });
+
+  // full pipeline only for the winner (multicam: every camera used), and only if the cache has not seen it pass
+  const size_t want = a.multicam == "off" ? 1 : (size_t)a.multicam_max;
+  std::vector<DeviceProbe*> chosen;
+  for (auto* p : cands) {
+    if (chosen.size() >= want) break;
+    if (p->from_cache && p->entry.validated) { chosen.push_back(p); continue; }
+    // doğrulanamayan mod cihazı elemez: sıradaki mod denenir
+    for (const CamProfile& c : p->modes) {
+      if ((p->entry.validated = validate_mode(c.device, c.mjpg, c.width, c.height, c.fps))) {
+        p->entry.best = c;
+        break;
+      }
+      std::cerr << "[auto] " << c.device << " " << c.width << "x" << c.height << "@" << c.fps
+                << " failed validation\n";
     }
+    if (p->entry.validated) chosen.push_back(p);
+  }
+
+  if (!cache_path.empty()) {
+    for (const auto& p : probes) if (p.present) cache.put(p.entry);
+    if (!cache.save(cache_path)) std::cerr << "[auto] cache write failed: " << cache_path << "\n";
   }
-  if (!found) return false;
+  if (chosen.empty()) return false;
 
+  const CamProfile best = *chosen[0]->entry.best;
   a.device      = best.device;
   a.width       = best.width;
   a.height      = best.height;
   a.fps         = best.fps;
   a.prefer_mjpg = best.mjpg ? 1 : 0;
 
+  a.cams.clear();
+  if (chosen.size() > 1) {
+    for (auto* p : chosen) a.cams.push_back(*p->entry.best);
+    if (a.multicam == "composite") composite_layout(a, chosen);   // a.width/height/fps = birleşik kare
+    for (const auto& c : a.cams)
+      std::cout << "[multicam] " << c.device << " " << (c.mjpg ? "MJPG" : "RAW") << " "
+                << c.width << "x" << c.height << "@" << c.fps << "\n";
+  } else if (a.multicam != "off") {
+    std::cout << "[multicam] tek kullanılabilir kamera, tek kaynak\n";
+  }
+
   std::cout << "[auto] device=" << a.device
             << " mode=" << (a.prefer_mjpg ? "MJPG" : "RAW")
             << " " << a.width << "x" << a.height
@@ -260,76 +248,54 @@ static bool auto_select_best_camera(Args& a) {
   return true;
 }
 
-// ---- kontrol kanalı (PING/PONG) ----
-class ControlChannel {
- public:
-  ControlChannel(const std::string& peer_ip, int send_port, int listen_port)
-  : peer_ip_(peer_ip), send_port_(send_port), listen_port_(listen_port) {}
-
-  bool start() {
-    tx_fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
-    if (tx_fd_ < 0) { perror("socket tx"); return false; }
-    rx_fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
-    if (rx_fd_ < 0) { perror("socket rx"); return false; }
-
-    sockaddr_in addr{}; addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(listen_port_);
-    if (bind(rx_fd_, (sockaddr*)&addr, sizeof(addr)) < 0) { perror("bind rx"); return false; }
-
-    memset(&peer_addr_, 0, sizeof(peer_addr_));
-    peer_addr_.sin_family = AF_INET;
-    peer_addr_.sin_port = htons(send_port_);
-    inet_pton(AF_INET, peer_ip_.c_str(), &peer_addr_.sin_addr);
-
-    recv_thr_ = std::thread([this]{ this->recv_loop(); });
-    send_thr_ = std::thread([this]{ this->send_loop(); });
-    return true;
-  }
-  void stop() {
-    g_stop = true;
-    if (send_thr_.joinable()) send_thr_.join();
-    if (recv_thr_.joinable()) recv_thr_.join();
-    if (tx_fd_>=0) close(tx_fd_);
-    if (rx_fd_>=0) close(rx_fd_);
-  }
-
- private:
-  void send_loop() {
-    using namespace std::chrono;
-    while (!g_stop) {
-      auto now = duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
-      char buf[64];
-      int n = snprintf(buf, sizeof(buf), "PING %lld", (long long)now);
-      sendto(tx_fd_, buf, n, 0, (sockaddr*)&peer_addr_, sizeof(peer_addr_));
-      std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    }
-  }
-  void recv_loop() {
-    char buf[256];
-    while (!g_stop) {
-      sockaddr_in src{}; socklen_t sl = sizeof(src);
-      int n = recvfrom(rx_fd_, buf, sizeof(buf)-1, 0, (sockaddr*)&src, &sl);
-      if (n <= 0) continue;
-      buf[n] = 0;
-      if (!strncmp(buf, "PING ", 5)) {
-        buf[1] = 'O'; buf[2] = 'N'; buf[3] = 'G';
-        sendto(tx_fd_, buf, n, 0, (sockaddr*)&src, sizeof(src));
-      } else if (!strncmp(buf, "PONG ", 5)) {
-        long long t0 = atoll(buf+5);
-        auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
-                     std::chrono::steady_clock::now().time_since_epoch()).count();
-        std::cout << "[ctrl] RTT ~ " << (now - t0) << " ms\n";
-      }
-    }
+// ---- streaming thread'leri: ad, sınıf kuralı, CPU muhasebesi ----
+// stream-status ENTER/LEAVE görevin kendi thread'inde gelir (bus sync handler'ı orada çalışır).
+// Sınıf sahibi elemandan: gönderici kaynak görevi yakalama (+ jpegdec/dönüşüm/tee), q1* kodlama
+// (+ paketleme; udpsink yolunda gönderim de), qtx* toplu gönderim pacer'ı; alıcıda udpsrc alım,
+// jbuf / rxsrc (ring) çözme ve gösterim.
+static ThreadClass stream_thread_class(GstElement* owner, bool sender, const std::string& n) {
+  if (n == "rec_q") return ThreadClass::Io;
+  if (sender) {
+    if (n.rfind("q1", 0) == 0 || n.rfind("cq", 0) == 0) return ThreadClass::Encode;   // cq<k>: ek kamera
+    if (n == "mix") return ThreadClass::Capture;   // composite: karo birleştirme
+    if (n.rfind("qtx", 0) == 0) return ThreadClass::Send;
+    if (owner->numsinkpads == 0) return ThreadClass::Capture;
+    return ThreadClass::Other;   // qprev
   }
+  if (n == "udpsrc") return ThreadClass::Recv;
+  if (n == "jbuf" || n == "rxsrc") return ThreadClass::Decode;
+  return ThreadClass::Other;
+}
 
-  std::string peer_ip_;
-  int send_port_, listen_port_;
-  int tx_fd_ = -1, rx_fd_ = -1;
-  sockaddr_in peer_addr_{};
-  std::thread send_thr_, recv_thr_;
-};
+static GstBusSyncReply thread_sync_cb(GstBus*, GstMessage* msg, gpointer user_data) {
+  if (GST_MESSAGE_TYPE(msg) != GST_MESSAGE_STREAM_STATUS) return GST_BUS_PASS;
+  static const char* const PREFIX[THREAD_CLASS_COUNT] = {"cap", "enc", "send", "recv", "dec", "ctrl", "io", "misc"};
+  GstStreamStatusType type;
+  GstElement* owner = nullptr;
+  gst_message_parse_stream_status(msg, &type, &owner);
+  if (type == GST_STREAM_STATUS_TYPE_LEAVE) {
+    ThreadPolicy::get().leave();
+  } else if (type == GST_STREAM_STATUS_TYPE_ENTER && owner) {
+    const std::string n = GST_OBJECT_NAME(owner);
+    const ThreadClass c = stream_thread_class(owner, strcmp(static_cast<const char*>(user_data), "sender") == 0, n);
+    ThreadPolicy::get().enter(c, std::string(PREFIX[(int)c]) + "-" + n);
+  }
+  return GST_BUS_PASS;
+}
+
+// ana thread: kayıtlı thread'lerin CPU'su gönderici bus'ına uygulama mesajı olarak (bus_cb yazar)
+static gboolean thread_stats_cb(gpointer user_data) {
+  auto* pipe = static_cast<GstElement*>(user_data);
+  double rest = 0;
+  GstStructure* st = gst_structure_new_empty("nova-threads");
+  for (const auto& u : ThreadPolicy::get().sample(rest)) {
+    const std::string key = u.name + "." + std::to_string(u.tid);
+    gst_structure_set(st, key.c_str(), G_TYPE_DOUBLE, u.cpu_percent, (key + ":cpu").c_str(), G_TYPE_INT, u.last_cpu, NULL);
+  }
+  gst_structure_set(st, "rest", G_TYPE_DOUBLE, rest, NULL);
+  gst_element_post_message(pipe, gst_message_new_application(GST_OBJECT(pipe), st));
+  return G_SOURCE_CONTINUE;
+}
 
 // ---- GStreamer Bus watcher (ERROR/EOS -> quit) ----
 static gboolean bus_cb(GstBus* /*bus*/, GstMessage* msg, gpointer user_data) {
@@ -340,6 +306,7 @@ static gboolean bus_cb(GstBus* /*bus*/, GstMessage* msg, gpointer user_data) {
       gst_message_parse_error(msg, &err, &dbg);
       std::cerr << "[" << tag << "] ERROR: " << (err?err->message:"") << (dbg?std::string(" | ")+dbg:"") << std::endl;
       if (err) g_error_free(err); if (dbg) g_free(dbg);
+      if (strcmp(tag, "peer") == 0) break;   // eş alıcısının hatası oturumu bitirmez
       g_stop = true; if (g_loop) g_main_loop_quit(g_loop);
       break;
     }
@@ -347,269 +314,2198 @@ static gboolean bus_cb(GstBus* /*bus*/, GstMessage* msg, gpointer user_data) {
       std::cerr << "[" << tag << "] EOS\n";
       g_stop = true; if (g_loop) g_main_loop_quit(g_loop);
       break;
+    case GST_MESSAGE_LATENCY: {
+      // canlı latency değişimi (uyarlamalı jitterbuffer): sink'lerin gecikmesini yeniden dağıt
+      GstObject* top = GST_OBJECT(gst_object_ref(GST_MESSAGE_SRC(msg)));
+      while (GstObject* parent = gst_object_get_parent(top)) { gst_object_unref(top); top = parent; }
+      if (GST_IS_BIN(top)) gst_bin_recalculate_latency(GST_BIN(top));
+      gst_object_unref(top);
+      break;
+    }
+    case GST_MESSAGE_APPLICATION: {
+      // thread başına CPU (thread_stats_cb): "ad.tid" -> %, "ad.tid:cpu" -> son çekirdek
+      const GstStructure* st = gst_message_get_structure(msg);
+      if (!st || !gst_structure_has_name(st, "nova-threads")) break;
+      std::ostringstream line;
+      for (int i = 0; i < gst_structure_n_fields(st); ++i) {
+        const char* f = gst_structure_nth_field_name(st, i);
+        double pct;
+        int cpu;
+        if (gst_structure_get_double(st, f, &pct)) line << (i ? " | " : "") << f << " " << std::fixed << std::setprecision(1) << pct << "%";
+        else if (gst_structure_get_int(st, f, &cpu)) line << " @" << cpu;
+      }
+      std::cout << "[threads] " << line.str() << "\n";
+      break;
+    }
     default: break;
   }
   return TRUE;
 }
 
-// ---- STDIN watcher (ESC/q -> quit) ----
-static gboolean stdin_cb(GIOChannel* ch, GIOCondition cond, gpointer) {
+// ---- STDIN watcher (ESC/q -> quit; satır komutları -> canlı yeniden yapılandırma) ----
+static gboolean stdin_cb(GIOChannel* ch, GIOCondition cond, gpointer user_data) {
   if (cond & (G_IO_HUP|G_IO_ERR|G_IO_NVAL)) { return TRUE; }
-  gchar buf[16]; gsize n=0; GError* err=nullptr;
+  static std::string line;   // terminal satır modunda: komut Enter ile gelir
+  gchar buf[64]; gsize n=0; GError* err=nullptr;
   GIOStatus s = g_io_channel_read_chars(ch, buf, sizeof(buf), &n, &err);
   if (s == G_IO_STATUS_NORMAL && n>0) {
     for (gsize i=0;i<n;i++) {
       unsigned char c = (unsigned char)buf[i];
-      if (c==27 || c=='q' || c=='Q') {
+      const bool quit = c==27 || (c=='\n' && (line=="q" || line=="Q" || line=="quit"));
+      if (quit) {
         std::cout << "[key] quit\n";
         g_stop = true; if (g_loop) g_main_loop_quit(g_loop);
+        line.clear();
         break;
       }
+      if (c=='\n') { if (!line.empty()) live_command(static_cast<LiveCtx*>(user_data), line); line.clear(); }
+      else if (c!='\r' && line.size() < 256) line += (char)c;
     }
   }
   if (err) g_error_free(err);
   return TRUE; // watch devam
 }
 
+// ---- benchmark: yakalama damgası -> gösterim ----
+static LatencyRecorder g_latency;
+
+template <typename Fn>
+static bool with_luma(GstPad* pad, GstBuffer* buf, GstMapFlags flags, Fn fn) {
+  GstCaps* caps = gst_pad_get_current_caps(pad);
+  GstVideoInfo vi;
+  const bool ok = caps && gst_video_info_from_caps(&vi, caps);
+  if (caps) gst_caps_unref(caps);
+  GstVideoFrame f;
+  if (!ok || !gst_video_frame_map(&f, &vi, buf, flags)) return false;
+  fn(static_cast<uint8_t*>(GST_VIDEO_FRAME_COMP_DATA(&f, 0)), GST_VIDEO_FRAME_COMP_STRIDE(&f, 0),
+     GST_VIDEO_FRAME_WIDTH(&f), GST_VIDEO_FRAME_HEIGHT(&f));
+  gst_video_frame_unmap(&f);
+  return true;
+}
+
+// gönderici: kaynak çıkışındaki her kareye sayaç damgası (yakalama anı kaydedilir)
+static GstPadProbeReturn stamp_probe(GstPad* pad, GstPadProbeInfo* info, gpointer) {
+  GstBuffer* buf = gst_buffer_make_writable(GST_PAD_PROBE_INFO_BUFFER(info));
+  GST_PAD_PROBE_INFO_DATA(info) = buf;
+  with_luma(pad, buf, GST_MAP_WRITE, [](uint8_t* y, int stride, int w, int h) {
+    stamp_write(y, stride, w, h, g_latency.on_capture(ctrl_now_us() * 1000));
+  });
+  return GST_PAD_PROBE_OK;
+}
+
+// alıcı: fakesink handoff'u senkron beklemeden sonra, yani "gösterim" anında
+static void bench_handoff(GstElement*, GstBuffer* buf, GstPad* pad, gpointer) {
+  const uint64_t now_ns = ctrl_now_us() * 1000;
+  with_luma(pad, buf, GST_MAP_READ, [now_ns](uint8_t* y, int stride, int w, int h) {
+    uint32_t id = 0;
+    if (stamp_read(y, stride, w, h, id)) g_latency.on_display(id, now_ns);
+    else g_latency.on_bad_stamp();
+  });
+}
+
+std::vector<std::string> split_list(const std::string& s) {
+  std::vector<std::string> out;
+  std::stringstream ss(s);
+  for (std::string item; std::getline(ss, item, ',');) if (!item.empty()) out.push_back(item);
+  return out;
+}
+
+static bool bench_is_mjpg(const Args& a) { return a.bench_format == "MJPG"; }
+
+// videotestsrc ya da dosya (gerçek zamanlı hızda) -> I420 WxH@fps; damga kuyruk elemanının çıkışında
+// formats: kaynağın sunabildikleri; birden çoksa anlaşmada ilki seçilir (v4l2src gibi)
+static GstElement* add_bench_source(GstElement* pipe, const Args& a, const std::string& formats) {
+  GstElement* bcaps = gst_element_factory_make("capsfilter", "bench_caps");
+  CHECK_ELEM(bcaps, "capsfilter");
+  const std::string fmt = bench_is_mjpg(a) ? "I420" : formats;
+  GstCaps* caps = gst_caps_from_string(("video/x-raw,format=(string){" + fmt + "},width=" + std::to_string(a.width) +
+                                        ",height=" + std::to_string(a.height) +
+                                        ",framerate=" + std::to_string(a.fps) + "/1").c_str());
+  if (!caps) { std::cerr << "Geçersiz bench formatı: " << fmt << "\n"; return nullptr; }
+  g_object_set(G_OBJECT(bcaps), "caps", caps, NULL);
+  gst_caps_unref(caps);
+
+  GstElement* tail = bcaps;
+  if (a.bench_src.empty()) {
+    GstElement* src = gst_element_factory_make("videotestsrc", "src"); CHECK_ELEM(src, "videotestsrc");
+    set_bool(src, "is-live", TRUE);
+    set_arg(src, "pattern", "smpte");
+    set_int(src, "horizontal-speed", 4);   // hareket: kodlayıcı boş kare üretmesin
+    if (!add_chain(pipe, {src, bcaps})) return nullptr;
+  } else {
+    GstElement* src   = gst_element_factory_make("filesrc", "src");        CHECK_ELEM(src, "filesrc");
+    GstElement* dbin  = gst_element_factory_make("decodebin", "bench_dec"); CHECK_ELEM(dbin, "decodebin");
+    GstElement* fconv = gst_element_factory_make("videoconvert", "bench_conv"); CHECK_ELEM(fconv, "videoconvert");
+    GstElement* scale = gst_element_factory_make("videoscale", "bench_scale"); CHECK_ELEM(scale, "videoscale");
+    GstElement* rate  = gst_element_factory_make("videorate", "bench_rate"); CHECK_ELEM(rate, "videorate");
+    GstElement* pace  = gst_element_factory_make("identity", "bench_pace"); CHECK_ELEM(pace, "identity");
+    set_str(src, "location", a.bench_src);
+    set_bool(pace, "sync", TRUE);   // dosyayı kamera hızında akıt
+    if (!add_chain(pipe, {src, dbin})) return nullptr;
+    if (!add_chain(pipe, {fconv, scale, rate, bcaps, pace})) return nullptr;
+    g_signal_connect(dbin, "pad-added",
+      G_CALLBACK(+[] (GstElement*, GstPad* newpad, gpointer user_data){
+        GstCaps* c = gst_pad_get_current_caps(newpad);
+        const bool video = c && g_str_has_prefix(gst_structure_get_name(gst_caps_get_structure(c, 0)), "video/");
+        if (c) gst_caps_unref(c);
+        if (!video) return;
+        GstPad* sinkpad = gst_element_get_static_pad(static_cast<GstElement*>(user_data), "sink");
+        if (!gst_pad_is_linked(sinkpad)) gst_pad_link(newpad, sinkpad);
+        gst_object_unref(sinkpad);
+      }), fconv);
+    tail = pace;
+  }
+
+  GstPad* tpad = gst_element_get_static_pad(tail, "src");
+  gst_pad_add_probe(tpad, GST_PAD_PROBE_TYPE_BUFFER, stamp_probe, nullptr, nullptr);
+  gst_object_unref(tpad);
+
+  // MJPG kamera benzetimi: damga ham karede, sonra sıkıştırma
+  if (bench_is_mjpg(a)) {
+    GstElement* jenc = gst_element_factory_make("jpegenc", "bench_jpegenc"); CHECK_ELEM(jenc, "jpegenc");
+    set_int(jenc, "quality", 85);
+    if (!add_chain(pipe, {tail, jenc})) return nullptr;
+    tail = jenc;
+  }
+  return tail;
+}
+
+// ---- yakalama yolu: kamera formatı -> kodlayıcı ----
+// Kameranın bu boyut/fps'te sunduğu ham formatlar (V4L2 ioctl)
+static std::vector<std::string> camera_raw_formats(const Args& a) {
+  std::vector<std::string> out;
+  for (const auto& m : v4l2_enumerate_modes(a.device, {{a.width, a.height}})) {
+    if (m.mjpg || m.width != a.width || m.height != a.height || !m.has_fps(a.fps)) continue;
+    if (const char* f = v4l2_fourcc_to_gst(m.fourcc))
+      if (std::find(out.begin(), out.end(), f) == out.end()) out.push_back(f);
+  }
+  return out;
+}
+
+// Kodlayıcı tercih sırasıyla kameranın da sunduğu ilk format; yoksa "" (dönüşüm gerekir)
+static std::string pick_native_format(const std::vector<std::string>& enc_fmts, const std::vector<std::string>& cam_fmts) {
+  for (const auto& f : enc_fmts)
+    if (std::find(cam_fmts.begin(), cam_fmts.end(), f) != cam_fmts.end()) return f;
+  return "";
+}
+
 // ---- sender ----
+std::string layer_name(const char* base, int layer) {
+  return layer ? base + std::to_string(layer) : std::string(base);
+}
+
+std::vector<int> layer_kbps(const Args& a) {
+  std::vector<int> out;
+  const auto list = split_list(a.simulcast_kbps);
+  for (int i = 0; i < std::max(1, a.simulcast); ++i) {
+    static const int DIV[MAX_LAYERS] = {1, 3, 9};
+    int k = i < (int)list.size() ? std::atoi(list[i].c_str()) : a.bitrate_kbps / DIV[i];
+    out.push_back(std::max(100, k));
+  }
+  return out;
+}
+
+// x264: çekirdekler katmanların piksel alanıyla orantılı bölünür (tam katman ~%76, 3 katmanda)
+static int x264_layer_threads(int layer, int nlayers) {
+  double sum = 0;
+  for (int i = 0; i < nlayers; ++i) sum += 1.0 / (1 << 2*i);
+  const int cores = (int)std::max(1u, std::thread::hardware_concurrency());
+  return std::max(1, (int)(cores * (1.0 / (1 << 2*layer)) / sum + 0.5));
+}
+
+// ---- çoklu kamera ----
+// Bir kameranın yakalama zinciri (v4l2src -> caps -> [MJPG çözücü]); son eleman döner.
+// Adlar kamera sırasıyla: cam_src<k>, cam_caps<k> (kare zamanlaması burada ölçülür), cam_dec<k>.
+static GstElement* add_camera_source(GstElement* pipe, const CamProfile& c, int k, const std::string& jpeg_dec) {
+  const std::string sfx = std::to_string(k);
+  GstElement* src = gst_element_factory_make("v4l2src", ("cam_src" + sfx).c_str()); CHECK_ELEM(src, "v4l2src");
+  set_str(src, "device", c.device);
+  GstElement* capsf = gst_element_factory_make("capsfilter", ("cam_caps" + sfx).c_str()); CHECK_ELEM(capsf, "capsfilter");
+  GstCaps* caps = gst_caps_new_simple(c.mjpg ? "image/jpeg" : "video/x-raw",
+    "width",  G_TYPE_INT, c.width,
+    "height", G_TYPE_INT, c.height,
+    "framerate", GST_TYPE_FRACTION, c.fps, 1, NULL);
+  g_object_set(G_OBJECT(capsf), "caps", caps, NULL);
+  gst_caps_unref(caps);
+  GstElement* dec = nullptr;
+  if (c.mjpg) { dec = gst_element_factory_make(jpeg_dec.c_str(), ("cam_dec" + sfx).c_str()); CHECK_ELEM(dec, jpeg_dec.c_str()); }
+  if (!add_chain(pipe, {src, capsf, dec})) return nullptr;
+  return dec ? dec : capsf;
+}
+
+// composite: kameralar kuyruk -> compositor karosu, çıktı caps_src (width x height@fps) -> tek kodlama.
+// Kuyruklar tek karelik ve sızdıran: yavaş kamera diğerlerini bekletmez, compositor onun son
+// karesini tekrarlar. Karo içinde en-boy oranı korunur (eklenti destekliyorsa).
+static GstElement* add_composite_source(GstElement* pipe, const Args& a, const std::string& jpeg_dec) {
+  const int n = (int)a.cams.size();
+  const int cols = (int)std::ceil(std::sqrt((double)n)), rows = (n + cols - 1) / cols;
+  const int tw = a.width / cols & ~1, th = a.height / rows & ~1;
+
+  GstElement* mix = gst_element_factory_make("compositor", "mix"); CHECK_ELEM(mix, "compositor");
+  if (has_prop(mix, "start-time-selection")) set_arg(mix, "start-time-selection", "first");
+  if (has_prop(mix, "ignore-inactive-pads")) set_bool(mix, "ignore-inactive-pads", TRUE);   // kopan kamera
+  GstElement* capsf = gst_element_factory_make("capsfilter", "caps_src"); CHECK_ELEM(capsf, "capsfilter");
+  GstCaps* caps = gst_caps_new_simple("video/x-raw",
+    "width",  G_TYPE_INT, a.width,
+    "height", G_TYPE_INT, a.height,
+    "framerate", GST_TYPE_FRACTION, a.fps, 1,
+    "pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1, NULL);
+  g_object_set(G_OBJECT(capsf), "caps", caps, NULL);
+  gst_caps_unref(caps);
+  if (!add_chain(pipe, {mix, capsf})) return nullptr;
+
+  for (int k = 0; k < n; ++k) {
+    GstElement* tail = add_camera_source(pipe, a.cams[k], k, jpeg_dec);
+    if (!tail) return nullptr;
+    GstElement* q = gst_element_factory_make("queue", ("cam_q" + std::to_string(k)).c_str()); CHECK_ELEM(q, "queue");
+    set_int(q, "max-size-buffers", 1); set_int(q, "max-size-bytes", 0); set_int(q, "max-size-time", 0);
+    set_int(q, "leaky", 2);
+    if (!add_chain(pipe, {tail, q, mix})) return nullptr;
+    GstPad* qsrc = gst_element_get_static_pad(q, "src");
+    if (GstPad* mpad = gst_pad_get_peer(qsrc)) {
+      g_object_set(G_OBJECT(mpad), "xpos", k % cols * tw, "ypos", k / cols * th, "width", tw, "height", th, NULL);
+      if (g_object_class_find_property(G_OBJECT_GET_CLASS(mpad), "sizing-policy"))
+        gst_util_set_object_arg(G_OBJECT(mpad), "sizing-policy", "keep-aspect-ratio");
+      gst_object_unref(mpad);
+    }
+    gst_object_unref(qsrc);
+  }
+  return capsf;
+}
+
+// streams: k. kamera (k >= 1) kendi kodlayıcısıyla video_send_port + k'ye. Ek akışlar sade: sabit
+// bitrate, FEC/NACK/ABR yok; SSRC ayrı. Kodlayıcı thread'leri çekirdek bütçesinden paylaştırılır.
+static bool add_camera_stream(GstElement* pipe, const Args& a, int k, const std::string& enc_name,
+                              const std::string& jpeg_dec, int kbps, int threads) {
+  const CodecInfo& ci = codec_info(codec_of_encoder(enc_name));
+  const std::string sfx = std::to_string(k);
+  GstElement* tail = add_camera_source(pipe, a.cams[k], k, jpeg_dec);
+  if (!tail) return false;
+  GstElement* conv = gst_element_factory_make("videoconvert", ("cconv" + sfx).c_str());   // format uyuyorsa geçiş
+  GstElement* q    = gst_element_factory_make("queue", ("cq" + sfx).c_str());
+  GstElement* enc  = gst_element_factory_make(enc_name.c_str(), ("cenc" + sfx).c_str());
+  GstElement* parse = ci.parse ? gst_element_factory_make(ci.parse, ("cparse" + sfx).c_str()) : nullptr;
+  GstElement* pay  = gst_element_factory_make(ci.pay, ("cpay" + sfx).c_str());
+  GstElement* sink = gst_element_factory_make("udpsink", ("cudpsink" + sfx).c_str());
+  if (!conv || !q || !enc || (ci.parse && !parse) || !pay || !sink) {
+    std::cerr << "[multicam] " << a.cams[k].device << ": akış elemanları oluşturulamadı\n";
+    return false;
+  }
+  set_int(q, "max-size-time", 0); set_int(q, "max-size-bytes", 0); set_int(q, "max-size-buffers", 3); set_int(q, "leaky", 2);
+  configure_encoder(enc, enc_name, kbps, a.keyint, threads);
+  if (parse) {
+    set_int(parse, "config-interval", 1);
+    set_arg(parse, "stream-format", "byte-stream");
+    set_arg(parse, "alignment", "au");
+  }
+  set_int(pay, "pt", 96); set_int(pay, "mtu", a.mtu);
+  if (has_prop(pay, "config-interval")) set_int(pay, "config-interval", 1);
+  g_object_set(G_OBJECT(pay), "ssrc", g_random_int(), NULL);
+  set_str(sink, "host", a.peer_ip); set_int(sink, "port", a.video_send_port + k);
+  set_bool(sink, "sync", FALSE); set_bool(sink, "async", FALSE);
+  return add_chain(pipe, {tail, conv, q, enc, parse, pay, sink});
+}
+
 static GstElement* build_sender(const Args& a) {
-  std::string enc_name = choose_h264_encoder();
-  std::cerr << "[nova] encoder: " << enc_name << std::endl;
+  std::string enc_name = a.encoder.empty() ? choose_h264_encoder() : a.encoder;
+  const CodecInfo& ci = codec_info(codec_of_encoder(enc_name));
+  std::cerr << "[nova] encoder: " << enc_name << " (" << ci.name << ")" << std::endl;
 
   GstElement* pipe = gst_pipeline_new("sender");
 
-  GstElement* src = gst_element_factory_make("v4l2src", "src");
-  CHECK_ELEM(src, "v4l2src");
-  set_str(src, "device", a.device);
+  // kodlayıcı önce: sink caps'i kamera formatı seçimine girer
+  GstElement *enc = gst_element_factory_make(enc_name.c_str(), "enc"); CHECK_ELEM(enc, enc_name.c_str());
 
-  GstElement* capsf = gst_element_factory_make("capsfilter", "caps_src");
-  CHECK_ELEM(capsf, "capsfilter");
+  const bool multicam = !a.bench && a.cams.size() > 1;
+  const bool composite = multicam && a.multicam == "composite";
+  const bool mjpg = a.bench ? bench_is_mjpg(a) : !composite && a.prefer_mjpg != 0;
+  const std::string jpeg_dec = !a.native_capture ? "jpegdec"
+                             : !a.mjpg_decoder.empty() ? a.mjpg_decoder : choose_jpeg_decoder(enc_name);
+  std::string native;   // kodlayıcının doğrudan aldığı kamera formatı; boşsa videoconvert
+  if (a.native_capture && !mjpg && !composite) {
+    const auto cam_fmts = a.bench ? split_list(a.bench_format) : camera_raw_formats(a);
+    native = pick_native_format(encoder_raw_formats(enc), cam_fmts);
+    if (native.empty() && !cam_fmts.empty())
+      std::cerr << "[capture] " << enc_name << " kamera formatlarını almıyor (" << cam_fmts[0] << "), videoconvert\n";
+    else if (!native.empty())
+      std::cerr << "[capture] " << native << " -> " << enc_name << " (dönüşüm yok)\n";
+  }
 
   GstCaps* caps = nullptr;
   GstElement* jpegdec = nullptr;
-  GstElement* conv = gst_element_factory_make("videoconvert", "conv");
-  CHECK_ELEM(conv, "videoconvert");
+  GstElement* conv = nullptr;   // native formatta yok
+  if (native.empty()) {
+    conv = gst_element_factory_make("videoconvert", "conv");
+    CHECK_ELEM(conv, "videoconvert");
+  }
+  GstElement *tee = gst_element_factory_make("tee", "tee");
+  CHECK_ELEM(tee, "tee");
 
-  if (a.prefer_mjpg) {
-    caps = gst_caps_new_simple("image/jpeg",
-      "width",  G_TYPE_INT, a.width,
-      "height", G_TYPE_INT, a.height,
-      "framerate", GST_TYPE_FRACTION, a.fps, 1, NULL);
-    g_object_set(G_OBJECT(capsf), "caps", caps, NULL);
-    gst_caps_unref(caps);
+  if (mjpg) {
+    std::cerr << "[capture] MJPG decoder: " << jpeg_dec << std::endl;
+    jpegdec = gst_element_factory_make(jpeg_dec.c_str(), "jpegdec");
+    CHECK_ELEM(jpegdec, jpeg_dec.c_str());
+  }
 
-    jpegdec = gst_element_factory_make("jpegdec", "jpegdec");
-    CHECK_ELEM(jpegdec, "jpegdec");
+  if (composite) {
+    GstElement* tail = add_composite_source(pipe, a, jpeg_dec);
+    if (!tail || !add_chain(pipe, {tail, conv, tee})) { std::cerr << "Link failed (composite)\n"; return nullptr; }
+  } else if (a.bench) {
+    GstElement* tail = add_bench_source(pipe, a, native.empty() ? a.bench_format : native);
+    if (!tail || !add_chain(pipe, {tail, jpegdec, conv, tee})) { std::cerr << "Link failed (bench source)\n"; return nullptr; }
+  } else {
+    GstElement* src = gst_element_factory_make("v4l2src", "src");
+    CHECK_ELEM(src, "v4l2src");
+    set_str(src, "device", a.device);
+
+    // dmabuf: kare kamera tamponunda kalır, VA/QSV kodlayıcı doğrudan içe alır
+    std::string io_mode = a.io_mode;
+    if (io_mode == "auto")
+      io_mode = a.native_capture && !mjpg && !native.empty() &&
+                (encoder_family(enc_name) == "va" || encoder_family(enc_name) == "vaapi" ||
+                 encoder_family(enc_name) == "qsv") ? "dmabuf" : "";
+    if (!io_mode.empty() && has_prop(src, "io-mode")) {
+      set_arg(src, "io-mode", io_mode.c_str());
+      std::cerr << "[capture] io-mode=" << io_mode << std::endl;
+    }
 
-    gst_bin_add_many(GST_BIN(pipe), src, capsf, jpegdec, conv, NULL);
-    if (!gst_element_link_many(src, capsf, jpegdec, conv, NULL)) {
-      std::cerr << "Link failed (src->jpegdec->conv)\n"; return nullptr;
+    GstElement* capsf = gst_element_factory_make("capsfilter", "caps_src");
+    CHECK_ELEM(capsf, "capsfilter");
+
+    if (mjpg) {
+      caps = gst_caps_new_simple("image/jpeg",
+        "width",  G_TYPE_INT, a.width,
+        "height", G_TYPE_INT, a.height,
+        "framerate", GST_TYPE_FRACTION, a.fps, 1, NULL);
+      g_object_set(G_OBJECT(capsf), "caps", caps, NULL);
+      gst_caps_unref(caps);
+    } else {
+      caps = gst_caps_new_simple("video/x-raw",
+        "width",  G_TYPE_INT, a.width,
+        "height", G_TYPE_INT, a.height,
+        "framerate", GST_TYPE_FRACTION, a.fps, 1, NULL);
+      if (!native.empty()) gst_caps_set_simple(caps, "format", G_TYPE_STRING, native.c_str(), NULL);
+      g_object_set(G_OBJECT(capsf), "caps", caps, NULL);
+      gst_caps_unref(caps);
     }
-  } else {
-    caps = gst_caps_new_simple("video/x-raw",
-      "width",  G_TYPE_INT, a.width,
-      "height", G_TYPE_INT, a.height,
-      "framerate", GST_TYPE_FRACTION, a.fps, 1, NULL);
-    g_object_set(G_OBJECT(capsf), "caps", caps, NULL);
-    gst_caps_unref(caps);
+    if (!add_chain(pipe, {src, capsf, jpegdec, conv, tee})) return nullptr;
+  }
 
-    gst_bin_add_many(GST_BIN(pipe), src, capsf, conv, NULL);
-    if (!gst_element_link_many(src, capsf, conv, NULL)) {
-      std::cerr << "Link failed (src->conv)\n"; return nullptr;
+  // preview branch: ayna kaynağın formatında, sink'in istediği formata yalnızca gerekirse dönüşüm.
+  // Kuyruk tek karelik ve sızdıran: yavaş ekran tee'yi (dolayısıyla kodlayıcıyı) bekletmez.
+  if (a.preview != Preview::Off) {
+    GstElement *qprev  = gst_element_factory_make("queue", "qprev");  CHECK_ELEM(qprev, "queue");
+    set_int(qprev, "max-size-buffers", 1); set_int(qprev, "max-size-bytes", 0); set_int(qprev, "max-size-time", 0);
+    set_int(qprev, "leaky", 2);
+    GstElement *conv2  = gst_element_factory_make("videoconvert", "conv2"); CHECK_ELEM(conv2, "videoconvert");
+    GstElement *flip2  = gst_element_factory_make("videoflip", "flip2"); CHECK_ELEM(flip2, "videoflip");
+    set_arg(flip2, "method", "horizontal-flip");
+    GstElement *sink2  = gst_element_factory_make(a.bench ? "fakesink" : "autovideosink", "local_preview");
+    CHECK_ELEM(sink2, "preview sink");
+    set_bool(sink2, "sync", a.bench ? FALSE : TRUE);
+
+    // lite: önce kare seyreltme, sonra küçültme; dönüşüm/ayna küçük karede
+    GstElement *prate = nullptr, *pscale = nullptr, *pcaps = nullptr;
+    if (a.preview == Preview::Lite) {
+      prate = gst_element_factory_make("videorate", "prev_rate"); CHECK_ELEM(prate, "videorate");
+      set_bool(prate, "drop-only", TRUE);
+      set_int(prate, "max-rate", std::max(1, a.preview_fps));
+      pscale = gst_element_factory_make("videoscale", "prev_scale"); CHECK_ELEM(pscale, "videoscale");
+      pcaps = gst_element_factory_make("capsfilter", "prev_caps"); CHECK_ELEM(pcaps, "capsfilter");
+      const int pw = a.preview_width  > 0 ? a.preview_width  : std::max(2, a.width / 2  & ~1);
+      const int ph = a.preview_height > 0 ? a.preview_height : std::max(2, a.height / 2 & ~1);
+      GstCaps* pc = gst_caps_new_simple("video/x-raw", "width", G_TYPE_INT, pw, "height", G_TYPE_INT, ph,
+                                        "pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1, NULL);
+      g_object_set(G_OBJECT(pcaps), "caps", pc, NULL);
+      gst_caps_unref(pc);
     }
+
+    if (!a.native_capture) { if (!add_chain(pipe, {tee, qprev, prate, pscale, pcaps, conv2, flip2, sink2})) return nullptr; }
+    else if (!add_chain(pipe, {tee, qprev, prate, pscale, pcaps, flip2, conv2, sink2})) return nullptr;
   }
 
-  GstElement *tee = gst_element_factory_make("tee", "tee");
-  CHECK_ELEM(tee, "tee");
-  gst_bin_add(GST_BIN(pipe), tee);
-  if (!gst_element_link(conv, tee)) { std::cerr << "link fail conv->tee\n"; return nullptr; }
+  // network branch: katman başına valve -> kuyruk -> [ölçek] -> kodlayıcı -> RTP -> sink.
+  // Katman 0 eski adları korur (q1, enc, pay, udpsink/txsink); diğerleri sonek alır (enc1, pay1...).
+  const std::vector<int> kbps = layer_kbps(a);
+  const int nlayers = (int)kbps.size();
+  // streams: kodlayıcılar tek çekirdek bütçesini paylaşır (kamera başına eşit pay)
+  const bool cam_streams = multicam && a.multicam == "streams";
+  const int cam_threads = cam_streams
+    ? std::max(1, (int)std::max(1u, std::thread::hardware_concurrency()) / (int)a.cams.size()) : 0;
+  // aynı RTP zaman tabanı: katman geçişinde alıcının zamanlaması kopmaz; SSRC'ler ayrı
+  const guint ts_base = g_random_int(), ssrc_base = g_random_int() & ~3u;
+  for (int i = 0; i < nlayers; ++i) {
+    GstElement *q1 = gst_element_factory_make("queue", layer_name("q1", i).c_str()); CHECK_ELEM(q1, "queue");
+    set_int(q1, "max-size-time", 0); set_int(q1, "max-size-buffers", 0); set_int(q1, "max-size-bytes", 0); set_int(q1, "leaky", 2);
+    // kamera tamponlarını kuyrukta biriktirme: v4l2src havuzu tükenince kareleri kopyalar
+    if (a.native_capture && !a.bench) set_int(q1, "max-size-buffers", 3);
+
+    // izleyicisi olmayan katman kodlanmaz; PeerHub açar
+    GstElement *valve = nullptr, *scale = nullptr, *scaps = nullptr;
+    if (nlayers > 1) {
+      valve = gst_element_factory_make("valve", layer_name("valve", i).c_str()); CHECK_ELEM(valve, "valve");
+      set_bool(valve, "drop", i == 0 && a.record_tx ? FALSE : TRUE);   // kayıt tam katmanı izler
+    }
+    if (i > 0) {
+      scale = gst_element_factory_make("videoscale", layer_name("scale", i).c_str()); CHECK_ELEM(scale, "videoscale");
+      scaps = gst_element_factory_make("capsfilter", layer_name("scaps", i).c_str()); CHECK_ELEM(scaps, "capsfilter");
+      GstCaps* lc = gst_caps_new_simple("video/x-raw",
+        "width",  G_TYPE_INT, std::max(16, (a.width  >> i) & ~1),
+        "height", G_TYPE_INT, std::max(16, (a.height >> i) & ~1),
+        "pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1, NULL);
+      g_object_set(G_OBJECT(scaps), "caps", lc, NULL);
+      gst_caps_unref(lc);
+    }
 
-  // preview branch
-  GstElement *qprev  = gst_element_factory_make("queue", "qprev");  CHECK_ELEM(qprev, "queue");
-  GstElement *conv2  = gst_element_factory_make("videoconvert", "conv2"); CHECK_ELEM(conv2, "videoconvert");
-  GstElement *flip2  = gst_element_factory_make("videoflip", "flip2"); CHECK_ELEM(flip2, "videoflip");
-  set_arg(flip2, "method", "horizontal-flip");
-  GstElement *sink2  = gst_element_factory_make("autovideosink", "local_preview"); CHECK_ELEM(sink2, "autovideosink");
-  set_bool(sink2, "sync", TRUE);
+    GstElement* lenc = enc;
+    if (i > 0) { lenc = gst_element_factory_make(enc_name.c_str(), layer_name("enc", i).c_str()); CHECK_ELEM(lenc, enc_name.c_str()); }
+    configure_encoder(lenc, enc_name, kbps[i], a.keyint, nlayers > 1 ? x264_layer_threads(i, nlayers) : cam_threads);
+
+    // VP9/AV1: ayrıştırıcı yok, payloader kodlayıcı çıktısını doğrudan alır
+    GstElement *parse = nullptr;
+    if (ci.parse) {
+      parse = gst_element_factory_make(ci.parse, layer_name("parse", i).c_str()); CHECK_ELEM(parse, ci.parse);
+      set_int(parse, "config-interval", 1);
+      set_arg(parse, "stream-format", "byte-stream");
+      set_arg(parse, "alignment", "au");
+    }
 
-  gst_bin_add_many(GST_BIN(pipe), qprev, conv2, flip2, sink2, NULL);
-  if (!gst_element_link_many(tee, qprev, conv2, flip2, sink2, NULL)) {
-    std::cerr << "preview link fail\n"; return nullptr;
-  }
+    GstElement *pay = gst_element_factory_make(ci.pay, layer_name("pay", i).c_str()); CHECK_ELEM(pay, ci.pay);
+    set_int(pay, "pt", 96); set_int(pay, "mtu", a.mtu);
+    if (has_prop(pay, "config-interval")) set_int(pay, "config-interval", 1);
+    if (nlayers > 1) g_object_set(G_OBJECT(pay), "ssrc", ssrc_base | (guint)i, "timestamp-offset", ts_base, NULL);
+
+    // ULPFEC (RFC 5109): keyframe paketleri iki kat korunur
+    GstElement *fec = nullptr;
+    if (a.fec_percent > 0) {
+      fec = gst_element_factory_make("rtpulpfecenc", layer_name("fec", i).c_str()); CHECK_ELEM(fec, "rtpulpfecenc");
+      set_int(fec, "pt", FEC_PT); set_int(fec, "percentage", a.fec_percent);
+      set_int(fec, "percentage-important", std::min(100, a.fec_percent*2));
+    }
 
-  // network branch
-  GstElement *q1 = gst_element_factory_make("queue", "q1"); CHECK_ELEM(q1, "queue");
-  set_int(q1, "max-size-time", 0); set_int(q1, "max-size-buffers", 0); set_int(q1, "max-size-bytes", 0); set_int(q1, "leaky", 2);
+    GstElement *qtx = nullptr, *sink = nullptr;
+    if (a.batch_tx) {
+      // pacer kendi thread'inde uyusun; kodlayıcı thread'i beklemesin
+      qtx = gst_element_factory_make("queue", layer_name("qtx", i).c_str()); CHECK_ELEM(qtx, "queue");
+      set_int(qtx, "max-size-buffers", 0); set_int(qtx, "max-size-bytes", 0);
+      g_object_set(G_OBJECT(qtx), "max-size-time", (guint64)(500 * GST_MSECOND), NULL);
+      sink = gst_element_factory_make("appsink", layer_name("txsink", i).c_str()); CHECK_ELEM(sink, "appsink");
+      set_bool(sink, "sync", FALSE); set_bool(sink, "async", FALSE);
+      set_int(sink, "max-buffers", 0); set_bool(sink, "drop", FALSE);
+      if (has_prop(sink, "buffer-list")) set_bool(sink, "buffer-list", TRUE);
+    } else {
+      if (a.multi) {
+        // eşler çalışırken PeerHub tarafından eklenir ("add"/"remove" sinyalleri)
+        sink = gst_element_factory_make("multiudpsink", layer_name("udpsink", i).c_str()); CHECK_ELEM(sink, "multiudpsink");
+      } else {
+        sink = gst_element_factory_make("udpsink", "udpsink"); CHECK_ELEM(sink, "udpsink");
+        set_str(sink, "host", a.peer_ip); set_int(sink, "port", a.video_send_port);
+      }
+      set_bool(sink, "sync", FALSE); set_bool(sink, "async", FALSE);
+    }
 
-  GstElement *enc = gst_element_factory_make(enc_name.c_str(), "enc"); CHECK_ELEM(enc, enc_name.c_str());
-  if (enc_name == "nvh264enc") {
-    set_str(enc, "preset", "low-latency-hq"); set_str(enc, "rc", "cbr");
-    set_int(enc, "bitrate", a.bitrate_kbps); set_int(enc, "key-int-max", a.keyint); set_bool(enc, "zerolatency", TRUE);
-  } else if (enc_name == "vaapih264enc") {
-    set_arg(enc, "rate-control", "cbr");
-    set_int(enc, "bitrate", a.bitrate_kbps);
-    set_int(enc, "keyframe-period", a.keyint);
-  } else if (enc_name == "qsvh264enc") {
-    set_str(enc, "rate-control", "cbr"); set_int(enc, "bitrate", a.bitrate_kbps*1000); set_int(enc, "gop-size", a.keyint);
-  } else if (enc_name == "vah264enc") {
-    set_int(enc, "bitrate", a.bitrate_kbps*1000);
-  } else { // x264enc
-    set_arg(enc, "tune", "zerolatency"); set_arg(enc, "speed-preset", "ultrafast");
-    set_int(enc, "bitrate", a.bitrate_kbps); set_int(enc, "key-int-max", a.keyint); set_bool(enc, "byte-stream", TRUE);
-  }
-
-  GstElement *parse = gst_element_factory_make("h264parse", "parse"); CHECK_ELEM(parse, "h264parse");
-  set_int(parse, "config-interval", 1);
-  set_arg(parse, "stream-format", "byte-stream");
-  set_arg(parse, "alignment", "au");
-
-  GstElement *pay = gst_element_factory_make("rtph264pay", "pay"); CHECK_ELEM(pay, "rtph264pay");
-  set_int(pay, "pt", 96); set_int(pay, "mtu", a.mtu); set_int(pay, "config-interval", 1);
-
-  GstElement *sink = gst_element_factory_make("udpsink", "udpsink"); CHECK_ELEM(sink, "udpsink");
-  set_str(sink, "host", a.peer_ip); set_int(sink, "port", a.video_send_port);
-  set_bool(sink, "sync", FALSE); set_bool(sink, "async", FALSE);
+    // kayıt: tam katmanın kodlanmış akışı, paketleyiciden önce
+    GstElement* rtee = nullptr;
+    if (i == 0 && a.record_tx) { rtee = gst_element_factory_make("tee", "rec_tee"); CHECK_ELEM(rtee, "tee"); }
+
+    if (!add_chain(pipe, {tee, valve, q1, scale, scaps, lenc, parse, rtee, pay, fec, qtx, sink})) return nullptr;
+    if (rtee && !add_record_branch(pipe, rtee, a, ci.codec)) return nullptr;
+  }
 
-  gst_bin_add_many(GST_BIN(pipe), q1, enc, parse, pay, sink, NULL);
-  if (!gst_element_link_many(tee, q1, enc, parse, pay, sink, NULL)) return nullptr;
+  if (cam_streams) {
+    const int ckbps = a.multicam_kbps > 0 ? a.multicam_kbps : std::max(100, a.bitrate_kbps / (int)a.cams.size());
+    for (int k = 1; k < (int)a.cams.size(); ++k) {
+      if (!add_camera_stream(pipe, a, k, enc_name, jpeg_dec, ckbps, cam_threads)) return nullptr;
+      std::cerr << "[multicam] " << a.cams[k].device << " -> " << a.peer_ip << ":" << a.video_send_port + k
+                << " (" << ckbps << " kbps)\n";
+    }
+  }
 
   // bus watch
   GstBus* bus = gst_element_get_bus(pipe);
   gst_bus_add_watch(bus, bus_cb, (gpointer)"sender");
+  if (a.threads) gst_bus_set_sync_handler(bus, thread_sync_cb, (gpointer)"sender", nullptr);
   gst_object_unref(bus);
 
   return pipe;
 }
 
-// ---- receiver ----
-static GstElement* build_receiver(const Args& a) {
-  GstElement* pipe = gst_pipeline_new("receiver");
+// ---- alıcı geri bildirimi (RR) ----
+static RxLink g_rx;   // ana alıcı
+
+static GstPadProbeReturn rx_stats_probe(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+  auto* link = static_cast<RxLink*>(user_data);
+  GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  if (gst_rtp_buffer_map(buf, GST_MAP_READ, &rtp)) {
+    const uint64_t now_ns = ctrl_now_us() * 1000;
+    link->stats.on_packet(gst_rtp_buffer_get_seq(&rtp), gst_rtp_buffer_get_timestamp(&rtp),
+                          now_ns, gst_buffer_get_size(buf));
+    link->delay.on_packet(gst_rtp_buffer_get_timestamp(&rtp), now_ns);
+    if (gst_rtp_buffer_get_marker(&rtp) && gst_rtp_buffer_get_payload_type(&rtp) == 96)
+      link->owd.on_frame(gst_rtp_buffer_get_timestamp(&rtp), now_ns / 1000);
+    gst_rtp_buffer_unmap(&rtp);
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+gboolean report_cb(gpointer user_data) {
+  auto* ctx = static_cast<ReportCtx*>(user_data);
+  guint64 pushed=0, lost=0;
+  if (ctx->ring) {
+    pushed = ctx->ring->delivered();
+    lost   = ctx->ring->lost();
+  } else {
+    GstStructure* st = nullptr;
+    g_object_get(G_OBJECT(ctx->jbuf), "stats", &st, NULL);
+    if (!st) return G_SOURCE_CONTINUE;
+    gst_structure_get_uint64(st, "num-pushed", &pushed);
+    gst_structure_get_uint64(st, "num-lost", &lost);
+    gst_structure_free(st);
+  }
+
+  ctrl::ReceiverReport r;
+  r.t_report_us     = ctrl_now_us();
+  r.ext_highest_seq = ctx->link->stats.ext_highest_seq();
+  r.cumulative_lost = static_cast<uint32_t>(lost);
+  r.jitter          = ctx->link->stats.jitter();
+  r.packets         = pushed;
+  r.bytes           = ctx->link->stats.bytes();
+  if (ctx->fecdec) {
+    guint rec=0, unrec=0;
+    g_object_get(G_OBJECT(ctx->fecdec), "recovered", &rec, "unrecovered", &unrec, NULL);
+    r.fec_recovered = rec; r.fec_unrecovered = unrec;
+  }
+  ctx->link->ctrl->send_report(r, ctx->link->dest());
+  return G_SOURCE_CONTINUE;
+}
+
+// ---- uyarlamalı alıcı tamponu ----
+// Göreli gecikme yüzdeliği (RxLink::delay) + geç paket oranı -> jitterbuffer latency / ring bekleme süresi.
+// Sabit modda yalnızca derinlik ve geç/kayıp sayaçları raporlanır.
+gboolean jb_cb(gpointer user_data) {
+  auto* ctx = static_cast<JbCtx*>(user_data);
+  guint64 late=0, delivered=0, lost=0;
+  if (ctx->ring) {
+    late = ctx->ring->late(); delivered = ctx->ring->delivered(); lost = ctx->ring->lost();
+  } else {
+    GstStructure* st = nullptr;
+    g_object_get(G_OBJECT(ctx->jbuf), "stats", &st, NULL);
+    if (!st) return G_SOURCE_CONTINUE;
+    gst_structure_get_uint64(st, "num-late", &late);
+    gst_structure_get_uint64(st, "num-pushed", &delivered);
+    gst_structure_get_uint64(st, "num-lost", &lost);
+    gst_structure_free(st);
+  }
+
+  const int64_t now = (int64_t)(ctrl_now_us() / 1000);
+  const double pct_ms = ctx->link->delay.percentile_ms();
+  if (ctx->adaptive) {
+    if (int ms = ctx->pd->update(pct_ms, late, delivered, now)) {
+      if (ctx->jbuf) set_int(ctx->jbuf, "latency", ms);   // LATENCY mesajı -> bus_cb yeniden hesaplar
+      if (ctx->ring) ctx->ring->set_latency_ms(ms);
+    }
+  }
+  if (now - ctx->last_log_ms >= 5000) {
+    std::cout << "[jb] depth=" << ctx->pd->current_ms() << " ms p" << ctx->pct * 100 << "=" << pct_ms
+              << " ms jitter=" << ctx->link->stats.jitter_ms() << " ms late=" << late << " lost=" << lost << "\n";
+    // yakalama (gönderen) -> son paketin alımı, son 10 sn
+    const ClockSync& clk = ctx->link->owd.clock();
+    const auto h = ctx->link->owd.histogram().snapshot(ctrl_now_us() * 1000);
+    if (h.count)
+      std::cout << "[owd] p50=" << h.percentile_us(0.50) / 1000 << " ms p95=" << h.percentile_us(0.95) / 1000
+                << " ms p99=" << h.percentile_us(0.99) / 1000 << " ms max=" << h.max_us / 1000.0
+                << " ms offset=" << clk.offset_us() / 1000 << " ms drift=" << clk.drift_ppm()
+                << " ppm rtt=" << clk.delay_us() / 1000 << " ms\n";
+    ctx->last_log_ms = now;
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+// ---- simulcast katman isteği (alıcı) ----
+// boru hattındaki video sink'lerinin (autovideosink içindekiler dahil) gösterilen/düşen kareleri
+static void sink_frame_counts(GstElement* pipe, guint64& rendered, guint64& dropped) {
+  rendered = dropped = 0;
+  GstIterator* it = gst_bin_iterate_recurse(GST_BIN(pipe));
+  GValue item = G_VALUE_INIT;
+  while (gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+    GstElement* e = GST_ELEMENT(g_value_get_object(&item));
+    if (!GST_IS_BIN(e) && GST_OBJECT_FLAG_IS_SET(e, GST_ELEMENT_FLAG_SINK) && has_prop(e, "stats")) {
+      GstStructure* st = nullptr;
+      g_object_get(G_OBJECT(e), "stats", &st, NULL);
+      if (st) {
+        guint64 r = 0, d = 0;
+        gst_structure_get_uint64(st, "rendered", &r);
+        gst_structure_get_uint64(st, "dropped", &d);
+        rendered += r; dropped += d;
+        gst_structure_free(st);
+      }
+    }
+    g_value_reset(&item);
+  }
+  g_value_unset(&item);
+  gst_iterator_free(it);
+}
+
+// Çözücü/CPU yetişemeyince sink kareleri geç kalıp düşürür (QoS): iki ardışık pencerede %5'ten
+// fazla düşme bir kaba katman ister, 30 sn temiz gösterimden sonra bir ince katman denenir.
+// İstek UDP ile gider; kaybolabileceği için varsayılan dışındaki her durum periyodik tekrarlanır.
+gboolean layer_cb(gpointer user_data) {
+  auto* ctx = static_cast<LayerCtx*>(user_data);
+  const int64_t now = (int64_t)(ctrl_now_us() / 1000);
+  ctrl::LayerSelect ls;
+  if (ctx->pref >= 0) {
+    ls.layer = (uint8_t)ctx->pref;
+  } else {
+    guint64 r = 0, d = 0;
+    sink_frame_counts(ctx->pipe, r, d);
+    const guint64 dr = r - std::min(r, ctx->rendered), dd = d - std::min(d, ctx->dropped);
+    ctx->rendered = r; ctx->dropped = d;
+    if (dr + dd < 10) return G_SOURCE_CONTINUE;   // akış yok / çok az kare
+
+    const int prev = ctx->cap;
+    const double ratio = (double)dd / (double)(dr + dd);
+    if (ratio > 0.05) {
+      if (++ctx->bad >= 2 && ctx->cap < MAX_LAYERS - 1) { ++ctx->cap; ctx->bad = 0; }
+      ctx->good_since_ms = now;
+    } else {
+      ctx->bad = 0;
+      if (ratio > 0.005) ctx->good_since_ms = now;
+      else if (ctx->cap > 0 && now - ctx->good_since_ms >= 30000) { --ctx->cap; ctx->good_since_ms = now; }
+    }
+    if (ctx->cap != prev)
+      std::cout << "[layer] gösterim düşmesi %" << ratio * 100.0 << " -> katman " << ctx->cap << " istendi\n";
+    else if (ctx->cap == 0 && prev == 0) return G_SOURCE_CONTINUE;   // varsayılan: söylenecek bir şey yok
+    else if (now - ctx->sent_ms < 5000) return G_SOURCE_CONTINUE;
+    ls.layer = (uint8_t)ctx->cap;
+    ls.reason = ctrl::LAYER_DECODE_LOAD;
+  }
+  if (ctx->pref >= 0 && now - ctx->sent_ms < 5000) return G_SOURCE_CONTINUE;
+  ctx->sent_ms = now;
+  ctx->link->ctrl->send_layer_select(ls, ctx->link->dest());
+  return G_SOURCE_CONTINUE;
+}
+
+// ---- çözücü: kare başına çözme süresi, gecikme farkındalıklı atlama ----
+// Sink'in QoS olayları (diff > 0: kare geç) çözücünün src pad'inde yakalanır; 500 ms'lik pencerede
+// en büyük gecikmeye göre seviye (yalnızca --dec-mode=lowlat):
+//   1: referans olmayan erişim birimleri çözücüye girmeden atılır (sonraki kareler bozulmaz),
+//   2: iki pencere boyunca çok gerideyse IDR'ye kadar tüm delta kareler atılır ve IDR istenir.
+// Dört sakin pencereden sonra normale dönülür. Süreler kapalı modda da ölçülür ve günlüğe yazılır.
+static constexpr int64_t DEC_LATE_MS    = 20;    // basesink max-lateness varsayılanı
+static constexpr int64_t DEC_CATCHUP_MS = 200;
+
+static GstPadProbeReturn dec_in_probe(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+  auto* ctx = static_cast<DecodeCtx*>(user_data);
+  if (info->type & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+    GstEvent* ev = GST_PAD_PROBE_INFO_EVENT(info);
+    if (GST_EVENT_TYPE(ev) == GST_EVENT_CAPS) {
+      GstCaps* caps = nullptr;
+      gst_event_parse_caps(ev, &caps);
+      const gchar* fmt = caps ? gst_structure_get_string(gst_caps_get_structure(caps, 0), "stream-format") : nullptr;
+      ctx->length_prefixed = fmt && (g_str_equal(fmt, "avc") || g_str_equal(fmt, "avc3") ||
+                                     g_str_equal(fmt, "hvc1") || g_str_equal(fmt, "hev1"));
+    }
+    return GST_PAD_PROBE_OK;
+  }
+  GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+  const int level = ctx->level.load(std::memory_order_relaxed);
+  if (level > 0) {
+    const bool delta = GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT);
+    if (level == 2) {
+      if (delta) { ctx->skipped_delta.fetch_add(1, std::memory_order_relaxed); return GST_PAD_PROBE_DROP; }
+      ctx->level = 1;   // IDR geldi: referans zinciri yeniden başlıyor
+    } else if (delta) {
+      bool nonref = GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DROPPABLE);
+      GstMapInfo m;
+      if (!nonref && gst_buffer_map(buf, &m, GST_MAP_READ)) {
+        nonref = au_is_nonref(ctx->codec, m.data, m.size, ctx->length_prefixed.load(std::memory_order_relaxed));
+        gst_buffer_unmap(buf, &m);
+      }
+      if (nonref) { ctx->skipped_nonref.fetch_add(1, std::memory_order_relaxed); return GST_PAD_PROBE_DROP; }
+    }
+  }
+  if (GST_BUFFER_PTS_IS_VALID(buf))
+    ctx->timing.on_in(GST_BUFFER_PTS(buf), (uint64_t)g_get_monotonic_time() * 1000, gst_buffer_get_size(buf), 1);
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn dec_out_probe(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+  auto* ctx = static_cast<DecodeCtx*>(user_data);
+  if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+    GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (GST_BUFFER_PTS_IS_VALID(buf))
+      ctx->timing.on_out(GST_BUFFER_PTS(buf), (uint64_t)g_get_monotonic_time() * 1000, gst_buffer_get_size(buf), 1);
+    return GST_PAD_PROBE_OK;
+  }
+  GstEvent* ev = GST_PAD_PROBE_INFO_EVENT(info);
+  if (GST_EVENT_TYPE(ev) == GST_EVENT_QOS) {
+    GstQOSType type; gdouble proportion; GstClockTimeDiff diff; GstClockTime ts;
+    gst_event_parse_qos(ev, &type, &proportion, &diff, &ts);
+    int64_t cur = ctx->max_late_ns.load(std::memory_order_relaxed);
+    while (diff > cur && !ctx->max_late_ns.compare_exchange_weak(cur, diff, std::memory_order_relaxed)) {}
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+void attach_decode_ctx(GstElement* receiver, DecodeCtx* ctx, const Args& a) {
+  ctx->dec = gst_bin_get_by_name(GST_BIN(receiver), "dec");
+  gst_object_unref(ctx->dec);   // bin sahibi
+  ctx->codec = a.use_ts ? Codec::H264 : a.rx_codec;
+  ctx->lowlat = a.dec_lowlat;
+  GstElementFactory* f = gst_element_get_factory(ctx->dec);
+  ctx->label = f ? GST_OBJECT_NAME(f) : "dec";
+  GstPad* in  = gst_element_get_static_pad(ctx->dec, "sink");
+  GstPad* out = gst_element_get_static_pad(ctx->dec, "src");
+  gst_pad_add_probe(in, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM),
+                    dec_in_probe, ctx, nullptr);
+  gst_pad_add_probe(out, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_UPSTREAM),
+                    dec_out_probe, ctx, nullptr);
+  gst_object_unref(in);
+  gst_object_unref(out);
+}
+
+gboolean dec_cb(gpointer user_data) {
+  auto* ctx = static_cast<DecodeCtx*>(user_data);
+  const int64_t late_ms = ctx->max_late_ns.exchange(0) / 1000000;
+  if (ctx->lowlat) {
+    const int prev = ctx->level;
+    if (late_ms > DEC_CATCHUP_MS) {
+      ctx->calm_windows = 0;
+      if (++ctx->late_windows >= 2 && prev < 2) {
+        ctx->level = 2;
+        ctx->late_windows = 0;
+        // kaynağa kadar gider: keyframe_req_probe KEYFRAME_REQ'e çevirir (PLI açıksa)
+        GstPad* in = gst_element_get_static_pad(ctx->dec, "sink");
+        gst_pad_push_event(in, gst_video_event_new_upstream_force_key_unit(GST_CLOCK_TIME_NONE, TRUE, 0));
+        gst_object_unref(in);
+      } else if (prev == 0) ctx->level = 1;
+    } else if (late_ms > DEC_LATE_MS) {
+      ctx->calm_windows = 0; ctx->late_windows = 0;
+      if (prev == 0) ctx->level = 1;
+    } else {
+      ctx->late_windows = 0;
+      if (++ctx->calm_windows >= 4 && prev == 1) ctx->level = 0;
+    }
+    if (ctx->level != prev)
+      std::cout << "[dec] geç " << late_ms << " ms -> "
+                << (ctx->level == 2 ? "IDR'ye kadar atlama" : ctx->level == 1 ? "referans olmayanları atlama" : "normal") << "\n";
+  }
+
+  const int64_t now = (int64_t)(ctrl_now_us() / 1000);
+  if (now - ctx->last_log_ms >= 5000) {
+    const StageStats::Snapshot sn = ctx->timing.snapshot();
+    const uint64_t n = sn.lat_count - ctx->last_count, sum = sn.lat_sum_ns - ctx->last_sum_ns;
+    std::cout << "[dec] " << ctx->label << " " << (n ? sum / 1e6 / n : 0.0) << " ms/kare p95="
+              << sn.percentile_us(0.95) / 1000.0 << " ms atlanan=" << ctx->skipped_nonref.load()
+              << "+" << ctx->skipped_delta.load() << " geç=" << late_ms << " ms\n";
+    ctx->last_count = sn.lat_count; ctx->last_sum_ns = sn.lat_sum_ns;
+    ctx->last_log_ms = now;
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+// ---- NACK / seçici tekrar gönderim ----
+// Alıcı: rtpjitterbuffer'ın upstream GstRTPRetransmissionRequest olayları
+// kontrol kanalına NACK olarak gider; RTT kalan süreyi aşıyorsa istenmez.
+static GstPadProbeReturn nack_probe(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+  GstEvent* ev = GST_PAD_PROBE_INFO_EVENT(info);
+  if (GST_EVENT_TYPE(ev) != GST_EVENT_CUSTOM_UPSTREAM ||
+      !gst_event_has_name(ev, "GstRTPRetransmissionRequest")) return GST_PAD_PROBE_OK;
+
+  const GstStructure* st = gst_event_get_structure(ev);
+  guint seq=0, deadline=0, delay=0, retry=0, freq=0;
+  gst_structure_get_uint(st, "seqnum", &seq);
+  gst_structure_get_uint(st, "deadline", &deadline);
+  gst_structure_get_uint(st, "delay", &delay);
+  gst_structure_get_uint(st, "retry", &retry);
+  gst_structure_get_uint(st, "frequency", &freq);
+
+  auto* link = static_cast<RxLink*>(user_data);
+  const int budget = (int)deadline - (int)delay - (int)(retry * freq);
+  if (budget > link->ctrl->rtt_ms()) {
+    ctrl::Nack nk;
+    nk.budget_ms = (uint16_t)budget; nk.count = 1; nk.seqs[0] = (uint16_t)seq;
+    link->ctrl->send_nack(nk, link->dest());
+  }
+  return GST_PAD_PROBE_DROP;   // udpsrc'nin işi yok
+}
+
+// Gönderici: udpsink'e giren her paket (FEC dahil) geçmiş ringine yazılır.
+static inline void rtx_store(RtxHistory* hist, const guint8* data, gsize size) {
+  if (size >= 12) hist->store((uint16_t)(data[2] << 8 | data[3]), data, size);
+}
+
+static GstPadProbeReturn rtx_store_probe(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+  auto* hist = static_cast<RtxHistory*>(user_data);
+  auto store_buf = [hist](GstBuffer* buf) {
+    GstMapInfo map;
+    if (!gst_buffer_map(buf, &map, GST_MAP_READ)) return;
+    rtx_store(hist, map.data, map.size);
+    gst_buffer_unmap(buf, &map);
+  };
+  if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+    GstBufferList* list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);   // rtph264pay FU-A'ları liste olarak iter
+    for (guint i=0; i<gst_buffer_list_length(list); ++i) store_buf(gst_buffer_list_get(list, i));
+  } else {
+    store_buf(GST_PAD_PROBE_INFO_BUFFER(info));
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+// ---- toplu UDP gönderimi (appsink -> sendmmsg + pacer) ----
+// Paketler eşlenmiş (map) GstBuffer belleğinden kopyalanmadan gönderilir;
+// AU'nun son paketi (RTP marker) gelince tek flush. Marker'dan sonra aynı
+// zaman damgasıyla gelen FEC paketleri beklemeden hemen gönderilir.
+struct TxStage {
+  UdpBatchSender* tx = nullptr;
+  RtxHistory* hist = nullptr;                       // NACK kapalıysa nullptr
+  std::vector<GstSample*> samples;                  // flush'a kadar tutulan örnekler
+  std::vector<std::pair<GstBuffer*, GstMapInfo>> maps;
+  bool have_flushed_ts = false;
+  uint32_t flushed_ts = 0;
+
+  TxStage() = default;
+  TxStage(const TxStage&) = delete;
+  TxStage& operator=(const TxStage&) = delete;
+  // boru hattı durduktan sonra (appsink artık çağırmaz): yarım kalan AU'nun örnekleri bırakılır
+  ~TxStage() {
+    if (tx) tx->discard();
+    for (auto& m : maps) gst_buffer_unmap(m.first, &m.second);
+    for (auto* s : samples) gst_sample_unref(s);
+  }
+};
+
+static void tx_flush(TxStage* st) {
+  st->tx->flush();
+  for (auto& m : st->maps) gst_buffer_unmap(m.first, &m.second);
+  st->maps.clear();
+  for (auto* s : st->samples) gst_sample_unref(s);
+  st->samples.clear();
+}
+
+// RTP marker biti ve zaman damgası döner
+static bool tx_add_buffer(TxStage* st, GstBuffer* b, uint32_t& ts) {
+  GstMapInfo map;
+  if (!gst_buffer_map(b, &map, GST_MAP_READ)) return false;
+  if (map.size < 12) { gst_buffer_unmap(b, &map); return false; }
+  if (st->tx->pending() >= UdpBatchSender::MAX_BATCH) tx_flush(st);   // dev AU: erken gönder
+  st->tx->push(map.data, map.size);
+  if (st->hist) rtx_store(st->hist, map.data, map.size);
+  ts = (uint32_t)map.data[4] << 24 | (uint32_t)map.data[5] << 16 | (uint32_t)map.data[6] << 8 | map.data[7];
+  const bool marker = map.data[1] & 0x80;
+  st->maps.emplace_back(b, map);
+  return marker;
+}
+
+static GstFlowReturn tx_new_sample(GstAppSink* sink, gpointer user_data) {
+  auto* st = static_cast<TxStage*>(user_data);
+  GstSample* sample = gst_app_sink_pull_sample(sink);
+  if (!sample) return GST_FLOW_EOS;
+
+  bool marker = false;
+  uint32_t ts = 0;
+  if (GstBufferList* list = gst_sample_get_buffer_list(sample)) {
+    for (guint i=0; i<gst_buffer_list_length(list); ++i) marker = tx_add_buffer(st, gst_buffer_list_get(list, i), ts);
+  } else if (GstBuffer* b = gst_sample_get_buffer(sample)) {
+    marker = tx_add_buffer(st, b, ts);
+  }
+  st->samples.push_back(sample);   // erken flush bu örneği bırakmasın diye sonra eklenir
 
-  auto src = gst_element_factory_make("udpsrc", "udpsrc");
-  CHECK_ELEM(src, "udpsrc");
-  set_int(src, "port", a.video_listen_port);
-  set_int(src, "buffer-size", 8*1024*1024);
+  const bool trailing_fec = st->have_flushed_ts && ts == st->flushed_ts;
+  if (marker || trailing_fec) {
+    tx_flush(st);
+    st->have_flushed_ts = true;
+    st->flushed_ts = ts;
+  }
+  return GST_FLOW_OK;
+}
+
+static void attach_batch_tx(GstElement* sender, TxStage* st, const std::string& sink_name = "txsink") {
+  st->samples.reserve(UdpBatchSender::MAX_BATCH);
+  st->maps.reserve(UdpBatchSender::MAX_BATCH);
+  GstElement* txsink = gst_bin_get_by_name(GST_BIN(sender), sink_name.c_str());
+  GstAppSinkCallbacks cbs{};
+  cbs.new_sample = tx_new_sample;
+  gst_app_sink_set_callbacks(GST_APP_SINK(txsink), &cbs, st, nullptr);
+  gst_object_unref(txsink);
+}
 
+// ---- keyframe istekleri (PLI) ----
+static constexpr int64_t KEYFRAME_MIN_INTERVAL_MS = 500;   // gönderici tarafı sınır
+
+// depay (request-keyframe) ve decoder (automatic-request-sync-points) kayıpta
+// upstream force-key-unit üretir; jitterbuffer'ın src pad'inde yakalanıp karşıya gider.
+static GstPadProbeReturn keyframe_req_probe(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+  GstEvent* ev = GST_PAD_PROBE_INFO_EVENT(info);
+  if (!gst_video_event_is_force_key_unit(ev)) return GST_PAD_PROBE_OK;
+
+  auto* link = static_cast<RxLink*>(user_data);
+  // istenen IDR en erken bir RTT sonra gelir; o zamana kadar tekrar isteme
+  const int64_t now = (int64_t)(ctrl_now_us() / 1000);
+  const int64_t wait = std::max<int64_t>(200, (int64_t)(link->ctrl->rtt_ms() * 1.5));
+  if (now - link->last_kf_ms.load() >= wait) {
+    link->last_kf_ms = now;
+    link->ctrl->send_keyframe_request(ctrl::KeyframeRequest{}, link->dest());
+  }
+  return GST_PAD_PROBE_DROP;
+}
+
+// ---- recvmmsg alım ringi -> appsrc ----
+// Slab slotları kopyalanmadan GstBuffer'a sarılır; buffer serbest kalınca slot havuza döner.
+// Ring, alıcı boru hattından önce durdurulmalı ve ondan sonra yok edilmeli.
+static void attach_ring_rx(GstElement* receiver, UdpRxRing* ring) {
+  GstElement* appsrc = gst_bin_get_by_name(GST_BIN(receiver), "rxsrc");
+  gst_object_unref(appsrc);   // bin sahibi; boru hattı ömrünce geçerli
+
+  ring->on_au([ring, appsrc](const RxPacket* pkts, size_t n, bool discont) {
+    GstClockTime pts = GST_CLOCK_TIME_NONE;
+    if (GstClock* clk = gst_element_get_clock(appsrc)) {
+      pts = gst_clock_get_time(clk) - gst_element_get_base_time(appsrc);
+      gst_object_unref(clk);
+    }
+    GstBufferList* list = gst_buffer_list_new_sized((guint)n);
+    for (size_t i=0; i<n; ++i) {
+      GstBuffer* b = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY, pkts[i].data, UdpRxRing::SLOT_SIZE,
+                                                 0, pkts[i].len, ring->cookie(pkts[i].slot), UdpRxRing::release_cookie);
+      GST_BUFFER_PTS(b) = pts;
+      if (i == 0 && discont) GST_BUFFER_FLAG_SET(b, GST_BUFFER_FLAG_DISCONT);
+      gst_buffer_list_add(list, b);
+    }
+    gst_app_src_push_buffer_list(GST_APP_SRC(appsrc), list);
+  });
+  ring->on_packet([](uint16_t seq, uint32_t rtp_ts, uint64_t arrival_ns, size_t bytes, bool marker) {
+    g_rx.stats.on_packet(seq, rtp_ts, arrival_ns, bytes);
+    g_rx.delay.on_packet(rtp_ts, arrival_ns);
+    if (marker) g_rx.owd.on_frame(rtp_ts, arrival_ns / 1000);
+  });
+}
+
+// ---- receiver ----
+GstElement* build_receiver(const Args& a, RxLink* link, const std::string& name) {
+  GstElement* pipe = gst_pipeline_new(name.c_str());
+  const bool ring = a.ring_rx;   // main() MP2T/FEC ile birlikte kapatır
+
+  GstElement* src = nullptr;
+  if (ring) {
+    // UdpRxRing sıralı AU'ları buffer list olarak iter; jitterbuffer yok
+    src = gst_element_factory_make("appsrc", "rxsrc");
+    CHECK_ELEM(src, "appsrc");
+    set_bool(src, "is-live", TRUE);
+    set_arg(src, "format", "time");
+    set_bool(src, "block", FALSE);
+    g_object_set(G_OBJECT(src), "max-bytes", (guint64)(8*1024*1024), NULL);
+  } else {
+    src = gst_element_factory_make("udpsrc", "udpsrc");
+    CHECK_ELEM(src, "udpsrc");
+    set_int(src, "port", a.video_listen_port);
+    set_int(src, "buffer-size", 8*1024*1024);
+  }
+
+  const CodecInfo& ci = codec_info(a.rx_codec);
   auto capf = gst_element_factory_make("capsfilter", "capf");
   CHECK_ELEM(capf, "capsfilter");
   GstCaps* caps = (!a.use_ts)
     ? gst_caps_new_simple("application/x-rtp",
         "media", G_TYPE_STRING, "video",
-        "encoding-name", G_TYPE_STRING, "H264",
+        "clock-rate", G_TYPE_INT, 90000,
+        "encoding-name", G_TYPE_STRING, ci.rtp_name,
         "payload", G_TYPE_INT, 96, NULL)
     : gst_caps_new_simple("application/x-rtp",
         "media", G_TYPE_STRING, "video",
+        "clock-rate", G_TYPE_INT, 90000,
         "encoding-name", G_TYPE_STRING, "MP2T",
         "payload", G_TYPE_INT, 33, NULL);
   g_object_set(G_OBJECT(capf), "caps", caps, NULL);
+  if (ring) g_object_set(G_OBJECT(src), "caps", caps, NULL);
   gst_caps_unref(caps);
 
-  auto jbuf = gst_element_factory_make("rtpjitterbuffer", "jbuf");
-  CHECK_ELEM(jbuf, "rtpjitterbuffer");
-  set_int(jbuf, "latency", a.latency_ms);
-  set_bool(jbuf, "mode", TRUE);
+  GstElement* jbuf = nullptr;
+  if (!ring) {
+    jbuf = gst_element_factory_make("rtpjitterbuffer", "jbuf");
+    CHECK_ELEM(jbuf, "rtpjitterbuffer");
+    set_int(jbuf, "latency", a.latency_ms);
+    set_bool(jbuf, "mode", TRUE);
+
+    GstPad* jsink = gst_element_get_static_pad(jbuf, "sink");
+    gst_pad_add_probe(jsink, GST_PAD_PROBE_TYPE_BUFFER, rx_stats_probe, link, nullptr);
+    if (a.nack) {
+      set_bool(jbuf, "do-retransmission", TRUE);
+      gst_pad_add_probe(jsink, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM, nack_probe, link, nullptr);
+    }
+    gst_object_unref(jsink);
+  }
+
+  // FEC: rtpstorage paketleri tutar, jitterbuffer kayıp olayı üretir,
+  // rtpulpfecdec kaybı yeniden gönderim beklemeden storage'dan kurtarır.
+  GstElement* storage = nullptr;
+  GstElement* fecdec = nullptr;
+  if (a.fec_percent > 0 && !ring) {
+    storage = gst_element_factory_make("rtpstorage", "storage");
+    CHECK_ELEM(storage, "rtpstorage");
+    g_object_set(G_OBJECT(storage), "size-time", (guint64)((a.adaptive_jb ? a.jb_max_ms : a.latency_ms) + 100) * GST_MSECOND, NULL);
+
+    fecdec = gst_element_factory_make("rtpulpfecdec", "fecdec");
+    CHECK_ELEM(fecdec, "rtpulpfecdec");
+    set_int(fecdec, "pt", FEC_PT);
+    GObject* internal = nullptr;
+    g_object_get(G_OBJECT(storage), "internal-storage", &internal, NULL);
+    g_object_set(G_OBJECT(fecdec), "storage", internal, NULL);
+    g_object_unref(internal);
+
+    set_bool(jbuf, "do-lost", TRUE);
+    // FEC paketleri aynı akışta farklı PT ile gelir; saat hızını jitterbuffer'a ver
+    g_signal_connect(jbuf, "request-pt-map",
+      G_CALLBACK(+[] (GstElement*, guint pt, gpointer) -> GstCaps* {
+        return gst_caps_new_simple("application/x-rtp",
+          "media", G_TYPE_STRING, "video", "clock-rate", G_TYPE_INT, 90000,
+          "payload", G_TYPE_INT, (int)pt, NULL);
+      }), nullptr);
+  }
 
   auto depay = (!a.use_ts)
-    ? gst_element_factory_make("rtph264depay", "depay")
+    ? gst_element_factory_make(ci.depay, "depay")
     : gst_element_factory_make("rtpmp2tdepay", "depay");
   CHECK_ELEM(depay, "depay");
 
-  auto parse = gst_element_factory_make("h264parse", "parse");
-  CHECK_ELEM(parse, "h264parse");
-  auto dec = gst_element_factory_make("avdec_h264", "dec");
-  CHECK_ELEM(dec, "avdec_h264");
+  // MP2T her zaman H264 taşır; VP9/AV1'de ayrıştırıcı yok (depay -> çözücü)
+  const Codec dec_codec = a.use_ts ? Codec::H264 : a.rx_codec;
+  GstElement* parse = nullptr;
+  if (codec_info(dec_codec).parse) {
+    parse = gst_element_factory_make(codec_info(dec_codec).parse, "parse");
+    CHECK_ELEM(parse, codec_info(dec_codec).parse);
+  }
+  const std::string dec_name = choose_decoder(dec_codec, a.decoder);
+  auto dec = dec_name.empty() ? nullptr : gst_element_factory_make(dec_name.c_str(), "dec");
+  CHECK_ELEM(dec, dec_name.empty() ? a.decoder.c_str() : dec_name.c_str());
+  const std::string threading = a.dec_threading == "auto" && a.dec_lowlat ? "slice" : a.dec_threading;
+  std::cerr << "[dec] " << configure_decoder(dec, dec_name, a.dec_threads, threading) << std::endl;
+
+  if (a.pli) {
+    if (has_prop(depay, "request-keyframe")) set_bool(depay, "request-keyframe", TRUE);
+    if (has_prop(dec, "automatic-request-sync-points")) set_bool(dec, "automatic-request-sync-points", TRUE);
+    GstPad* jsrc = gst_element_get_static_pad(ring ? capf : jbuf, "src");
+    gst_pad_add_probe(jsrc, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM, keyframe_req_probe, link, nullptr);
+    gst_object_unref(jsrc);
+  }
   auto conv = gst_element_factory_make("videoconvert", "conv");
   CHECK_ELEM(conv, "videoconvert");
 
-  auto flip = gst_element_factory_make("videoflip", "flip");
-  CHECK_ELEM(flip, "videoflip");
-  set_arg(flip, "method", "horizontal-flip");
+  GstElement *flip = nullptr, *outcaps = nullptr, *sink = nullptr;
+  if (a.bench) {
+    // damga okunabilsin: ayna yok, I420; handoff senkron beklemeden sonra gelir
+    outcaps = gst_element_factory_make("capsfilter", "bench_out");
+    CHECK_ELEM(outcaps, "capsfilter");
+    GstCaps* i420 = gst_caps_new_simple("video/x-raw", "format", G_TYPE_STRING, "I420", NULL);
+    g_object_set(G_OBJECT(outcaps), "caps", i420, NULL);
+    gst_caps_unref(i420);
+    sink = gst_element_factory_make("fakesink", "sink");
+    CHECK_ELEM(sink, "fakesink");
+    set_bool(sink, "sync", TRUE);
+    set_bool(sink, "signal-handoffs", TRUE);
+    g_signal_connect(sink, "handoff", G_CALLBACK(bench_handoff), nullptr);
+  } else {
+    flip = gst_element_factory_make("videoflip", "flip");
+    CHECK_ELEM(flip, "videoflip");
+    set_arg(flip, "method", "horizontal-flip");
+
+    sink = gst_element_factory_make("autovideosink", "sink");
+    CHECK_ELEM(sink, "autovideosink");
+    set_bool(sink, "sync", TRUE);
+  }
 
-  auto sink = gst_element_factory_make("autovideosink", "sink");
-  CHECK_ELEM(sink, "autovideosink");
-  set_bool(sink, "sync", TRUE);
+  // kayıt: depay (MP2T'de tsdemux) çıkışındaki kodlanmış akış
+  GstElement* rtee = nullptr;
+  if (a.record_rx) { rtee = gst_element_factory_make("tee", "rec_tee"); CHECK_ELEM(rtee, "tee"); }
 
   if (!a.use_ts) {
-    gst_bin_add_many(GST_BIN(pipe), src, capf, jbuf, depay, parse, dec, conv, flip, sink, NULL);
-    if (!gst_element_link_many(src, capf, jbuf, depay, parse, dec, conv, flip, sink, NULL)) return nullptr;
+    if (!add_chain(pipe, {src, capf, storage, jbuf, fecdec, depay, rtee, parse, dec, conv, flip, outcaps, sink})) return nullptr;
   } else {
     auto tsdemux = gst_element_factory_make("tsdemux", "tsdemux");
     CHECK_ELEM(tsdemux, "tsdemux");
-    gst_bin_add_many(GST_BIN(pipe), src, capf, jbuf, depay, tsdemux, parse, dec, conv, flip, sink, NULL);
-    if (!gst_element_link_many(src, capf, jbuf, depay, tsdemux, NULL)) return nullptr;
+    if (!add_chain(pipe, {rtee, parse, dec, conv, flip, outcaps, sink})) return nullptr;
+    if (!add_chain(pipe, {src, capf, storage, jbuf, fecdec, depay, tsdemux})) return nullptr;
     g_signal_connect(tsdemux, "pad-added",
       G_CALLBACK(+[] (GstElement* /*demux*/, GstPad* newpad, gpointer user_data){
-        auto parse = static_cast<GstElement*>(user_data);
-        GstPad* sinkpad = gst_element_get_static_pad(parse, "sink");
+        auto head = static_cast<GstElement*>(user_data);
+        GstPad* sinkpad = gst_element_get_static_pad(head, "sink");
         if (!gst_pad_is_linked(sinkpad)) gst_pad_link(newpad, sinkpad);
         gst_object_unref(sinkpad);
-      }), parse);
-    if (!gst_element_link_many(parse, dec, conv, flip, sink, NULL)) return nullptr;
+      }), rtee ? rtee : parse);
   }
+  if (rtee && !add_record_branch(pipe, rtee, a, dec_codec)) return nullptr;
 
   // bus watch
   GstBus* bus = gst_element_get_bus(pipe);
-  gst_bus_add_watch(bus, bus_cb, (gpointer)"receiver");
+  gst_bus_add_watch(bus, bus_cb, (gpointer)(name == "receiver" ? "receiver" : "peer"));
+  if (a.threads) gst_bus_set_sync_handler(bus, thread_sync_cb, (gpointer)"receiver", nullptr);
   gst_object_unref(bus);
 
   return pipe;
 }
 
-int main(int argc, char** argv) {
-  gst_init(&argc, &argv);
-  std::signal(SIGINT, sig_handler);
-  std::signal(SIGTERM, sig_handler);
+// ---- isteğe bağlı --anahtar=değer seçenekleri (konumsal argümanlardan sonra) ----
+static bool parse_options(int argc, char** argv, int first, Args& a) {
+  for (int i=first; i<argc; ++i) {
+    const std::string opt = argv[i];
+    if (opt.rfind("--", 0) != 0) { std::cerr << "Bilinmeyen argüman: " << opt << "\n"; return false; }
+    const auto eq = opt.find('=');
+    const std::string key = opt.substr(2, eq == std::string::npos ? std::string::npos : eq-2);
+    const std::string val = eq == std::string::npos ? "1" : opt.substr(eq+1);
+    try {
+      if      (key == "bitrate")     a.bitrate_kbps = std::stoi(val);
+      else if (key == "min-bitrate") a.min_bitrate_kbps = std::stoi(val);
+      else if (key == "abr")         a.abr = val != "0";
+      else if (key == "fec")         a.fec_percent = std::clamp(std::stoi(val), 0, 100);
+      else if (key == "nack")        a.nack = val != "0";
+      else if (key == "pli")         a.pli = val != "0";
+      else if (key == "keyint")      a.keyint = std::max(1, std::stoi(val));
+      else if (key == "mtu")         a.mtu = std::clamp(std::stoi(val), MIN_MTU, MAX_MTU);
+      else if (key == "tx") {
+        if (val != "udpsink" && val != "batch") throw std::invalid_argument(val);
+        a.batch_tx = val == "batch";
+      }
+      else if (key == "pacing")      a.pacing = val != "0";
+      else if (key == "latency") {
+        if (val == "auto") a.adaptive_jb = true;
+        else { a.adaptive_jb = false; a.latency_ms = std::max(0, std::stoi(val)); }
+      }
+      else if (key == "jb-min")      a.jb_min_ms = std::max(0, std::stoi(val));
+      else if (key == "jb-max")      a.jb_max_ms = std::max(1, std::stoi(val));
+      else if (key == "jb-pct")      a.jb_percentile = std::clamp(std::stod(val) / 100.0, 0.5, 0.9999);
+      else if (key == "encoder")     a.encoder = val;
+      else if (key == "codec") {
+        Codec c;
+        if (val != "auto" && !codec_from_name(val, c)) throw std::invalid_argument(val);
+        a.codec = val;
+      }
+      else if (key == "enc-bench") {
+        if (val != "0" && val != "1" && val != "refresh") throw std::invalid_argument(val);
+        a.enc_bench = val == "refresh" ? 2 : std::stoi(val);
+      }
+      else if (key == "codec-timeout") a.codec_timeout_ms = std::max(0, std::stoi(val));
+      else if (key == "bench")       a.bench = val != "0";
+      else if (key == "bench-src")      { a.bench = true; a.bench_src = val; }
+      else if (key == "bench-seconds")  a.bench_seconds = std::max(1, std::stoi(val));
+      else if (key == "bench-warmup")   a.bench_warmup = std::max(0, std::stoi(val));
+      else if (key == "bench-encoders") a.bench_encoders = val;
+      else if (key == "bench-sizes")    a.bench_sizes = val;
+      else if (key == "bench-out")      a.bench_out = val;
+      else if (key == "capture") {
+        if (val != "native" && val != "legacy") throw std::invalid_argument(val);
+        a.native_capture = val == "native";
+      }
+      else if (key == "preview") {
+        if      (val == "full") a.preview = Preview::Full;
+        else if (val == "lite") a.preview = Preview::Lite;
+        else if (val == "off" || val == "0") a.preview = Preview::Off;
+        else throw std::invalid_argument(val);
+      }
+      else if (key == "preview-size") {
+        if (sscanf(val.c_str(), "%dx%d", &a.preview_width, &a.preview_height) != 2 ||
+            a.preview_width <= 0 || a.preview_height <= 0) throw std::invalid_argument(val);
+        a.preview = Preview::Lite;
+      }
+      else if (key == "preview-fps") { a.preview_fps = std::max(1, std::stoi(val)); a.preview = Preview::Lite; }
+      else if (key == "multi")       a.multi = val != "0";
+      else if (key == "peers")       { a.multi = true; a.peers = val; }
+      else if (key == "join")        a.join = val != "0";
+      else if (key == "dec-threads") a.dec_threads = std::max(0, std::stoi(val));
+      else if (key == "decoder")     a.decoder = val;
+      else if (key == "dec-threading") {
+        if (val != "auto" && val != "slice" && val != "frame") throw std::invalid_argument(val);
+        a.dec_threading = val;
+      }
+      else if (key == "dec-mode") {
+        if (val != "default" && val != "lowlat") throw std::invalid_argument(val);
+        a.dec_lowlat = val == "lowlat";
+      }
+      else if (key == "simulcast")   a.simulcast = std::clamp(std::stoi(val), 1, MAX_LAYERS);
+      else if (key == "simulcast-kbps") a.simulcast_kbps = val;
+      else if (key == "layer")       a.layer = val == "auto" ? -1 : std::clamp(std::stoi(val), 0, MAX_LAYERS - 1);
+      else if (key == "io-mode")     a.io_mode = val;
+      else if (key == "mjpg-dec")    a.mjpg_decoder = val;
+      else if (key == "bench-format")   a.bench_format = val;
+      else if (key == "bench-capture")  a.bench_capture = val;
+      else if (key == "metrics") {
+        // off | prom[:port] | json[:dosya]
+        const auto colon = val.find(':');
+        const std::string mode = val.substr(0, colon);
+        if (mode == "off" || mode == "0") a.metrics.clear();
+        else if (mode == "prom" || mode == "1") {
+          a.metrics = "prom";
+          if (colon != std::string::npos) a.metrics_port = std::stoi(val.substr(colon+1));
+        } else if (mode == "json") {
+          a.metrics = "json";
+          if (colon != std::string::npos) a.metrics_out = val.substr(colon+1);
+        } else throw std::invalid_argument(val);
+      }
+      else if (key == "record") {
+        if (val != "off" && val != "0" && val != "tx" && val != "rx" && val != "both" && val != "1")
+          throw std::invalid_argument(val);
+        a.record_tx = val == "tx" || val == "both" || val == "1";
+        a.record_rx = val == "rx" || val == "both" || val == "1";
+      }
+      else if (key == "record-dir")  a.record_dir = val;
+      else if (key == "record-format") {
+        if (val != "mkv" && val != "mp4" && val != "ts") throw std::invalid_argument(val);
+        a.record_format = val;
+      }
+      else if (key == "record-segment") a.record_segment_s = std::max(1, std::stoi(val));
+      else if (key == "record-buffer")  a.record_buffer_mb = std::max(2, std::stoi(val));
+      else if (key == "motion") {
+        if (val != "auto" && val != "on" && val != "1" && val != "off" && val != "0") throw std::invalid_argument(val);
+        a.motion = val == "1" ? "on" : val == "0" ? "off" : val;
+      }
+      else if (key == "motion-thresh")    a.motion_thresh = std::max(0.5, std::stod(val));
+      else if (key == "motion-idle-fps")  a.motion_idle_fps = std::max(1, std::stoi(val));
+      else if (key == "motion-idle-kbps") a.motion_idle_kbps = std::clamp(std::stoi(val), 1, 100);
+      else if (key == "motion-budget")    a.motion_budget_us = std::max(50, std::stoi(val));
+      else if (key == "threads")      a.threads = val != "0" && val != "off";
+      else if (key == "affinity") {
+        if (!ThreadPolicy::get().set_affinity(val)) throw std::invalid_argument(val);
+        a.threads = true;
+      }
+      else if (key == "sched") {
+        if (!ThreadPolicy::get().set_sched(val)) throw std::invalid_argument(val);
+        a.threads = true;
+      }
+      else if (key == "thread-stats") a.thread_stats_s = std::max(0, std::stoi(val));
+      else if (key == "multicam") {
+        if (val != "off" && val != "0" && val != "composite" && val != "streams") throw std::invalid_argument(val);
+        a.multicam = val == "0" ? "off" : val;
+      }
+      else if (key == "multicam-max")  a.multicam_max = std::clamp(std::stoi(val), 1, MAX_CAMS);
+      else if (key == "multicam-kbps") a.multicam_kbps = std::max(0, std::stoi(val));
+      else if (key == "rx-streams")    a.rx_streams = std::clamp(std::stoi(val), 1, MAX_CAMS);
+      else if (key == "rx") {
+        if (val != "udpsrc" && val != "ring") throw std::invalid_argument(val);
+        a.ring_rx = val == "ring";
+      }
+      else { std::cerr << "Bilinmeyen seçenek: --" << key << "\n"; return false; }
+    } catch (const std::exception&) {
+      std::cerr << "Geçersiz değer: " << opt << "\n"; return false;
+    }
+  }
+  return true;
+}
 
-  if (argc < 6) {
-    std::cerr << "Kullanım: ./nova_engine <peer_ip> <video_send_port> <video_listen_port> <ctrl_send_port> <ctrl_listen_port>\n";
-    return 1;
+int64_t steady_ms() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ---- headless benchmark ----
+struct BenchRun {
+  int warmup_s = 2, seconds = 10;
+  double cpu0 = 0;
+  int64_t t0_ms = 0;
+  double wall_s = 0, cpu_percent = 0;   // tüm süreç, tek çekirdek = %100
+  bool completed = false;
+};
+
+static double process_cpu_s() {
+  rusage ru{}; getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+void remove_sources(std::vector<guint>& ids) {
+  for (guint id : ids)
+    if (GSource* src = g_main_context_find_source_by_id(nullptr, id)) g_source_destroy(src);
+  ids.clear();
+}
+
+// ---- tek yön gecikme: gönderen tarafı ----
+// Paketleyici çıkışında her yeni karenin RTP zaman damgası ve yakalama anı (PTS, boru hattı
+// saatinden steady saate çevrilir); 1 sn'de bir SENDER_REPORT olarak alıcılara gider.
+// Simulcast katmanları aynı zaman tabanını paylaşır: hangisi akıyorsa eşleme aynıdır.
+struct SrCtx {
+  std::mutex mu;
+  bool valid = false;
+  ctrl::SenderReport last;
+  ControlChannel* ctrl = nullptr;
+  PeerHub* hub = nullptr;    // çok eşli: tüm eşlere
+};
+
+static GstPadProbeReturn sr_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data) {
+  auto* ctx = static_cast<SrCtx*>(user_data);
+  GstBuffer* buf = (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST)
+    ? gst_buffer_list_get(GST_PAD_PROBE_INFO_BUFFER_LIST(info), 0) : GST_PAD_PROBE_INFO_BUFFER(info);
+  if (!buf || !GST_BUFFER_PTS_IS_VALID(buf)) return GST_PAD_PROBE_OK;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  if (!gst_rtp_buffer_map(buf, GST_MAP_READ, &rtp)) return GST_PAD_PROBE_OK;
+  const uint32_t ts = gst_rtp_buffer_get_timestamp(&rtp);
+  gst_rtp_buffer_unmap(&rtp);
+  {
+    std::lock_guard<std::mutex> lk(ctx->mu);
+    if (ctx->valid && ctx->last.rtp_ts == ts) return GST_PAD_PROBE_OK;   // aynı karenin devamı
   }
+  GstElement* pay = gst_pad_get_parent_element(pad);
+  if (!pay) return GST_PAD_PROBE_OK;
+  if (GstClock* clk = gst_element_get_clock(pay)) {
+    const GstClockTime capture = gst_element_get_base_time(pay) + GST_BUFFER_PTS(buf);
+    const int64_t age_us = GST_CLOCK_DIFF(capture, gst_clock_get_time(clk)) / 1000;
+    const uint64_t now_us = ctrl_now_us();
+    gst_object_unref(clk);
+    std::lock_guard<std::mutex> lk(ctx->mu);
+    ctx->last.rtp_ts = ts;
+    ctx->last.capture_us = now_us - (uint64_t)std::max<int64_t>(0, age_us);
+    ctx->valid = true;
+  }
+  gst_object_unref(pay);
+  return GST_PAD_PROBE_OK;
+}
 
-  Args a;
-  a.peer_ip           = argv[1];
-  a.video_send_port   = std::stoi(argv[2]);
-  a.video_listen_port = std::stoi(argv[3]);
-  a.ctrl_send_port    = std::stoi(argv[4]);
-  a.ctrl_listen_port  = std::stoi(argv[5]);
+void force_key_unit(GstElement* enc) {
+  gst_element_send_event(enc, gst_video_event_new_upstream_force_key_unit(GST_CLOCK_TIME_NONE, TRUE, 0));
+}
 
-  if (!auto_select_best_camera(a)) {
-    std::cerr << "Kamera bulunamadı veya kaps doğrulanamadı.\n";
-    return 1;
+std::atomic<bool> g_scene_idle(false);
+
+int scene_kbps(const Args& a, int kbps) {
+  if (!g_scene_idle.load(std::memory_order_relaxed)) return kbps;
+  return std::min(kbps, std::max(a.min_bitrate_kbps, kbps * a.motion_idle_kbps / 100));
+}
+
+static gboolean sr_cb(gpointer user_data) {
+  auto* ctx = static_cast<SrCtx*>(user_data);
+  ctrl::SenderReport sr;
+  {
+    std::lock_guard<std::mutex> lk(ctx->mu);
+    if (!ctx->valid) return G_SOURCE_CONTINUE;
+    sr = ctx->last;
   }
+  if (!ctx->hub) { ctx->ctrl->send_sender_report(sr); return G_SOURCE_CONTINUE; }
+  std::lock_guard<std::mutex> lk(ctx->hub->mu);
+  for (auto& kv : ctx->hub->peers) ctx->ctrl->send_sender_report(sr, &kv.second.ctrl);
+  return G_SOURCE_CONTINUE;
+}
 
-  std::cout << "[auto] device=" << a.device
-            << " mode=" << (a.prefer_mjpg ? "MJPG" : "RAW")
-            << " " << a.width << "x" << a.height
-            << "@" << a.fps << " selected\n";
+// ---- hareket kapısı ----
+// Analiz tee girişinde (kare başına bir kez), karar katman kuyruklarının girişinde: önizleme ve
+// diğer dallar her kareyi görmeye devam eder. tee kareyi aynı thread'de dağıttığından atılacak
+// kare işaretçiyle tanınır. Durağan/hareketli geçişinde bitrate ana thread'de yeniden uygulanır.
+struct MotionCtx {
+  explicit MotionCtx(const MotionGate::Config& c) : gate(c) {}
+  MotionGate gate;
+  std::vector<GstElement*> encs;       // LiveCtx'in referansları
+  GstBuffer* drop = nullptr;           // tee'nin şu an dağıttığı kare atılacaksa (yalnızca karşılaştırma)
+  bool idle = false, off_logged = false;
+  std::function<void()> apply_rate;    // ana thread
+  std::mutex mu;                       // idle_ids
+  std::vector<guint> idle_ids;
+};
 
-  ControlChannel ctrl(a.peer_ip, a.ctrl_send_port, a.ctrl_listen_port);
-  if (!ctrl.start()) { std::cerr << "Control channel start failed\n"; return 1; }
+static GstPadProbeReturn motion_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data) {
+  auto* mc = static_cast<MotionCtx*>(user_data);
+  mc->drop = nullptr;
+  GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+  GstCaps* caps = gst_pad_get_current_caps(pad);
+  GstVideoInfo vi;
+  const bool ok = caps && gst_video_info_from_caps(&vi, caps) && GST_VIDEO_INFO_IS_YUV(&vi);
+  if (caps) gst_caps_unref(caps);
+  GstVideoFrame f;
+  if (!ok || !gst_video_frame_map(&f, &vi, buf, GST_MAP_READ)) return GST_PAD_PROBE_OK;
+  const int64_t t_us = GST_BUFFER_PTS_IS_VALID(buf) ? (int64_t)(GST_BUFFER_PTS(buf) / 1000) : (int64_t)ctrl_now_us();
+  const MotionGate::Verdict v = mc->gate.on_frame(static_cast<const uint8_t*>(GST_VIDEO_FRAME_COMP_DATA(&f, 0)),
+      GST_VIDEO_FRAME_COMP_STRIDE(&f, 0), GST_VIDEO_FRAME_COMP_WIDTH(&f, 0) * GST_VIDEO_FRAME_COMP_PSTRIDE(&f, 0),
+      GST_VIDEO_FRAME_COMP_HEIGHT(&f, 0), t_us);
+  gst_video_frame_unmap(&f);
+
+  if (v == MotionGate::Verdict::Drop) mc->drop = buf;
+  if (v == MotionGate::Verdict::Cut) {
+    for (GstElement* e : mc->encs) force_key_unit(e);
+    std::cout << "[motion] sahne kesmesi -> IDR\n";
+  }
+  if (mc->gate.disabled() && !mc->off_logged) {
+    mc->off_logged = true;
+    std::cerr << "[motion] analiz " << (int)mc->gate.cost_us() << " µs, bütçe aşıldı: kapı kapalı\n";
+  }
+  if (mc->gate.idle() != mc->idle) {
+    mc->idle = mc->gate.idle();
+    g_scene_idle = mc->idle;
+    std::cout << "[motion] " << (mc->idle ? "durağan: kare hızı ve bitrate düşürüldü" : "hareket: tam hız") << "\n";
+    std::lock_guard<std::mutex> lk(mc->mu);
+    mc->idle_ids.push_back(g_idle_add_full(G_PRIORITY_DEFAULT, +[](gpointer d) -> gboolean {
+      static_cast<MotionCtx*>(d)->apply_rate();
+      return G_SOURCE_REMOVE;
+    }, mc, nullptr));
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn motion_drop_probe(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+  auto* mc = static_cast<MotionCtx*>(user_data);
+  return mc->drop && GST_PAD_PROBE_INFO_BUFFER(info) == mc->drop ? GST_PAD_PROBE_DROP : GST_PAD_PROBE_OK;
+}
+
+static bool motion_enabled(const Args& a, const std::string& enc_name) {
+  if (a.motion == "auto") return !a.bench && encoder_family(enc_name) == "sw";
+  return a.motion == "on";
+}
+
+// ---- çoklu kamera: kaynak başına kare zamanlaması (yakalama capsfilter'ı çıkışında) ----
+struct CamPacing {
+  std::string device;
+  FramePacing pacing;
+  CamPacing(std::string d, int fps) : device(std::move(d)), pacing(fps) {}
+};
+
+static GstPadProbeReturn cam_pacing_probe(GstPad*, GstPadProbeInfo*, gpointer user_data) {
+  static_cast<CamPacing*>(user_data)->pacing.on_frame(ctrl_now_us());
+  return GST_PAD_PROBE_OK;
+}
+
+static gboolean cam_pacing_cb(gpointer user_data) {
+  auto* cams = static_cast<std::vector<std::unique_ptr<CamPacing>>*>(user_data);
+  const uint64_t now = ctrl_now_us();
+  std::ostringstream line;
+  line << std::fixed << std::setprecision(1);
+  for (auto& c : *cams) {
+    const FramePacing::Snapshot s = c->pacing.take(now);
+    if (line.tellp() > 0) line << " | ";
+    line << c->device << " " << s.fps << " fps aralık " << s.mean_ms << "±" << s.jitter_ms
+         << " ms maks " << s.max_ms << " ms geç " << s.late;
+  }
+  std::cout << "[cams] " << line.str() << "\n";
+  return G_SOURCE_CONTINUE;
+}
+
+// Tek gönderici + alıcı oturumu; ESC/q, sinyal ya da (benchmark) süre dolana kadar çalışır.
+static int run_session(Args a, BenchRun* bench) {
+  std::vector<guint> timers;
+  g_rx.stats.reset();
+  g_rx.delay.reset();
+  g_rx.owd.reset();
+
+  if (a.ring_rx && a.use_ts) {
+    std::cerr << "[rx] ring yalnızca H264 RTP ile; udpsrc kullanılıyor\n";
+    a.ring_rx = false;
+  }
+  if (a.ring_rx && (a.fec_percent > 0 || a.nack))
+    std::cout << "[rx] ring: jitterbuffer yok, alıcı tarafta FEC kurtarma ve NACK devre dışı\n";
 
+  ControlChannel ctrl(a.peer_ip, a.ctrl_send_port, a.ctrl_listen_port);
+  g_rx.ctrl = &ctrl;
+  g_rx.has_to = false;
   auto sender   = build_sender(a);
-  auto receiver = build_receiver(a);
-  if (!sender || !receiver) { ctrl.stop(); return 1; }
+  auto receiver = build_receiver(a, &g_rx);
+  // Her çıkış buradan geçer: GLib kaynakları yığındaki bağlamlara bakar (benchmark aynı süreçte
+  // yeniden oturum açar), boru hatları NULL'a, bus izleyicileri ve referanslar bırakılır.
+  const auto release_pipelines = [&]{
+    remove_sources(timers);
+    for (GstElement* p : {sender, receiver}) {
+      if (!p) continue;
+      gst_element_set_state(p, GST_STATE_NULL);
+      GstBus* bus = gst_element_get_bus(p);
+      gst_bus_remove_watch(bus);
+      gst_object_unref(bus);
+      gst_object_unref(p);
+    }
+  };
+  if (!sender || !receiver) { release_pipelines(); return 1; }
+  auto tx_rec = attach_recorder(sender, a, "tx");
+  auto rx_rec = attach_recorder(receiver, a, "rx");
+
+  // çok eşli: hedefler PeerHub'dan; birincil eş yalnızca ilk eşlerden biri
+  PeerHub hub;
+  const auto peer_of = [&](const sockaddr_in& from) -> Peer* {
+    auto it = hub.peers.find(peer_key(from));
+    return it != hub.peers.end() ? &it->second : nullptr;
+  };
+
+  const int nlayers = std::max(1, a.simulcast);
+  const std::vector<int> kbps = layer_kbps(a);
+
+  // ---- NACK: gönderilen paketlerin geçmişi (simulcast: katman başına, sıra numaraları ayrı) ----
+  std::vector<std::unique_ptr<RtxServer>> rtx;
+  for (int i = 0; i < nlayers; ++i) {
+    rtx.push_back(std::make_unique<RtxServer>(a.peer_ip, a.video_send_port));
+    if (!a.nack || a.batch_tx) continue;
+    GstElement* usink = gst_bin_get_by_name(GST_BIN(sender), layer_name("udpsink", i).c_str());
+    GstPad* upad = gst_element_get_static_pad(usink, "sink");
+    gst_pad_add_probe(upad, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                      rtx_store_probe, &rtx[i]->history(), nullptr);
+    gst_object_unref(upad);
+    gst_object_unref(usink);
+  }
+  if (a.nack) {
+    ctrl.on_nack([&](const ctrl::Nack& nk){
+      if (!a.multi) { rtx[0]->on_nack(nk.seqs, nk.count, nk.budget_ms, ctrl.rtt_ms()); return; }
+      sockaddr_in to;
+      int layer;
+      {
+        std::lock_guard<std::mutex> lk(hub.mu);
+        Peer* p = peer_of(ctrl.from());
+        if (!p) return;   // bilinmeyen eş
+        // katman geçişinden hemen sonra gelen NACK eski katmanın sıra numaralarıdır
+        if (nlayers > 1 && steady_ms() - p->switched_ms < 500) return;
+        to = p->video;
+        layer = p->layer;
+      }
+      rtx[layer]->on_nack(nk.seqs, nk.count, nk.budget_ms, ctrl.rtt_ms(), &to);
+    });
+    timers.push_back(g_timeout_add_seconds(5, +[](gpointer p) -> gboolean {
+      auto* v = static_cast<std::vector<std::unique_ptr<RtxServer>>*>(p);
+      static uint64_t last = 0;
+      uint64_t resent = 0, skipped = 0, missing = 0;
+      for (auto& r : *v) { resent += r->resent(); skipped += r->skipped(); missing += r->missing(); }
+      const uint64_t total = resent + skipped + missing;
+      if (total != last) {
+        std::cout << "[rtx] resent=" << resent << " too-late=" << skipped << " evicted=" << missing << "\n";
+        last = total;
+      }
+      return G_SOURCE_CONTINUE;
+    }, &rtx));
+  }
+
+  // ---- toplu gönderim ----
+  std::vector<std::unique_ptr<UdpBatchSender>> batch;
+  std::vector<std::unique_ptr<TxStage>> tx_stage;   // batch'ten önce yıkılır; boru hatları o sırada NULL
+  if (a.batch_tx) {
+    for (int i = 0; i < nlayers; ++i) {
+      batch.push_back(std::make_unique<UdpBatchSender>(a.multi ? "0.0.0.0" : a.peer_ip, a.multi ? 0 : a.video_send_port));
+      UdpBatchSender& b = *batch.back();
+      if (!b.ok()) { release_pipelines(); return 1; }
+      b.set_frame_interval_us(1000000 / std::max(1, a.fps));
+      b.set_pacing(a.pacing);
+      tx_stage.push_back(std::make_unique<TxStage>());
+      tx_stage.back()->tx = &b;
+      tx_stage.back()->hist = a.nack ? &rtx[i]->history() : nullptr;
+      attach_batch_tx(sender, tx_stage.back().get(), layer_name("txsink", i));
+    }
+    timers.push_back(g_timeout_add_seconds(5, [](gpointer d) -> gboolean {
+      auto* v = static_cast<std::vector<std::unique_ptr<UdpBatchSender>>*>(d);
+      uint64_t pkts = 0, sc = 0;
+      for (auto& b : *v) { pkts += b->packets(); sc += b->syscalls(); }
+      std::cout << "[tx] pkts=" << pkts << " sendmmsg=" << sc
+                << " pkts/call=" << (sc ? (double)pkts / sc : 0.0) << "\n";
+      return G_SOURCE_CONTINUE;
+    }, &batch));
+  }
+
+  GstElement* enc = gst_bin_get_by_name(GST_BIN(sender), "enc");
+  const std::string enc_name = gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(gst_element_get_factory(enc)));
+
+  // ---- çok eşli / simulcast: katman dalları PeerHub'a ----
+  if (a.multi) {
+    hub.a = &a; hub.ctrl = &ctrl; hub.enc_name = enc_name;
+    hub.layers.resize(nlayers);
+    for (int i = 0; i < nlayers; ++i) {
+      TxLayer& l = hub.layers[i];
+      l.hub = &hub; l.index = i;
+      l.enc = gst_bin_get_by_name(GST_BIN(sender), layer_name("enc", i).c_str());
+      if (nlayers > 1) l.valve = gst_bin_get_by_name(GST_BIN(sender), layer_name("valve", i).c_str());
+      if (a.batch_tx) l.batch = batch[i].get();
+      else            l.msink = gst_bin_get_by_name(GST_BIN(sender), layer_name("udpsink", i).c_str());
+      l.rtx = rtx[i].get();
+      l.max_kbps = l.enc_kbps = kbps[i];
+      if (nlayers > 1) {
+        GstElement* pay = gst_bin_get_by_name(GST_BIN(sender), layer_name("pay", i).c_str());
+        GstPad* ppad = gst_element_get_static_pad(pay, "sink");
+        gst_pad_add_probe(ppad, GST_PAD_PROBE_TYPE_BUFFER, layer_switch_probe, &l, nullptr);
+        gst_object_unref(ppad);
+        gst_object_unref(pay);
+        std::cout << "[simulcast] L" << i << " " << std::max(16, (a.width >> i) & ~1) << "x"
+                  << std::max(16, (a.height >> i) & ~1) << " " << kbps[i] << " kbps\n";
+      }
+    }
+    ctrl.on_peer_update([&](bool add, const ctrl::PeerUpdate& u){ hub_post_update(&hub, add, u); });
+    if (nlayers > 1) ctrl.on_layer_select([&](const ctrl::LayerSelect& ls){
+      GstElement* kf = nullptr;
+      {
+        std::lock_guard<std::mutex> lk(hub.mu);
+        Peer* p = peer_of(ctrl.from());
+        const int req = std::min<int>(ls.layer, nlayers - 1);
+        if (!p || p->req_layer == req) return;
+        p->req_layer = req;
+        kf = hub_select_layer(&hub, *p);
+      }
+      if (kf) force_key_unit(kf);
+    });
+  }
+
+  // ---- PLI: karşının isteğiyle kodlayıcıya force-key-unit (hız sınırlı; simulcast: eşin katmanı) ----
+  int64_t last_kf_ms = 0;
+  guint kf_count = 0;
+  ctrl.on_keyframe_request([&](const ctrl::KeyframeRequest&){
+    GstElement* kf_enc = enc;
+    int64_t* last = &last_kf_ms;
+    if (a.multi) {
+      std::lock_guard<std::mutex> lk(hub.mu);
+      Peer* p = peer_of(ctrl.from());
+      if (!p) return;
+      kf_enc = hub.layers[p->layer].enc;
+      last = &hub.layers[p->layer].last_kf_ms;
+    }
+    const int64_t now = steady_ms();
+    if (now - *last < KEYFRAME_MIN_INTERVAL_MS) return;
+    *last = now;
+    gst_element_send_event(kf_enc, gst_video_event_new_upstream_force_key_unit(GST_CLOCK_TIME_NONE, TRUE, ++kf_count));
+    std::cout << "[pli] keyframe requested by peer (#" << kf_count << ")\n";
+  });
+
+  // ---- saat eşleme + tek yön gecikme: her PONG eşin saat örneği, SENDER_REPORT zaman eşlemesi ----
+  // Çok eşli modda kendi alıcısı olan eşin örnekleri o alıcıya, diğerleri ana alıcıya.
+  const auto owd_apply = [&](const std::function<void(OwdTracker&)>& fn) {
+    if (a.multi) {
+      std::lock_guard<std::mutex> lk(hub.mu);
+      Peer* p = peer_of(ctrl.from());
+      if (p && p->rx) { fn(p->rx->link.owd); return; }
+    }
+    fn(g_rx.owd);
+  };
+  ctrl.on_clock_sample([&](const ClockSample& cs){ owd_apply([&](OwdTracker& o){ o.clock().on_sample(cs); }); });
+  ctrl.on_sender_report([&](const ctrl::SenderReport& sr){
+    owd_apply([&](OwdTracker& o){ o.on_sender_report(sr.rtp_ts, sr.capture_us); });
+  });
+  SrCtx sr_ctx;
+  sr_ctx.ctrl = &ctrl;
+  sr_ctx.hub = a.multi ? &hub : nullptr;
+  for (int i = 0; i < nlayers; ++i) {   // kapalı (izleyicisiz) katman paket üretmez
+    GstElement* pay = gst_bin_get_by_name(GST_BIN(sender), layer_name("pay", i).c_str());
+    GstPad* ppad = gst_element_get_static_pad(pay, "src");
+    gst_pad_add_probe(ppad, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                      sr_probe, &sr_ctx, nullptr);
+    gst_object_unref(ppad);
+    gst_object_unref(pay);
+  }
+
+  // ---- ABR: karşının RR'leri + kendi RTT'miz -> canlı kodlayıcı bitrate ----
+  RateController rc(a.min_bitrate_kbps, a.bitrate_kbps, a.bitrate_kbps);
+  if (a.abr) ctrl.on_rtt([&](double rtt_ms){
+    if (!a.multi) { rc.on_rtt(rtt_ms, steady_ms()); return; }
+    std::lock_guard<std::mutex> lk(hub.mu);
+    if (Peer* p = peer_of(ctrl.from())) p->rc->on_rtt(rtt_ms, steady_ms());
+  });
+  int64_t fec_logged_ms = 0;
+  ctrl::ReceiverReport fec_last;
+  ctrl.on_report([&](const ctrl::ReceiverReport& rr){
+    // karşının FEC sayaçları: ek yükü boyutlandırmak için (en fazla 5 sn'de bir)
+    if ((rr.fec_recovered != fec_last.fec_recovered || rr.fec_unrecovered != fec_last.fec_unrecovered)
+        && steady_ms() - fec_logged_ms >= 5000) {
+      std::cout << "[fec] peer recovered=" << rr.fec_recovered << " unrecovered=" << rr.fec_unrecovered
+                << " lost=" << rr.cumulative_lost << "\n";
+      fec_last = rr; fec_logged_ms = steady_ms();
+    }
+    if (!a.abr) return;
+
+    RateReport r;
+    r.received  = rr.packets;
+    r.lost      = rr.cumulative_lost;
+    r.bytes     = rr.bytes;
+    r.jitter_ms = rr.jitter / 90.0;   // 90 kHz video clock
+    if (a.multi) {
+      GstElement* kf = nullptr;
+      {
+        std::lock_guard<std::mutex> lk(hub.mu);
+        Peer* p = peer_of(ctrl.from());
+        if (!p) return;
+        const int64_t now = steady_ms();
+        if (p->rc->on_report(r, now)) hub_apply_rate(&hub);
+        kf = hub_bw_layer(&hub, *p, now);
+      }
+      if (kf) force_key_unit(kf);
+      return;
+    }
+    int kbps = rc.on_report(r, steady_ms());
+    if (!kbps) return;
+    set_encoder_bitrate(enc, enc_name, scene_kbps(a, kbps));
+    std::cout << "[abr] bitrate=" << kbps << " kbps loss=" << rc.loss()*100.0
+              << "% qdelay=" << rc.queue_delay_ms() << " ms\n";
+  });
+  // ---- canlı yeniden yapılandırma: stdin komutları ve karşının RECONFIG isteği ----
+  LiveCtx live;
+  live.a = &a; live.sender = sender; live.enc_name = enc_name; live.ctrl = &ctrl;
+  live.hub = a.multi ? &hub : nullptr;
+  live.rc = &rc;
+  live.base_keyint = a.keyint;
+  live.recording = tx_rec != nullptr;
+  for (int i = 0; i < nlayers; ++i) live.encs.push_back(gst_bin_get_by_name(GST_BIN(sender), layer_name("enc", i).c_str()));
+  for (auto& b : batch) live.batch.push_back(b.get());
+  if (GstElement* tee = gst_bin_get_by_name(GST_BIN(sender), "tee")) {
+    GstPad* tpad = gst_element_get_static_pad(tee, "sink");
+    gst_pad_add_probe(tpad, GST_PAD_PROBE_TYPE_BUFFER, live_keyint_probe, &live, nullptr);
+    gst_object_unref(tpad);
+    gst_object_unref(tee);
+  }
+  // ---- hareket kapısı: durağan sahnede kodlayıcıya seyreltilmiş kareler, kesmede IDR ----
+  std::unique_ptr<MotionCtx> motion;
+  if (motion_enabled(a, enc_name)) {
+    MotionGate::Config mcfg;
+    mcfg.thresh = a.motion_thresh;
+    mcfg.idle_fps = std::min(a.motion_idle_fps, a.fps);
+    mcfg.budget_us = a.motion_budget_us;
+    motion = std::make_unique<MotionCtx>(mcfg);
+    motion->encs = live.encs;
+    motion->apply_rate = [&]{
+      if (!a.multi) {
+        set_encoder_bitrate(enc, enc_name, scene_kbps(a, a.abr ? rc.target_kbps() : a.bitrate_kbps));
+        return;
+      }
+      std::lock_guard<std::mutex> lk(hub.mu);
+      for (auto& l : hub.layers) if (l.enc_kbps) set_encoder_bitrate(l.enc, enc_name, scene_kbps(a, l.enc_kbps));
+    };
+    if (GstElement* tee = gst_bin_get_by_name(GST_BIN(sender), "tee")) {
+      GstPad* tpad = gst_element_get_static_pad(tee, "sink");
+      gst_pad_add_probe(tpad, GST_PAD_PROBE_TYPE_BUFFER, motion_probe, motion.get(), nullptr);
+      gst_object_unref(tpad);
+      gst_object_unref(tee);
+    }
+    for (int i = 0; i < nlayers; ++i)
+      if (GstElement* q = gst_bin_get_by_name(GST_BIN(sender), layer_name("q1", i).c_str())) {
+        GstPad* qpad = gst_element_get_static_pad(q, "sink");
+        gst_pad_add_probe(qpad, GST_PAD_PROBE_TYPE_BUFFER, motion_drop_probe, motion.get(), nullptr);
+        gst_object_unref(qpad);
+        gst_object_unref(q);
+      }
+    std::cout << "[motion] açık: eşik=" << a.motion_thresh << " durağan " << mcfg.idle_fps << " fps, bitrate %"
+              << a.motion_idle_kbps << ", bütçe " << a.motion_budget_us << " µs/kare\n";
+  }
+  ctrl.on_reconfig([&](const ctrl::Reconfig& r){
+    if (a.multi) {
+      std::lock_guard<std::mutex> lk(hub.mu);
+      if (!peer_of(ctrl.from())) return;   // yalnızca bilinen eşler ortak kodlamayı değiştirir
+    }
+    live_post(&live, r, addr_str(ctrl.from()));
+  });
+  const auto live_release = [&]{
+    remove_sources(live.idle_ids);
+    if (motion) {
+      std::lock_guard<std::mutex> lk(motion->mu);
+      remove_sources(motion->idle_ids);
+    }
+    g_scene_idle = false;
+    for (GstElement* e : live.encs) if (e) gst_object_unref(e);
+    live.encs.clear();
+  };
+  const auto abort_session = [&]{
+    hub_release(&hub);
+    live_release();
+    gst_object_unref(enc);
+    release_pipelines();
+    return 1;
+  };
+
+  if (!ctrl.start()) {
+    std::cerr << "Control channel start failed\n";
+    return abort_session();
+  }
+  // SR yalnızca çalışan kanaldan; sr_ctx yığında, zamanlayıcı release_pipelines ile kalkar
+  timers.push_back(g_timeout_add(1000, sr_cb, &sr_ctx));
+
+  // ---- recvmmsg alım ringi ----
+  std::optional<UdpRxRing> rx_ring;   // udpsrc ile aynı portu bağlar; yalnızca ring modunda
+  if (a.ring_rx) {
+    rx_ring.emplace(a.video_listen_port, a.latency_ms, 96);
+    if (!rx_ring->ok()) return abort_session();
+    attach_ring_rx(receiver, &*rx_ring);
+    timers.push_back(g_timeout_add_seconds(5, [](gpointer d) -> gboolean {
+      auto* r = static_cast<UdpRxRing*>(d);
+      const uint64_t sc = r->syscalls();
+      std::cout << "[rx] pkts=" << r->packets() << " recvmmsg=" << sc
+                << " pkts/call=" << (sc ? (double)r->packets() / sc : 0.0)
+                << " lost=" << r->lost() << " late=" << r->late() << " dup=" << r->duplicates()
+                << " pool-empty=" << r->pool_empty() << "\n";
+      return G_SOURCE_CONTINUE;
+    }, &*rx_ring));
+  }
+
+  GstElement* jbuf   = gst_bin_get_by_name(GST_BIN(receiver), "jbuf");     // ring modunda nullptr
+  GstElement* fecdec = gst_bin_get_by_name(GST_BIN(receiver), "fecdec");   // FEC kapalıysa nullptr
+  ReportCtx report_ctx{jbuf, fecdec, rx_ring ? &*rx_ring : nullptr, &g_rx};
+  timers.push_back(g_timeout_add(250, report_cb, &report_ctx));
+
+  PlayoutDelay playout(a.adaptive_jb ? a.jb_min_ms : a.latency_ms,
+                       a.adaptive_jb ? a.jb_max_ms : a.latency_ms, a.latency_ms);
+  JbCtx jb_ctx{jbuf, rx_ring ? &*rx_ring : nullptr, &playout, &g_rx, a.adaptive_jb, a.jb_percentile, 0};
+  timers.push_back(g_timeout_add(250, jb_cb, &jb_ctx));
+
+  // karşı simulcast gönderiyorsa katman isteği (göndermiyorsa yok sayılır)
+  LayerCtx layer_ctx{receiver, &g_rx, a.layer};
+  timers.push_back(g_timeout_add(2000, layer_cb, &layer_ctx));
+
+  DecodeCtx dec_ctx;
+  attach_decode_ctx(receiver, &dec_ctx, a);
+  timers.push_back(g_timeout_add(500, dec_cb, &dec_ctx));
+
+  // ---- aşama metrikleri: kapalıyken hiç prob takılmaz ----
+  std::optional<PipelineMetrics> metrics;
+  std::pair<PipelineMetrics*, std::string> metrics_dump;
+  if (!a.metrics.empty()) {
+    metrics.emplace();
+    metrics->instrument(sender, "sender");
+    metrics->instrument(receiver, "receiver");
+    metrics->add_rolling("owd", a.multi ? "primary" : a.peer_ip, &g_rx.owd.histogram());
+    if (a.metrics == "prom") {
+      if (guint id = metrics->serve_prometheus(a.metrics_port)) timers.push_back(id);
+    } else {
+      std::cout << "[metrics] json -> " << a.metrics_out << " (5 sn)\n";
+      metrics_dump = {&*metrics, a.metrics_out};
+      timers.push_back(g_timeout_add_seconds(5, [](gpointer d) -> gboolean {
+        auto* m = static_cast<std::pair<PipelineMetrics*, std::string>*>(d);
+        m->first->dump_json(m->second);
+        return G_SOURCE_CONTINUE;
+      }, &metrics_dump));
+    }
+  }
+
+  if (a.threads && a.thread_stats_s > 0)
+    timers.push_back(g_timeout_add_seconds(a.thread_stats_s, thread_stats_cb, sender));
+
+  // ring boru hatlarından önce: başlatılamazsa hiçbir şey akmadan kapanır
+  if (rx_ring && !rx_ring->start()) { std::cerr << "[rx] ring start failed\n"; return abort_session(); }
+
+  // çoklu kamera: streams modunda kamera 0 ana zincirden (caps_src) geçer
+  std::vector<std::unique_ptr<CamPacing>> cam_pacing;
+  if (!a.bench && a.cams.size() > 1) {
+    for (size_t k = 0; k < a.cams.size(); ++k) {
+      const std::string tap = a.multicam == "streams" && k == 0 ? "caps_src" : "cam_caps" + std::to_string(k);
+      GstElement* capsf = gst_bin_get_by_name(GST_BIN(sender), tap.c_str());
+      if (!capsf) continue;
+      cam_pacing.push_back(std::make_unique<CamPacing>(a.cams[k].device, a.cams[k].fps));
+      GstPad* cpad = gst_element_get_static_pad(capsf, "src");
+      gst_pad_add_probe(cpad, GST_PAD_PROBE_TYPE_BUFFER, cam_pacing_probe, cam_pacing.back().get(), nullptr);
+      gst_object_unref(cpad);
+      gst_object_unref(capsf);
+    }
+    if (!cam_pacing.empty()) timers.push_back(g_timeout_add_seconds(5, cam_pacing_cb, &cam_pacing));
+  }
+  // eşin ek kamera akışları (--rx-streams)
+  std::vector<std::unique_ptr<PeerRx>> cam_rx;
+  for (int k = 1; k < a.rx_streams && !a.bench; ++k)
+    if (auto rx = start_stream_rx(a, k)) cam_rx.push_back(std::move(rx));
 
   gst_element_set_state(receiver, GST_STATE_PLAYING);
   gst_element_set_state(sender,   GST_STATE_PLAYING);
 
+  // ---- çok eşli: ilk eşler ve --join ----
+  if (a.multi) {
+    ctrl::PeerUpdate u;
+    in_addr ia{};
+    if (inet_pton(AF_INET, a.peer_ip.c_str(), &ia) == 1 && ia.s_addr != 0) {
+      u.ipv4 = ntohl(ia.s_addr);
+      u.video_port = (uint16_t)a.video_send_port; u.ctrl_port = (uint16_t)a.ctrl_send_port; u.rx_port = 0;
+      hub_update(&hub, true, u);
+    }
+    for (const auto& spec : split_list(a.peers)) {
+      if (parse_peer(spec, u)) hub_update(&hub, true, u);
+      else std::cerr << "[peer] geçersiz eş: " << spec << "\n";
+    }
+  }
+  // yayıncıya katıl: kendi adresimizi (0 = kaynak adresi) ve dinlediğimiz portları bildir
+  const ctrl::PeerUpdate join_msg{0, (uint16_t)a.video_listen_port, (uint16_t)a.ctrl_listen_port,
+                                  (uint16_t)a.video_send_port};
+  if (a.join) ctrl.send_peer_update(true, join_msg);
+
+  // benchmark: ısınmadan sonra ölçüm penceresi, süre dolunca döngüden çık
+  if (bench) {
+    timers.push_back(g_timeout_add_seconds(bench->warmup_s, [](gpointer d) -> gboolean {
+      auto* b = static_cast<BenchRun*>(d);
+      g_latency.start_window();
+      b->cpu0 = process_cpu_s();
+      b->t0_ms = steady_ms();
+      return G_SOURCE_REMOVE;
+    }, bench));
+    timers.push_back(g_timeout_add_seconds(bench->warmup_s + bench->seconds, [](gpointer d) -> gboolean {
+      auto* b = static_cast<BenchRun*>(d);
+      b->wall_s = (steady_ms() - b->t0_ms) / 1000.0;
+      b->cpu_percent = b->wall_s > 0 ? (process_cpu_s() - b->cpu0) / b->wall_s * 100.0 : 0.0;
+      b->completed = true;
+      if (g_loop) g_main_loop_quit(g_loop);
+      return G_SOURCE_REMOVE;
+    }, bench));
+  }
+
   // ---- GLib main loop + STDIN watcher (ESC/q) ----
   g_loop = g_main_loop_new(NULL, FALSE);
 
-  GIOChannel* ch = g_io_channel_unix_new(STDIN_FILENO);
-  g_io_channel_set_encoding(ch, NULL, NULL);
-  g_io_channel_set_flags(ch, (GIOFlags)(g_io_channel_get_flags(ch) | G_IO_FLAG_NONBLOCK), NULL);
-  g_io_add_watch(ch, (GIOCondition)(G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL), stdin_cb, NULL);
+  // benchmark CI'da stdin'siz koşar (EOF'ta sürekli uyanır, CPU ölçümünü bozar)
+  GIOChannel* ch = nullptr;
+  if (!bench) {
+    ch = g_io_channel_unix_new(STDIN_FILENO);
+    g_io_channel_set_encoding(ch, NULL, NULL);
+    g_io_channel_set_flags(ch, (GIOFlags)(g_io_channel_get_flags(ch) | G_IO_FLAG_NONBLOCK), NULL);
+    timers.push_back(g_io_add_watch(ch, (GIOCondition)(G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL), stdin_cb, &live));
+  }
 
   g_main_loop_run(g_loop);
 
   // ---- shutdown ----
+  // benchmark aynı süreçte yeniden oturum açar: yığındaki bağlamlara bakan kaynaklar kalmasın
+  remove_sources(timers);
+  if (rx_ring) rx_ring->stop();
   gst_element_set_state(sender, GST_STATE_NULL);
   gst_element_set_state(receiver, GST_STATE_NULL);
-  gst_object_unref(sender);
-  gst_object_unref(receiver);
+  tx_rec.reset();   // kuyruktaki bloklar diske yazılır
+  rx_rec.reset();
+  if (motion) {
+    const MotionGate& g = motion->gate;
+    std::cout << "[motion] kare=" << g.frames() << " atılan=" << g.dropped() << " kesme=" << g.cuts()
+              << " analiz=" << (int)g.cost_us() << " µs (1/" << g.row_step() << " satır)"
+              << (g.disabled() ? " kapalı" : "") << "\n";
+  }
+  if (a.join) ctrl.send_peer_update(false, join_msg);
   ctrl.stop();
+  live_release();
+  if (a.multi) hub_clear(&hub);
+  hub_release(&hub);
+  for (auto& rx : cam_rx) stop_peer_rx(rx.get());
+  gst_object_unref(enc);
+  if (jbuf) gst_object_unref(jbuf);
+  if (fecdec) gst_object_unref(fecdec);
+  release_pipelines();
 
   if (ch) g_io_channel_unref(ch);
   if (g_loop) { g_main_loop_unref(g_loop); g_loop=nullptr; }
   return 0;
 }
+
+static std::string json_str(const std::string& s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') out += '\\';
+    out += c;
+  }
+  return out + "\"";
+}
+
+// Kodlayıcı x çözünürlük matrisi; her hücre ayrı oturum (127.0.0.1 üzerinde kendine gönderim).
+// Çıktı JSON: gecikme yüzdelikleri, gösterilen fps, süreç CPU'su (%100 = bir çekirdek).
+static int run_benchmark(Args a) {
+  // video ve kontrol aynı porta: kontrol soketi kendi PING'ine PONG, kendi RR'ine ABR ile yanıt verir
+  a.peer_ip = "127.0.0.1";
+  a.video_send_port = a.video_listen_port;
+  a.ctrl_send_port  = a.ctrl_listen_port;
+
+  std::vector<std::string> encoders = split_list(a.bench_encoders);
+  if (encoders.empty()) encoders.push_back(a.encoder.empty() ? choose_h264_encoder() : a.encoder);
+  struct Size { int w, h, fps; };
+  std::vector<Size> sizes;
+  for (const auto& wh : split_list(a.bench_sizes)) {
+    int w = 0, h = 0, f = a.fps;   // WxH ya da WxH@fps
+    const int n = sscanf(wh.c_str(), "%dx%d@%d", &w, &h, &f);
+    if (n < 2 || w <= 0 || h <= 0 || f <= 0) {
+      std::cerr << "Geçersiz boyut: " << wh << "\n"; return 1;
+    }
+    sizes.push_back({w, h, f});
+  }
+  if (sizes.empty()) sizes.push_back({a.width, a.height, a.fps});
+  std::vector<bool> captures;
+  for (const auto& c : split_list(a.bench_capture)) {
+    if (c != "native" && c != "legacy") { std::cerr << "Geçersiz yakalama yolu: " << c << "\n"; return 1; }
+    captures.push_back(c == "native");
+  }
+  if (captures.empty()) captures.push_back(a.native_capture);
+
+  std::ostringstream js;
+  js << "{\n  \"source\": " << json_str(a.bench_src.empty() ? "videotestsrc" : a.bench_src)
+     << ", \"fps_target\": " << a.fps << ", \"bitrate_kbps\": " << a.bitrate_kbps
+     << ", \"latency\": " << (a.adaptive_jb ? std::string("\"auto\"") : std::to_string(a.latency_ms))
+     << ", \"format\": " << json_str(a.bench_format)
+     << ", \"seconds\": " << a.bench_seconds << ",\n  \"runs\": [";
+
+  bool first = true;
+  int failures = 0;
+  for (const auto& enc : encoders) {
+    for (const auto& wh : sizes) for (bool native : captures) {
+      if (g_stop) break;
+      if (GstElementFactory* f = gst_element_factory_find(enc.c_str())) gst_object_unref(f);
+      else { std::cerr << "[bench] " << enc << " yok, atlanıyor\n"; continue; }
+
+      Args r = a;
+      r.encoder = enc; r.width = wh.w; r.height = wh.h; r.fps = wh.fps;
+      r.rx_codec = codec_of_encoder(enc);   // kendine gönderim: anlaşma yok
+      r.native_capture = native;
+      std::cerr << "[bench] " << enc << " " << r.width << "x" << r.height << "@" << r.fps
+                << " capture=" << (native ? "native" : "legacy") << "\n";
+      BenchRun br;
+      br.warmup_s = a.bench_warmup; br.seconds = a.bench_seconds;
+      const int rc = run_session(r, &br);
+      const LatencyRecorder::Summary sum = g_latency.summary();
+      const bool ok = rc == 0 && br.completed && sum.displayed > 0;
+      if (!ok) ++failures;
+
+      // süreç CPU'su / yakalanan kare: yakalama yolundaki kopyaların doğrudan karşılığı
+      const double cpu_ms_per_frame = sum.captured ? br.cpu_percent / 100.0 * br.wall_s * 1000.0 / sum.captured : 0.0;
+      js << (first ? "\n" : ",\n")
+         << "    {\"encoder\": " << json_str(enc) << ", \"width\": " << r.width << ", \"height\": " << r.height
+         << ", \"fps_target\": " << r.fps << ", \"capture\": " << (native ? "\"native\"" : "\"legacy\"")
+         << ", \"ok\": " << (ok ? "true" : "false")
+         << ", \"fps\": " << (br.wall_s > 0 ? sum.displayed / br.wall_s : 0.0)
+         << ", \"frames_captured\": " << sum.captured << ", \"frames_displayed\": " << sum.displayed
+         << ", \"bad_stamps\": " << sum.bad_stamps
+         << ", \"latency_ms\": {\"p50\": " << sum.p50_ms << ", \"p99\": " << sum.p99_ms
+         << ", \"p999\": " << sum.p999_ms << ", \"mean\": " << sum.mean_ms << ", \"max\": " << sum.max_ms << "}"
+         << ", \"cpu_percent\": " << br.cpu_percent << ", \"cpu_ms_per_frame\": " << cpu_ms_per_frame << "}";
+      first = false;
+    }
+  }
+  js << "\n  ]\n}\n";
+
+  if (a.bench_out.empty()) {
+    std::cout << js.str();
+  } else {
+    std::ofstream f(a.bench_out);
+    f << js.str();
+    if (!f) { std::cerr << "Yazılamadı: " << a.bench_out << "\n"; return 1; }
+    std::cerr << "[bench] " << a.bench_out << "\n";
+  }
+  return failures ? 2 : 0;
+}
+
+// ---- kodlayıcı seçimi ve kodek anlaşması ----
+// İki uç oturumdan önce aynı kontrol portlarında CODEC_CAPS değiş tokuş eder. Her uç kendi
+// gönderdiği akışın kodeğini seçer: kendi sıralamasındaki, eşin çözebildiği ilk kodek (pick_codec).
+// Eşin kuralı aynı olduğundan alınacak kodek de bilinir. Eski sürüm ya da sessiz eş: H264.
+static void negotiate_codecs(const Args& a, const std::vector<Codec>& ranked, Codec& tx, Codec& rx) {
+  tx = rx = Codec::H264;
+  ctrl::CodecCaps mine;
+  mine.decode_mask = decodable_codecs();
+  for (Codec c : ranked)
+    if (mine.count < ctrl::MAX_CODECS) mine.ranked[mine.count++] = static_cast<uint8_t>(c);
+
+  std::mutex mu;
+  std::optional<ctrl::CodecCaps> theirs;
+  uint8_t their_ack = ctrl::ACK_NONE;
+  ControlChannel ch(a.peer_ip, a.ctrl_send_port, a.ctrl_listen_port);
+  ch.on_codec_caps([&](const ctrl::CodecCaps& c) {
+    std::lock_guard<std::mutex> lk(mu);
+    theirs = c;
+    their_ack = std::max(their_ack, c.ack);
+  });
+  if (!ch.start()) { std::cerr << "[codec] kontrol kanalı açılamadı; H264\n"; return; }
+
+  // Karşı bizim yeteneklerimizi aldığını bildirince (ack >= HAVE_CAPS) seçim bu uçta kesinleşir ve
+  // geri alınmaz. Kesinleşen uç, karşı da kesinleştiğini bildirene kadar (ya da bir zaman aşımı
+  // daha) COMMITTED yinelemeyi sürdürür: son ack'imiz kaybolursa karşı H264'e düşmesin.
+  const int64_t deadline = steady_ms() + a.codec_timeout_ms;
+  int64_t done_ms = 0;
+  bool confirmed = false;
+  while (!g_stop) {
+    const int64_t now = steady_ms();
+    {
+      std::lock_guard<std::mutex> lk(mu);
+      if (!done_ms && theirs && their_ack >= ctrl::ACK_HAVE_CAPS) done_ms = now;
+      mine.ack = done_ms ? ctrl::ACK_COMMITTED : theirs ? ctrl::ACK_HAVE_CAPS : ctrl::ACK_NONE;
+      confirmed = their_ack >= ctrl::ACK_COMMITTED;
+    }
+    ch.send_codec_caps(mine);
+    if (done_ms ? confirmed || now - done_ms >= a.codec_timeout_ms : now >= deadline) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  // karşı kesinleşmişse onun son yinelemeleri de yanıtsız kalmasın
+  if (done_ms && confirmed) ch.send_codec_caps(mine);
+  ch.stop();
+
+  std::lock_guard<std::mutex> lk(mu);
+  if (!done_ms || !theirs) {
+    std::cerr << "[codec] eş " << a.codec_timeout_ms << " ms içinde yanıt vermedi; H264\n";
+    return;
+  }
+  if (!confirmed) std::cerr << "[codec] eşin kesinleşmesi görülmedi; seçim yine de uygulanıyor\n";
+  tx = pick_codec(mine.ranked, mine.count, theirs->decode_mask);
+  rx = pick_codec(theirs->ranked, std::min<size_t>(theirs->count, ctrl::MAX_CODECS), mine.decode_mask);
+}
+
+// Canlı oturum: kodlayıcı sıralaması (benchmark önbelleği) -> kodek anlaşması -> a.encoder, a.rx_codec.
+// --encoder verilmişse yalnızca onun kodeği önerilir; çok eşli modda herkes H264 çözer.
+static void select_codec(Args& a) {
+  std::vector<EncoderScore> ranking;
+  if (!a.encoder.empty()) {
+    EncoderScore s;
+    s.encoder = a.encoder; s.codec = codec_of_encoder(a.encoder); s.ok = true;
+    ranking.push_back(s);
+  } else if (a.enc_bench > 0 && !(std::getenv("NOVA_FORCE_X264") && *std::getenv("NOVA_FORCE_X264") == '1')) {
+    ranking = encoder_ranking(a.width, a.height, a.fps, a.bitrate_kbps, a.enc_bench == 2);
+  }
+  Codec only{};
+  const bool fixed = a.codec != "auto" && codec_from_name(a.codec, only);
+  ranking.erase(std::remove_if(ranking.begin(), ranking.end(), [&](const EncoderScore& s) {
+    return !s.ok || (fixed && s.codec != only) || (a.multi && s.codec != Codec::H264);
+  }), ranking.end());
+
+  std::vector<Codec> codecs;
+  for (const auto& s : ranking)
+    if (std::find(codecs.begin(), codecs.end(), s.codec) == codecs.end()) codecs.push_back(s.codec);
+
+  Codec tx = Codec::H264, rx = Codec::H264;
+  if (!a.multi && !a.use_ts) negotiate_codecs(a, codecs, tx, rx);
+
+  std::string enc;
+  for (const auto& s : ranking) if (s.codec == tx) { enc = s.encoder; break; }
+  if (enc.empty()) { tx = Codec::H264; enc = choose_h264_encoder(); }   // eş ilk tercihi çözemiyor ya da ölçüm yok
+  if (!ranking.empty() && enc != ranking[0].encoder)
+    std::cerr << "[codec] " << ranking[0].encoder << " yerine " << enc << " (eşin çözebildiği)\n";
+  a.encoder = enc;
+  a.rx_codec = rx;
+  std::cout << "[codec] gönderim=" << codec_info(tx).name << " (" << enc << ") alım=" << codec_info(rx).name << "\n";
+}
+
+int main(int argc, char** argv) {
+  gst_init(&argc, &argv);
+  std::signal(SIGINT, sig_handler);
+  std::signal(SIGTERM, sig_handler);
+
+  // --bench: konumsal argümanlar olmadan 127.0.0.1 üzerinde kendi kendine
+  const bool bench_only = argc >= 2 && std::string(argv[1]).rfind("--bench", 0) == 0;
+  if (argc < 6 && !bench_only) {
+    std::cerr << "Kullanım: ./nova_engine <peer_ip> <video_send_port> <video_listen_port> <ctrl_send_port> <ctrl_listen_port>"
+                 " [--bitrate=kbps] [--min-bitrate=kbps] [--abr=0|1] [--fec=%] [--nack=0|1]"
+                 " [--pli=0|1] [--keyint=frames] [--mtu=bytes] [--tx=udpsink|batch] [--pacing=0|1]"
+                 " [--rx=udpsrc|ring] [--latency=ms|auto] [--jb-min=ms] [--jb-max=ms] [--jb-pct=99]"
+                 " [--encoder=name] [--codec=auto|h264|h265|vp9|av1] [--enc-bench=0|1|refresh] [--codec-timeout=ms]"
+                 " [--metrics=off|prom[:port]|json[:file]]"
+                 " [--record=off|tx|rx|both] [--record-dir=.] [--record-format=mkv|mp4|ts] [--record-segment=s] [--record-buffer=MiB]"
+                 " [--motion=auto|on|off] [--motion-thresh=4] [--motion-idle-fps=5] [--motion-idle-kbps=%] [--motion-budget=us]"
+                 " [--threads=0|1] [--affinity=class:cpus]... [--sched=class:fifo:prio|class:nice:n]... [--thread-stats=s]"
+                 " [--multicam=off|composite|streams] [--multicam-max=4] [--multicam-kbps=kbps] [--rx-streams=n]"
+                 " [--multi] [--peers=ip:vport:cport[:rxport],...] [--join]"
+                 " [--decoder=auto|sw|name] [--dec-threads=n] [--dec-threading=auto|slice|frame] [--dec-mode=default|lowlat]"
+                 " [--simulcast=1..3] [--simulcast-kbps=a,b,c] [--layer=auto|0..2]"
+                 " [--preview=full|lite|off] [--preview-size=WxH] [--preview-fps=15]"
+                 " [--capture=native|legacy] [--io-mode=auto|mmap|dmabuf|...] [--mjpg-dec=name]\n"
+                 "       ./nova_engine --bench [--bench-src=file] [--bench-seconds=10] [--bench-warmup=2]"
+                 " [--bench-encoders=a,b] [--bench-sizes=WxH[@fps],...]"
+                 " [--bench-format=I420|YUY2,NV12|MJPG] [--bench-capture=native,legacy] [--bench-out=file.json] [seçenekler]\n";
+    return 1;
+  }
+
+  Args a;
+  if (bench_only) {
+    a.peer_ip = "127.0.0.1";
+    a.video_send_port = a.video_listen_port = BENCH_VIDEO_PORT;
+    a.ctrl_send_port  = a.ctrl_listen_port  = BENCH_CTRL_PORT;
+  } else {
+    a.peer_ip           = argv[1];
+    a.video_send_port   = std::stoi(argv[2]);
+    a.video_listen_port = std::stoi(argv[3]);
+    a.ctrl_send_port    = std::stoi(argv[4]);
+    a.ctrl_listen_port  = std::stoi(argv[5]);
+  }
+  if (!parse_options(argc, argv, bench_only ? 1 : 6, a)) return 1;
+  if (a.jb_max_ms < a.jb_min_ms) std::swap(a.jb_min_ms, a.jb_max_ms);
+  if (a.adaptive_jb) a.latency_ms = std::clamp(a.latency_ms, a.jb_min_ms, a.jb_max_ms);
+  if (a.simulcast > 1) a.multi = true;   // katman seçimi eş başına hedef listesiyle yapılır
+  g_rx.delay.set_percentile(a.jb_percentile);
+  if (a.bench) return run_benchmark(a);
+  if (a.multicam == "streams" && a.multi) {
+    // ek akışlar tek eşe düz RTP; PeerHub hedef listesi yalnızca ana kodlamayı dağıtır
+    std::cerr << "[multicam] streams çok eşli modda yok; composite kullanılıyor\n";
+    a.multicam = "composite";
+  }
+
+  if (!auto_select_best_camera(a)) {
+    std::cerr << "Kamera bulunamadı veya kaps doğrulanamadı.\n";
+    return 1;
+  }
+
+  std::cout << "[auto] device=" << a.device
+            << " mode=" << (a.prefer_mjpg ? "MJPG" : "RAW")
+            << " " << a.width << "x" << a.height
+            << "@" << a.fps << " selected\n";
+
+  select_codec(a);
+  return run_session(a, nullptr);
+}
+
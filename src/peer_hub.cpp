@@ -0,0 +1,299 @@
+#include "peer_hub.hpp"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <arpa/inet.h>
+
+uint64_t peer_key(const sockaddr_in& ctrl_addr) {
+  return (uint64_t)ntohl(ctrl_addr.sin_addr.s_addr) << 16 | ntohs(ctrl_addr.sin_port);
+}
+
+static sockaddr_in make_addr(uint32_t ipv4, uint16_t port) {
+  sockaddr_in sa{};
+  sa.sin_family = AF_INET;
+  sa.sin_addr.s_addr = htonl(ipv4);
+  sa.sin_port = htons(port);
+  return sa;
+}
+
+std::string addr_str(const sockaddr_in& sa) {
+  char ip[INET_ADDRSTRLEN] = "";
+  inet_ntop(AF_INET, &sa.sin_addr, ip, sizeof(ip));
+  return std::string(ip) + ":" + std::to_string(ntohs(sa.sin_port));
+}
+
+// fan-out hedefi ekle/çıkar; herhangi bir thread (multiudpsink ve UdpBatchSender kendi kilitli)
+static bool layer_add_dst(TxLayer& l, const sockaddr_in& v) {
+  char ip[INET_ADDRSTRLEN] = "";
+  inet_ntop(AF_INET, &v.sin_addr, ip, sizeof(ip));
+  if (l.msink) g_signal_emit_by_name(l.msink, "add", ip, (gint)ntohs(v.sin_port));
+  return !l.batch || l.batch->add_destination(v);
+}
+
+static void layer_remove_dst(TxLayer& l, const sockaddr_in& v) {
+  char ip[INET_ADDRSTRLEN] = "";
+  inet_ntop(AF_INET, &v.sin_addr, ip, sizeof(ip));
+  if (l.msink) g_signal_emit_by_name(l.msink, "remove", ip, (gint)ntohs(v.sin_port));
+  if (l.batch) l.batch->remove_destination(v);
+}
+
+// mu tutulurken: alan ya da geçiş bekleyen eşi olmayan katmanın valve'ı kapanır
+static void hub_refresh_valves(PeerHub* hub) {
+  for (auto& l : hub->layers) {
+    if (!l.valve) continue;
+    bool used = false;
+    for (auto& kv : hub->peers) used |= kv.second.layer == l.index || kv.second.pending == l.index;
+    used |= l.index == 0 && hub->a->record_tx;   // kayıt tam katmanı izler
+    if (used == l.open) continue;
+    l.open = used;
+    set_bool(l.valve, "drop", used ? FALSE : TRUE);
+    std::cout << "[simulcast] L" << l.index << (used ? " açık" : " kapalı (izleyici yok)") << "\n";
+  }
+}
+
+GstElement* hub_select_layer(PeerHub* hub, Peer& p) {
+  const int want = std::clamp(std::max(p.req_layer, p.bw_layer), 0, (int)hub->layers.size() - 1);
+  const int cur = p.pending >= 0 ? p.pending : p.layer;
+  if (want == cur) return nullptr;
+  if (want == p.layer) {             // bekleyen geçiş geri alındı
+    p.pending = -1;
+    hub->pending.fetch_sub(1);
+    hub_refresh_valves(hub);
+    return nullptr;
+  }
+  if (p.pending < 0) hub->pending.fetch_add(1);
+  p.pending = want;
+  hub_refresh_valves(hub);
+  std::cout << "[simulcast] " << addr_str(p.ctrl) << " L" << p.layer << " -> L" << want
+            << " (istek L" << p.req_layer << ", bant L" << p.bw_layer << ")\n";
+  return hub->layers[want].enc;
+}
+
+GstElement* hub_bw_layer(PeerHub* hub, Peer& p, int64_t now) {
+  if (!hub->a->abr || hub->layers.size() < 2) return nullptr;
+  // geçiş sürerken ya da alıcı sınırı bant kararından kabaysa ölçüm bu katmanı yansıtmaz
+  if (p.pending >= 0 || p.layer != p.bw_layer || now - p.switched_ms < 2000) return nullptr;
+  const int t = p.rc->target_kbps();
+  if (p.bw_layer + 1 < (int)hub->layers.size() && t < hub->layers[p.bw_layer].max_kbps * 3 / 4) {
+    if (now - p.bw_ms < p.up_hold_ms) p.up_hold_ms = std::min<int64_t>(p.up_hold_ms * 2, 120000);
+    ++p.bw_layer;
+  } else if (p.bw_layer > 0 && now - p.bw_ms >= p.up_hold_ms &&
+             p.rc->loss() < 0.02 && p.rc->queue_delay_ms() < 25.0) {
+    --p.bw_layer;
+  } else {
+    return nullptr;
+  }
+  p.bw_ms = now;
+  return hub_select_layer(hub, p);
+}
+
+GstPadProbeReturn layer_switch_probe(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+  auto* l = static_cast<TxLayer*>(user_data);
+  PeerHub* hub = l->hub;
+  if (hub->pending.load(std::memory_order_relaxed) == 0) return GST_PAD_PROBE_OK;
+  if (GST_BUFFER_FLAG_IS_SET(GST_PAD_PROBE_INFO_BUFFER(info), GST_BUFFER_FLAG_DELTA_UNIT)) return GST_PAD_PROBE_OK;
+
+  std::lock_guard<std::mutex> lk(hub->mu);
+  const int64_t now = steady_ms();
+  for (auto& kv : hub->peers) {
+    Peer& p = kv.second;
+    if (p.pending != l->index) continue;
+    layer_remove_dst(hub->layers[p.layer], p.video);
+    layer_add_dst(*l, p.video);
+    const int start = l->index < p.layer ? l->max_kbps : std::min(p.rc->target_kbps(), l->max_kbps);
+    p.rc = std::make_unique<RateController>(hub->a->min_bitrate_kbps, hub->a->bitrate_kbps, start);
+    p.layer = l->index; p.pending = -1; p.switched_ms = now;
+    hub->pending.fetch_sub(1);
+  }
+  hub_refresh_valves(hub);
+  return GST_PAD_PROBE_OK;
+}
+
+void stop_peer_rx(PeerRx* rx) {
+  remove_sources(rx->timers);
+  gst_element_set_state(rx->pipe, GST_STATE_NULL);
+  rx->rec.reset();
+  GstBus* bus = gst_element_get_bus(rx->pipe);
+  gst_bus_remove_watch(bus);
+  gst_object_unref(bus);
+  if (rx->jbuf) gst_object_unref(rx->jbuf);
+  if (rx->fecdec) gst_object_unref(rx->fecdec);
+  gst_object_unref(rx->pipe);
+}
+
+// çözücü thread bütçesi: çekirdekler alıcılar arasında bölünür (ana alıcı dahil)
+static int peer_dec_threads(size_t receivers) {
+  const int cores = (int)std::max(1u, std::thread::hardware_concurrency());
+  return std::max(1, cores / (int)std::max<size_t>(1, receivers));
+}
+
+static std::unique_ptr<PeerRx> start_peer_rx(PeerHub* hub, const Peer& p, size_t receivers) {
+  Args r = *hub->a;
+  r.video_listen_port = p.rx_port;
+  r.ring_rx = false;   // ring tek porta bağlı; eş alıcıları udpsrc
+  r.bench = false;
+  r.dec_threads = peer_dec_threads(receivers);
+
+  auto rx = std::make_unique<PeerRx>();
+  rx->link.ctrl = hub->ctrl;
+  rx->link.has_to = true;
+  rx->link.to = p.ctrl;
+  rx->link.delay.set_percentile(r.jb_percentile);
+  rx->pipe = build_receiver(r, &rx->link, "receiver-" + addr_str(p.ctrl));
+  if (!rx->pipe) return nullptr;
+  rx->jbuf = gst_bin_get_by_name(GST_BIN(rx->pipe), "jbuf");
+  rx->fecdec = gst_bin_get_by_name(GST_BIN(rx->pipe), "fecdec");
+  rx->rec = attach_recorder(rx->pipe, r, "rx-" + addr_str(p.ctrl));
+  rx->playout = std::make_unique<PlayoutDelay>(r.adaptive_jb ? r.jb_min_ms : r.latency_ms,
+                                               r.adaptive_jb ? r.jb_max_ms : r.latency_ms, r.latency_ms);
+  rx->report = ReportCtx{rx->jbuf, rx->fecdec, nullptr, &rx->link};
+  rx->jb = JbCtx{rx->jbuf, nullptr, rx->playout.get(), &rx->link, r.adaptive_jb, r.jb_percentile, 0};
+  rx->layer.pipe = rx->pipe; rx->layer.link = &rx->link; rx->layer.pref = r.layer;
+  rx->timers.push_back(g_timeout_add(250, report_cb, &rx->report));
+  rx->timers.push_back(g_timeout_add(250, jb_cb, &rx->jb));
+  rx->timers.push_back(g_timeout_add(2000, layer_cb, &rx->layer));
+  rx->dec = std::make_unique<DecodeCtx>();
+  attach_decode_ctx(rx->pipe, rx->dec.get(), r);
+  rx->timers.push_back(g_timeout_add(500, dec_cb, rx->dec.get()));
+  gst_element_set_state(rx->pipe, GST_STATE_PLAYING);
+  return rx;
+}
+
+std::unique_ptr<PeerRx> start_stream_rx(const Args& a, int k) {
+  Args r = a;
+  r.video_listen_port = a.video_listen_port + k;
+  r.ring_rx = false; r.bench = false; r.use_ts = false;
+  r.fec_percent = 0; r.nack = false; r.pli = false; r.record_rx = false;
+  r.dec_threads = peer_dec_threads(a.rx_streams);
+
+  auto rx = std::make_unique<PeerRx>();
+  rx->link.delay.set_percentile(r.jb_percentile);
+  rx->pipe = build_receiver(r, &rx->link, "receiver-cam" + std::to_string(k));
+  if (!rx->pipe) return nullptr;
+  rx->jbuf = gst_bin_get_by_name(GST_BIN(rx->pipe), "jbuf");
+  rx->playout = std::make_unique<PlayoutDelay>(r.adaptive_jb ? r.jb_min_ms : r.latency_ms,
+                                               r.adaptive_jb ? r.jb_max_ms : r.latency_ms, r.latency_ms);
+  rx->jb = JbCtx{rx->jbuf, nullptr, rx->playout.get(), &rx->link, r.adaptive_jb, r.jb_percentile, 0};
+  rx->timers.push_back(g_timeout_add(250, jb_cb, &rx->jb));
+  rx->dec = std::make_unique<DecodeCtx>();
+  attach_decode_ctx(rx->pipe, rx->dec.get(), r);
+  rx->timers.push_back(g_timeout_add(500, dec_cb, rx->dec.get()));
+  gst_element_set_state(rx->pipe, GST_STATE_PLAYING);
+  std::cout << "[multicam] ek akış " << k << " dinleniyor: " << r.video_listen_port << "\n";
+  return rx;
+}
+
+void hub_apply_rate(PeerHub* hub) {
+  if (!hub->a->abr) return;
+  for (auto& l : hub->layers) {
+    int kbps = 0, n = 0;
+    for (auto& kv : hub->peers) {
+      if (kv.second.layer != l.index) continue;
+      const int t = kv.second.rc->target_kbps();
+      kbps = n++ ? std::min(kbps, t) : t;
+    }
+    if (!n) continue;
+    kbps = std::min(kbps, l.max_kbps);
+    if (kbps == l.enc_kbps) continue;
+    l.enc_kbps = kbps;
+    set_encoder_bitrate(l.enc, hub->enc_name, scene_kbps(*hub->a, kbps));
+    std::cout << "[abr] " << (hub->layers.size() > 1 ? "L" + std::to_string(l.index) + " " : std::string())
+              << "bitrate=" << kbps << " kbps (en zayıf eş, " << n << " eş)\n";
+  }
+}
+
+void hub_update(PeerHub* hub, bool add, const ctrl::PeerUpdate& u) {
+  const sockaddr_in video = make_addr(u.ipv4, u.video_port);
+  const sockaddr_in caddr = make_addr(u.ipv4, u.ctrl_port);
+  const uint64_t key = peer_key(caddr);
+  std::unique_ptr<PeerRx> dead;
+  GstElement* kf = nullptr;
+  if (add) {
+    size_t receivers = 1;
+    {
+      std::lock_guard<std::mutex> lk(hub->mu);
+      if (hub->peers.count(key) || !u.video_port) return;
+      for (auto& kv : hub->peers) if (kv.second.rx) ++receivers;
+    }
+    Peer p;
+    p.video = video; p.ctrl = caddr;
+    p.rx_port = u.rx_port != hub->a->video_listen_port ? u.rx_port : 0;
+    p.switched_ms = p.bw_ms = steady_ms();
+    if (p.rx_port) {
+      p.rx = start_peer_rx(hub, p, receivers + 1);
+      if (!p.rx) std::cerr << "[peer] " << addr_str(caddr) << " alıcı kurulamadı\n";
+    }
+
+    std::lock_guard<std::mutex> lk(hub->mu);
+    // yeni eş tam katmandan başlar; bant/alıcı isteği gerekirse indirir
+    TxLayer& l = hub->layers[0];
+    p.rc = std::make_unique<RateController>(hub->a->min_bitrate_kbps, hub->a->bitrate_kbps,
+                                            l.enc_kbps ? l.enc_kbps : l.max_kbps);
+    if (!layer_add_dst(l, video)) {
+      std::cerr << "[peer] hedef sınırı (" << UdpBatchSender::MAX_DESTS << ") dolu\n";
+      dead = std::move(p.rx);
+    } else {
+      hub->ctrl->add_peer(caddr);
+      std::cout << "[peer] +" << addr_str(video) << " ctrl=" << addr_str(caddr)
+                << (p.rx_port ? " rx=" + std::to_string(p.rx_port) : std::string()) << "\n";
+      hub->peers.emplace(key, std::move(p));
+      hub_refresh_valves(hub);
+      kf = l.enc;   // yeni eş ilk IDR'ı beklemesin
+    }
+  } else {
+    std::lock_guard<std::mutex> lk(hub->mu);
+    auto it = hub->peers.find(key);
+    if (it == hub->peers.end()) return;
+    layer_remove_dst(hub->layers[it->second.layer], it->second.video);
+    if (it->second.pending >= 0) hub->pending.fetch_sub(1);
+    hub->ctrl->remove_peer(caddr);
+    std::cout << "[peer] -" << addr_str(it->second.video) << "\n";
+    dead = std::move(it->second.rx);
+    hub->peers.erase(it);
+    hub_refresh_valves(hub);
+    hub_apply_rate(hub);
+  }
+  if (dead) stop_peer_rx(dead.get());
+  if (kf) force_key_unit(kf);
+}
+
+void hub_clear(PeerHub* hub) {
+  std::vector<ctrl::PeerUpdate> gone;
+  {
+    std::lock_guard<std::mutex> lk(hub->mu);
+    remove_sources(hub->idle_ids);
+    for (auto& kv : hub->peers) {
+      ctrl::PeerUpdate u;
+      u.ipv4 = ntohl(kv.second.ctrl.sin_addr.s_addr); u.ctrl_port = ntohs(kv.second.ctrl.sin_port);
+      gone.push_back(u);
+    }
+  }
+  for (const auto& u : gone) hub_update(hub, false, u);   // alıcılar kilit dışında durur
+}
+
+void hub_release(PeerHub* hub) {
+  for (auto& l : hub->layers)
+    for (GstElement* e : {l.enc, l.valve, l.msink}) if (e) gst_object_unref(e);
+  hub->layers.clear();
+}
+
+void hub_post_update(PeerHub* hub, bool add, const ctrl::PeerUpdate& u) {
+  struct Req { PeerHub* hub; bool add; ctrl::PeerUpdate u; };
+  std::lock_guard<std::mutex> lk(hub->mu);
+  hub->idle_ids.push_back(g_idle_add_full(G_PRIORITY_DEFAULT, +[](gpointer d) -> gboolean {
+    auto* r = static_cast<Req*>(d);
+    hub_update(r->hub, r->add, r->u);
+    return G_SOURCE_REMOVE;
+  }, new Req{hub, add, u}, +[](gpointer d){ delete static_cast<Req*>(d); }));
+}
+
+bool parse_peer(const std::string& spec, ctrl::PeerUpdate& u) {
+  char ip[64] = "";
+  int vp = 0, cp = 0, rp = 0;
+  if (sscanf(spec.c_str(), "%63[^:]:%d:%d:%d", ip, &vp, &cp, &rp) < 3) return false;
+  in_addr ia{};
+  if (inet_pton(AF_INET, ip, &ia) != 1 || vp <= 0 || cp <= 0) return false;
+  u.ipv4 = ntohl(ia.s_addr);
+  u.video_port = (uint16_t)vp; u.ctrl_port = (uint16_t)cp; u.rx_port = (uint16_t)std::max(0, rp);
+  return true;
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "common.hpp"
+#include "ctrl_proto.hpp"
+#include "engine.hpp"
+#include "rate_control.hpp"
+#include "recording.hpp"
+#include "rtx.hpp"
+#include "udp_batch.hpp"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+
+// Çok eşli yayın (--multi).
+// Tek yakalama + tek kodlama; paketler multiudpsink ya da UdpBatchSender ile tüm eşlere kopyalanır.
+// Eşler kontrol kanalından PEER_ADD/PEER_REMOVE ile eklenip çıkarılır; yalnızca hedef listesi
+// değişir, boru hattı yeniden anlaşmaz. Kodlayıcı hızı en zayıf eşin denetleyicisine göre;
+// simulcast'te katman başına, ve yetişemeyen eş daha kaba bir katmana geçer (diğerleri etkilenmez).
+// Bize gönderen eşler (rx_port) için eş başına alıcı boru hattı; çözücü thread'leri tek bir
+// çekirdek bütçesinden paylaştırılır.
+struct PeerRx {
+  RxLink link;
+  GstElement* pipe = nullptr;
+  GstElement* jbuf = nullptr;
+  GstElement* fecdec = nullptr;            // FEC kapalıysa nullptr
+  std::unique_ptr<PlayoutDelay> playout;
+  ReportCtx report{};
+  JbCtx jb{};
+  LayerCtx layer{};
+  std::unique_ptr<DecodeCtx> dec;
+  std::unique_ptr<RecordTap> rec;
+  std::vector<guint> timers;
+};
+
+struct Peer {
+  sockaddr_in video{}, ctrl{};
+  int rx_port = 0;
+  std::unique_ptr<RateController> rc;
+  std::unique_ptr<PeerRx> rx;
+
+  // simulcast: layer = şu an aldığı; pending = geçilecek (o katmanın IDR'ında), -1 = yok
+  int layer = 0, pending = -1;
+  int req_layer = 0;                 // alıcının LAYER_SELECT sınırı
+  int bw_layer = 0;                  // bant genişliği (rc) kararı
+  int64_t switched_ms = 0, bw_ms = 0;
+  int64_t up_hold_ms = 10000;        // başarısız yukarı geçişte ikiye katlanır
+};
+
+struct PeerHub;
+
+// build_sender'ın bir katman dalı (simulcast kapalıyken tek katman)
+struct TxLayer {
+  PeerHub* hub = nullptr;
+  int index = 0;
+  GstElement* enc = nullptr;
+  GstElement* msink = nullptr;       // multiudpsink (udpsink yolu)
+  UdpBatchSender* batch = nullptr;   // toplu gönderim yolu
+  GstElement* valve = nullptr;       // simulcast: izleyicisi olmayan katman kodlanmaz
+  bool open = false;
+  RtxServer* rtx = nullptr;
+  int max_kbps = 0, enc_kbps = 0;
+  int64_t last_kf_ms = 0;            // kontrol thread'i
+};
+
+struct PeerHub {
+  const Args* a = nullptr;
+  ControlChannel* ctrl = nullptr;
+  std::string enc_name;
+  std::vector<TxLayer> layers;       // kurulumdan sonra boyutu değişmez
+
+  std::mutex mu;                     // peers: kontrol thread'i (RR/RTT/NACK) + ana thread (ekle/çıkar)
+  std::map<uint64_t, Peer> peers;    // anahtar: kontrol adresi
+  std::atomic<int> pending{0};       // geçiş bekleyen eş sayısı (IDR probunun hızlı yolu)
+  std::vector<guint> idle_ids;
+};
+
+uint64_t peer_key(const sockaddr_in& ctrl_addr);
+std::string addr_str(const sockaddr_in& sa);
+// "ip:video_port:ctrl_port[:rx_port]"
+bool parse_peer(const std::string& spec, ctrl::PeerUpdate& u);
+
+// ana thread (eş ekleyip çıkaran tek thread). Eş alıcısının boru hattı mu dışında kurulur ve
+// durdurulur: durum değişimi streaming thread'lerini bekler, onlar da (IDR probu, kontrol geri
+// çağrıları) mu'yu bekleyebilir.
+void hub_update(PeerHub* hub, bool add, const ctrl::PeerUpdate& u);
+
+// kontrol thread'inden: ana döngüye aktarılır (boru hattı kurulumu/yıkımı orada)
+void hub_post_update(PeerHub* hub, bool add, const ctrl::PeerUpdate& u);
+
+void hub_clear(PeerHub* hub);
+// katman elemanı referansları (boru hattı durduktan sonra)
+void hub_release(PeerHub* hub);
+
+// mu tutulurken: her katmanın kodlayıcısı o katmandaki en zayıf eşin hedefine (katman tavanıyla)
+void hub_apply_rate(PeerHub* hub);
+
+// mu tutulurken. Eşin katmanı max(alıcı sınırı, bant kararı); değiştiyse geçiş beklemeye alınır ve
+// IDR istenecek kodlayıcı döner. Olay kilit dışında gönderilmeli: kodlayıcının stream kilidi
+// tutulurken çalışan IDR probu da mu'yu bekler.
+GstElement* hub_select_layer(PeerHub* hub, Peer& p);
+
+// mu tutulurken, RR sonrası: hedef katmanın %75'inin altına inen eş bir kaba katmana;
+// up_hold boyunca kayıpsız ve kuyruksuz kalan eş bir ince katmana denenir. Yukarı geçiş
+// kısa sürede geri dönerse bekleme ikiye katlanır (en fazla 2 dk).
+GstElement* hub_bw_layer(PeerHub* hub, Peer& p, int64_t now);
+
+// Katmanın pay girişinde (AU): IDR geldiğinde bu katmana geçecek eşlerin hedefi taşınır.
+// Yukarı geçişte denetleyici katman hızından, aşağıda mevcut hedeften yeniden başlar
+// (yeni SSRC'nin sıra numarası sıçraması kayıp sayılmasın).
+GstPadProbeReturn layer_switch_probe(GstPad*, GstPadProbeInfo* info, gpointer user_data);
+
+// Eşin --multicam=streams ek kameraları: video_listen_port + k üzerinde sade alıcı. Gönderen ek
+// akışları sabit bitrate ile, FEC/NACK olmadan, düz RTP olarak yollar; geri bildirim yok (link.ctrl boş).
+std::unique_ptr<PeerRx> start_stream_rx(const Args& a, int k);
+
+void stop_peer_rx(PeerRx* rx);
@@ -0,0 +1,178 @@
+#include "pipeline_metrics.hpp"
+#include "common.hpp"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+PipelineMetrics::~PipelineMetrics() {
+  if (listen_ch_) g_io_channel_unref(listen_ch_);
+  if (listen_fd_ >= 0) close(listen_fd_);
+  for (auto& s : sampled_) gst_object_unref(s.elem);
+}
+
+// PTS'i değiştiren RTP aşamaları (jitterbuffer yeniden zamanlar) RTP ts+seq ile eşlenir
+static bool wants_rtp_key(const std::string& factory) {
+  return factory == "rtpjitterbuffer" || factory == "rtpstorage" ||
+         factory == "rtpulpfecdec" || factory == "rtpulpfecenc";
+}
+
+static uint64_t buffer_key(GstBuffer* buf, bool rtp_key) {
+  if (!rtp_key) return GST_BUFFER_PTS_IS_VALID(buf) ? GST_BUFFER_PTS(buf) : StageStats::NO_KEY;
+  guint8 hdr[8];
+  if (gst_buffer_extract(buf, 0, hdr, sizeof(hdr)) != sizeof(hdr)) return StageStats::NO_KEY;
+  const uint64_t seq = (uint64_t)hdr[2] << 8 | hdr[3];
+  const uint64_t ts  = (uint64_t)hdr[4] << 24 | (uint64_t)hdr[5] << 16 | (uint64_t)hdr[6] << 8 | hdr[7];
+  return ts << 16 | seq;
+}
+
+GstPadProbeReturn PipelineMetrics::probe_cb(GstPad*, GstPadProbeInfo* info, gpointer user_data) {
+  auto* p = static_cast<Probe*>(user_data);
+  const uint64_t now = metrics_now_ns();
+  uint64_t key, bytes;
+  uint32_t n;
+  if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+    GstBufferList* list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+    n = gst_buffer_list_length(list);
+    if (!n) return GST_PAD_PROBE_OK;
+    key = buffer_key(gst_buffer_list_get(list, 0), p->rtp_key);
+    bytes = gst_buffer_list_calculate_size(list);
+  } else {
+    GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+    n = 1;
+    key = buffer_key(buf, p->rtp_key);
+    bytes = gst_buffer_get_size(buf);
+  }
+  if (p->out) p->stats->on_out(key, now, bytes, n);
+  else        p->stats->on_in(key, now, bytes, n);
+  return GST_PAD_PROBE_OK;
+}
+
+void PipelineMetrics::instrument(GstElement* pipe, const std::string& name) {
+  GstIterator* it = gst_bin_iterate_elements(GST_BIN(pipe));
+  GValue item = G_VALUE_INIT;
+  while (gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+    GstElement* e = GST_ELEMENT(g_value_get_object(&item));
+    const std::string factory = gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(gst_element_get_factory(e)));
+    StageStats* st = reg_.add(name, GST_ELEMENT_NAME(e), factory);
+    const bool rtp_key = wants_rtp_key(factory);
+
+    // tee gibi çok çıkışlı elemanlarda tüm src pad'leri sayılır; gecikme ilk çıkışla ölçülür
+    GstIterator* pit = gst_element_iterate_pads(e);
+    GValue pv = G_VALUE_INIT;
+    while (gst_iterator_next(pit, &pv) == GST_ITERATOR_OK) {
+      GstPad* pad = GST_PAD(g_value_get_object(&pv));
+      probes_.push_back(std::make_unique<Probe>(Probe{st, GST_PAD_IS_SRC(pad), rtp_key}));
+      gst_pad_add_probe(pad, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                        probe_cb, probes_.back().get(), nullptr);
+      g_value_reset(&pv);
+    }
+    g_value_unset(&pv);
+    gst_iterator_free(pit);
+
+    if (factory == "queue")
+      sampled_.push_back({GST_ELEMENT(gst_object_ref(e)), st, Sampled::QUEUE});
+    else if (factory == "rtpjitterbuffer")
+      sampled_.push_back({GST_ELEMENT(gst_object_ref(e)), st, Sampled::JITTERBUFFER});
+    else if (GST_OBJECT_FLAG_IS_SET(e, GST_ELEMENT_FLAG_SINK) && has_prop(e, "stats"))
+      sampled_.push_back({GST_ELEMENT(gst_object_ref(e)), st, Sampled::SINK});
+    g_value_reset(&item);
+  }
+  g_value_unset(&item);
+  gst_iterator_free(it);
+}
+
+void PipelineMetrics::sample() {
+  for (auto& s : sampled_) {
+    switch (s.kind) {
+      case Sampled::QUEUE: {
+        guint level = 0; guint64 level_ns = 0;
+        g_object_get(G_OBJECT(s.elem), "current-level-buffers", &level, "current-level-time", &level_ns, NULL);
+        s.stats->set_level(level, static_cast<int64_t>(level_ns));
+        // leaky kuyruk: giren - çıkan - bekleyen
+        const auto snap = s.stats->snapshot();
+        const int64_t dropped = (int64_t)snap.in_buffers - (int64_t)snap.out_buffers - (int64_t)level;
+        s.stats->set_dropped(std::max<int64_t>(0, dropped));
+        break;
+      }
+      case Sampled::JITTERBUFFER:
+      case Sampled::SINK: {
+        GstStructure* st = nullptr;
+        g_object_get(G_OBJECT(s.elem), "stats", &st, NULL);
+        if (!st) break;
+        guint64 a = 0, b = 0;
+        if (s.kind == Sampled::JITTERBUFFER) {
+          gst_structure_get_uint64(st, "num-late", &a);
+          gst_structure_get_uint64(st, "num-lost", &b);
+        } else {
+          gst_structure_get_uint64(st, "dropped", &a);   // QoS ile geç kalıp gösterilmeyen
+        }
+        s.stats->set_dropped(static_cast<int64_t>(a + b));
+        gst_structure_free(st);
+        break;
+      }
+    }
+  }
+}
+
+guint PipelineMetrics::serve_prometheus(int port) {
+  listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+  if (listen_fd_ < 0) { perror("metrics socket"); return 0; }
+  int one = 1;
+  setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);   // yalnızca yerel
+  if (bind(listen_fd_, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd_, 8) < 0) {
+    perror("metrics bind");
+    close(listen_fd_); listen_fd_ = -1;
+    return 0;
+  }
+  listen_ch_ = g_io_channel_unix_new(listen_fd_);
+  std::cout << "[metrics] http://127.0.0.1:" << port << "/metrics\n";
+  return g_io_add_watch(listen_ch_, G_IO_IN, accept_cb, this);
+}
+
+// İstek içeriği önemsenmez: her bağlantıya metin biçiminde tüm metrikler döner.
+gboolean PipelineMetrics::accept_cb(GIOChannel*, GIOCondition, gpointer user_data) {
+  auto* self = static_cast<PipelineMetrics*>(user_data);
+  const int fd = accept4(self->listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+  if (fd < 0) return G_SOURCE_CONTINUE;
+  timeval tv{0, 200000};   // ana döngüyü yavaş istemciye kilitleme
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+  char req[1024];
+  if (recv(fd, req, sizeof(req), 0) > 0) {
+    self->sample();
+    const std::string body = self->reg_.render_prometheus();
+    char head[160];
+    const int hn = snprintf(head, sizeof(head),
+                            "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                            "Content-Length: %zu\r\nConnection: close\r\n\r\n", body.size());
+    std::string resp(head, hn);
+    resp += body;
+    for (size_t off = 0; off < resp.size();) {
+      const ssize_t w = send(fd, resp.data() + off, resp.size() - off, MSG_NOSIGNAL);
+      if (w <= 0) break;
+      off += static_cast<size_t>(w);
+    }
+  }
+  close(fd);
+  return G_SOURCE_CONTINUE;
+}
+
+bool PipelineMetrics::dump_json(const std::string& path) {
+  sample();
+  const std::string body = reg_.render_json();
+  if (path == "-") { std::cout << body << std::flush; return true; }
+  const std::string tmp = path + ".tmp";
+  FILE* f = fopen(tmp.c_str(), "w");
+  if (!f) { perror(tmp.c_str()); return false; }
+  const bool ok = fwrite(body.data(), 1, body.size(), f) == body.size();
+  if (fclose(f) != 0 || !ok || rename(tmp.c_str(), path.c_str()) != 0) { perror(path.c_str()); return false; }
+  return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "stage_metrics.hpp"
+#include <gst/gst.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Boru hattındaki her elemanın pad'lerine prob takar (giriş: sink pad'leri, çıkış: src pad'leri)
+// ve MetricsRegistry'e yazar. Kuyruk doluluğu / düşürmeler ana thread'de sample() ile okunur.
+// Metrikler kapalıyken hiç oluşturulmaz: prob yok, maliyet yok.
+class PipelineMetrics {
+ public:
+  PipelineMetrics() = default;
+  ~PipelineMetrics();
+  PipelineMetrics(const PipelineMetrics&) = delete;
+  PipelineMetrics& operator=(const PipelineMetrics&) = delete;
+
+  // yapım sonrası, PLAYING öncesi; üst düzey elemanlar (dinamik pad'ler hariç)
+  void instrument(GstElement* pipe, const std::string& name);
+  void sample();
+  // sahibi çağıran; PipelineMetrics'ten uzun yaşamalı
+  void add_rolling(const std::string& name, const std::string& peer, const RollingHistogram* h) { reg_.add_rolling(name, peer, h); }
+
+  // 127.0.0.1:port üzerinde Prometheus metin uç noktası (GLib ana döngüsünde). Watch id, 0 = hata.
+  guint serve_prometheus(int port);
+  // path'e atomik yazım (geçici dosya + rename); "-" = stdout
+  bool dump_json(const std::string& path);
+
+  const MetricsRegistry& registry() const { return reg_; }
+
+ private:
+  struct Probe { StageStats* stats; bool out; bool rtp_key; };
+  struct Sampled { GstElement* elem; StageStats* stats; enum { QUEUE, JITTERBUFFER, SINK } kind; };
+
+  static GstPadProbeReturn probe_cb(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+  static gboolean accept_cb(GIOChannel* ch, GIOCondition cond, gpointer user_data);
+
+  MetricsRegistry reg_;
+  std::vector<std::unique_ptr<Probe>> probes_;
+  std::vector<Sampled> sampled_;
+  int listen_fd_ = -1;
+  GIOChannel* listen_ch_ = nullptr;
+};
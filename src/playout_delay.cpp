@@ -0,0 +1,129 @@
+#include "playout_delay.hpp"
+#include <algorithm>
+#include <cmath>
+
+static constexpr int EVAL_INTERVAL_MS = 250;
+
+static constexpr double HEADROOM     = 1.2;     // yüzdelik üstüne pay
+static constexpr double HEADROOM_MS  = 5.0;
+static constexpr double LATE_SPIKE   = 0.002;   // %0.2 geç paket -> büyü
+static constexpr double SPIKE_GROWTH = 1.3;
+static constexpr int64_t CALM_MS     = 3000;    // küçülmeden önce sakinlik
+static constexpr int64_t SHRINK_EVERY_MS = 1000;
+static constexpr double SHRINK_STEP  = 0.10;
+static constexpr int MIN_CHANGE_MS   = 5;       // histerezis
+
+DelayTracker::DelayTracker(uint32_t clock_rate, int window_ms)
+: clock_rate_(clock_rate), window_ms_(window_ms) {}
+
+void DelayTracker::on_packet(uint32_t rtp_ts, uint64_t arrival_ns) {
+  const int64_t now_ms = static_cast<int64_t>(arrival_ns / 1000000ULL);
+  if (!started_) {
+    started_ = true;
+    last_ts_ = rtp_ts;
+    ext_ts_ = rtp_ts;
+    next_eval_ms_ = now_ms + EVAL_INTERVAL_MS;
+  } else {
+    ext_ts_ += static_cast<int32_t>(rtp_ts - last_ts_);
+    last_ts_ = rtp_ts;
+  }
+
+  const double transit = static_cast<double>(arrival_ns) / 1e6 - ext_ts_ * 1000.0 / clock_rate_;
+  const int64_t start = now_ms - now_ms % BUCKET_MS;
+  if (buckets_.empty() || buckets_.back().start_ms != start) {
+    Bucket b;
+    if (!spare_.empty()) { b = std::move(spare_.back()); spare_.pop_back(); }
+    b.start_ms = start;
+    b.seen = 0;
+    b.min_transit = transit;
+    b.transit_ms.clear();
+    b.transit_ms.reserve(BUCKET_CAP);
+    buckets_.push_back(std::move(b));
+  }
+  Bucket& b = buckets_.back();
+  b.min_transit = std::min(b.min_transit, transit);
+  if (b.transit_ms.size() < BUCKET_CAP) {
+    b.transit_ms.push_back(transit);
+  } else {
+    // rezervuar: kovanın her paketi eşit olasılıkla örnekte (xorshift64)
+    rng_ ^= rng_ << 13; rng_ ^= rng_ >> 7; rng_ ^= rng_ << 17;
+    const uint64_t j = rng_ % (b.seen + 1);
+    if (j < BUCKET_CAP) b.transit_ms[j] = transit;
+  }
+  ++b.seen;
+
+  if (now_ms >= next_eval_ms_) {
+    evaluate(now_ms);
+    next_eval_ms_ = now_ms + EVAL_INTERVAL_MS;
+  }
+}
+
+void DelayTracker::reset() {
+  started_ = false;
+  while (!buckets_.empty()) { spare_.push_back(std::move(buckets_.front())); buckets_.pop_front(); }
+  pct_ms_ = 0.0;
+}
+
+void DelayTracker::evaluate(int64_t now_ms) {
+  // kova, son paketi bile pencere dışında kalınca düşer
+  while (!buckets_.empty() && now_ms - (buckets_.front().start_ms + BUCKET_MS) > window_ms_) {
+    spare_.push_back(std::move(buckets_.front()));
+    buckets_.pop_front();
+  }
+  if (buckets_.empty()) return;
+
+  // pencere içindeki en hızlı paket referans: saat kayması pencereyle birlikte izlenir
+  double min_transit = buckets_.front().min_transit;
+  double total = 0;
+  for (const auto& b : buckets_) { min_transit = std::min(min_transit, b.min_transit); total += b.seen; }
+
+  scratch_.clear();
+  for (const auto& b : buckets_) {
+    const double w = static_cast<double>(b.seen) / b.transit_ms.size();
+    for (double t : b.transit_ms) scratch_.emplace_back(t - min_transit, w);
+  }
+  std::sort(scratch_.begin(), scratch_.end());
+  const double want = pct_ * total;
+  double acc = 0;
+  double v = scratch_.back().first;
+  for (const auto& s : scratch_) {
+    acc += s.second;
+    if (acc >= want) { v = s.first; break; }
+  }
+  pct_ms_.store(v, std::memory_order_relaxed);
+}
+
+PlayoutDelay::PlayoutDelay(int min_ms, int max_ms, int start_ms)
+: min_ms_(min_ms), max_ms_(max_ms),
+  target_(std::clamp(start_ms, min_ms, max_ms)), applied_(static_cast<int>(target_)) {}
+
+int PlayoutDelay::update(double pct_ms, uint64_t late, uint64_t delivered, int64_t now_ms) {
+  if (!have_prev_) {
+    have_prev_ = true;
+    prev_late_ = late; prev_delivered_ = delivered;
+    last_spike_ms_ = last_shrink_ms_ = now_ms;
+    return 0;
+  }
+  const uint64_t d_late = late - prev_late_;
+  const uint64_t d_total = (delivered - prev_delivered_) + d_late;
+  prev_late_ = late; prev_delivered_ = delivered;
+  late_rate_ = d_total ? static_cast<double>(d_late) / d_total : 0.0;
+
+  const double desired = pct_ms * HEADROOM + HEADROOM_MS;
+  if (late_rate_ > LATE_SPIKE) {
+    target_ = std::max(desired, target_ * SPIKE_GROWTH);
+    last_spike_ms_ = now_ms;
+  } else if (desired > target_) {
+    target_ = desired;
+    last_spike_ms_ = now_ms;
+  } else if (now_ms - last_spike_ms_ >= CALM_MS && now_ms - last_shrink_ms_ >= SHRINK_EVERY_MS) {
+    target_ = std::max(desired, target_ * (1.0 - SHRINK_STEP));
+    last_shrink_ms_ = now_ms;
+  }
+  target_ = std::clamp(target_, static_cast<double>(min_ms_), static_cast<double>(max_ms_));
+
+  const int next = static_cast<int>(std::lround(target_));
+  if (std::abs(next - applied_) < MIN_CHANGE_MS) return 0;
+  applied_ = next;
+  return applied_;
+}
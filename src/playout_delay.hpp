@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+// Paket geliş gecikmesi değişiminin kayan penceredeki yüzdeliği.
+// transit = varış - RTP zamanı (sabit ofset önemsiz); göreli gecikme = transit - pencere min'i.
+// Pencere zamana göre kovalara bölünür ve kova kova düşer; yüksek paket hızında her kova sınırlı
+// bir rezervuar örneği tutar (ağırlığı kovanın paket sayısı), yüzdelik tüm pencereyi kapsar.
+// on_packet() tek streaming thread'inden çağrılır; percentile_ms() atomik okunur.
+class DelayTracker {
+ public:
+  explicit DelayTracker(uint32_t clock_rate = 90000, int window_ms = 5000);
+
+  void set_percentile(double p) { pct_ = p; }   // start öncesi
+  void on_packet(uint32_t rtp_ts, uint64_t arrival_ns);
+  void reset();   // akış yokken (yeni oturum)
+
+  double percentile_ms() const { return pct_ms_.load(std::memory_order_relaxed); }
+
+  static constexpr int BUCKET_MS = 250;
+  static constexpr size_t BUCKET_CAP = 1024;   // kova başına örnek
+
+ private:
+  void evaluate(int64_t now_ms);
+
+  struct Bucket {
+    int64_t start_ms = 0;
+    uint64_t seen = 0;                   // kovaya düşen paket sayısı
+    double min_transit = 0;              // kesin (örneklemeden bağımsız)
+    std::vector<double> transit_ms;      // en fazla BUCKET_CAP (rezervuar)
+  };
+
+  const uint32_t clock_rate_;
+  const int window_ms_;
+  double pct_ = 0.99;
+
+  bool started_ = false;
+  uint32_t last_ts_ = 0;
+  int64_t ext_ts_ = 0;
+  int64_t next_eval_ms_ = 0;
+
+  std::deque<Bucket> buckets_;
+  std::vector<Bucket> spare_;            // düşen kovaların belleği yeniden kullanılır
+  uint64_t rng_ = 0x9e3779b97f4a7c15ULL;
+  std::vector<std::pair<double, double>> scratch_;   // (göreli gecikme, ağırlık)
+
+  std::atomic<double> pct_ms_{0.0};
+};
+
+// Alıcı tamponu derinliği: yüzdelik + geç paket oranına göre.
+//  - büyüme hemen (geç paket görülünce 1.3x), küçülme yavaş (3 sn sakinlikten sonra
+//    saniyede en fazla %10).
+class PlayoutDelay {
+ public:
+  PlayoutDelay(int min_ms, int max_ms, int start_ms);
+
+  // late/delivered kümülatif sayaçlar. Yeni derinlik uygulanmalıysa ms döner, değilse 0.
+  int update(double pct_ms, uint64_t late, uint64_t delivered, int64_t now_ms);
+
+  int current_ms() const { return applied_; }
+  double late_rate() const { return late_rate_; }
+
+ private:
+  const int min_ms_, max_ms_;
+  double target_;
+  int applied_;
+
+  bool have_prev_ = false;
+  uint64_t prev_late_ = 0, prev_delivered_ = 0;
+  int64_t last_spike_ms_ = 0, last_shrink_ms_ = 0;
+  double late_rate_ = 0;
+};
@@ -0,0 +1,106 @@
+#include "rate_control.hpp"
+#include <algorithm>
+#include <cmath>
+
+static constexpr int64_t MIN_RTT_WINDOW_MS = 10000;
+static constexpr size_t  TREND_SAMPLES     = 20;
+static constexpr double  QDELAY_OVERUSE_MS = 25.0;
+static constexpr double  QDELAY_HARD_MS    = 150.0;
+static constexpr double  LOSS_HIGH         = 0.10;
+static constexpr double  LOSS_LOW          = 0.02;
+static constexpr double  INCREASE_PER_SEC  = 0.08;
+static constexpr int64_t HOLD_AFTER_DECREASE_MS = 1000;
+static constexpr double  APPLY_HYSTERESIS  = 0.03;
+
+RateController::RateController(int min_kbps, int max_kbps, int start_kbps)
+: min_kbps_(min_kbps), max_kbps_(std::max(min_kbps, max_kbps)),
+  target_(std::clamp(start_kbps, min_kbps_, max_kbps_)), applied_(static_cast<int>(target_)) {}
+
+void RateController::on_rtt(double rtt_ms, int64_t now_ms) {
+  std::lock_guard<std::mutex> lk(mu_);
+  srtt_ = srtt_ > 0 ? 0.8 * srtt_ + 0.2 * rtt_ms : rtt_ms;
+  rtts_.emplace_back(now_ms, srtt_);
+  while (rtts_.size() > 1 && now_ms - rtts_.front().first > MIN_RTT_WINDOW_MS) rtts_.pop_front();
+
+  min_rtt_ = rtt_ms;
+  for (const auto& s : rtts_) min_rtt_ = std::min(min_rtt_, s.second);
+}
+
+double RateController::trend_slope() const {
+  const size_t n = std::min(rtts_.size(), TREND_SAMPLES);
+  if (n < 4) return 0;
+  auto first = rtts_.end() - static_cast<long>(n);
+  double mx = 0, my = 0;
+  for (auto it = first; it != rtts_.end(); ++it) { mx += it->first; my += it->second; }
+  mx /= n; my /= n;
+  double num = 0, den = 0;
+  for (auto it = first; it != rtts_.end(); ++it) {
+    num += (it->first - mx) * (it->second - my);
+    den += (it->first - mx) * (it->first - mx);
+  }
+  return den > 0 ? num / den * 1000.0 : 0;
+}
+
+int RateController::on_report(const RateReport& r, int64_t now_ms) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (!have_prev_ || r.received < prev_.received || r.bytes < prev_.bytes) {   // ilk rapor / karşı taraf yeniden başladı
+    prev_ = r; prev_ms_ = now_ms; have_prev_ = true;
+    return 0;
+  }
+  const int64_t dt = now_ms - prev_ms_;
+  if (dt <= 0) return 0;
+
+  const double drecv = static_cast<double>(r.received - prev_.received);
+  const double dlost = r.lost >= prev_.lost ? static_cast<double>(r.lost - prev_.lost) : 0.0;
+  const double recv_kbps = static_cast<double>(r.bytes - prev_.bytes) * 8.0 / static_cast<double>(dt);
+  prev_ = r; prev_ms_ = now_ms;
+  loss_ = (drecv + dlost) > 0 ? dlost / (drecv + dlost) : 0.0;
+
+  const double qdelay = srtt_ > 0 ? srtt_ - min_rtt_ : 0.0;
+  const bool overuse = qdelay > QDELAY_HARD_MS || (qdelay > QDELAY_OVERUSE_MS && trend_slope() > 0);
+  // bir azaltmanın etkisi ancak bir RTT sonra görünür; üst üste kesme
+  const bool may_decrease = now_ms - last_decrease_ms_ > static_cast<int64_t>(srtt_) + 100;
+
+  if (overuse || loss_ > LOSS_HIGH) {
+    if (may_decrease) {
+      if (overuse) target_ = 0.85 * (recv_kbps > 0 ? std::min(target_, recv_kbps) : target_);
+      else         target_ *= 1.0 - 0.5 * loss_;
+      last_decrease_ms_ = now_ms;
+    }
+    hold_until_ms_ = now_ms + HOLD_AFTER_DECREASE_MS;
+  } else if (loss_ < LOSS_LOW && now_ms >= hold_until_ms_) {
+    double next = target_ * std::pow(1.0 + INCREASE_PER_SEC, dt / 1000.0);
+    // gönderilen hız hedefin çok altındaysa (durağan sahne) boşuna büyütme
+    if (recv_kbps > 0) next = std::min(next, std::max(target_, 1.5 * recv_kbps));
+    target_ = next;
+  }
+  target_ = std::clamp(target_, static_cast<double>(min_kbps_), static_cast<double>(max_kbps_));
+
+  const int t = static_cast<int>(target_);
+  if (std::abs(t - applied_) < APPLY_HYSTERESIS * applied_) return 0;
+  applied_ = t;
+  return t;
+}
+
+int RateController::set_max_kbps(int max_kbps) {
+  std::lock_guard<std::mutex> lk(mu_);
+  max_kbps_ = std::max(min_kbps_, max_kbps);
+  target_ = std::min(target_, static_cast<double>(max_kbps_));
+  applied_ = static_cast<int>(target_);
+  return applied_;
+}
+
+int RateController::target_kbps() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return static_cast<int>(target_);
+}
+
+double RateController::queue_delay_ms() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return srtt_ > 0 ? srtt_ - min_rtt_ : 0.0;
+}
+
+double RateController::loss() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return loss_;
+}
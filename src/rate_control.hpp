@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+// Alıcı geri bildirimi (kümülatif sayaçlar; fark gönderici tarafında alınır).
+struct RateReport {
+  uint64_t received = 0;   // jitterbuffer'dan çıkan paketler
+  uint64_t lost = 0;
+  uint64_t bytes = 0;      // alınan RTP baytları
+  double   jitter_ms = 0;
+};
+
+// Delay + loss based sender-side congestion control (GCC-style).
+//  - delay: queuing delay = smoothed RTT - windowed min RTT; overuse when it is
+//    above threshold and still rising (trendline slope) -> 0.85 x receive rate.
+//  - loss:  >10% loss cuts by (1 - loss/2), <2% allows multiplicative increase.
+class RateController {
+ public:
+  RateController(int min_kbps, int max_kbps, int start_kbps);
+
+  void on_rtt(double rtt_ms, int64_t now_ms);
+  // Yeni hedef uygulanmalıysa kbps döner, değilse 0.
+  int on_report(const RateReport& r, int64_t now_ms);
+
+  // canlı yeniden yapılandırma: üst sınır değişir; hedef yalnızca yeni sınırın üstündeyse
+  // kırpılır (yükselişte denetleyici normal hızıyla tırmanır). Uygulanacak hedef döner.
+  int set_max_kbps(int max_kbps);
+
+  int target_kbps() const;
+  double queue_delay_ms() const;
+  double loss() const;
+
+ private:
+  double trend_slope() const;   // ms RTT per second
+
+  mutable std::mutex mu_;
+  const int min_kbps_;
+  int max_kbps_;
+  double target_;
+  int applied_;
+
+  std::deque<std::pair<int64_t,double>> rtts_;   // (t, rtt) for min/trend
+  double srtt_ = 0, min_rtt_ = 0;
+
+  bool have_prev_ = false;
+  RateReport prev_{};
+  int64_t prev_ms_ = 0;
+  int64_t hold_until_ms_ = 0;
+  int64_t last_decrease_ms_ = 0;
+  double loss_ = 0;
+};
@@ -0,0 +1,91 @@
+#include "recording.hpp"
+#include <gst/app/gstappsink.h>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+
+GstElement* add_record_branch(GstElement* pipe, GstElement* tee, const Args& a, Codec codec) {
+  const CodecInfo& ci = codec_info(codec);
+  std::string fmt = a.record_format;
+  if (fmt == "ts" && codec != Codec::H264 && codec != Codec::H265) {
+    std::cerr << "[rec] TS " << ci.name << " taşımıyor, mkv\n";
+    fmt = "mkv";
+  }
+  GstElement* q = gst_element_factory_make("queue", "rec_q"); CHECK_ELEM(q, "queue");
+  set_int(q, "max-size-buffers", 0); set_int(q, "max-size-bytes", 0); set_int(q, "leaky", 2);
+  g_object_set(G_OBJECT(q), "max-size-time", (guint64)(2 * GST_SECOND), NULL);
+
+  // mp4/mkv avc/hvc1 ister; canlı dalın byte-stream'ini kaydın kendi ayrıştırıcısı dönüştürür
+  GstElement* parse = nullptr;
+  if (ci.parse) { parse = gst_element_factory_make(ci.parse, "rec_parse"); CHECK_ELEM(parse, ci.parse); }
+
+  const char* mux_name = fmt == "mp4" ? "mp4mux" : fmt == "ts" ? "mpegtsmux" : "matroskamux";
+  GstElement* mux = gst_element_factory_make(mux_name, "rec_mux"); CHECK_ELEM(mux, mux_name);
+  if (fmt == "mp4") { set_int(mux, "fragment-duration", 1000); set_bool(mux, "streamable", TRUE); }
+  else if (fmt == "mkv") set_bool(mux, "streamable", TRUE);
+
+  GstElement* sink = gst_element_factory_make("appsink", "rec_sink"); CHECK_ELEM(sink, "appsink");
+  set_bool(sink, "sync", FALSE); set_bool(sink, "async", FALSE);
+  set_int(sink, "max-buffers", 0); set_bool(sink, "drop", FALSE);
+
+  GstElement* split = gst_element_factory_make("splitmuxsink", "rec_split"); CHECK_ELEM(split, "splitmuxsink");
+  g_object_set(G_OBJECT(split), "muxer", mux, "sink", sink,
+               "max-size-time", (guint64)a.record_segment_s * GST_SECOND, NULL);
+  if (!add_chain(pipe, {tee, q, parse, split})) return nullptr;
+  return split;
+}
+
+static GstFlowReturn rec_new_sample(GstAppSink* sink, gpointer user_data) {
+  auto* rec = static_cast<RecordTap*>(user_data);
+  GstSample* sample = gst_app_sink_pull_sample(sink);
+  if (!sample) return GST_FLOW_EOS;
+  GstMapInfo m;
+  GstBuffer* b = gst_sample_get_buffer(sample);
+  if (b && gst_buffer_map(b, &m, GST_MAP_READ)) {
+    rec->writer.write(m.data, m.size);   // yalnızca kopya; disk I/O'su yazıcının thread'inde
+    gst_buffer_unmap(b, &m);
+  }
+  gst_sample_unref(sample);
+  return GST_FLOW_OK;
+}
+
+std::unique_ptr<RecordTap> attach_recorder(GstElement* pipe, const Args& a, std::string tag) {
+  GstElement* split = gst_bin_get_by_name(GST_BIN(pipe), "rec_split");
+  if (!split) return nullptr;
+  GstElement* mux  = gst_bin_get_by_name(GST_BIN(pipe), "rec_mux");
+  GstElement* sink = gst_bin_get_by_name(GST_BIN(pipe), "rec_sink");
+
+  std::replace(tag.begin(), tag.end(), ':', '-');
+  char stamp[32] = "";
+  const std::time_t now = std::time(nullptr);
+  std::tm tm{};
+  localtime_r(&now, &tm);
+  std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm);
+
+  auto rec = std::make_unique<RecordTap>((size_t)a.record_buffer_mb << 20);
+  rec->prefix = a.record_dir + "/nova-" + tag + "-" + stamp;
+  const std::string mux_name = mux ? gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(gst_element_get_factory(mux))) : "";
+  rec->ext = mux_name == "mp4mux" ? "mp4" : mux_name == "mpegtsmux" ? "ts" : "mkv";
+
+  // yeni parça: önceki dosyanın tüm verisi (muxer EOS'u) appsink'ten geçmiş olur
+  g_signal_connect(split, "format-location", G_CALLBACK(+[] (GstElement*, guint id, gpointer d) -> gchar* {
+    auto* r = static_cast<RecordTap*>(d);
+    char n[16];
+    snprintf(n, sizeof(n), "-%05u.", id);
+    const std::string path = r->prefix + n + r->ext;
+    r->writer.open(path);
+    return g_strdup(path.c_str());
+  }), rec.get());
+  GstAppSinkCallbacks cbs{};
+  cbs.new_sample = rec_new_sample;
+  cbs.eos = +[](GstAppSink*, gpointer d) { static_cast<RecordTap*>(d)->writer.close(); };
+  gst_app_sink_set_callbacks(GST_APP_SINK(sink), &cbs, rec.get(), nullptr);
+  std::cout << "[rec] " << tag << " -> " << rec->prefix << "-NNNNN." << rec->ext
+            << " (" << a.record_segment_s << " sn parçalar)\n";
+
+  gst_object_unref(sink);
+  if (mux) gst_object_unref(mux);
+  gst_object_unref(split);
+  return rec;
+}
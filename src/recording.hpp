@@ -0,0 +1,26 @@
+#pragma once
+#include "common.hpp"
+#include "disk_writer.hpp"
+#include "engine.hpp"
+#include <memory>
+#include <string>
+
+// Kayıt dalı: yeniden kodlamasız arşiv.
+// Kodlanmış akış (gönderici: katman 0'ın parse çıkışı; alıcı: depay çıkışı) bir tee'den
+// sızdıran kuyruk -> [parse] -> splitmuxsink(muxer -> appsink) dalına ayrılır. splitmuxsink
+// süre dolunca ilk anahtar karede yeni dosyaya geçer (IDR istemez, canlı akış etkilenmez);
+// muxer geri sarmasız çalışır (akışlı MKV, parçalı MP4, TS). appsink baytları DiskWriter'ın
+// I/O thread'ine verir. Disk yavaşsa DiskWriter, muxer yavaşsa kuyruk veri atar: tee beklemez.
+GstElement* add_record_branch(GstElement* pipe, GstElement* tee, const Args& a, Codec codec);
+
+// splitmuxsink'in appsink'i -> DiskWriter
+struct RecordTap {
+  DiskWriter writer;
+  std::string prefix;   // <dizin>/nova-<etiket>-<başlangıç>
+  std::string ext;
+  explicit RecordTap(size_t max_bytes) : writer(max_bytes) {}
+};
+
+// build_sender/build_receiver kayıt dalı eklediyse; tag dosya adına girer ("tx", "rx", eş adresi).
+// Dönen nesne boru hattından uzun yaşamalı (NULL'a alındıktan sonra yok edilir).
+std::unique_ptr<RecordTap> attach_recorder(GstElement* pipe, const Args& a, std::string tag);
@@ -0,0 +1,38 @@
+#include "rtp_stats.hpp"
+
+static constexpr int MAX_DROPOUT = 3000;
+
+void RtpRxStats::on_packet(uint16_t seq, uint32_t rtp_ts, uint64_t arrival_ns, size_t bytes) {
+  packets_.fetch_add(1, std::memory_order_relaxed);
+  bytes_.fetch_add(bytes, std::memory_order_relaxed);
+
+  const int64_t arrival = static_cast<int64_t>(arrival_ns / 1000 * clock_rate_ / 1000000);
+  const int64_t transit = arrival - static_cast<int64_t>(rtp_ts);
+
+  if (!started_) {
+    started_ = true;
+    max_seq_ = seq;
+    prev_transit_ = transit;
+  } else {
+    const uint16_t udelta = static_cast<uint16_t>(seq - max_seq_);
+    if (udelta < MAX_DROPOUT) {
+      if (seq < max_seq_) cycles_ += 1u << 16;   // wrap
+      max_seq_ = seq;
+    }
+    // J += (|D| - J) / 16
+    int64_t d = transit - prev_transit_;
+    prev_transit_ = transit;
+    if (d < 0) d = -d;
+    jitter_acc_ += static_cast<uint32_t>(d) - ((jitter_acc_ + 8) >> 4);
+  }
+
+  ext_max_.store(cycles_ | max_seq_, std::memory_order_relaxed);
+  jitter_q4_.store(jitter_acc_, std::memory_order_relaxed);
+}
+
+void RtpRxStats::reset() {
+  started_ = false;
+  max_seq_ = 0; cycles_ = 0;
+  prev_transit_ = 0; jitter_acc_ = 0;
+  ext_max_ = 0; jitter_q4_ = 0; packets_ = 0; bytes_ = 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// RFC 3550 A.1/A.8: extended highest sequence and interarrival jitter.
+// on_packet() tek streaming thread'inden çağrılır; okuyucular atomik alanları okur.
+class RtpRxStats {
+ public:
+  explicit RtpRxStats(uint32_t clock_rate = 90000) : clock_rate_(clock_rate) {}
+
+  void on_packet(uint16_t seq, uint32_t rtp_ts, uint64_t arrival_ns, size_t bytes);
+  void reset();   // akış yokken (yeni oturum)
+
+  uint32_t ext_highest_seq() const { return ext_max_.load(std::memory_order_relaxed); }
+  uint32_t jitter() const          { return jitter_q4_.load(std::memory_order_relaxed) >> 4; }  // RTP units
+  double   jitter_ms() const       { return jitter() * 1000.0 / clock_rate_; }
+  uint64_t packets() const         { return packets_.load(std::memory_order_relaxed); }
+  uint64_t bytes() const           { return bytes_.load(std::memory_order_relaxed); }
+
+ private:
+  const uint32_t clock_rate_;
+  bool     started_ = false;
+  uint16_t max_seq_ = 0;
+  uint32_t cycles_ = 0;
+  int64_t  prev_transit_ = 0;
+  uint32_t jitter_acc_ = 0;   // jitter * 16 (A.8 fixed point)
+
+  std::atomic<uint32_t> ext_max_{0};
+  std::atomic<uint32_t> jitter_q4_{0};
+  std::atomic<uint64_t> packets_{0};
+  std::atomic<uint64_t> bytes_{0};
+};
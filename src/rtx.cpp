@@ -0,0 +1,47 @@
+#include "rtx.hpp"
+#include <cstdio>
+#include <cstring>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+RtxHistory::RtxHistory() : slots_(new Slot[SLOTS]) {}
+
+void RtxHistory::store(uint16_t seq, const uint8_t* data, size_t len) {
+  if (len == 0 || len > MAX_PKT) return;
+  Slot& s = slots_[seq & (SLOTS - 1)];
+  std::lock_guard<std::mutex> lk(mu_);
+  s.seq = seq;
+  s.len = static_cast<uint16_t>(len);
+  memcpy(s.data, data, len);
+}
+
+size_t RtxHistory::lookup(uint16_t seq, uint8_t* out) const {
+  const Slot& s = slots_[seq & (SLOTS - 1)];
+  std::lock_guard<std::mutex> lk(mu_);
+  if (!s.len || s.seq != seq) return 0;   // üzerine yazılmış
+  memcpy(out, s.data, s.len);
+  return s.len;
+}
+
+RtxServer::RtxServer(const std::string& peer_ip, int video_port) {
+  fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (fd_ < 0) perror("socket rtx");
+  peer_.sin_family = AF_INET;
+  peer_.sin_port = htons(video_port);
+  inet_pton(AF_INET, peer_ip.c_str(), &peer_.sin_addr);
+}
+
+RtxServer::~RtxServer() { if (fd_ >= 0) close(fd_); }
+
+void RtxServer::on_nack(const uint16_t* seqs, size_t n, int budget_ms, double rtt_ms, const sockaddr_in* to) {
+  const sockaddr_in* dst = to ? to : &peer_;
+  // NACK buraya rtt/2'de geldi, paket bir rtt/2 daha yolda olacak
+  if (rtt_ms >= budget_ms) { skipped_ += n; return; }
+  uint8_t pkt[RtxHistory::MAX_PKT];
+  for (size_t i = 0; i < n; ++i) {
+    size_t len = hist_.lookup(seqs[i], pkt);
+    if (!len) { ++missing_; continue; }
+    if (sendto(fd_, pkt, len, 0, (const sockaddr*)dst, sizeof(*dst)) > 0) ++resent_;
+  }
+}
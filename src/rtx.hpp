@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <netinet/in.h>
+
+// Gönderilen RTP paketlerinin sınırlı, önceden ayrılmış geçmişi; NACK'lerde
+// aynı paket (aynı SSRC/seq) tekrar gönderilir, alıcı jitterbuffer'ı yerine oturtur.
+class RtxHistory {
+ public:
+  static constexpr size_t SLOTS   = 2048;   // 2^n; 18 Mbps @1200B ~1 s
+  static constexpr size_t MAX_PKT = 1500;
+
+  RtxHistory();
+
+  // sender streaming thread
+  void store(uint16_t seq, const uint8_t* data, size_t len);
+  // NACK thread; paket hâlâ ringdeyse kopyalar
+  size_t lookup(uint16_t seq, uint8_t* out) const;
+
+ private:
+  struct Slot {
+    uint16_t seq = 0;
+    uint16_t len = 0;     // 0 = boş
+    uint8_t  data[MAX_PKT];
+  };
+  std::unique_ptr<Slot[]> slots_;
+  mutable std::mutex mu_;
+};
+
+class RtxServer {
+ public:
+  RtxServer(const std::string& peer_ip, int video_port);
+  ~RtxServer();
+
+  RtxHistory& history() { return hist_; }
+
+  // budget_ms: NACK gönderildiğinde alıcıda oynatma anına kalan süre;
+  // RTT bunu aşıyorsa paket geç kalacağından gönderilmez. to: çok eşli modda isteyen eşin video adresi
+  void on_nack(const uint16_t* seqs, size_t n, int budget_ms, double rtt_ms, const sockaddr_in* to = nullptr);
+
+  uint64_t resent() const  { return resent_.load(); }
+  uint64_t skipped() const { return skipped_.load(); }
+  uint64_t missing() const { return missing_.load(); }
+
+ private:
+  RtxHistory hist_;
+  int fd_ = -1;
+  sockaddr_in peer_{};
+  std::atomic<uint64_t> resent_{0}, skipped_{0}, missing_{0};
+};
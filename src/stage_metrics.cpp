@@ -0,0 +1,310 @@
+#include "stage_metrics.hpp"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+
+uint64_t metrics_now_ns() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static constexpr auto RLX = std::memory_order_relaxed;
+
+StageStats::StageStats(std::string pipeline, std::string stage, std::string kind)
+: pipeline_(std::move(pipeline)), stage_(std::move(stage)), kind_(std::move(kind)),
+  shards_(new Shard[METRIC_SHARDS]), pending_(new Pending[PENDING]) {}
+
+StageStats::Shard& StageStats::shard() {
+  // thread başına sabit indeks; shard sayısından fazla thread varsa paylaşılır (atomik, yine doğru)
+  static std::atomic<unsigned> next{0};
+  thread_local unsigned idx = next.fetch_add(1, RLX) % METRIC_SHARDS;
+  return shards_[idx];
+}
+
+static uint64_t mix(uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  return k;
+}
+
+void StageStats::on_in(uint64_t key, uint64_t now_ns, uint64_t bytes, uint32_t buffers) {
+  Shard& s = shard();
+  s.in_buffers.fetch_add(buffers, RLX);
+  s.in_bytes.fetch_add(bytes, RLX);
+  if (key == NO_KEY) return;
+  Pending& p = pending_[mix(key) % PENDING];
+  p.key.store(NO_KEY, RLX);
+  p.t_ns.store(now_ns, std::memory_order_release);
+  p.key.store(key, std::memory_order_release);
+}
+
+void StageStats::on_out(uint64_t key, uint64_t now_ns, uint64_t bytes, uint32_t buffers) {
+  Shard& s = shard();
+  s.out_buffers.fetch_add(buffers, RLX);
+  s.out_bytes.fetch_add(bytes, RLX);
+  if (key == NO_KEY) return;
+  Pending& p = pending_[mix(key) % PENDING];
+  if (p.key.load(std::memory_order_acquire) != key) return;
+  const uint64_t t0 = p.t_ns.load(std::memory_order_acquire);
+  // ilk çıkan eşleşme sayılır (paketleyici bir girişten çok çıkış üretir)
+  uint64_t expected = key;
+  if (!p.key.compare_exchange_strong(expected, NO_KEY, RLX)) return;
+  if (now_ns < t0) return;
+
+  const uint64_t dt = now_ns - t0;
+  const uint64_t us = dt / 1000;
+  size_t b = 0;
+  while (b < LATENCY_BOUNDS_US.size() && us > LATENCY_BOUNDS_US[b]) ++b;
+  s.buckets[b].fetch_add(1, RLX);
+  s.lat_count.fetch_add(1, RLX);
+  s.lat_sum_ns.fetch_add(dt, RLX);
+}
+
+StageStats::Snapshot StageStats::snapshot() const {
+  Snapshot r;
+  for (size_t i = 0; i < METRIC_SHARDS; ++i) {
+    const Shard& s = shards_[i];
+    r.in_buffers += s.in_buffers.load(RLX);
+    r.in_bytes += s.in_bytes.load(RLX);
+    r.out_buffers += s.out_buffers.load(RLX);
+    r.out_bytes += s.out_bytes.load(RLX);
+    r.lat_count += s.lat_count.load(RLX);
+    r.lat_sum_ns += s.lat_sum_ns.load(RLX);
+    for (size_t b = 0; b < LATENCY_BUCKETS; ++b) r.buckets[b] += s.buckets[b].load(RLX);
+  }
+  r.level_buffers = level_buffers_.load(RLX);
+  r.level_time_ns = level_time_ns_.load(RLX);
+  r.dropped = dropped_.load(RLX);
+  return r;
+}
+
+// kova üst sınırı (son kova için son sınır); kaba ama sabit maliyetli
+double StageStats::Snapshot::percentile_us(double p) const {
+  uint64_t total = 0;
+  for (uint64_t c : buckets) total += c;
+  if (!total) return 0.0;
+  const uint64_t rank = static_cast<uint64_t>(p * total + 0.5);
+  uint64_t cum = 0;
+  for (size_t b = 0; b < LATENCY_BUCKETS; ++b) {
+    cum += buckets[b];
+    if (cum >= rank && cum) return LATENCY_BOUNDS_US[std::min(b, LATENCY_BOUNDS_US.size() - 1)];
+  }
+  return LATENCY_BOUNDS_US.back();
+}
+
+void RollingHistogram::record(int64_t value_us, uint64_t now_ns) {
+  const uint64_t sec = now_ns / 1000000000ULL;
+  Slot& s = slots_[sec % (WINDOW_S + 1)];
+  if (s.sec.load(RLX) != sec) {
+    s.count.store(0, RLX); s.negative.store(0, RLX); s.sum_us.store(0, RLX);
+    s.min_us.store(value_us, RLX); s.max_us.store(value_us, RLX);
+    for (auto& b : s.buckets) b.store(0, RLX);
+    s.sec.store(sec, std::memory_order_release);
+  }
+  size_t b = 0;
+  if (value_us < 0) s.negative.fetch_add(1, RLX);
+  else while (b < DELAY_BOUNDS_US.size() && (uint64_t)value_us > DELAY_BOUNDS_US[b]) ++b;
+  s.buckets[b].fetch_add(1, RLX);
+  s.count.fetch_add(1, RLX);
+  s.sum_us.fetch_add(value_us, RLX);
+  if (value_us < s.min_us.load(RLX)) s.min_us.store(value_us, RLX);   // tek yazar
+  if (value_us > s.max_us.load(RLX)) s.max_us.store(value_us, RLX);
+  total_count_.fetch_add(1, RLX);
+  total_sum_us_.fetch_add(value_us, RLX);
+}
+
+void RollingHistogram::reset() {
+  for (auto& s : slots_) s.sec.store(UINT64_MAX, RLX);
+  total_count_.store(0, RLX);
+  total_sum_us_.store(0, RLX);
+}
+
+RollingHistogram::Snapshot RollingHistogram::snapshot(uint64_t now_ns) const {
+  Snapshot r;
+  const uint64_t now_sec = now_ns / 1000000000ULL;
+  bool first = true;
+  for (const auto& s : slots_) {
+    const uint64_t sec = s.sec.load(std::memory_order_acquire);
+    if (sec == UINT64_MAX || sec > now_sec || now_sec - sec > WINDOW_S) continue;
+    const uint64_t n = s.count.load(RLX);
+    if (!n) continue;
+    r.count += n;
+    r.negative += s.negative.load(RLX);
+    r.sum_us += (double)s.sum_us.load(RLX);
+    const int64_t lo = s.min_us.load(RLX), hi = s.max_us.load(RLX);
+    r.min_us = first ? lo : std::min(r.min_us, lo);
+    r.max_us = first ? hi : std::max(r.max_us, hi);
+    first = false;
+    for (size_t b = 0; b < DELAY_BUCKETS; ++b) r.buckets[b] += s.buckets[b].load(RLX);
+  }
+  return r;
+}
+
+double RollingHistogram::Snapshot::percentile_us(double p) const {
+  uint64_t total = 0;
+  for (uint64_t c : buckets) total += c;
+  if (!total) return 0.0;
+  const double rank = p * total;
+  uint64_t cum = 0;
+  for (size_t b = 0; b < DELAY_BUCKETS; ++b) {
+    if (!buckets[b] || cum + buckets[b] < rank) { cum += buckets[b]; continue; }
+    const double lo = b ? DELAY_BOUNDS_US[b - 1] : 0.0;
+    const double hi = b < DELAY_BOUNDS_US.size() ? (double)DELAY_BOUNDS_US[b] : std::max<double>(lo, max_us);
+    const double v = lo + (hi - lo) * (rank - cum) / buckets[b];
+    return std::clamp(v, (double)std::max<int64_t>(0, min_us), (double)std::max<int64_t>(0, max_us));
+  }
+  return (double)max_us;
+}
+
+void MetricsRegistry::add_rolling(const std::string& name, const std::string& peer, const RollingHistogram* h) {
+  rolling_.push_back({name, peer, h});
+}
+
+StageStats* MetricsRegistry::add(const std::string& pipeline, const std::string& stage, const std::string& kind) {
+  stages_.push_back(std::make_unique<StageStats>(pipeline, stage, kind));
+  return stages_.back().get();
+}
+
+static void appendf(std::string& out, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+static void appendf(std::string& out, const char* fmt, ...) {
+  char buf[512];
+  va_list ap;
+  va_start(ap, fmt);
+  const int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  if (n > 0) out.append(buf, std::min(static_cast<size_t>(n), sizeof(buf) - 1));
+}
+
+std::string MetricsRegistry::render_prometheus() const {
+  std::string out;
+  out.reserve(4096 + stages_.size() * 2048);
+  auto counter = [&](const char* name, const char* help, auto get) {
+    appendf(out, "# HELP %s %s\n# TYPE %s counter\n", name, help, name);
+    for (auto& st : stages_) {
+      const auto s = st->snapshot();
+      appendf(out, "%s{pipeline=\"%s\",stage=\"%s\",kind=\"%s\"} %llu\n", name,
+              st->pipeline().c_str(), st->stage().c_str(), st->kind().c_str(),
+              static_cast<unsigned long long>(get(s)));
+    }
+  };
+  using S = StageStats::Snapshot;
+  counter("nova_stage_in_buffers_total", "Buffers entering the stage", [](const S& s) { return s.in_buffers; });
+  counter("nova_stage_in_bytes_total", "Bytes entering the stage", [](const S& s) { return s.in_bytes; });
+  counter("nova_stage_out_buffers_total", "Buffers leaving the stage", [](const S& s) { return s.out_buffers; });
+  counter("nova_stage_out_bytes_total", "Bytes leaving the stage", [](const S& s) { return s.out_bytes; });
+
+  appendf(out, "# HELP nova_stage_dropped_total Buffers dropped inside the stage\n"
+               "# TYPE nova_stage_dropped_total counter\n");
+  for (auto& st : stages_) {
+    const auto s = st->snapshot();
+    if (s.dropped < 0) continue;
+    appendf(out, "nova_stage_dropped_total{pipeline=\"%s\",stage=\"%s\"} %lld\n",
+            st->pipeline().c_str(), st->stage().c_str(), static_cast<long long>(s.dropped));
+  }
+  appendf(out, "# HELP nova_stage_queue_level_buffers Buffers currently queued\n"
+               "# TYPE nova_stage_queue_level_buffers gauge\n");
+  for (auto& st : stages_) {
+    const auto s = st->snapshot();
+    if (s.level_buffers < 0) continue;
+    appendf(out, "nova_stage_queue_level_buffers{pipeline=\"%s\",stage=\"%s\"} %lld\n",
+            st->pipeline().c_str(), st->stage().c_str(), static_cast<long long>(s.level_buffers));
+  }
+  appendf(out, "# HELP nova_stage_queue_level_seconds Media time currently queued\n"
+               "# TYPE nova_stage_queue_level_seconds gauge\n");
+  for (auto& st : stages_) {
+    const auto s = st->snapshot();
+    if (s.level_time_ns < 0) continue;
+    appendf(out, "nova_stage_queue_level_seconds{pipeline=\"%s\",stage=\"%s\"} %.6f\n",
+            st->pipeline().c_str(), st->stage().c_str(), s.level_time_ns / 1e9);
+  }
+
+  appendf(out, "# HELP nova_stage_latency_seconds Time from stage input pad to output pad\n"
+               "# TYPE nova_stage_latency_seconds histogram\n");
+  for (auto& st : stages_) {
+    const auto s = st->snapshot();
+    if (!s.lat_count) continue;
+    uint64_t cum = 0;
+    for (size_t b = 0; b < LATENCY_BUCKETS; ++b) {
+      cum += s.buckets[b];
+      if (b < LATENCY_BOUNDS_US.size())
+        appendf(out, "nova_stage_latency_seconds_bucket{pipeline=\"%s\",stage=\"%s\",le=\"%g\"} %llu\n",
+                st->pipeline().c_str(), st->stage().c_str(), LATENCY_BOUNDS_US[b] / 1e6,
+                static_cast<unsigned long long>(cum));
+      else
+        appendf(out, "nova_stage_latency_seconds_bucket{pipeline=\"%s\",stage=\"%s\",le=\"+Inf\"} %llu\n",
+                st->pipeline().c_str(), st->stage().c_str(), static_cast<unsigned long long>(cum));
+    }
+    appendf(out, "nova_stage_latency_seconds_sum{pipeline=\"%s\",stage=\"%s\"} %.9f\n",
+            st->pipeline().c_str(), st->stage().c_str(), s.lat_sum_ns / 1e9);
+    appendf(out, "nova_stage_latency_seconds_count{pipeline=\"%s\",stage=\"%s\"} %llu\n",
+            st->pipeline().c_str(), st->stage().c_str(), static_cast<unsigned long long>(s.lat_count));
+  }
+
+  // kayan pencere: histogram kovaları kümülatif olmadığından summary (yüzdelikler son WINDOW_S sn)
+  const uint64_t now = metrics_now_ns();
+  std::string last_name;
+  for (auto& r : rolling_) {
+    if (r.name != last_name) {
+      appendf(out, "# HELP nova_%s_seconds Rolling %zu s window\n# TYPE nova_%s_seconds summary\n",
+              r.name.c_str(), RollingHistogram::WINDOW_S, r.name.c_str());
+      last_name = r.name;
+    }
+    const auto s = r.h->snapshot(now);
+    for (double q : {0.5, 0.95, 0.99})
+      appendf(out, "nova_%s_seconds{peer=\"%s\",quantile=\"%g\"} %.6f\n",
+              r.name.c_str(), r.peer.c_str(), q, s.percentile_us(q) / 1e6);
+    appendf(out, "nova_%s_seconds_sum{peer=\"%s\"} %.6f\n", r.name.c_str(), r.peer.c_str(), r.h->total_sum_us() / 1e6);
+    appendf(out, "nova_%s_seconds_count{peer=\"%s\"} %llu\n", r.name.c_str(), r.peer.c_str(),
+            static_cast<unsigned long long>(r.h->total_count()));
+  }
+  return out;
+}
+
+std::string MetricsRegistry::render_json() const {
+  std::string out = "{\n  \"t_ms\": ";
+  appendf(out, "%llu,\n  \"stages\": [", static_cast<unsigned long long>(metrics_now_ns() / 1000000ULL));
+  bool first = true;
+  for (auto& st : stages_) {
+    const auto s = st->snapshot();
+    appendf(out, "%s\n    {\"pipeline\": \"%s\", \"stage\": \"%s\", \"kind\": \"%s\", ", first ? "" : ",",
+            st->pipeline().c_str(), st->stage().c_str(), st->kind().c_str());
+    appendf(out, "\"in_buffers\": %llu, \"in_bytes\": %llu, \"out_buffers\": %llu, \"out_bytes\": %llu",
+            static_cast<unsigned long long>(s.in_buffers), static_cast<unsigned long long>(s.in_bytes),
+            static_cast<unsigned long long>(s.out_buffers), static_cast<unsigned long long>(s.out_bytes));
+    if (s.lat_count)
+      appendf(out, ", \"latency_us\": {\"count\": %llu, \"mean\": %.1f, \"p50\": %.0f, \"p99\": %.0f}",
+              static_cast<unsigned long long>(s.lat_count), s.lat_sum_ns / 1e3 / s.lat_count,
+              s.percentile_us(0.50), s.percentile_us(0.99));
+    if (s.level_buffers >= 0)
+      appendf(out, ", \"queue_level_buffers\": %lld, \"queue_level_ms\": %.1f",
+              static_cast<long long>(s.level_buffers), s.level_time_ns / 1e6);
+    if (s.dropped >= 0) appendf(out, ", \"dropped\": %lld", static_cast<long long>(s.dropped));
+    out += "}";
+    first = false;
+  }
+  out += "\n  ],\n  \"rolling\": [";
+  first = true;
+  const uint64_t now = metrics_now_ns();
+  for (auto& r : rolling_) {
+    const auto s = r.h->snapshot(now);
+    appendf(out, "%s\n    {\"name\": \"%s\", \"peer\": \"%s\", \"window_s\": %zu, \"count\": %llu, "
+                 "\"negative\": %llu", first ? "" : ",", r.name.c_str(), r.peer.c_str(), RollingHistogram::WINDOW_S,
+            static_cast<unsigned long long>(s.count), static_cast<unsigned long long>(s.negative));
+    if (s.count)
+      appendf(out, ", \"us\": {\"min\": %lld, \"mean\": %.1f, \"p50\": %.0f, \"p95\": %.0f, \"p99\": %.0f, \"max\": %lld}",
+              static_cast<long long>(s.min_us), s.mean_us(), s.percentile_us(0.50), s.percentile_us(0.95),
+              s.percentile_us(0.99), static_cast<long long>(s.max_us));
+    out += ", \"buckets_le_us\": [";
+    for (size_t b = 0; b < DELAY_BUCKETS; ++b)
+      appendf(out, "%s[%s, %llu]", b ? ", " : "",
+              b < DELAY_BOUNDS_US.size() ? std::to_string(DELAY_BOUNDS_US[b]).c_str() : "null",
+              static_cast<unsigned long long>(s.buckets[b]));
+    out += "]}";
+    first = false;
+  }
+  out += "\n  ]\n}\n";
+  return out;
+}
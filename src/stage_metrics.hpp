@@ -0,0 +1,127 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ---- aşama metrikleri ----
+// Her boru hattı aşaması (eleman) için: giriş/çıkış buffer ve bayt sayaçları, işlem süresi
+// histogramı (giriş pad'i -> çıkış pad'i, anahtar: PTS ya da RTP ts+seq), kuyruk doluluğu ve
+// düşürülen buffer'lar. Sıcak yol ayırma yapmaz ve kilitsizdir: her thread kendi shard'ına
+// relaxed atomik ekleme yapar; okuyucu shard'ları toplar.
+
+static constexpr size_t METRIC_SHARDS = 16;
+// µs cinsinden üst sınırlar (Prometheus "le"); son kova +Inf
+static constexpr std::array<uint32_t, 12> LATENCY_BOUNDS_US = {
+  50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000 };
+static constexpr size_t LATENCY_BUCKETS = LATENCY_BOUNDS_US.size() + 1;
+
+class StageStats {
+ public:
+  StageStats(std::string pipeline, std::string stage, std::string kind);
+
+  const std::string& pipeline() const { return pipeline_; }
+  const std::string& stage() const { return stage_; }
+  const std::string& kind() const { return kind_; }
+
+  // streaming thread'lerinden; key == NO_KEY ise yalnızca sayaçlar
+  static constexpr uint64_t NO_KEY = UINT64_MAX;
+  void on_in(uint64_t key, uint64_t now_ns, uint64_t bytes, uint32_t buffers);
+  void on_out(uint64_t key, uint64_t now_ns, uint64_t bytes, uint32_t buffers);
+
+  // örnekleyici (ana thread) tarafından yazılan göstergeler; -1 = yok
+  void set_level(int64_t buffers, int64_t time_ns) { level_buffers_ = buffers; level_time_ns_ = time_ns; }
+  void set_dropped(int64_t n) { dropped_ = n; }
+
+  struct Snapshot {
+    uint64_t in_buffers = 0, in_bytes = 0, out_buffers = 0, out_bytes = 0;
+    uint64_t lat_count = 0, lat_sum_ns = 0;
+    uint64_t buckets[LATENCY_BUCKETS] = {};
+    int64_t level_buffers = -1, level_time_ns = -1, dropped = -1;
+    double percentile_us(double p) const;
+  };
+  Snapshot snapshot() const;
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> in_buffers{0}, in_bytes{0}, out_buffers{0}, out_bytes{0};
+    std::atomic<uint64_t> lat_count{0}, lat_sum_ns{0};
+    std::atomic<uint64_t> buckets[LATENCY_BUCKETS] = {};
+  };
+  // giriş zamanı, anahtarın hash'ine göre; çıkışta aynı anahtar bulunursa süre kaydedilir
+  struct alignas(16) Pending {
+    std::atomic<uint64_t> key{NO_KEY};
+    std::atomic<uint64_t> t_ns{0};
+  };
+  static constexpr size_t PENDING = 256;
+
+  Shard& shard();
+
+  std::string pipeline_, stage_, kind_;
+  std::unique_ptr<Shard[]> shards_;
+  std::unique_ptr<Pending[]> pending_;
+  std::atomic<int64_t> level_buffers_{-1}, level_time_ns_{-1}, dropped_{-1};
+};
+
+// ---- kayan pencereli gecikme histogramı ----
+// Son WINDOW_S saniye (saniyelik dilimler halkası); ör. yakalamadan alıma tek yön gecikme.
+// record() tek yazar thread'inden, snapshot() herhangi bir thread'den (relaxed atomikler; dilim
+// yeni saniyeye geçerken okunan pencere bir dilim kadar eksik olabilir, metrik için yeterli).
+// Negatif değerler (saat eşleme hatası) ilk kovaya sayılır, ayrıca negative'de tutulur.
+static constexpr std::array<uint32_t, 14> DELAY_BOUNDS_US = {
+  1000, 2000, 5000, 10000, 20000, 30000, 50000, 75000, 100000, 150000, 200000, 300000, 500000, 1000000 };
+static constexpr size_t DELAY_BUCKETS = DELAY_BOUNDS_US.size() + 1;
+
+class RollingHistogram {
+ public:
+  static constexpr size_t WINDOW_S = 10;
+
+  void record(int64_t value_us, uint64_t now_ns);
+  void reset();
+
+  struct Snapshot {
+    uint64_t count = 0, negative = 0;
+    int64_t min_us = 0, max_us = 0;
+    double sum_us = 0;
+    uint64_t buckets[DELAY_BUCKETS] = {};
+    double mean_us() const { return count ? sum_us / count : 0.0; }
+    double percentile_us(double p) const;   // kova içinde doğrusal
+  };
+  Snapshot snapshot(uint64_t now_ns) const;
+  // pencereden bağımsız toplamlar (Prometheus _count/_sum)
+  uint64_t total_count() const { return total_count_.load(std::memory_order_relaxed); }
+  double total_sum_us() const { return (double)total_sum_us_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> sec{UINT64_MAX};
+    std::atomic<uint64_t> count{0}, negative{0};
+    std::atomic<int64_t> sum_us{0}, min_us{0}, max_us{0};
+    std::atomic<uint64_t> buckets[DELAY_BUCKETS] = {};
+  };
+  Slot slots_[WINDOW_S + 1];   // +1: yazılmakta olan saniye
+  std::atomic<uint64_t> total_count_{0};
+  std::atomic<int64_t> total_sum_us_{0};
+};
+
+class MetricsRegistry {
+ public:
+  // boru hattı kurulurken (ayırma burada)
+  StageStats* add(const std::string& pipeline, const std::string& stage, const std::string& kind);
+  const std::vector<std::unique_ptr<StageStats>>& stages() const { return stages_; }
+  // sahibi çağıran (kayıttan uzun yaşamalı); Prometheus'ta summary, JSON'da "rolling" altında
+  void add_rolling(const std::string& name, const std::string& peer, const RollingHistogram* h);
+
+  std::string render_prometheus() const;
+  std::string render_json() const;
+
+ private:
+  struct Rolling { std::string name, peer; const RollingHistogram* h; };
+  std::vector<std::unique_ptr<StageStats>> stages_;
+  std::vector<Rolling> rolling_;
+};
+
+uint64_t metrics_now_ns();   // CLOCK_MONOTONIC (vDSO)
@@ -0,0 +1,206 @@
+#include "thread_policy.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const char* const CLASS_NAMES[THREAD_CLASS_COUNT] = {
+  "capture", "encode", "send", "recv", "decode", "control", "io", "other"
+};
+
+const char* thread_class_name(ThreadClass c) { return CLASS_NAMES[(int)c]; }
+
+bool thread_class_from_name(const std::string& name, ThreadClass& out) {
+  for (int i = 0; i < THREAD_CLASS_COUNT; ++i)
+    if (name == CLASS_NAMES[i]) { out = (ThreadClass)i; return true; }
+  return false;
+}
+
+static pid_t current_tid() { return (pid_t)syscall(SYS_gettid); }
+
+static uint64_t mono_ns() {
+  timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000ULL + uint64_t(ts.tv_nsec);
+}
+
+// /proc/.../stat: comm parantez içinde (boşluk içerebilir); kalan alanlar ')' sonrasından sayılır.
+// utime/stime 14./15., işlemci 39. alan
+static bool read_stat(const std::string& path, uint64_t& ticks, int* cpu) {
+  FILE* f = std::fopen(path.c_str(), "r");
+  if (!f) return false;
+  char buf[1024];
+  const size_t n = std::fread(buf, 1, sizeof(buf) - 1, f);
+  std::fclose(f);
+  buf[n] = 0;
+  const char* p = std::strrchr(buf, ')');
+  if (!p) return false;
+  std::istringstream in(p + 1);
+  std::string tok;
+  uint64_t ut = 0, st = 0;
+  for (int field = 3; in >> tok; ++field) {
+    if (field == 14) ut = std::strtoull(tok.c_str(), nullptr, 10);
+    else if (field == 15) st = std::strtoull(tok.c_str(), nullptr, 10);
+    else if (field == 39) { if (cpu) *cpu = std::atoi(tok.c_str()); break; }
+  }
+  ticks = ut + st;
+  return true;
+}
+
+static bool task_stat(pid_t tid, uint64_t& ticks, int* cpu) {
+  return read_stat("/proc/self/task/" + std::to_string(tid) + "/stat", ticks, cpu);
+}
+
+// "4-7,9"
+static bool parse_cpus(const std::string& s, std::vector<int>& out) {
+  out.clear();
+  std::stringstream ss(s);
+  for (std::string item; std::getline(ss, item, ',');) {
+    int lo, hi;
+    char extra;
+    const int k = std::sscanf(item.c_str(), "%d-%d%c", &lo, &hi, &extra);
+    if (k == 1) hi = lo;
+    else if (k != 2) return false;
+    if (lo < 0 || hi < lo || hi >= CPU_SETSIZE) return false;
+    for (int c = lo; c <= hi; ++c) out.push_back(c);
+  }
+  return !out.empty();
+}
+
+ThreadPolicy& ThreadPolicy::get() {
+  static ThreadPolicy p;
+  return p;
+}
+
+ThreadPolicy::ThreadPolicy() {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    for (int c = 0; c < CPU_SETSIZE; ++c) if (CPU_ISSET(c, &set)) default_cpus_.push_back(c);
+  prev_ns_ = mono_ns();
+  read_stat("/proc/self/stat", prev_proc_ticks_, nullptr);
+}
+
+bool ThreadPolicy::set_affinity(const std::string& spec) {
+  const auto colon = spec.find(':');
+  ThreadClass c;
+  std::vector<int> cpus;
+  if (colon == std::string::npos || !thread_class_from_name(spec.substr(0, colon), c) ||
+      !parse_cpus(spec.substr(colon + 1), cpus)) return false;
+  std::lock_guard<std::mutex> lk(mu_);
+  rules_[(int)c].cpus = cpus;
+  return true;
+}
+
+bool ThreadPolicy::set_sched(const std::string& spec) {
+  const auto c1 = spec.find(':');
+  const auto c2 = c1 == std::string::npos ? c1 : spec.find(':', c1 + 1);
+  ThreadClass c;
+  if (c2 == std::string::npos || !thread_class_from_name(spec.substr(0, c1), c)) return false;
+  const std::string kind = spec.substr(c1 + 1, c2 - c1 - 1);
+  char* end = nullptr;
+  const long v = std::strtol(spec.c_str() + c2 + 1, &end, 10);
+  if (end == spec.c_str() + c2 + 1 || *end) return false;
+  std::lock_guard<std::mutex> lk(mu_);
+  Rule& r = rules_[(int)c];
+  if (kind == "fifo" && v >= 1 && v <= 99) { r.fifo = (int)v; return true; }
+  if (kind == "nice" && v >= -20 && v <= 19) { r.has_nice = true; r.nice = (int)v; return true; }
+  return false;
+}
+
+bool ThreadPolicy::apply(Rule& r) {
+  bool any = false;
+  const char* failed = nullptr;
+  int err = 0;
+  if (!r.cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : r.cpus) CPU_SET(c, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) == 0) any = true;
+    else { failed = "affinity"; err = errno; }
+  }
+  if (r.fifo > 0) {
+    sched_param sp{};
+    sp.sched_priority = r.fifo;
+    if (sched_setscheduler(0, SCHED_FIFO, &sp) == 0) any = true;
+    else { failed = "SCHED_FIFO"; err = errno; }
+  }
+  if (r.has_nice) {
+    // Linux'ta PRIO_PROCESS + tid yalnızca o thread'i etkiler
+    if (setpriority(PRIO_PROCESS, (id_t)current_tid(), r.nice) == 0) any = true;
+    else { failed = "nice"; err = errno; }
+  }
+  if (failed && !r.warned) {
+    r.warned = true;
+    std::cerr << "[threads] " << failed << " uygulanamadı: " << std::strerror(err)
+              << (err == EPERM ? " (CAP_SYS_NICE ya da RLIMIT_RTPRIO gerekli)" : "") << "\n";
+  }
+  return any;
+}
+
+void ThreadPolicy::reset() {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int c : default_cpus_) CPU_SET(c, &set);
+  if (!default_cpus_.empty()) sched_setaffinity(0, sizeof(set), &set);
+  sched_param sp{};
+  sched_setscheduler(0, SCHED_OTHER, &sp);
+  setpriority(PRIO_PROCESS, (id_t)current_tid(), 0);
+}
+
+void ThreadPolicy::enter(ThreadClass c, const std::string& name) {
+  pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+  const pid_t tid = current_tid();
+  Entry e{tid, name, c, false};
+  task_stat(tid, e.ticks, nullptr);
+  std::lock_guard<std::mutex> lk(mu_);
+  e.tuned = apply(rules_[(int)c]);
+  threads_.erase(std::remove_if(threads_.begin(), threads_.end(), [tid](const Entry& x) { return x.tid == tid; }),
+                 threads_.end());
+  threads_.push_back(std::move(e));
+}
+
+void ThreadPolicy::leave() {
+  const pid_t tid = current_tid();
+  std::lock_guard<std::mutex> lk(mu_);
+  auto it = std::find_if(threads_.begin(), threads_.end(), [tid](const Entry& x) { return x.tid == tid; });
+  if (it == threads_.end()) return;
+  if (it->tuned) reset();
+  threads_.erase(it);
+}
+
+std::vector<ThreadPolicy::Usage> ThreadPolicy::sample(double& rest_percent) {
+  static const double HZ = (double)sysconf(_SC_CLK_TCK);
+  const uint64_t now = mono_ns();
+  uint64_t proc = 0;
+  read_stat("/proc/self/stat", proc, nullptr);
+
+  std::vector<Usage> out;
+  std::lock_guard<std::mutex> lk(mu_);
+  const double dt_s = (now - prev_ns_) / 1e9;
+  uint64_t sum = 0;
+  for (auto it = threads_.begin(); it != threads_.end();) {
+    uint64_t ticks;
+    int cpu = -1;
+    if (!task_stat(it->tid, ticks, &cpu)) { it = threads_.erase(it); continue; }   // leave()'siz çıkmış
+    const uint64_t d = ticks >= it->ticks ? ticks - it->ticks : 0;
+    sum += d;
+    it->ticks = ticks;
+    out.push_back({it->tid, it->name, it->cls, dt_s > 0 ? d / HZ / dt_s * 100.0 : 0.0, cpu});
+    ++it;
+  }
+  const uint64_t dproc = proc >= prev_proc_ticks_ ? proc - prev_proc_ticks_ : 0;
+  rest_percent = dt_s > 0 && dproc > sum ? (dproc - sum) / HZ / dt_s * 100.0 : 0.0;
+  prev_ns_ = now;
+  prev_proc_ticks_ = proc;
+  std::sort(out.begin(), out.end(), [](const Usage& a, const Usage& b) { return a.cpu_percent > b.cpu_percent; });
+  return out;
+}
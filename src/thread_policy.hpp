@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+// Thread sınıfları: kural (CPU kümesi, SCHED_FIFO / nice) sınıf başına verilir.
+// Kritik yol yakalama -> kodlama -> gönderimdir; kodlayıcının kendi işçi thread'leri (x264 dilimleri
+// gibi) oluşturuldukları streaming thread'inin CPU kümesini ve önceliğini miras alır.
+enum class ThreadClass : uint8_t { Capture, Encode, Send, Recv, Decode, Control, Io, Other };
+constexpr int THREAD_CLASS_COUNT = 8;
+
+const char* thread_class_name(ThreadClass c);   // "capture", "encode"... (komut satırı / günlük)
+bool thread_class_from_name(const std::string& name, ThreadClass& out);
+
+// Süreç genelinde thread adlandırma, kurallar ve thread başına CPU muhasebesi.
+// GStreamer streaming thread'leri bus sync handler'ında (stream-status ENTER/LEAVE), kendi
+// thread'lerimiz (kontrol kanalı, alım ringi, kayıt yazıcısı) ThreadScope ile kaydolur.
+// Kural yoksa yalnızca ad verilir ve kayıt tutulur; maliyet thread başına bir kez.
+class ThreadPolicy {
+ public:
+  static ThreadPolicy& get();
+
+  // "encode:4-7,9" -> sınıfın CPU kümesi
+  bool set_affinity(const std::string& spec);
+  // "capture:fifo:50" (1-99) ya da "decode:nice:-5" (-20..19)
+  bool set_sched(const std::string& spec);
+
+  // çağıran thread: ad (15 karaktere kırpılır), sınıf kuralı, CPU muhasebesi kaydı
+  void enter(ThreadClass c, const std::string& name);
+  // çağıran thread: kayıttan çıkar, kural uygulandıysa süreç varsayılanına döner
+  // (GStreamer thread havuzu thread'i başka bir görev için yeniden kullanabilir)
+  void leave();
+
+  struct Usage {
+    pid_t tid;
+    std::string name;
+    ThreadClass cls;
+    double cpu_percent;   // önceki sample()'dan bu yana, tek çekirdeğe göre
+    int last_cpu;         // en son çalıştığı çekirdek
+  };
+  // kayıtlı thread'ler, çok tüketenden aza; rest_percent: kayıtsız thread'lerin toplamı
+  // (kodlayıcı işçileri, GLib ana döngüsü...). Ana thread'den.
+  std::vector<Usage> sample(double& rest_percent);
+
+ private:
+  struct Rule {
+    std::vector<int> cpus;   // boş = dokunma
+    int fifo = 0;            // 0 = SCHED_OTHER
+    bool has_nice = false;
+    int nice = 0;
+    bool warned = false;
+  };
+  struct Entry {
+    pid_t tid;
+    std::string name;
+    ThreadClass cls;
+    bool tuned;
+    uint64_t ticks = 0;      // utime + stime (son örnek)
+  };
+
+  ThreadPolicy();
+  bool apply(Rule& r);     // mu_ tutulurken, çağıran thread'e
+  void reset();            // çağıran thread'e süreç varsayılanları
+
+  std::mutex mu_;
+  Rule rules_[THREAD_CLASS_COUNT];
+  std::vector<int> default_cpus_;   // açılıştaki süreç CPU kümesi
+  std::vector<Entry> threads_;
+  uint64_t prev_ns_ = 0, prev_proc_ticks_ = 0;
+};
+
+// kendi std::thread'lerimiz için: gövdenin başında kurulur, çıkışta leave()
+class ThreadScope {
+ public:
+  ThreadScope(ThreadClass c, const std::string& name) { ThreadPolicy::get().enter(c, name); }
+  ~ThreadScope() { ThreadPolicy::get().leave(); }
+  ThreadScope(const ThreadScope&) = delete;
+  ThreadScope& operator=(const ThreadScope&) = delete;
+};
@@ -0,0 +1,136 @@
+#include "udp_batch.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+static constexpr int SNDBUF_BYTES = 4 * 1024 * 1024;
+
+static int64_t mono_ns() {
+  timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+  return int64_t(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+static void sleep_until_ns(int64_t t) {
+  timespec ts{ time_t(t / 1000000000LL), long(t % 1000000000LL) };
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+}
+
+UdpBatchSender::UdpBatchSender(const std::string& ip, int port) {
+  fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (fd_ < 0) { perror("socket tx"); return; }
+  setsockopt(fd_, SOL_SOCKET, SO_SNDBUF, &SNDBUF_BYTES, sizeof(SNDBUF_BYTES));
+
+  sockaddr_in dst{};
+  dst.sin_family = AF_INET;
+  dst.sin_port = htons(port);
+  inet_pton(AF_INET, ip.c_str(), &dst.sin_addr);
+  if (port > 0 && dst.sin_addr.s_addr != 0) add_destination(dst);
+
+  memset(msgs_, 0, sizeof(msgs_));
+  for (size_t i = 0; i < MAX_BATCH; ++i) {
+    msgs_[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    msgs_[i].msg_hdr.msg_iov     = &iov_[i];
+    msgs_[i].msg_hdr.msg_iovlen  = 1;
+  }
+}
+
+static bool same_dst(const sockaddr_in& a, const sockaddr_in& b) {
+  return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+}
+
+bool UdpBatchSender::add_destination(const sockaddr_in& dst) {
+  std::lock_guard<std::mutex> lk(dst_mu_);
+  for (size_t i = 0; i < ndst_; ++i) if (same_dst(dsts_[i], dst)) return true;
+  if (ndst_ >= MAX_DESTS) return false;
+  dsts_[ndst_++] = dst;
+  return true;
+}
+
+void UdpBatchSender::remove_destination(const sockaddr_in& dst) {
+  std::lock_guard<std::mutex> lk(dst_mu_);
+  for (size_t i = 0; i < ndst_; ++i)
+    if (same_dst(dsts_[i], dst)) { dsts_[i] = dsts_[--ndst_]; return; }
+}
+
+size_t UdpBatchSender::destinations() const {
+  std::lock_guard<std::mutex> lk(dst_mu_);
+  return ndst_;
+}
+
+UdpBatchSender::~UdpBatchSender() { if (fd_ >= 0) close(fd_); }
+
+bool UdpBatchSender::push(const uint8_t* data, size_t len) {
+  if (n_ >= MAX_BATCH) return false;
+  iov_[n_].iov_base = const_cast<uint8_t*>(data);
+  iov_[n_].iov_len  = len;
+  ++n_;
+  pending_bytes_ += len;
+  return true;
+}
+
+void UdpBatchSender::send_range(size_t first0, size_t count0, const sockaddr_in* dsts, size_t ndst) {
+  for (size_t d = 0; d < ndst; ++d) {
+    size_t first = first0, count = count0;
+    for (size_t i = 0; i < count; ++i) msgs_[first + i].msg_hdr.msg_name = const_cast<sockaddr_in*>(&dsts[d]);
+    while (count > 0) {
+      int r = sendmmsg(fd_, &msgs_[first], static_cast<unsigned>(count), 0);
+      syscalls_.fetch_add(1, std::memory_order_relaxed);
+      if (r < 0) {
+        if (errno == EINTR) continue;
+        if (errno != ECONNREFUSED) perror("sendmmsg");
+        break;   // UDP: kalan AU düşer, alıcı NACK/PLI ile toparlar
+      }
+      for (int i = 0; i < r; ++i) bytes_.fetch_add(iov_[first + i].iov_len, std::memory_order_relaxed);
+      packets_.fetch_add(static_cast<uint64_t>(r), std::memory_order_relaxed);
+      first += static_cast<size_t>(r);
+      count -= static_cast<size_t>(r);
+    }
+  }
+}
+
+void UdpBatchSender::flush() {
+  sockaddr_in dsts[MAX_DESTS];
+  size_t ndst;
+  {
+    std::lock_guard<std::mutex> lk(dst_mu_);
+    ndst = ndst_;
+    std::copy(dsts_, dsts_ + ndst_, dsts);
+  }
+  if (!n_ || fd_ < 0 || !ndst) { n_ = 0; pending_bytes_ = 0; return; }
+
+  if (!pacing_ || n_ <= static_cast<size_t>(burst_)) {
+    send_range(0, n_, dsts, ndst);
+  } else {
+    // token bucket: hız = AU baytı / (spread * kare aralığı), kova = bir dilim
+    const double window_s = spread_ * frame_us_ / 1e6;
+    const double rate = pending_bytes_ * ndst / window_s;   // bytes/s, tüm hedefler
+    double tokens = 0;
+    int64_t last = mono_ns();
+    for (size_t i = 0; i < n_; ) {
+      const size_t cnt = std::min(static_cast<size_t>(burst_), n_ - i);
+      size_t need = 0;
+      for (size_t k = 0; k < cnt; ++k) need += iov_[i + k].iov_len;
+      need *= ndst;
+
+      if (i == 0) tokens = static_cast<double>(need);   // ilk dilim hemen
+      const int64_t now = mono_ns();
+      tokens += (now - last) * rate / 1e9;
+      last = now;
+      if (tokens < need) {
+        const int64_t wait = static_cast<int64_t>((need - tokens) / rate * 1e9);
+        sleep_until_ns(now + wait);
+        tokens = static_cast<double>(need);
+        last = now + wait;
+      }
+      send_range(i, cnt, dsts, ndst);
+      tokens -= static_cast<double>(need);
+      i += cnt;
+    }
+  }
+  n_ = 0;
+  pending_bytes_ = 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+// Bir erişim biriminin (AU) RTP paketlerini toplayıp tek sendmmsg ile gönderir.
+// Yükler kopyalanmaz: push() edilen işaretçiler flush() bitene kadar geçerli kalmalı.
+// Pacer: token bucket; AU, kare aralığının spread kesrine yayılır (burst_pkts'lik dilimler).
+// Çok eşli: her dilim tüm hedeflere gönderilir (tek kodlama, N kopya yalnızca çekirdekte).
+class UdpBatchSender {
+ public:
+  static constexpr size_t MAX_BATCH = 1024;
+  static constexpr size_t MAX_DESTS = 32;
+
+  // ip "0.0.0.0" ya da port 0: başlangıçta hedef yok (add_destination ile eklenir)
+  UdpBatchSender(const std::string& ip, int port);
+  ~UdpBatchSender();
+  UdpBatchSender(const UdpBatchSender&) = delete;
+  UdpBatchSender& operator=(const UdpBatchSender&) = delete;
+
+  bool ok() const { return fd_ >= 0; }
+
+  // herhangi bir thread'den; sonraki flush()'tan itibaren geçerli
+  bool add_destination(const sockaddr_in& dst);
+  void remove_destination(const sockaddr_in& dst);
+  size_t destinations() const;
+
+  void set_frame_interval_us(int64_t us) { frame_us_ = us > 0 ? us : 33333; }
+  void set_pacing(bool on, double spread = 0.8, int burst_pkts = 16) {
+    pacing_ = on; spread_ = spread; burst_ = burst_pkts > 0 ? burst_pkts : 1;
+  }
+
+  // false: batch dolu, önce flush() gerekir
+  bool push(const uint8_t* data, size_t len);
+  size_t pending() const { return n_; }
+  void flush();
+  // gönderilmemiş paketleri bırakır (push edilen işaretçiler artık geçersiz olacaksa)
+  void discard() { n_ = 0; pending_bytes_ = 0; }
+
+  uint64_t packets() const  { return packets_.load(std::memory_order_relaxed); }
+  uint64_t bytes() const    { return bytes_.load(std::memory_order_relaxed); }
+  uint64_t syscalls() const { return syscalls_.load(std::memory_order_relaxed); }
+
+ private:
+  void send_range(size_t first, size_t count, const sockaddr_in* dsts, size_t ndst);
+
+  int fd_ = -1;
+  mutable std::mutex dst_mu_;
+  sockaddr_in dsts_[MAX_DESTS];
+  size_t ndst_ = 0;
+  mmsghdr msgs_[MAX_BATCH];
+  iovec   iov_[MAX_BATCH];
+  size_t  n_ = 0, pending_bytes_ = 0;
+
+  bool    pacing_ = true;
+  double  spread_ = 0.8;
+  int     burst_ = 16;
+  int64_t frame_us_ = 33333;
+
+  std::atomic<uint64_t> packets_{0}, bytes_{0}, syscalls_{0};
+};
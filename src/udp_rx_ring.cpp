@@ -0,0 +1,220 @@
+#include "udp_rx_ring.hpp"
+#include "thread_policy.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static constexpr int RCVBUF_BYTES = 8 * 1024 * 1024;
+
+static uint64_t mono_ns() {
+  timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000ULL + uint64_t(ts.tv_nsec);
+}
+
+UdpRxRing::UdpRxRing(int port, int latency_ms, int payload_type)
+: latency_ms_(latency_ms), pt_(payload_type) {
+  slab_ = static_cast<uint8_t*>(std::aligned_alloc(64, POOL_SLOTS * SLOT_SIZE));
+  if (!slab_) { perror("rx slab"); return; }
+  cookies_.reset(new Cookie[POOL_SLOTS]);
+  next_free_.reset(new uint32_t[POOL_SLOTS]);
+  for (uint32_t i = 0; i < POOL_SLOTS; ++i) {
+    cookies_[i] = { this, i };
+    next_free_[i] = i + 1 < POOL_SLOTS ? i + 1 : NIL;
+  }
+  local_free_ = 0;
+  ring_.reset(new Entry[RING]());
+  out_.reset(new RxPacket[RING]);
+
+  fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (fd_ < 0) { perror("socket rx"); return; }
+  setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &RCVBUF_BYTES, sizeof(RCVBUF_BYTES));
+  sockaddr_in addr{}; addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = INADDR_ANY;
+  addr.sin_port = htons(port);
+  if (bind(fd_, (sockaddr*)&addr, sizeof(addr)) < 0) { perror("bind rx"); close(fd_); fd_ = -1; }
+}
+
+UdpRxRing::~UdpRxRing() {
+  stop();
+  if (fd_ >= 0) close(fd_);
+  std::free(slab_);
+}
+
+bool UdpRxRing::start() {
+  if (!ok()) return false;
+  stop_ = false;
+  thr_ = std::thread([this]{ this->run(); });
+  return true;
+}
+
+// shutdown(SHUT_RD) bloklu recvmmsg'yi hemen uyandırır
+void UdpRxRing::stop() {
+  if (!thr_.joinable()) return;
+  stop_ = true;
+  shutdown(fd_, SHUT_RD);
+  thr_.join();
+}
+
+void UdpRxRing::release(uint32_t slot) {
+  uint32_t head = free_head_.load(std::memory_order_relaxed);
+  do { next_free_[slot] = head; }
+  while (!free_head_.compare_exchange_weak(head, slot, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void UdpRxRing::release_cookie(void* cookie) {
+  auto* c = static_cast<Cookie*>(cookie);
+  c->ring->release(c->slot);
+}
+
+uint32_t UdpRxRing::pop_free() {
+  if (local_free_ == NIL) local_free_ = free_head_.exchange(NIL, std::memory_order_acquire);
+  const uint32_t s = local_free_;
+  if (s != NIL) local_free_ = next_free_[s];
+  return s;
+}
+
+void UdpRxRing::reset() {
+  for (uint16_t s = next_seq_; s != end_seq_; ++s) {
+    Entry& e = ring_[s & (RING - 1)];
+    if (e.used) { release(e.slot); e.used = false; }
+  }
+  have_base_ = false;
+  next_seq_ = end_seq_ = 0;
+}
+
+void UdpRxRing::handle(uint32_t slot, uint32_t len, uint64_t now_ns) {
+  const uint8_t* p = slot_ptr(slot);
+  if (len < 12 || (p[0] >> 6) != 2) { release(slot); return; }
+  packets_.fetch_add(1, std::memory_order_relaxed);
+
+  const uint16_t seq = uint16_t(p[2] << 8 | p[3]);
+  const uint32_t ts  = uint32_t(p[4]) << 24 | uint32_t(p[5]) << 16 | uint32_t(p[6]) << 8 | p[7];
+  const bool marker  = p[1] & 0x80;
+  const bool media   = pt_ < 0 || (p[1] & 0x7f) == pt_;   // FEC aynı sıra uzayında, teslim edilmez
+  if (media && pkt_cb_) pkt_cb_(seq, ts, now_ns, len, marker);
+
+  if (!have_base_) { have_base_ = true; next_seq_ = end_seq_ = seq; }
+  const int d = int16_t(uint16_t(seq - next_seq_));
+  if (d < 0 && d > -int(RING)) { late_.fetch_add(1, std::memory_order_relaxed); release(slot); return; }
+  if (d < 0 || d >= int(RING)) {
+    // gönderici yeniden başladı / uzun kesinti: ringi boşalt, buradan devam
+    reset();
+    have_base_ = true; next_seq_ = end_seq_ = seq;
+    discont_ = true;
+  }
+
+  Entry& e = ring_[seq & (RING - 1)];
+  if (e.used) { dups_.fetch_add(1, std::memory_order_relaxed); release(slot); return; }
+  e = { now_ns, slot, len, ts, seq, true, marker, media };
+  if (int16_t(uint16_t(seq + 1 - end_seq_)) > 0) end_seq_ = uint16_t(seq + 1);
+}
+
+void UdpRxRing::emit(uint16_t count, bool discont) {
+  size_t n = 0;
+  for (uint16_t i = 0; i < count; ++i) {
+    Entry& e = ring_[uint16_t(next_seq_ + i) & (RING - 1)];
+    if (!e.used) continue;
+    e.used = false;
+    if (e.media) out_[n++] = { slot_ptr(e.slot), e.len, e.slot };
+    else release(e.slot);
+  }
+  next_seq_ = uint16_t(next_seq_ + count);
+  if (!n) return;
+
+  aus_.fetch_add(1, std::memory_order_relaxed);
+  delivered_.fetch_add(n, std::memory_order_relaxed);
+  if (au_cb_) au_cb_(out_.get(), n, discont);
+  else for (size_t i = 0; i < n; ++i) release(out_[i].slot);
+}
+
+void UdpRxRing::drain(uint64_t now_ns) {
+  const uint64_t latency_ns = uint64_t(latency_ms_.load(std::memory_order_relaxed)) * 1000000ULL;
+  while (next_seq_ != end_seq_) {
+    const uint16_t span = uint16_t(end_seq_ - next_seq_);
+    uint16_t i = 0;
+    bool complete = false;
+    for (; i < span; ++i) {
+      const Entry& e = ring_[uint16_t(next_seq_ + i) & (RING - 1)];
+      if (!e.used) break;
+      if (e.media && e.marker) { complete = true; ++i; break; }
+    }
+    if (complete) { emit(i, discont_); discont_ = false; continue; }
+    if (i == span) break;   // son AU henüz tamamlanmadı
+
+    // i'de boşluk; boşluğu ortaya çıkaran ilk paket latency kadar beklediyse kayıp say
+    uint16_t j = uint16_t(i + 1);
+    while (j < span && !ring_[uint16_t(next_seq_ + j) & (RING - 1)].used) ++j;
+    if (now_ns - ring_[uint16_t(next_seq_ + j) & (RING - 1)].arrival_ns < latency_ns) break;
+
+    if (i) emit(i, discont_);   // eksik AU'nun başı; depay discont'ta yarım NAL'ı atar
+    lost_.fetch_add(j - i, std::memory_order_relaxed);
+    next_seq_ = uint16_t(next_seq_ + (j - i));
+    discont_ = true;
+  }
+}
+
+// Bloklayan recvmmsg(MSG_WAITFORONE): uyanış başına tek syscall, o ana kadar gelenlerin hepsi.
+// Ringde bekleyen paket varken SO_RCVTIMEO kısa tutulur ki boşluk zaman aşımı kaçmasın.
+void UdpRxRing::set_timeout(int ms) {
+  if (ms == timeout_ms_) return;
+  timeval tv{ ms / 1000, (ms % 1000) * 1000 };
+  setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  timeout_ms_ = ms;
+}
+
+void UdpRxRing::run() {
+  ThreadScope scope(ThreadClass::Recv, "nova-rxring");
+  mmsghdr msgs[BATCH];
+  iovec iov[BATCH];
+  uint32_t slots[BATCH];
+  size_t reserved = 0;
+  memset(msgs, 0, sizeof(msgs));
+  for (size_t i = 0; i < BATCH; ++i) {
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  alignas(64) static uint8_t scratch[SLOT_SIZE];   // havuz boşken okunup atılır
+
+  while (!stop_.load(std::memory_order_relaxed)) {
+    set_timeout(next_seq_ != end_seq_ ? 2 : 100);
+
+    while (reserved < BATCH) {
+      const uint32_t s = pop_free();
+      if (s == NIL) break;
+      slots[reserved++] = s;
+    }
+    if (!reserved) {
+      if (recv(fd_, scratch, sizeof(scratch), 0) > 0) pool_empty_.fetch_add(1, std::memory_order_relaxed);
+      drain(mono_ns());
+      continue;
+    }
+    for (size_t i = 0; i < reserved; ++i) {
+      iov[i] = { slot_ptr(slots[i]), SLOT_SIZE };
+      msgs[i].msg_hdr.msg_flags = 0;
+    }
+    const int r = recvmmsg(fd_, msgs, static_cast<unsigned>(reserved), MSG_WAITFORONE, nullptr);
+    syscalls_.fetch_add(1, std::memory_order_relaxed);
+    const uint64_t now = mono_ns();
+    if (r > 0) {
+      for (int i = 0; i < r; ++i) {
+        // shutdown() sonrası boş datagram döner
+        if (!msgs[i].msg_len || (msgs[i].msg_hdr.msg_flags & MSG_TRUNC)) release(slots[i]);
+        else handle(slots[i], msgs[i].msg_len, now);
+      }
+      reserved -= static_cast<size_t>(r);
+      memmove(slots, slots + r, reserved * sizeof(uint32_t));
+    } else if (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      perror("recvmmsg");
+      break;
+    }
+    drain(now);
+  }
+
+  for (size_t i = 0; i < reserved; ++i) release(slots[i]);
+  reset();
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+// recvmmsg ile toplu alım + RTP sıra numarasıyla indekslenen sabit boyutlu yeniden sıralama ringi.
+// Paketler önceden ayrılmış, 64 bayt hizalı bir slab'a doğrudan okunur (kopya yok).
+// Tam AU'lar (marker bitine kadar) sırayla on_au ile teslim edilir; boşluk latency_ms
+// içinde dolmazsa kayıp sayılır, sonraki teslim discont=true ile işaretlenir.
+// Teslim edilen slotlar release() ile (herhangi bir thread'den) havuza döner.
+// stop() soketi kapatır (shutdown); aynı nesne yeniden başlatılmaz.
+struct RxPacket {
+  uint8_t* data;
+  uint32_t len;
+  uint32_t slot;
+};
+
+class UdpRxRing {
+ public:
+  static constexpr size_t SLOT_SIZE  = 2048;    // MTU + pay; 64'ün katı
+  static constexpr size_t POOL_SLOTS = 8192;    // ring + aşağı akışta tutulanlar
+  static constexpr size_t RING       = 4096;    // 2^n, indeks = seq & (RING-1)
+  static constexpr size_t BATCH      = 64;      // recvmmsg başına paket
+
+  // on_au: alıcı thread'inden; paketlerin sahipliği geçer (her slot için release())
+  using AuHandler     = std::function<void(const RxPacket* pkts, size_t n, bool discont)>;
+  using PacketHandler = std::function<void(uint16_t seq, uint32_t rtp_ts, uint64_t arrival_ns, size_t bytes, bool marker)>;
+
+  UdpRxRing(int port, int latency_ms, int payload_type);
+  ~UdpRxRing();
+  UdpRxRing(const UdpRxRing&) = delete;
+  UdpRxRing& operator=(const UdpRxRing&) = delete;
+
+  bool ok() const { return fd_ >= 0 && slab_; }
+
+  // start()'tan önce çağrılmalı
+  void on_au(AuHandler h)         { au_cb_ = std::move(h); }
+  void on_packet(PacketHandler h) { pkt_cb_ = std::move(h); }
+
+  bool start();
+  void stop();
+
+  // boşluk bekleme süresi; herhangi bir thread'den (uyarlamalı tampon)
+  void set_latency_ms(int ms) { latency_ms_.store(ms, std::memory_order_relaxed); }
+
+  void release(uint32_t slot);
+  // GDestroyNotify uyumlu: cookie(slot) -> release_cookie(cookie)
+  void* cookie(uint32_t slot) { return &cookies_[slot]; }
+  static void release_cookie(void* cookie);
+
+  uint64_t packets() const    { return packets_.load(std::memory_order_relaxed); }
+  uint64_t delivered() const  { return delivered_.load(std::memory_order_relaxed); }
+  uint64_t syscalls() const   { return syscalls_.load(std::memory_order_relaxed); }
+  uint64_t aus() const        { return aus_.load(std::memory_order_relaxed); }
+  uint64_t lost() const       { return lost_.load(std::memory_order_relaxed); }
+  uint64_t late() const       { return late_.load(std::memory_order_relaxed); }
+  uint64_t duplicates() const { return dups_.load(std::memory_order_relaxed); }
+  uint64_t pool_empty() const { return pool_empty_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Entry {
+    uint64_t arrival_ns;
+    uint32_t slot, len, rtp_ts;
+    uint16_t seq;
+    bool used, marker, media;
+  };
+  struct Cookie { UdpRxRing* ring; uint32_t slot; };
+  static constexpr uint32_t NIL = UINT32_MAX;
+
+  void run();
+  void handle(uint32_t slot, uint32_t len, uint64_t now_ns);
+  void drain(uint64_t now_ns);
+  void emit(uint16_t count, bool discont);
+  void reset();
+  void set_timeout(int ms);
+  uint32_t pop_free();
+  uint8_t* slot_ptr(uint32_t slot) const { return slab_ + size_t(slot) * SLOT_SIZE; }
+
+  int fd_ = -1;
+  std::atomic<int> latency_ms_;
+  int pt_;
+  int timeout_ms_ = -1;
+  std::atomic<bool> stop_{false};
+  uint8_t* slab_ = nullptr;
+  std::unique_ptr<Cookie[]> cookies_;
+
+  // boş slot yığını: çok üretici (release), tek tüketici (alıcı thread'i).
+  // Tüketici tüm yığını exchange ile alır; ABA oluşmaz.
+  std::unique_ptr<uint32_t[]> next_free_;
+  std::atomic<uint32_t> free_head_{NIL};
+  uint32_t local_free_ = NIL;
+
+  // yalnızca alıcı thread'i
+  std::unique_ptr<Entry[]> ring_;
+  bool have_base_ = false, discont_ = false;
+  uint16_t next_seq_ = 0, end_seq_ = 0;   // [next_seq_, end_seq_) aralığı ringde
+  std::unique_ptr<RxPacket[]> out_;
+
+  std::thread thr_;
+  AuHandler au_cb_;
+  PacketHandler pkt_cb_;
+  std::atomic<uint64_t> packets_{0}, delivered_{0}, syscalls_{0}, aus_{0}, lost_{0}, late_{0}, dups_{0}, pool_empty_{0};
+};
@@ -0,0 +1,153 @@
+#include "v4l2_probe.hpp"
+#include <algorithm>
+#include <functional>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/videodev2.h>
+
+static int sys_open(const char* path, int flags) { return ::open(path, flags); }
+static int sys_ioctl(int fd, unsigned long req, void* arg) { return ::ioctl(fd, req, arg); }
+static int sys_close(int fd) { return ::close(fd); }
+
+static V4l2Ops g_ops = { sys_open, sys_ioctl, sys_close };
+
+void v4l2_set_ops(const V4l2Ops& ops) { g_ops = ops; }
+void v4l2_reset_ops() { g_ops = { sys_open, sys_ioctl, sys_close }; }
+
+static int xioctl(int fd, unsigned long req, void* arg) {
+  int r;
+  do { r = g_ops.ioctl_fn(fd, req, arg); } while (r < 0 && errno == EINTR);
+  return r;
+}
+
+static bool read_identity(int fd, V4l2Identity& out) {
+  v4l2_capability cap{};
+  if (xioctl(fd, VIDIOC_QUERYCAP, &cap) < 0) return false;
+  out.driver   = reinterpret_cast<const char*>(cap.driver);
+  out.card     = reinterpret_cast<const char*>(cap.card);
+  out.bus_info = reinterpret_cast<const char*>(cap.bus_info);
+  out.version  = cap.version;
+  uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+  out.capture = (caps & V4L2_CAP_VIDEO_CAPTURE) && (caps & V4L2_CAP_STREAMING);
+  return true;
+}
+
+bool v4l2_query_identity(const std::string& devpath, V4l2Identity& out) {
+  int fd = g_ops.open_fn(devpath.c_str(), O_RDWR | O_NONBLOCK);
+  if (fd < 0) return false;
+  bool ok = read_identity(fd, out);
+  g_ops.close_fn(fd);
+  return ok;
+}
+
+// interval n/d saniye -> fps d/n; sadece tam sayı olanlar (30000/1001 gibi değil)
+static int exact_fps(const v4l2_fract& f) {
+  if (f.numerator == 0 || f.denominator == 0) return 0;
+  if (f.denominator % f.numerator) return 0;
+  return static_cast<int>(f.denominator / f.numerator);
+}
+
+// discrete: tam sayı hızların listesi; stepwise/continuous: aralık (rates boş)
+static bool frame_rates(int fd, uint32_t fourcc, int w, int h, V4l2Mode& m) {
+  m.rates.clear();
+  m.fps_min = 0; m.fps_max = 0;
+  for (uint32_t i = 0;; ++i) {
+    v4l2_frmivalenum iv{};
+    iv.index = i; iv.pixel_format = fourcc;
+    iv.width = static_cast<uint32_t>(w); iv.height = static_cast<uint32_t>(h);
+    if (xioctl(fd, VIDIOC_ENUM_FRAMEINTERVALS, &iv) < 0) break;
+
+    if (iv.type == V4L2_FRMIVAL_TYPE_DISCRETE) {
+      int f = exact_fps(iv.discrete);
+      if (f <= 0 || std::find(m.rates.begin(), m.rates.end(), f) != m.rates.end()) continue;
+      m.rates.push_back(f);
+      if (!m.fps_min || f < m.fps_min) m.fps_min = f;
+      if (f > m.fps_max) m.fps_max = f;
+    } else {
+      // continuous/stepwise: max interval -> min fps, min interval -> max fps
+      const v4l2_fract& lo = iv.stepwise.max;
+      const v4l2_fract& hi = iv.stepwise.min;
+      if (!lo.denominator || !hi.numerator) break;
+      int f0 = static_cast<int>((lo.denominator + lo.numerator - 1) / lo.numerator);
+      int f1 = static_cast<int>(hi.denominator / hi.numerator);
+      if (f1 >= f0 && f1 > 0) { m.fps_min = f0 < 1 ? 1 : f0; m.fps_max = f1; }
+      break;
+    }
+  }
+  std::sort(m.rates.begin(), m.rates.end(), std::greater<int>());
+  return m.fps_max > 0;
+}
+
+static bool is_mjpg(uint32_t fourcc) {
+  return fourcc == V4L2_PIX_FMT_MJPEG || fourcc == V4L2_PIX_FMT_JPEG;
+}
+
+std::vector<V4l2Mode> v4l2_enumerate_modes(const std::string& devpath,
+                                           const std::vector<std::pair<int,int>>& stepwise_sizes,
+                                           V4l2Identity* id_out) {
+  std::vector<V4l2Mode> out;
+  int fd = g_ops.open_fn(devpath.c_str(), O_RDWR | O_NONBLOCK);
+  if (fd < 0) return out;
+
+  V4l2Identity id;
+  if (!read_identity(fd, id) || !id.capture) { g_ops.close_fn(fd); return out; }
+  if (id_out) *id_out = id;
+
+  auto add = [&](uint32_t fourcc, bool mjpg, int w, int h) {
+    V4l2Mode m;
+    m.fourcc = fourcc; m.mjpg = mjpg; m.width = w; m.height = h;
+    if (frame_rates(fd, fourcc, w, h, m)) out.push_back(std::move(m));
+  };
+
+  for (uint32_t fi = 0;; ++fi) {
+    v4l2_fmtdesc fmt{};
+    fmt.index = fi; fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(fd, VIDIOC_ENUM_FMT, &fmt) < 0) break;
+
+    const bool mjpg = is_mjpg(fmt.pixelformat);
+    if ((fmt.flags & V4L2_FMT_FLAG_COMPRESSED) && !mjpg) continue;   // H264/HEVC kameralar
+
+    for (uint32_t si = 0;; ++si) {
+      v4l2_frmsizeenum fs{};
+      fs.index = si; fs.pixel_format = fmt.pixelformat;
+      if (xioctl(fd, VIDIOC_ENUM_FRAMESIZES, &fs) < 0) break;
+
+      if (fs.type == V4L2_FRMSIZE_TYPE_DISCRETE) {
+        add(fmt.pixelformat, mjpg, static_cast<int>(fs.discrete.width), static_cast<int>(fs.discrete.height));
+        continue;
+      }
+      const auto& sw = fs.stepwise;
+      for (const auto& wh : stepwise_sizes) {
+        const uint32_t w = static_cast<uint32_t>(wh.first), h = static_cast<uint32_t>(wh.second);
+        if (w < sw.min_width || w > sw.max_width || h < sw.min_height || h > sw.max_height) continue;
+        if (sw.step_width  > 1 && (w - sw.min_width)  % sw.step_width)  continue;
+        if (sw.step_height > 1 && (h - sw.min_height) % sw.step_height) continue;
+        add(fmt.pixelformat, mjpg, wh.first, wh.second);
+      }
+      break;
+    }
+  }
+
+  g_ops.close_fn(fd);
+  return out;
+}
+
+const char* v4l2_fourcc_to_gst(uint32_t fourcc) {
+  switch (fourcc) {
+    case V4L2_PIX_FMT_YUYV:   return "YUY2";
+    case V4L2_PIX_FMT_UYVY:   return "UYVY";
+    case V4L2_PIX_FMT_YVYU:   return "YVYU";
+    case V4L2_PIX_FMT_NV12:   return "NV12";
+    case V4L2_PIX_FMT_NV21:   return "NV21";
+    case V4L2_PIX_FMT_NV16:   return "NV16";
+    case V4L2_PIX_FMT_YUV420: return "I420";
+    case V4L2_PIX_FMT_YVU420: return "YV12";
+    case V4L2_PIX_FMT_GREY:   return "GRAY8";
+    case V4L2_PIX_FMT_RGB24:  return "RGB";
+    case V4L2_PIX_FMT_BGR24:  return "BGR";
+    default: return nullptr;
+  }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Direct V4L2 ioctl enumeration (VIDIOC_QUERYCAP / ENUM_FMT / ENUM_FRAMESIZES /
+// ENUM_FRAMEINTERVALS). No GStreamer pipeline is built here.
+
+struct V4l2Identity {
+  std::string driver, card, bus_info;
+  uint32_t version = 0;
+  bool capture = false;   // V4L2_CAP_VIDEO_CAPTURE on this node
+};
+
+struct V4l2Mode {
+  uint32_t fourcc = 0;
+  bool mjpg = false;
+  int width = 0, height = 0;
+  // Only exact integral rates (caps use F/1). Discrete intervals stay a list
+  // (15 and 30 does not mean 25); fps_min/fps_max span the list, and are the
+  // full range only for stepwise/continuous intervals (rates empty).
+  std::vector<int> rates;
+  int fps_min = 0, fps_max = 0;
+
+  bool has_fps(int f) const {
+    if (rates.empty()) return f >= fps_min && f <= fps_max;
+    for (int r : rates) if (r == f) return true;
+    return false;
+  }
+};
+
+// ioctl katmanı: v4l2loopback yoksa sahte bir cihazla değiştirilebilir.
+struct V4l2Ops {
+  int (*open_fn)(const char* path, int flags);
+  int (*ioctl_fn)(int fd, unsigned long req, void* arg);
+  int (*close_fn)(int fd);
+};
+void v4l2_set_ops(const V4l2Ops& ops);
+void v4l2_reset_ops();
+
+bool v4l2_query_identity(const std::string& devpath, V4l2Identity& out);
+
+// Every (format, size, frame rates) the driver reports. Stepwise/continuous
+// frame sizes are expanded only at the given candidate sizes.
+std::vector<V4l2Mode> v4l2_enumerate_modes(const std::string& devpath,
+                                           const std::vector<std::pair<int,int>>& stepwise_sizes,
+                                           V4l2Identity* id_out = nullptr);
+
+// V4L2 piksel formatı -> GStreamer video/x-raw "format" adı; bilinmeyen/sıkıştırılmışsa nullptr
+const char* v4l2_fourcc_to_gst(uint32_t fourcc);
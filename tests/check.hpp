@@ -0,0 +1,31 @@
+#pragma once
+#include <iostream>
+
+// Bağımlılıksız test yardımcıları: başarısız CHECK dosya:satır ile yazılır, test devam eder;
+// main() test_result() döner (ctest sıfır olmayan çıkışı hata sayar).
+inline int g_check_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ")\n"; ++g_check_failures; } \
+  } while (0)
+
+#define CHECK_EQ(a, b) do { \
+    const auto va_ = (a); const auto vb_ = (b); \
+    if (!(va_ == vb_)) { \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #a ", " #b "): " << va_ << " != " << vb_ << "\n"; \
+      ++g_check_failures; \
+    } \
+  } while (0)
+
+#define CHECK_NEAR(a, b, eps) do { \
+    const double va_ = (a), vb_ = (b); \
+    if (!(va_ - vb_ <= (eps) && vb_ - va_ <= (eps))) { \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_NEAR(" #a ", " #b "): " << va_ << " != " << vb_ << "\n"; \
+      ++g_check_failures; \
+    } \
+  } while (0)
+
+inline int test_result() {
+  if (g_check_failures) std::cerr << g_check_failures << " check(s) failed\n";
+  return g_check_failures ? 1 : 0;
+}
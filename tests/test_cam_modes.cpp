@@ -0,0 +1,147 @@
+// V4L2 ioctl katmanı v4l2_set_ops ile sahte bir cihaza bağlanır; sayım ve mod sıralaması sınanır.
+#include "cam_modes.hpp"
+#include "v4l2_probe.hpp"
+#include "check.hpp"
+#include <cerrno>
+#include <cstring>
+#include <linux/videodev2.h>
+
+namespace {
+
+constexpr int FAKE_FD = 42;
+
+// MJPG: 1920x1080 yalnızca 15 ve 50 fps (aralık sanılırsa 30'u da "sunar"), 1280x720@30.
+// YUYV: 640x480, sürekli 5..30 fps.
+struct FakeSize { uint32_t fourcc, w, h; std::vector<uint32_t> rates; bool continuous; };
+const FakeSize SIZES[] = {
+  {V4L2_PIX_FMT_MJPEG, 1920, 1080, {15, 50}, false},
+  {V4L2_PIX_FMT_MJPEG, 1280,  720, {30},     false},
+  {V4L2_PIX_FMT_YUYV,   640,  480, {5, 30},  true},
+};
+const uint32_t FORMATS[] = {V4L2_PIX_FMT_MJPEG, V4L2_PIX_FMT_YUYV};
+
+int fake_open(const char* path, int) { return std::strcmp(path, "/dev/fake") ? -1 : FAKE_FD; }
+int fake_close(int) { return 0; }
+
+int fake_ioctl(int fd, unsigned long req, void* arg) {
+  if (fd != FAKE_FD) { errno = EBADF; return -1; }
+  switch (req) {
+    case VIDIOC_QUERYCAP: {
+      auto* cap = static_cast<v4l2_capability*>(arg);
+      std::memset(cap, 0, sizeof(*cap));
+      std::strcpy(reinterpret_cast<char*>(cap->driver), "fake");
+      std::strcpy(reinterpret_cast<char*>(cap->card), "Fake Cam");
+      cap->capabilities = V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_STREAMING;
+      return 0;
+    }
+    case VIDIOC_ENUM_FMT: {
+      auto* f = static_cast<v4l2_fmtdesc*>(arg);
+      if (f->index >= sizeof(FORMATS) / sizeof(FORMATS[0])) break;
+      f->pixelformat = FORMATS[f->index];
+      f->flags = f->pixelformat == V4L2_PIX_FMT_MJPEG ? V4L2_FMT_FLAG_COMPRESSED : 0;
+      return 0;
+    }
+    case VIDIOC_ENUM_FRAMESIZES: {
+      auto* fs = static_cast<v4l2_frmsizeenum*>(arg);
+      uint32_t n = 0;
+      for (const auto& s : SIZES) {
+        if (s.fourcc != fs->pixel_format || n++ != fs->index) continue;
+        fs->type = V4L2_FRMSIZE_TYPE_DISCRETE;
+        fs->discrete.width = s.w; fs->discrete.height = s.h;
+        return 0;
+      }
+      break;
+    }
+    case VIDIOC_ENUM_FRAMEINTERVALS: {
+      auto* iv = static_cast<v4l2_frmivalenum*>(arg);
+      for (const auto& s : SIZES) {
+        if (s.fourcc != iv->pixel_format || s.w != iv->width || s.h != iv->height) continue;
+        if (s.continuous) {
+          if (iv->index) break;
+          iv->type = V4L2_FRMIVAL_TYPE_CONTINUOUS;
+          iv->stepwise.min = {1, s.rates[1]};   // en kısa aralık = en yüksek fps
+          iv->stepwise.max = {1, s.rates[0]};
+          iv->stepwise.step = {1, 1};
+          return 0;
+        }
+        if (iv->index >= s.rates.size()) break;
+        iv->type = V4L2_FRMIVAL_TYPE_DISCRETE;
+        iv->discrete = {1, s.rates[iv->index]};
+        return 0;
+      }
+      break;
+    }
+  }
+  errno = EINVAL;
+  return -1;
+}
+
+const CapsWindow* find_window(const std::vector<CapsWindow>& ws, bool mjpg, int w, int h) {
+  for (const auto& cw : ws) if (cw.mjpg == mjpg && cw.wmax == w && cw.hmax == h) return &cw;
+  return nullptr;
+}
+
+void test_discrete_rates() {
+  const auto modes = v4l2_enumerate_modes("/dev/fake", {});
+  CHECK_EQ(modes.size(), 3u);
+  for (const auto& m : modes) {
+    if (m.width != 1920) continue;
+    CHECK(m.mjpg);
+    CHECK_EQ(m.rates.size(), 2u);
+    CHECK(m.has_fps(15) && m.has_fps(50));
+    CHECK(!m.has_fps(25) && !m.has_fps(30));
+  }
+
+  const auto ws = enumerate_caps("/dev/fake");
+  const CapsWindow* big = find_window(ws, true, 1920, 1080);
+  const CapsWindow* raw = find_window(ws, false, 640, 480);
+  CHECK(big && raw);
+  if (big) {
+    CHECK(!big->has_fps(30));
+    CHECK_EQ(big->fps_upto(30), 15);
+    CHECK_EQ(big->fps_upto(60), 50);
+    CHECK_EQ(big->fps_upto(10), 0);
+  }
+  if (raw) {
+    CHECK(raw->rates.empty());
+    CHECK(raw->has_fps(25));
+    CHECK(!raw->has_fps(31));
+  }
+}
+
+void test_ranked_modes() {
+  const auto ranked = rank_modes("/dev/fake", enumerate_caps("/dev/fake"));
+  // tercih tablosu: MJPG 1280x720@30, ham 640x480@30; sonra en büyük gerçek mod; son çare 720p30 ham
+  CHECK_EQ(ranked.size(), 4u);
+  if (ranked.size() == 4) {
+    CHECK(ranked[0].mjpg && ranked[0].width == 1280 && ranked[0].height == 720 && ranked[0].fps == 30);
+    CHECK(!ranked[1].mjpg && ranked[1].width == 640 && ranked[1].fps == 30);
+    CHECK(ranked[2].mjpg && ranked[2].width == 1920 && ranked[2].fps == 50);
+    CHECK(!ranked[3].mjpg && ranked[3].width == 1280 && ranked[3].fps == 30);
+  }
+  for (const auto& p : ranked) {
+    CHECK_EQ(p.device, std::string("/dev/fake"));
+    CHECK(!(p.width == 1920 && p.fps == 30));   // ayrık 15/50 fps 30'u sunmaz
+  }
+  CHECK(rank_modes("/dev/fake", {}).empty());
+}
+
+void test_missing_device() {
+  V4l2Identity id;
+  CHECK(!v4l2_query_identity("/dev/none", id));
+  CHECK(v4l2_enumerate_modes("/dev/none", {}).empty());
+  CHECK(v4l2_query_identity("/dev/fake", id));
+  CHECK(id.capture);
+  CHECK_EQ(id.card, std::string("Fake Cam"));
+}
+
+}  // namespace
+
+int main() {
+  v4l2_set_ops({fake_open, fake_ioctl, fake_close});
+  test_discrete_rates();
+  test_ranked_modes();
+  test_missing_device();
+  v4l2_reset_ops();
+  return test_result();
+}
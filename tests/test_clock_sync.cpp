@@ -0,0 +1,91 @@
+// ClockSync/OwdTracker sentetik PING/PONG örnekleriyle sınanır: eş saati yerelden 5 s ileride, 100 ppm hızlı.
+#include "clock_sync.hpp"
+#include "check.hpp"
+
+namespace {
+
+constexpr double OFFSET_US = 5000000.0;
+constexpr double DRIFT = 100e-6;
+
+uint64_t peer_at(int64_t local_us) { return (uint64_t)(local_us + OFFSET_US + DRIFT * local_us); }
+
+// t1'de gönderilen PING; gidiş up_us, dönüş down_us sürer, eş 50 µs bekler.
+ClockSample ping(int64_t t1, int64_t up_us, int64_t down_us) {
+  const int64_t recv = t1 + up_us, send = recv + 50;
+  return {(uint64_t)t1, peer_at(recv), peer_at(send), (uint64_t)(send + down_us)};
+}
+
+void test_offset_and_filter() {
+  ClockSync cs;
+  CHECK(!cs.valid());
+  CHECK_EQ(cs.peer_to_local_us(123), 0);
+  const int64_t t0 = 1000000;
+  cs.on_sample(ping(t0, 500, 500));
+  CHECK(cs.valid());
+  CHECK_NEAR(cs.offset_us(), OFFSET_US + DRIFT * t0, 5.0);
+  CHECK_NEAR(cs.delay_us(), 1000.0, 1.0);
+
+  // tek yönlü kuyruklanma ofseti 10 ms kaydırırdı; filtre düşük gecikmeli örneği tutar
+  cs.on_sample(ping(t0 + 100000, 20500, 500));
+  CHECK_NEAR(cs.delay_us(), 1000.0, 1.0);
+  CHECK_NEAR(cs.offset_us(), OFFSET_US + DRIFT * t0, 5.0);
+
+  // eski PONG (t3 < t2) yok sayılır
+  ClockSample bad = ping(t0 + 200000, 500, 500);
+  bad.t3_us = bad.t2_us - 1;
+  cs.on_sample(bad);
+  CHECK_NEAR(cs.delay_us(), 1000.0, 1.0);
+
+  cs.reset();
+  CHECK(!cs.valid());
+  CHECK_EQ(cs.drift_ppm(), 0.0);
+}
+
+void test_drift_fit() {
+  ClockSync cs;
+  int64_t t = 1000000;
+  // ilk 10 sn kayma tahmin edilmez
+  for (int i = 0; i < 5; ++i, t += 1000000) cs.on_sample(ping(t, 400, 400));
+  CHECK_EQ(cs.drift_ppm(), 0.0);
+  // her 4. örnek asimetrik kuyruklanmalı; filtre (son 8) bunları eler
+  for (int i = 0; i < 40; ++i, t += 1000000) cs.on_sample(ping(t, (i % 4 == 0) ? 15000 : 400, 400));
+  CHECK_NEAR(cs.drift_ppm(), DRIFT * 1e6, 2.0);
+
+  const int64_t local = t + 250000;
+  CHECK_NEAR((double)cs.peer_to_local_us(peer_at(local)), (double)local, 20.0);
+}
+
+void test_one_way_delay() {
+  OwdTracker owd;
+  // SR ya da saat yokken kare sayılmaz
+  owd.on_frame(0, 2000000);
+  CHECK_EQ(owd.histogram().total_count(), 0u);
+
+  int64_t t = 1000000;
+  for (int i = 0; i < 20; ++i, t += 1000000) owd.clock().on_sample(ping(t, 300, 300));
+
+  // SR: RTP 90000 <-> eşte yakalama anı; kareler 40 ms sonra (3600 tick arayla) yakalanır
+  const int64_t cap0 = t;
+  owd.on_sender_report(90000, peer_at(cap0));
+  for (int i = 0; i < 10; ++i) {
+    const int64_t cap = cap0 + i * 40000;
+    owd.on_frame(90000 + 3600 * i, (uint64_t)(cap + 25000));   // 25 ms yakalamadan varışa
+  }
+  CHECK_EQ(owd.histogram().total_count(), 10u);
+  CHECK_NEAR(owd.histogram().total_sum_us() / 10, 25000.0, 50.0);
+
+  // reset SR'yi, saati ve histogramı siler
+  owd.reset();
+  owd.on_frame(90000, (uint64_t)cap0);
+  CHECK(!owd.clock().valid());
+  CHECK_EQ(owd.histogram().total_count(), 0u);
+}
+
+}  // namespace
+
+int main() {
+  test_offset_and_filter();
+  test_drift_fit();
+  test_one_way_delay();
+  return test_result();
+}
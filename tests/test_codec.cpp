@@ -0,0 +1,93 @@
+// Kodek tablosu, adlandırma, pick_codec anlaşma kuralı ve referans olmayan AU tespiti.
+#include "codec.hpp"
+#include "check.hpp"
+#include <vector>
+
+namespace {
+
+void test_names() {
+  Codec c = Codec::AV1;
+  CHECK(codec_from_name("h265", c) && c == Codec::H265);
+  CHECK(codec_from_name("hevc", c) && c == Codec::H265);
+  CHECK(codec_from_name("vp9", c) && c == Codec::VP9);
+  CHECK(!codec_from_name("mpeg2", c));
+  for (int i = 0; i < CODEC_COUNT; ++i) CHECK(codec_info(static_cast<Codec>(i)).codec == static_cast<Codec>(i));
+  CHECK_EQ(std::string(codec_info(Codec::H264).rtp_name), std::string("H264"));
+  CHECK(codec_info(Codec::VP9).parse == nullptr);
+
+  CHECK(codec_of_encoder("x265enc") == Codec::H265);
+  CHECK(codec_of_encoder("svtav1enc") == Codec::AV1);
+  CHECK(codec_of_encoder("unknownenc") == Codec::H264);
+
+  CHECK_EQ(encoder_family("nvh264enc"), std::string("nv"));
+  CHECK_EQ(encoder_family("vaapih264enc"), std::string("vaapi"));
+  CHECK_EQ(encoder_family("vah265enc"), std::string("va"));
+  CHECK_EQ(encoder_family("qsvav1enc"), std::string("qsv"));
+  CHECK_EQ(encoder_family("x264enc"), std::string("sw"));
+  CHECK(is_hw_decoder("nvh264dec"));
+  CHECK(is_hw_decoder("v4l2slh264dec"));
+  CHECK(!is_hw_decoder("avdec_h264"));
+  CHECK(!is_hw_decoder("dav1ddec"));
+}
+
+void test_pick_codec() {
+  const uint8_t ranked[] = {3, 1, 0};   // AV1, H265, H264
+  CHECK(pick_codec(ranked, 3, 0x0f) == Codec::AV1);
+  CHECK(pick_codec(ranked, 3, 0x03) == Codec::H265);
+  CHECK(pick_codec(ranked, 3, 0x04) == Codec::H264);   // ortak yok
+  const uint8_t bogus[] = {9, 2};
+  CHECK(pick_codec(bogus, 2, 0xff) == Codec::VP9);     // bilinmeyen kimlik atlanır
+  CHECK(pick_codec(nullptr, 0, 0xff) == Codec::H264);
+}
+
+std::vector<uint8_t> annexb(std::initializer_list<uint8_t> nal_headers) {
+  std::vector<uint8_t> au;
+  for (uint8_t h : nal_headers) au.insert(au.end(), {0, 0, 0, 1, h, 0x88, 0x84});
+  return au;
+}
+
+std::vector<uint8_t> hevc_annexb(std::initializer_list<int> types) {
+  std::vector<uint8_t> au;
+  for (int t : types) au.insert(au.end(), {0, 0, 1, uint8_t(t << 1), 1, 0xaf});
+  return au;
+}
+
+void test_nonref_h264() {
+  // SEI + nal_ref_idc=0 dilim: referans değil
+  auto au = annexb({0x06, 0x01});
+  CHECK(au_is_nonref(Codec::H264, au.data(), au.size(), false));
+  // referans P dilimi (nal_ref_idc=2), IDR
+  au = annexb({0x41});
+  CHECK(!au_is_nonref(Codec::H264, au.data(), au.size(), false));
+  au = annexb({0x67, 0x68, 0x65});
+  CHECK(!au_is_nonref(Codec::H264, au.data(), au.size(), false));
+  // yalnızca parametre kümeleri: VCL yok
+  au = annexb({0x67, 0x68});
+  CHECK(!au_is_nonref(Codec::H264, au.data(), au.size(), false));
+
+  // avc (4 bayt uzunluk önekli): iki referanssız dilim, ardından bozuk uzunluk
+  const std::vector<uint8_t> avc = {0, 0, 0, 3, 0x01, 0x88, 0x84, 0, 0, 0, 2, 0x01, 0x9a, 0, 0, 0, 99};
+  CHECK(au_is_nonref(Codec::H264, avc.data(), avc.size(), true));
+  CHECK(!au_is_nonref(Codec::VP9, avc.data(), avc.size(), true));
+}
+
+void test_nonref_h265() {
+  auto au = hevc_annexb({35, 0});           // AUD + TRAIL_N
+  CHECK(au_is_nonref(Codec::H265, au.data(), au.size(), false));
+  au = hevc_annexb({0, 8});                 // TRAIL_N + RASL_N
+  CHECK(au_is_nonref(Codec::H265, au.data(), au.size(), false));
+  au = hevc_annexb({1});                    // TRAIL_R
+  CHECK(!au_is_nonref(Codec::H265, au.data(), au.size(), false));
+  au = hevc_annexb({32, 33, 34, 19});       // VPS/SPS/PPS + IDR_W_RADL
+  CHECK(!au_is_nonref(Codec::H265, au.data(), au.size(), false));
+}
+
+}  // namespace
+
+int main() {
+  test_names();
+  test_pick_codec();
+  test_nonref_h264();
+  test_nonref_h265();
+  return test_result();
+}
@@ -0,0 +1,193 @@
+// ctrl_proto: big-endian başlık ve gövde baytları, her mesajın kodla-çöz turu, NACK sınırı,
+// eski PONG ve kısa/yanlış sürümlü datagramların reddi.
+#include "ctrl_proto.hpp"
+#include "check.hpp"
+#include <cstring>
+
+namespace {
+
+using namespace ctrl;
+
+// başlığı doğrulayıp gövdeyi çözer (ControlChannel'ın alım yolu gibi)
+template <typename T>
+bool roundtrip(const uint8_t* buf, size_t n, MsgType type, uint32_t seq, T& out) {
+  const uint8_t* p = buf;
+  Header h;
+  if (!get_header(p, n, h) || h.type != type || h.seq != seq) return false;
+  return decode(p, n, out);
+}
+
+void test_header_layout() {
+  uint8_t buf[MAX_MSG];
+  Ping m;
+  m.t_send_us = 0x0102030405060708ull;
+  const size_t n = encode(buf, 0xA1B2C3D4u, m);
+  CHECK_EQ(n, PING_SIZE);
+  const uint8_t want[] = {MAGIC, VERSION, PING, 0, 0xA1, 0xB2, 0xC3, 0xD4, 1, 2, 3, 4, 5, 6, 7, 8};
+  CHECK(std::memcmp(buf, want, sizeof(want)) == 0);
+
+  const uint8_t* p = buf;
+  Header h;
+  CHECK(get_header(p, n, h));
+  CHECK_EQ(h.type, PING);
+  CHECK_EQ(h.seq, 0xA1B2C3D4u);
+  CHECK(p == buf + HEADER_SIZE);
+}
+
+void test_rejects_bad_header() {
+  uint8_t buf[MAX_MSG];
+  const size_t n = encode(buf, 1, Ping{});
+  Header h;
+  const uint8_t* p = buf;
+  CHECK(!get_header(p, HEADER_SIZE - 1, h));   // kısa
+  buf[1] = VERSION + 1;
+  p = buf;
+  CHECK(!get_header(p, n, h));                  // yanlış sürüm
+  buf[1] = VERSION; buf[0] = 'X';
+  p = buf;
+  CHECK(!get_header(p, n, h));                  // yanlış magic
+}
+
+void test_ping_pong() {
+  uint8_t buf[MAX_MSG];
+  Ping ping;
+  ping.t_send_us = 123456789012345ull;
+  Ping ping2;
+  CHECK(roundtrip(buf, encode(buf, 7, ping), PING, 7, ping2));
+  CHECK_EQ(ping2.t_send_us, ping.t_send_us);
+  CHECK(!decode(buf + HEADER_SIZE, PING_SIZE - 1, ping2));
+
+  Pong pong;
+  pong.t_send_us = 1; pong.t_recv_us = 0xFFFFFFFF00000002ull; pong.t_reply_us = 3;
+  const size_t n = encode(buf, 8, pong);
+  CHECK_EQ(n, PONG_SIZE);
+  Pong out;
+  CHECK(roundtrip(buf, n, PONG, 8, out));
+  CHECK_EQ(out.t_send_us, 1u);
+  CHECK_EQ(out.t_recv_us, 0xFFFFFFFF00000002ull);
+  CHECK_EQ(out.t_reply_us, 3u);
+  // eski sürüm t_reply_us göndermez: alım anı yerine geçer
+  Pong v1;
+  CHECK(roundtrip(buf, PONG_V1_SIZE, PONG, 8, v1));
+  CHECK_EQ(v1.t_reply_us, v1.t_recv_us);
+  CHECK(!decode(buf + HEADER_SIZE, PONG_V1_SIZE - 1, v1));
+}
+
+void test_receiver_report() {
+  uint8_t buf[MAX_MSG];
+  ReceiverReport rr;
+  rr.t_report_us = 0x1122334455667788ull;
+  rr.ext_highest_seq = 3u << 16 | 65535;
+  rr.cumulative_lost = 42; rr.jitter = 900;
+  rr.packets = 1ull << 40; rr.bytes = (1ull << 50) + 7;
+  rr.fec_recovered = 5; rr.fec_unrecovered = 6;
+  const size_t n = encode(buf, 9, rr);
+  CHECK_EQ(n, RR_SIZE);
+  ReceiverReport out;
+  CHECK(roundtrip(buf, n, RR, 9, out));
+  CHECK_EQ(out.t_report_us, rr.t_report_us);
+  CHECK_EQ(out.ext_highest_seq, rr.ext_highest_seq);
+  CHECK_EQ(out.cumulative_lost, 42u);
+  CHECK_EQ(out.jitter, 900u);
+  CHECK_EQ(out.packets, rr.packets);
+  CHECK_EQ(out.bytes, rr.bytes);
+  CHECK_EQ(out.fec_recovered, 5u);
+  CHECK_EQ(out.fec_unrecovered, 6u);
+  CHECK(!decode(buf + HEADER_SIZE, n - 1, out));
+}
+
+void test_nack() {
+  uint8_t buf[MAX_MSG];
+  Nack m;
+  m.budget_ms = 85;
+  m.count = 3;
+  m.seqs[0] = 65535; m.seqs[1] = 0; m.seqs[2] = 0x1234;
+  size_t n = encode(buf, 10, m);
+  CHECK_EQ(n, HEADER_SIZE + 4 + 2 * 3u);
+  Nack out;
+  CHECK(roundtrip(buf, n, NACK, 10, out));
+  CHECK_EQ(out.budget_ms, 85);
+  CHECK_EQ(out.count, 3);
+  CHECK_EQ(out.seqs[0], 65535); CHECK_EQ(out.seqs[1], 0); CHECK_EQ(out.seqs[2], 0x1234);
+  CHECK(!decode(buf + HEADER_SIZE, n - 1, out));   // son sıra numarası eksik
+
+  // MAX_NACK'ten fazlası gönderilmez
+  for (size_t i = 0; i < MAX_NACK; ++i) m.seqs[i] = (uint16_t)(1000 + i);
+  m.count = MAX_NACK + 10;
+  n = encode(buf, 11, m);
+  CHECK_EQ(n, HEADER_SIZE + 4 + 2 * MAX_NACK);
+  CHECK(n <= MAX_MSG);
+  CHECK(roundtrip(buf, n, NACK, 11, out));
+  CHECK_EQ(out.count, MAX_NACK);
+  CHECK_EQ(out.seqs[MAX_NACK - 1], 1000 + MAX_NACK - 1);
+
+  // karşıdan gelen aşırı count reddedilir (seqs taşmaz)
+  uint8_t* p = buf + HEADER_SIZE + 2;
+  put16(p, uint16_t(MAX_NACK + 1));
+  CHECK(!decode(buf + HEADER_SIZE, MAX_MSG, out));
+}
+
+void test_other_messages() {
+  uint8_t buf[MAX_MSG];
+
+  KeyframeRequest kf;
+  kf.reason = KF_DECODE_ERROR;
+  KeyframeRequest kf2;
+  CHECK_EQ(encode(buf, 1, kf), KEYFRAME_REQ_SIZE);
+  CHECK(roundtrip(buf, KEYFRAME_REQ_SIZE, KEYFRAME_REQ, 1, kf2));
+  CHECK_EQ(kf2.reason, KF_DECODE_ERROR);
+
+  PeerUpdate pu;
+  pu.ipv4 = 0xC0A80102; pu.video_port = 5000; pu.ctrl_port = 7001; pu.rx_port = 5001;
+  PeerUpdate pu2;
+  CHECK_EQ(encode(buf, 2, PEER_REMOVE, pu), PEER_UPDATE_SIZE);
+  CHECK(roundtrip(buf, PEER_UPDATE_SIZE, PEER_REMOVE, 2, pu2));
+  CHECK_EQ(pu2.ipv4, 0xC0A80102u);
+  CHECK_EQ(pu2.video_port, 5000); CHECK_EQ(pu2.ctrl_port, 7001); CHECK_EQ(pu2.rx_port, 5001);
+  CHECK(!decode(buf + HEADER_SIZE, PEER_UPDATE_SIZE - 1, pu2));
+
+  LayerSelect ls;
+  ls.layer = 2; ls.reason = LAYER_DECODE_LOAD;
+  LayerSelect ls2;
+  CHECK_EQ(encode(buf, 3, ls), LAYER_SELECT_SIZE);
+  CHECK(roundtrip(buf, LAYER_SELECT_SIZE, LAYER_SELECT, 3, ls2));
+  CHECK_EQ(ls2.layer, 2); CHECK_EQ(ls2.reason, LAYER_DECODE_LOAD);
+
+  SenderReport sr;
+  sr.rtp_ts = 0xDEADBEEF; sr.capture_us = 0x0000123456789ABCull;
+  SenderReport sr2;
+  CHECK_EQ(encode(buf, 4, sr), SENDER_REPORT_SIZE);
+  CHECK(roundtrip(buf, SENDER_REPORT_SIZE, SENDER_REPORT, 4, sr2));
+  CHECK_EQ(sr2.rtp_ts, 0xDEADBEEFu); CHECK_EQ(sr2.capture_us, sr.capture_us);
+
+  Reconfig rc;
+  rc.width = 1280; rc.height = 720; rc.fps = 30; rc.keyint = 60; rc.mtu = 1200; rc.kbps = 4000000;
+  Reconfig rc2;
+  CHECK_EQ(encode(buf, 5, rc), RECONFIG_SIZE);
+  CHECK(roundtrip(buf, RECONFIG_SIZE, RECONFIG, 5, rc2));
+  CHECK_EQ(rc2.width, 1280); CHECK_EQ(rc2.height, 720); CHECK_EQ(rc2.fps, 30);
+  CHECK_EQ(rc2.keyint, 60); CHECK_EQ(rc2.mtu, 1200); CHECK_EQ(rc2.kbps, 4000000u);
+  CHECK(!decode(buf + HEADER_SIZE, RECONFIG_SIZE - 1, rc2));
+
+  CodecCaps cc;
+  cc.decode_mask = 0x0B; cc.ack = ACK_COMMITTED; cc.count = 2; cc.ranked[0] = 3; cc.ranked[1] = 1;
+  CodecCaps cc2;
+  CHECK_EQ(encode(buf, 6, cc), CODEC_CAPS_SIZE);
+  CHECK(roundtrip(buf, CODEC_CAPS_SIZE, CODEC_CAPS, 6, cc2));
+  CHECK_EQ(cc2.decode_mask, 0x0B); CHECK_EQ(cc2.ack, ACK_COMMITTED); CHECK_EQ(cc2.count, 2);
+  CHECK_EQ(cc2.ranked[0], 3); CHECK_EQ(cc2.ranked[1], 1); CHECK_EQ(cc2.ranked[2], 0);
+  buf[HEADER_SIZE + 2] = MAX_CODECS + 1;
+  CHECK(!decode(buf + HEADER_SIZE, CODEC_CAPS_SIZE, cc2));
+}
+
+}  // namespace
+
+int main() {
+  test_header_layout();
+  test_rejects_bad_header();
+  test_ping_pong();
+  test_receiver_report();
+  test_nack();
+  test_other_messages();
+  return test_result();
+}
@@ -0,0 +1,130 @@
+// DiskWriter: blok sınırlarını aşan yazmalar ve hizasız son parça, open()'dan open()'a dosya
+// geçişi, bellek sınırı dolunca beklemeden veri atma. Dosyalar geçici bir dizinde.
+#include "disk_writer.hpp"
+#include "check.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t MiB = DiskWriter::BLOCK_SIZE;
+
+std::string g_dir;
+
+std::vector<uint8_t> pattern(size_t n, uint8_t seed) {
+  std::vector<uint8_t> v(n);
+  for (size_t i = 0; i < n; ++i) v[i] = (uint8_t)(i * 131 + seed + (i >> 12));
+  return v;
+}
+
+std::vector<uint8_t> slurp(const std::string& path) {
+  std::ifstream f(path, std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+// düzensiz parçalarla: kopyalar blok sınırlarına denk gelmesin
+void write_chunked(DiskWriter& w, const std::vector<uint8_t>& data, size_t chunk) {
+  for (size_t off = 0; off < data.size(); off += chunk) w.write(data.data() + off, std::min(chunk, data.size() - off));
+}
+
+void test_blocks_and_tail() {
+  const std::string path = g_dir + "/tail.bin";
+  const auto data = pattern(2 * MiB + 12345, 1);   // iki tam blok + hizasız kuyruk
+  {
+    DiskWriter w(8 * MiB);
+    w.write(data.data(), 100);                      // open() öncesi: atılır
+    w.open(path);
+    write_chunked(w, data, 7777);
+    w.close();
+    w.close();                                      // ikinci close etkisiz
+    CHECK_EQ(w.bytes_dropped(), 100u);
+  }  // yıkıcı kuyruğu boşaltır
+  CHECK(slurp(path) == data);
+}
+
+void test_rollover() {
+  const std::string a = g_dir + "/a.bin", b = g_dir + "/b.bin";
+  const auto da = pattern(MiB + 4096, 2), db = pattern(300000, 3);
+  uint64_t written = 0, files = 0;
+  {
+    DiskWriter w(8 * MiB);
+    w.open(a);
+    write_chunked(w, da, 65536);
+    w.open(b);                                      // a kapanır, kısmi blok a'ya gider
+    write_chunked(w, db, 1500);
+    w.close();
+    // yıkıcıdan önce: I/O thread'i sırayla yetişir
+    for (int i = 0; i < 500 && w.bytes_written() < da.size() + db.size(); ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    written = w.bytes_written();
+    files = w.files();
+    CHECK_EQ(w.bytes_dropped(), 0u);
+  }
+  CHECK_EQ(written, (uint64_t)(da.size() + db.size()));
+  CHECK_EQ(files, 2u);
+  CHECK(slurp(a) == da);
+  CHECK(slurp(b) == db);
+}
+
+// Okuyucusu olmayan FIFO'yu açan I/O thread'i open'da bekler: tıkanmış disk. Üretici iki blokluk
+// sınırı aşınca beklemez, dosyanın kalanını atar ve sonraki open()'a kadar veri kabul etmez.
+void test_limit_drops_instead_of_blocking() {
+  const std::string fifo = g_dir + "/stuck.fifo", next = g_dir + "/next.bin";
+  CHECK_EQ(mkfifo(fifo.c_str(), 0600), 0);
+  const auto data = pattern(3 * MiB, 4), more = pattern(5000, 5), after = pattern(MiB / 2 + 77, 6);
+
+  DiskWriter w(2 * MiB);
+  w.open(fifo);
+  const auto t0 = std::chrono::steady_clock::now();
+  w.write(data.data(), data.size());               // iki blok kuyrukta, üçüncü yok
+  w.write(more.data(), more.size());               // atlama sürüyor
+  CHECK(std::chrono::steady_clock::now() - t0 < std::chrono::seconds(1));
+  CHECK_EQ(w.bytes_dropped(), (uint64_t)(MiB + more.size()));
+  CHECK_EQ(w.bytes_written(), 0u);
+
+  // okuyucu gelir: kuyruktaki iki blok FIFO'ya akar, bloklar havuza döner
+  std::vector<uint8_t> got;
+  std::thread reader([&] {
+    const int fd = ::open(fifo.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    std::vector<uint8_t> buf(65536);
+    for (ssize_t n; (n = ::read(fd, buf.data(), buf.size())) > 0;) got.insert(got.end(), buf.begin(), buf.begin() + n);
+    ::close(fd);
+  });
+  for (int i = 0; i < 1000 && w.bytes_written() < 2 * MiB; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  CHECK_EQ(w.bytes_written(), (uint64_t)(2 * MiB));
+
+  w.open(next);                                     // FIFO kapanır (okuyucu EOF görür), atlama biter
+  w.write(after.data(), after.size());
+  w.close();
+  reader.join();
+  for (int i = 0; i < 500 && w.bytes_written() < 2 * MiB + after.size(); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+  CHECK(got == std::vector<uint8_t>(data.begin(), data.begin() + 2 * MiB));
+  CHECK_EQ(w.bytes_dropped(), (uint64_t)(MiB + more.size()));
+  CHECK(slurp(next) == after);
+}
+
+}  // namespace
+
+int main() {
+  char tmpl[] = "/tmp/nova-disk-writer-XXXXXX";
+  if (!mkdtemp(tmpl)) { std::cerr << "mkdtemp failed\n"; return 1; }
+  g_dir = tmpl;
+  test_blocks_and_tail();
+  test_rollover();
+  test_limit_drops_instead_of_blocking();
+  std::system(("rm -rf '" + g_dir + "'").c_str());
+  return test_result();
+}
@@ -0,0 +1,64 @@
+// FramePacing: kare aralığı istatistikleri ve geç kare sayımı (30 fps nominal, 33333 µs).
+#include "frame_pacing.hpp"
+#include "check.hpp"
+
+namespace {
+
+void test_steady() {
+  FramePacing fp(30);
+  uint64_t t = 1000000;
+  for (int i = 0; i < 31; ++i, t += 33333) fp.on_frame(t);
+  const auto s = fp.take(t - 33333);
+  CHECK_EQ(s.frames, 31u);
+  CHECK_EQ(s.late, 0u);
+  CHECK_NEAR(s.mean_ms, 33.333, 0.001);
+  CHECK_NEAR(s.jitter_ms, 0.0, 0.001);
+  CHECK_NEAR(s.max_ms, 33.333, 0.001);
+  CHECK_NEAR(s.fps, 31.0, 0.01);
+}
+
+void test_late_and_window() {
+  FramePacing fp(30);
+  uint64_t t = 1000000;
+  fp.on_frame(t);
+  fp.on_frame(t += 33000);
+  fp.on_frame(t += 60000);   // 1.5 × nominal'den uzun: geç
+  fp.on_frame(t += 40000);   // 1.2 ×: geç değil
+  auto s = fp.take(t);
+  CHECK_EQ(s.frames, 4u);
+  CHECK_EQ(s.late, 1u);
+  CHECK_NEAR(s.max_ms, 60.0, 0.001);
+  CHECK_NEAR(s.mean_ms, (33.0 + 60.0 + 40.0) / 3, 0.001);
+
+  // yeni pencerenin ilk aralığı önceki son kareden ölçülür
+  fp.on_frame(t += 70000);
+  s = fp.take(t);
+  CHECK_EQ(s.frames, 1u);
+  CHECK_EQ(s.late, 1u);
+  CHECK_NEAR(s.mean_ms, 70.0, 0.001);
+
+  // kare yoksa boş pencere
+  s = fp.take(t + 1000000);
+  CHECK_EQ(s.frames, 0u);
+  CHECK_EQ(s.fps, 0.0);
+  CHECK_EQ(s.mean_ms, 0.0);
+}
+
+void test_bad_nominal() {
+  // geçersiz fps 30 kabul edilir
+  FramePacing fp(0);
+  fp.on_frame(1000000);
+  fp.on_frame(1000000 + 45000);
+  CHECK_EQ(fp.take(1045000).late, 0u);
+  fp.on_frame(1045000 + 55000);
+  CHECK_EQ(fp.take(1100000).late, 1u);
+}
+
+}  // namespace
+
+int main() {
+  test_steady();
+  test_late_and_window();
+  test_bad_nominal();
+  return test_result();
+}
@@ -0,0 +1,100 @@
+// MotionGate: sentetik 320x240 parlaklık düzlemleriyle durağan sahne, küçük hareket, sahne kesmesi
+// ve bütçe aşımı. Bütçe testler dışında ölçümden etkilenmesin diye bol tutulur.
+#include "motion_gate.hpp"
+#include "check.hpp"
+#include <vector>
+
+namespace {
+
+constexpr int W = 320, H = 240;
+constexpr int64_t FRAME_US = 33333;
+
+std::vector<uint8_t> gradient() {
+  std::vector<uint8_t> p((size_t)W * H);
+  for (int y = 0; y < H; ++y)
+    for (int x = 0; x < W; ++x) p[(size_t)y * W + x] = (uint8_t)((x + y) & 0xff);
+  return p;
+}
+
+MotionGate::Config roomy() {
+  MotionGate::Config c;
+  c.budget_us = 1000000;
+  return c;
+}
+
+void test_static_scene_drops() {
+  MotionGate g(roomy());
+  const auto p = gradient();
+  int64_t t = 0;
+  int pass = 0, drop = 0;
+  for (int i = 0; i < 90; ++i, t += FRAME_US) {
+    const auto v = g.on_frame(p.data(), W, W, H, t);
+    CHECK(v != MotionGate::Verdict::Cut);
+    if (t < 1000000) CHECK(v == MotionGate::Verdict::Pass);   // hold_ms dolmadan seyreltme yok
+    (v == MotionGate::Verdict::Drop ? drop : pass)++;
+  }
+  CHECK(g.idle());
+  // ~1 s tam hız, ~2 s 5 fps
+  CHECK(pass >= 35 && pass <= 45);
+  CHECK_EQ(g.dropped(), (uint64_t)drop);
+  CHECK_EQ(g.frames(), 90u);
+}
+
+void test_small_motion_wakes() {
+  MotionGate g(roomy());
+  auto p = gradient();
+  int64_t t = 0;
+  for (int i = 0; i < 60; ++i, t += FRAME_US) g.on_frame(p.data(), W, W, H, t);
+  CHECK(g.idle());
+  // tek karoda 16x16 parlak blok: tüm karenin ortalaması düşük kalsa da en çok değişen karo yakalar
+  for (int y = 100; y < 116; ++y)
+    for (int x = 100; x < 116; ++x) p[(size_t)y * W + x] ^= 0xff;
+  CHECK(g.on_frame(p.data(), W, W, H, t) == MotionGate::Verdict::Pass);
+  CHECK(!g.idle());
+  CHECK_EQ(g.cuts(), 0u);
+}
+
+void test_scene_cut() {
+  MotionGate g(roomy());
+  auto p = gradient();
+  int64_t t = 0;
+  g.on_frame(p.data(), W, W, H, t);
+  for (auto& b : p) b ^= 0x80;
+  CHECK(g.on_frame(p.data(), W, W, H, t += FRAME_US) == MotionGate::Verdict::Cut);
+  CHECK_EQ(g.cuts(), 1u);
+  // bekleme süresi içinde ikinci kesme IDR istemez
+  for (auto& b : p) b ^= 0x80;
+  CHECK(g.on_frame(p.data(), W, W, H, t += FRAME_US) == MotionGate::Verdict::Pass);
+  for (auto& b : p) b ^= 0x80;
+  CHECK(g.on_frame(p.data(), W, W, H, t += 1000000) == MotionGate::Verdict::Cut);
+  CHECK_EQ(g.cuts(), 2u);
+}
+
+void test_tiny_and_null_frames_pass() {
+  MotionGate g(roomy());
+  std::vector<uint8_t> small(64 * 4);
+  for (int i = 0; i < 5; ++i) CHECK(g.on_frame(small.data(), 64, 64, 4, i * FRAME_US) == MotionGate::Verdict::Pass);
+  CHECK(g.on_frame(nullptr, W, W, H, 0) == MotionGate::Verdict::Pass);
+}
+
+void test_over_budget_disables() {
+  MotionGate::Config c;
+  c.budget_us = 0;   // her ölçüm bütçeyi aşar
+  MotionGate g(c);
+  const auto p = gradient();
+  for (int i = 0; i < 60 && !g.disabled(); ++i) g.on_frame(p.data(), W, W, H, i * FRAME_US);
+  CHECK(g.disabled());
+  CHECK_EQ(g.row_step(), 16);
+  CHECK(!g.idle());
+}
+
+}  // namespace
+
+int main() {
+  test_static_scene_drops();
+  test_small_motion_wakes();
+  test_scene_cut();
+  test_tiny_and_null_frames_pass();
+  test_over_budget_disables();
+  return test_result();
+}
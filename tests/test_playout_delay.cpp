@@ -0,0 +1,92 @@
+// DelayTracker yüzdeliği sentetik varış zamanlarıyla (90 kHz RTP saati), PlayoutDelay hedefi
+// yüzdelik ve geç paket oranı dizileriyle sınanır.
+#include "playout_delay.hpp"
+#include "check.hpp"
+
+namespace {
+
+// t_us anında gönderilen paket delay_us gecikmeyle varır.
+void feed(DelayTracker& d, uint64_t t_us, uint64_t delay_us) {
+  d.on_packet(static_cast<uint32_t>(t_us * 90 / 1000), (t_us + delay_us) * 1000ULL);
+}
+
+void test_low_rate_exact() {
+  // 100 pkt/s, her 10. paket 20 ms geç: %10 seyrek gecikme p95'te görünür, p50'de görünmez
+  DelayTracker p95(90000, 5000), p50(90000, 5000);
+  p95.set_percentile(0.95);
+  p50.set_percentile(0.50);
+  for (uint64_t i = 0; i < 400; ++i) {
+    const uint64_t delay = (i % 10 == 0) ? 20000 : 0;
+    feed(p95, i * 10000, delay);
+    feed(p50, i * 10000, delay);
+  }
+  CHECK_NEAR(p95.percentile_ms(), 20.0, 0.01);
+  CHECK_NEAR(p50.percentile_ms(), 0.0, 0.01);
+}
+
+void test_high_rate_covers_window() {
+  // 20000 pkt/s: 5 s pencerede 100000 paket. İlk 2 s'de paketlerin %10'u 40 ms geç, sonrası temiz.
+  // Pencerenin %4'ü geç → p97 40 ms olmalı; yalnızca son ~16k paketi tutan bir tampon 0 görürdü.
+  DelayTracker d(90000, 5000);
+  d.set_percentile(0.97);
+  uint64_t t_us = 0;
+  for (uint64_t i = 0; i < 100000; ++i, t_us += 50) feed(d, t_us, (t_us < 2000000 && i % 10 == 0) ? 40000 : 0);
+  CHECK_NEAR(d.percentile_ms(), 40.0, 0.01);
+
+  // gecikmeli bölüm pencereden çıkınca yüzdelik düşer
+  for (uint64_t i = 0; i < 60000; ++i, t_us += 50) feed(d, t_us, 0);
+  CHECK_NEAR(d.percentile_ms(), 0.0, 0.01);
+}
+
+void test_reset() {
+  DelayTracker d(90000, 5000);
+  d.set_percentile(0.99);
+  for (uint64_t i = 0; i < 200; ++i) feed(d, i * 10000, (i % 2) ? 30000 : 0);
+  CHECK(d.percentile_ms() > 25.0);
+  d.reset();
+  CHECK_EQ(d.percentile_ms(), 0.0);
+  for (uint64_t i = 0; i < 200; ++i) feed(d, 10000000 + i * 10000, 0);
+  CHECK_NEAR(d.percentile_ms(), 0.0, 0.01);
+}
+
+void test_controller() {
+  PlayoutDelay pd(20, 200, 50);
+  CHECK_EQ(pd.current_ms(), 50);
+  int64_t t = 0;
+  CHECK_EQ(pd.update(0, 0, 0, t), 0);   // ilk çağrı yalnızca sayaçları alır
+
+  // yüzdelik artınca hedef hemen büyür: 100 × 1.2 + 5
+  CHECK_EQ(pd.update(100, 0, 1000, t += 250), 125);
+  // %1 geç paket: ×1.3
+  CHECK_EQ(pd.update(100, 10, 1990, t += 250), 163);
+  CHECK_NEAR(pd.late_rate(), 0.01, 1e-9);
+  // üst sınır
+  CHECK_EQ(pd.update(100, 20, 2980, t += 250), 200);
+
+  // sakin: 3 s boyunca küçülmez, sonra saniyede %10 (en az min)
+  uint64_t delivered = 2980;
+  int shrinks = 0, last = pd.current_ms();
+  for (int i = 0; i < 11; ++i) { delivered += 1000; CHECK_EQ(pd.update(0, 20, delivered, t += 250), 0); }
+  for (int i = 0; i < 200; ++i) {
+    delivered += 1000;
+    const int r = pd.update(0, 20, delivered, t += 250);
+    if (r) { CHECK(r < last); last = r; ++shrinks; }
+  }
+  CHECK(shrinks > 5);
+  // hedef min'e iner; son adım 5 ms'den küçükse uygulanmaz (histerezis)
+  const int floor_ms = pd.current_ms();
+  CHECK(floor_ms >= 20 && floor_ms < 25);
+  CHECK_EQ(pd.update(10, 20, delivered += 1000, t += 250), 0);
+  CHECK_EQ(pd.current_ms(), floor_ms);
+  CHECK_EQ(pd.update(20, 20, delivered += 1000, t += 250), 29);
+}
+
+}  // namespace
+
+int main() {
+  test_low_rate_exact();
+  test_high_rate_covers_window();
+  test_reset();
+  test_controller();
+  return test_result();
+}
@@ -0,0 +1,134 @@
+// RateController: sentetik RR ve RTT dizileriyle gecikme/kayıp kesmeleri, kesme sonrası bekleme,
+// büyüme ve tavanı, uygulama eşiği ve canlı üst sınır. Saat enjekte edilir (ms).
+#include "rate_control.hpp"
+#include "check.hpp"
+
+namespace {
+
+// Kümülatif RR üretici: her adımda dt_ms içinde kbps hızla alınmış paket/bayt eklenir.
+struct Feed {
+  RateReport r;
+  int64_t t = 10000;
+  int step(RateController& rc, int64_t dt_ms, double kbps, uint64_t recv = 100, uint64_t lost = 0) {
+    t += dt_ms;
+    r.received += recv;
+    r.lost += lost;
+    r.bytes += (uint64_t)(kbps * (double)dt_ms / 8.0);
+    return rc.on_report(r, t);
+  }
+};
+
+void test_first_report_primes() {
+  RateController rc(1000, 20000, 10000);
+  Feed f;
+  CHECK_EQ(f.step(rc, 0, 0), 0);
+  CHECK_EQ(rc.target_kbps(), 10000);
+}
+
+void test_overuse_cuts_to_receive_rate() {
+  RateController rc(1000, 20000, 10000);
+  Feed f;
+  int64_t t = 0;
+  for (int i = 0; i < 10; ++i, t += 100) rc.on_rtt(20, t);
+  for (double rtt = 40; rtt <= 200; rtt += 20, t += 100) rc.on_rtt(rtt, t);   // kuyruk doluyor
+  CHECK(rc.queue_delay_ms() > 25 && rc.queue_delay_ms() < 150);
+
+  f.t = t;
+  f.step(rc, 0, 0);
+  CHECK_NEAR(f.step(rc, 250, 6000), 0.85 * 6000, 1);
+  CHECK_NEAR(rc.target_kbps(), 0.85 * 6000, 1);
+  // bir RTT içinde ikinci kesme yok
+  CHECK_EQ(f.step(rc, 100, 3000), 0);
+  CHECK_NEAR(rc.target_kbps(), 0.85 * 6000, 1);
+}
+
+void test_loss_cut() {
+  RateController rc(1000, 20000, 10000);
+  Feed f;
+  f.step(rc, 0, 0);
+  // %20 kayıp (%10 sınırının üstünde): hedef x (1 - 0.2/2)
+  CHECK_EQ(f.step(rc, 250, 10000, 80, 20), 9000);
+  CHECK_NEAR(rc.loss(), 0.2, 1e-9);
+  // %5 kayıp: kesme de büyüme de yok
+  CHECK_EQ(f.step(rc, 250, 10000, 95, 5), 0);
+  CHECK_EQ(rc.target_kbps(), 9000);
+}
+
+void test_hold_after_cut() {
+  RateController rc(1000, 20000, 10000);
+  Feed f;
+  f.step(rc, 0, 0);
+  CHECK_EQ(f.step(rc, 250, 10000, 80, 20), 9000);
+  const int64_t cut = f.t;
+  // kayıpsız raporlar: 1 s dolana kadar hedef sabit
+  while (f.t + 250 < cut + 1000) {
+    CHECK_EQ(f.step(rc, 250, 20000), 0);
+    CHECK_EQ(rc.target_kbps(), 9000);
+  }
+  f.step(rc, cut + 1000 - f.t, 20000);
+  CHECK(rc.target_kbps() > 9000);
+}
+
+void test_growth_rate_and_cap() {
+  {
+    RateController rc(1000, 20000, 10000);
+    Feed f;
+    f.step(rc, 0, 0);
+    CHECK_NEAR(f.step(rc, 1000, 20000), 10800, 1);   // %8/s
+    CHECK_NEAR(f.step(rc, 1000, 20000), 11664, 1);
+  }
+  {
+    // alınan hız 4000: hedef 1.5 x 4000'de durur
+    RateController rc(1000, 20000, 5000);
+    Feed f;
+    f.step(rc, 0, 0);
+    for (int i = 0; i < 10; ++i) f.step(rc, 1000, 4000);
+    CHECK_EQ(rc.target_kbps(), 6000);
+    // hedef zaten tavanın üstündeyse düşürülmez (durağan sahne)
+    for (int i = 0; i < 4; ++i) f.step(rc, 1000, 1000);
+    CHECK_EQ(rc.target_kbps(), 6000);
+  }
+}
+
+void test_apply_hysteresis() {
+  RateController rc(1000, 20000, 10000);
+  Feed f;
+  f.step(rc, 0, 0);
+  // 250 ms'de ~%1.9 büyüme: %3'ün altında, kodlayıcıya uygulanmaz
+  CHECK_EQ(f.step(rc, 250, 20000), 0);
+  CHECK(rc.target_kbps() > 10000);
+  // ikinci adımda toplam ~%3.9: uygulanır
+  const int applied = f.step(rc, 250, 20000);
+  CHECK(applied > 10300);
+  CHECK_EQ(applied, rc.target_kbps());
+  CHECK_EQ(f.step(rc, 250, 20000), 0);
+}
+
+void test_set_max_kbps() {
+  RateController start(1000, 20000, 50000);
+  CHECK_EQ(start.target_kbps(), 20000);   // başlangıç sınırlara kırpılır
+
+  RateController rc(1000, 20000, 15000);
+  CHECK_EQ(rc.set_max_kbps(8000), 8000);
+  CHECK_EQ(rc.target_kbps(), 8000);
+  CHECK_EQ(rc.set_max_kbps(500), 1000);   // alt sınırın altına inmez
+  // yükselişte hedef kendiliğinden sıçramaz
+  CHECK_EQ(rc.set_max_kbps(20000), 1000);
+  Feed f;
+  f.step(rc, 0, 0);
+  for (int i = 0; i < 60; ++i) f.step(rc, 1000, 100000);
+  CHECK_EQ(rc.target_kbps(), 20000);
+}
+
+}  // namespace
+
+int main() {
+  test_first_report_primes();
+  test_overuse_cuts_to_receive_rate();
+  test_loss_cut();
+  test_hold_after_cut();
+  test_growth_rate_and_cap();
+  test_apply_hysteresis();
+  test_set_max_kbps();
+  return test_result();
+}
@@ -0,0 +1,127 @@
+// RtxHistory halkası ve RtxServer'ın NACK yanıtı; yeniden gönderimler loopback soketten okunur.
+#include "rtx.hpp"
+#include "check.hpp"
+#include <cstring>
+#include <vector>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+std::vector<uint8_t> packet(uint16_t seq, size_t len) {
+  std::vector<uint8_t> p(len);
+  for (size_t i = 0; i < len; ++i) p[i] = (uint8_t)(seq + i);
+  return p;
+}
+
+void test_history() {
+  RtxHistory h;
+  uint8_t out[RtxHistory::MAX_PKT];
+  CHECK_EQ(h.lookup(7, out), 0u);
+
+  const auto p = packet(7, 1200);
+  h.store(7, p.data(), p.size());
+  CHECK_EQ(h.lookup(7, out), 1200u);
+  CHECK(std::memcmp(out, p.data(), p.size()) == 0);
+
+  // aynı yuvaya düşen sonraki seq eskisini ezer
+  const uint16_t later = (uint16_t)(7 + RtxHistory::SLOTS);
+  const auto q = packet(later, 100);
+  h.store(later, q.data(), q.size());
+  CHECK_EQ(h.lookup(7, out), 0u);
+  CHECK_EQ(h.lookup(later, out), 100u);
+
+  // seq sarması: 65535 ve 0 ayrı yuvalar
+  h.store(65535, p.data(), 10);
+  h.store(0, q.data(), 20);
+  CHECK_EQ(h.lookup(65535, out), 10u);
+  CHECK_EQ(h.lookup(0, out), 20u);
+
+  // boş ve MTU'dan büyük paket saklanmaz
+  std::vector<uint8_t> big(RtxHistory::MAX_PKT + 1);
+  h.store(42, big.data(), big.size());
+  h.store(43, big.data(), 0);
+  CHECK_EQ(h.lookup(42, out), 0u);
+  CHECK_EQ(h.lookup(43, out), 0u);
+}
+
+int bind_loopback(int& port) {
+  const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  sockaddr_in a{};
+  a.sin_family = AF_INET;
+  a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t alen = sizeof(a);
+  if (fd < 0 || bind(fd, (const sockaddr*)&a, sizeof(a)) < 0 || getsockname(fd, (sockaddr*)&a, &alen) < 0) {
+    if (fd >= 0) close(fd);
+    return -1;
+  }
+  port = ntohs(a.sin_port);
+  return fd;
+}
+
+size_t recv_all(int fd, std::vector<std::vector<uint8_t>>& got) {
+  uint8_t buf[2048];
+  pollfd pfd{fd, POLLIN, 0};
+  while (poll(&pfd, 1, 200) > 0) {
+    const ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) break;
+    got.emplace_back(buf, buf + n);
+  }
+  return got.size();
+}
+
+void test_server_resends() {
+  int port = 0;
+  const int rx = bind_loopback(port);
+  CHECK(rx >= 0);
+  if (rx < 0) return;
+
+  RtxServer srv("127.0.0.1", port);
+  for (uint16_t s = 100; s < 110; ++s) {
+    const auto p = packet(s, 200 + s);
+    srv.history().store(s, p.data(), p.size());
+  }
+  const uint16_t nack[] = {101, 105, 500};
+  srv.on_nack(nack, 3, 100, 20.0);
+  std::vector<std::vector<uint8_t>> got;
+  CHECK_EQ(recv_all(rx, got), 2u);
+  CHECK_EQ(srv.resent(), 2u);
+  CHECK_EQ(srv.missing(), 1u);
+  if (got.size() == 2) {
+    CHECK(got[0] == packet(101, 301));
+    CHECK(got[1] == packet(105, 305));
+  }
+
+  // RTT oynatma bütçesini aşıyorsa paket geç kalır: hiç gönderilmez
+  srv.on_nack(nack, 2, 30, 40.0);
+  CHECK_EQ(srv.skipped(), 2u);
+  got.clear();
+  CHECK_EQ(recv_all(rx, got), 0u);
+
+  // çok eşli mod: açık hedef adrese gönderilir
+  int port2 = 0;
+  const int rx2 = bind_loopback(port2);
+  if (rx2 >= 0) {
+    sockaddr_in to{};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(port2);
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    srv.on_nack(nack, 1, 100, 1.0, &to);
+    got.clear();
+    CHECK_EQ(recv_all(rx2, got), 1u);
+    got.clear();
+    CHECK_EQ(recv_all(rx, got), 0u);
+    close(rx2);
+  }
+  close(rx);
+}
+
+}  // namespace
+
+int main() {
+  test_history();
+  test_server_resends();
+  return test_result();
+}
@@ -0,0 +1,142 @@
+// UdpRxRing loopback üzerinden: yeniden sıralama, AU teslimi, boşluk zaman aşımı, FEC ayıklama,
+// geç ve yinelenen paketler. Teslim edilen slotlar işleyicide release() ile havuza döner.
+#include "udp_rx_ring.hpp"
+#include "check.hpp"
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int PT = 96, FEC_PT = 127, LATENCY_MS = 30;
+
+struct Au { std::vector<uint16_t> seqs; bool discont; };
+
+int free_port() {
+  const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in a{};
+  a.sin_family = AF_INET;
+  a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t alen = sizeof(a);
+  int port = -1;
+  if (fd >= 0 && bind(fd, (const sockaddr*)&a, sizeof(a)) == 0 && getsockname(fd, (sockaddr*)&a, &alen) == 0)
+    port = ntohs(a.sin_port);
+  if (fd >= 0) close(fd);
+  return port;
+}
+
+class Sender {
+ public:
+  explicit Sender(int port) : fd_(::socket(AF_INET, SOCK_DGRAM, 0)) {
+    to_.sin_family = AF_INET;
+    to_.sin_port = htons(port);
+    to_.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  }
+  ~Sender() { if (fd_ >= 0) close(fd_); }
+
+  void rtp(uint16_t seq, uint32_t ts, bool marker, int pt = PT) {
+    uint8_t p[16] = {0x80, (uint8_t)((marker ? 0x80 : 0) | pt), (uint8_t)(seq >> 8), (uint8_t)seq,
+                     (uint8_t)(ts >> 24), (uint8_t)(ts >> 16), (uint8_t)(ts >> 8), (uint8_t)ts,
+                     0, 0, 0, 1, (uint8_t)seq, 0, 0, 0};
+    sendto(fd_, p, sizeof(p), 0, (const sockaddr*)&to_, sizeof(to_));
+  }
+  void raw(const void* data, size_t len) { sendto(fd_, data, len, 0, (const sockaddr*)&to_, sizeof(to_)); }
+
+ private:
+  int fd_;
+  sockaddr_in to_{};
+};
+
+// koşul sağlanana ya da 2 s dolana kadar bekler
+template <class F>
+bool wait_for(F cond) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (!cond()) {
+    if (std::chrono::steady_clock::now() > deadline) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  return true;
+}
+
+void test_ring() {
+  const int port = free_port();
+  CHECK(port > 0);
+  if (port <= 0) return;
+
+  UdpRxRing ring(port, LATENCY_MS, PT);
+  CHECK(ring.ok());
+  if (!ring.ok()) return;
+
+  std::mutex mu;
+  std::vector<Au> aus;
+  uint64_t media_pkts = 0;
+  ring.on_packet([&](uint16_t, uint32_t, uint64_t, size_t, bool) { std::lock_guard<std::mutex> lk(mu); ++media_pkts; });
+  ring.on_au([&](const RxPacket* p, size_t n, bool discont) {
+    Au au{{}, discont};
+    for (size_t i = 0; i < n; ++i) {
+      au.seqs.push_back(uint16_t(p[i].data[2] << 8 | p[i].data[3]));
+      ring.release(p[i].slot);
+    }
+    std::lock_guard<std::mutex> lk(mu);
+    aus.push_back(au);
+  });
+  auto au_count = [&] { std::lock_guard<std::mutex> lk(mu); return aus.size(); };
+  CHECK(ring.start());
+
+  Sender tx(port);
+  // ters sırada gelen AU sıraya konur
+  tx.rtp(10, 1000, false);
+  tx.rtp(11, 1000, true);
+  CHECK(wait_for([&] { return au_count() == 1; }));
+  // marker önce gelir; 12 latency içinde boşluğu doldurunca AU tamamlanır
+  tx.rtp(13, 2000, true);
+  tx.rtp(12, 2000, false);
+  CHECK(wait_for([&] { return au_count() == 2; }));
+
+  // 15 kayıp: latency sonra 14 (eksik AU'nun başı) teslim edilir, 16 discont ile gelir
+  tx.rtp(14, 3000, false);
+  tx.rtp(16, 3000, true);
+  CHECK(wait_for([&] { return au_count() == 4; }));
+  CHECK_EQ(ring.lost(), 1u);
+
+  // 15 artık geç; FEC paketi sıra uzayında yer tutar ama teslim edilmez; 18 yinelenir
+  tx.rtp(15, 3000, false);
+  tx.rtp(17, 0, false, FEC_PT);
+  tx.rtp(18, 4000, false);
+  tx.rtp(18, 4000, false);
+  tx.rtp(19, 4000, true);
+  // RTP olmayan datagram atılır
+  const char junk[4] = {1, 2, 3, 4};
+  tx.raw(junk, sizeof(junk));
+  CHECK(wait_for([&] { return au_count() == 5; }));
+
+  ring.stop();
+  std::lock_guard<std::mutex> lk(mu);
+  CHECK_EQ(aus.size(), 5u);
+  if (aus.size() == 5) {
+    CHECK(aus[0].seqs == (std::vector<uint16_t>{10, 11}));
+    CHECK(aus[1].seqs == (std::vector<uint16_t>{12, 13}));
+    CHECK(aus[2].seqs == (std::vector<uint16_t>{14}));
+    CHECK(aus[3].seqs == (std::vector<uint16_t>{16}));
+    CHECK(aus[3].discont);
+    CHECK(aus[4].seqs == (std::vector<uint16_t>{18, 19}));
+    CHECK(!aus[0].discont && !aus[4].discont);
+  }
+  CHECK_EQ(ring.late(), 1u);
+  CHECK_EQ(ring.duplicates(), 1u);
+  CHECK_EQ(ring.delivered(), 8u);
+  CHECK_EQ(ring.packets(), 11u);   // junk hariç, FEC ve yinelenen dahil
+  CHECK_EQ(media_pkts, 10u);
+  CHECK_EQ(ring.pool_empty(), 0u);
+}
+
+}  // namespace
+
+int main() {
+  test_ring();
+  return test_result();
+}